@@ -0,0 +1,116 @@
+// Dabs per second for 64 px brush dabs, per pixel format, with and without the mask cache;
+// the best of a few runs, as painting is short bursts on a warm core.
+// Baseline and AVX2 runs must agree to within a step of 8-bit rounding, which FMA contraction
+// can move; the exit code reports a mismatch.
+#include "2D/Image/DabMaskCache.h"
+#include "2D/Image/DabRasterizer.h"
+#include "2D/Image/Simd.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+using namespace AstralEngine::D2;
+
+namespace {
+    const char* formatName(PixelFormat format) {
+        switch (format) {
+            case PixelFormat::RGBA8: return "RGBA8";
+            case PixelFormat::RGBA16: return "RGBA16";
+            case PixelFormat::RGBA32F: return "RGBA32F";
+        }
+        return "?";
+    }
+
+    // Strokes across the whole image so tiles stay cold like in real painting
+    std::unique_ptr<TiledImage> paint(PixelFormat format, bool cached, uint32_t dabs, double& dabsPerSecond) {
+        auto image = std::make_unique<TiledImage>(2048, 2048, format);
+        DabMaskCache cache;
+        Dab dab;
+        dab.radius = 32.0f;
+        dab.hardness = 0.5f;
+        dab.opacity = 0.5f;
+        dab.color = {0.8f, 0.3f, 0.1f, 1.0f};
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < dabs; ++i) {
+            dab.center = {100.0f + static_cast<float>(i % 1800) * 1.013f, 100.0f + static_cast<float>(i / 1800 % 12) * 150.37f};
+            DabRasterizer::stamp(*image, dab, nullptr, cached ? &cache : nullptr);
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        dabsPerSecond = dabs / seconds;
+        return image;
+    }
+
+    float channel(const uint8_t* data, PixelFormat format, size_t index) {
+        switch (format) {
+            case PixelFormat::RGBA8: return data[index] / 255.0f;
+            case PixelFormat::RGBA16: return reinterpret_cast<const uint16_t*>(data)[index] / 65535.0f;
+            case PixelFormat::RGBA32F: return reinterpret_cast<const float*>(data)[index];
+        }
+        return 0.0f;
+    }
+
+    // Largest channel difference, in 8-bit steps
+    float maxDifference(const TiledImage& a, const TiledImage& b) {
+        float difference = 0.0f;
+        const PixelFormat format = a.getFormat();
+        for (uint32_t ty = 0; ty < a.getTilesY(); ++ty) {
+            for (uint32_t tx = 0; tx < a.getTilesX(); ++tx) {
+                const Tile* ta = a.getTile(tx, ty);
+                const Tile* tb = b.getTile(tx, ty);
+                if (!ta || !tb) {
+                    if (ta != tb) {
+                        return 255.0f;
+                    }
+                    continue;
+                }
+                for (size_t i = 0; i < static_cast<size_t>(TILE_PIXELS) * 4; ++i) {
+                    const float d = std::fabs(channel(ta->getData(), format, i) - channel(tb->getData(), format, i));
+                    difference = std::max(difference, d * 255.0f);
+                }
+            }
+        }
+        return difference;
+    }
+}
+
+int main(int argc, char** argv) {
+    const bool quick = argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+    const uint32_t dabs = quick ? 2000 : 20000;
+    const int runs = quick ? 1 : 3;
+    const bool avx2 = Simd::hasAvx2();
+    bool ok = true;
+
+    std::printf("%-8s %-9s %14s %14s\n", "format", "mask", "baseline", avx2 ? "avx2" : "avx2 (n/a)");
+    for (PixelFormat format : {PixelFormat::RGBA8, PixelFormat::RGBA16, PixelFormat::RGBA32F}) {
+        for (bool cached : {false, true}) {
+            double baselineRate = 0.0, avx2Rate = 0.0, rate = 0.0;
+            Simd::setAvx2Enabled(false);
+            std::unique_ptr<TiledImage> baseline;
+            for (int run = 0; run < runs; ++run) {
+                baseline = paint(format, cached, dabs, rate);
+                baselineRate = std::max(baselineRate, rate);
+            }
+            Simd::setAvx2Enabled(true);
+            if (avx2) {
+                std::unique_ptr<TiledImage> wide;
+                for (int run = 0; run < runs; ++run) {
+                    wide = paint(format, cached, dabs, rate);
+                    avx2Rate = std::max(avx2Rate, rate);
+                }
+                const float difference = maxDifference(*baseline, *wide);
+                if (difference > 1.01f) {
+                    std::printf("MISMATCH: %s %s differs by %.2f between baseline and AVX2\n", formatName(format),
+                                cached ? "cached" : "computed", difference);
+                    ok = false;
+                }
+            }
+            std::printf("%-8s %-9s %9.0f dab/s %9.0f dab/s\n", formatName(format), cached ? "cached" : "computed",
+                        baselineRate, avx2Rate);
+        }
+    }
+    return ok ? 0 : 1;
+}
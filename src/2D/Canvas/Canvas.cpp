@@ -1,10 +1,14 @@
 #include "2D/Canvas/Canvas.h"
 #include "Core/Logger.h"
 #include "2D/Layers/Layer.h"
+#include "2D/Image/TileStore.h"
 #include "Renderer/RRenderer.h"
 #include "Renderer/Shader.h"
 #include "Renderer/Model.h"
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 namespace AstralEngine {
     namespace D2 {
@@ -49,6 +53,8 @@ namespace AstralEngine {
             canvas.width = width;
             canvas.height = height;
             
+            m_canvasStates[canvasId].compositor.resize(width, height);
+            
             AE_DEBUG("Canvas oluşturuldu: {}x{} (ID: {})", width, height, canvasId);
             return canvasId;
         }
@@ -65,10 +71,16 @@ namespace AstralEngine {
             canvas.width = width;
             canvas.height = height;
             
+            // The composite is rebuilt in full and the texture recreated on the next render
+            auto& state = m_canvasStates[canvasId];
+            state.compositor.resize(width, height);
+            state.texture.reset();
+            state.textureLevel = 0;
+            
             AE_DEBUG("Canvas yeniden boyutlandırıldı: {}x{} (ID: {})", width, height, canvasId);
         }
         
-        void CanvasSystem::renderCanvas(ECS::EntityID canvasId, const std::vector<ECS::EntityID>& layers) {
+        void CanvasSystem::renderCanvas(ECS::EntityID canvasId, const std::vector<ECS::EntityID>& layers, ECS::EntityID activeLayer) {
             // Check if the canvas exists
             if (!m_scene.hasComponent<Canvas>(canvasId)) {
                 AE_WARN("Canvas bulunamadı: {}", canvasId);
@@ -78,16 +90,41 @@ namespace AstralEngine {
             // Get the canvas
             const auto& canvas = m_scene.getComponent<Canvas>(canvasId);
             
-            // For now, we'll just log the operation
-            // In a full implementation, we would:
-            // 1. Clear the framebuffer with the background color
-            // 2. Render each layer in order
-            // 3. Apply layer blending modes
-            // 4. Render grid if enabled
-            // 5. Render any UI elements on top
+            // Flatten the layers that changed since the last frame
+            std::vector<Layer*> layerComponents;
+            layerComponents.reserve(layers.size());
+            for (ECS::EntityID layerId : layers) {
+                if (m_scene.hasComponent<Layer>(layerId)) {
+                    layerComponents.push_back(&m_scene.getComponent<Layer>(layerId));
+                }
+            }
+            
+            // The composite takes the document's format from its layers
+            PixelFormat format = PixelFormat::RGBA8;
+            for (const Layer* layer : layerComponents) {
+                if (layer->pixels) {
+                    format = layer->pixels->getFormat();
+                    break;
+                }
+            }
+            
+            auto& state = m_canvasStates[canvasId];
+            state.compositor.resize(canvas.width, canvas.height, format);
+            const Layer* active = activeLayer != ECS::INVALID_ENTITY && m_scene.hasComponent<Layer>(activeLayer)
+                ? &m_scene.getComponent<Layer>(activeLayer) : nullptr;
+            const auto& updatedTiles = state.compositor.update(layerComponents, active);
+            
+            // Zoomed out, the view samples a reduced level, which is also all that gets uploaded
+            const uint32_t level = state.compositor.getPyramid().getLevelForScale(canvas.zoom);
+            if (level != state.textureLevel) {
+                state.texture.reset();
+                state.textureLevel = level;
+            }
+            uploadTiles(canvasId, state, level == 0 ? updatedTiles : state.compositor.updateLevel(level));
+            prefetchVisibleTiles(canvas, state, active);
             
-            AE_DEBUG("Canvas render ediliyor: {}x{} (ID: {}), {} layer", 
-                     canvas.width, canvas.height, canvasId, layers.size());
+            AE_DEBUG("Canvas render ediliyor: {}x{} (ID: {}), {} layer, {} tile güncellendi", 
+                     canvas.width, canvas.height, canvasId, layers.size(), updatedTiles.size());
             
             // Render grid if enabled
             if (canvas.showGrid) {
@@ -95,6 +132,73 @@ namespace AstralEngine {
             }
         }
         
+        const TiledImage* CanvasSystem::getComposite(ECS::EntityID canvasId) const {
+            auto it = m_canvasStates.find(canvasId);
+            return it != m_canvasStates.end() ? it->second.compositor.getComposite() : nullptr;
+        }
+        
+        std::shared_ptr<Texture> CanvasSystem::getCanvasTexture(ECS::EntityID canvasId) const {
+            auto it = m_canvasStates.find(canvasId);
+            return it != m_canvasStates.end() ? it->second.texture : nullptr;
+        }
+        
+        uint32_t CanvasSystem::getCanvasTextureLevel(ECS::EntityID canvasId) const {
+            auto it = m_canvasStates.find(canvasId);
+            return it != m_canvasStates.end() ? it->second.textureLevel : 0;
+        }
+        
+        void CanvasSystem::uploadTiles(ECS::EntityID canvasId, CanvasState& state, const std::vector<uint32_t>& tiles) {
+            const TiledImage* composite = state.compositor.getLevel(state.textureLevel);
+            if (!m_renderer || !composite) {
+                return;
+            }
+            
+            // A new texture starts empty and receives every tile
+            if (!state.texture) {
+                state.texture = std::make_shared<Texture>(m_renderer->getDevice(), composite->getWidth(), composite->getHeight(),
+                                                          VK_FORMAT_R8G8B8A8_UNORM, nullptr, false);
+                std::vector<uint32_t> allTiles(composite->getTileCount());
+                for (uint32_t i = 0; i < composite->getTileCount(); ++i) {
+                    allTiles[i] = i;
+                }
+                uploadTiles(canvasId, state, allTiles);
+                return;
+            }
+            if (tiles.empty()) {
+                return;
+            }
+            
+            // Pack the changed tiles, clipped to the canvas, into one staging upload
+            state.regions.clear();
+            state.uploadBuffer.clear();
+            for (uint32_t index : tiles) {
+                const uint32_t tx = index % composite->getTilesX();
+                const uint32_t ty = index / composite->getTilesX();
+                TextureRegion region;
+                region.x = tx * TILE_SIZE;
+                region.y = ty * TILE_SIZE;
+                region.width = std::min(TILE_SIZE, composite->getWidth() - region.x);
+                region.height = std::min(TILE_SIZE, composite->getHeight() - region.y);
+                state.regions.push_back(region);
+                
+                const size_t rowBytes = static_cast<size_t>(region.width) * 4;
+                const size_t offset = state.uploadBuffer.size();
+                state.uploadBuffer.resize(offset + rowBytes * region.height);
+                uint8_t* dst = state.uploadBuffer.data() + offset;
+                const Tile* tile = composite->getTile(tx, ty);
+                if (!tile) {
+                    std::memset(dst, 0, rowBytes * region.height);
+                    continue;
+                }
+                for (uint32_t y = 0; y < region.height; ++y) {
+                    std::memcpy(dst + y * rowBytes, tile->getData() + static_cast<size_t>(y) * TILE_SIZE * 4, rowBytes);
+                }
+            }
+            state.texture->updateRegions(state.regions, state.uploadBuffer.data());
+            
+            AE_DEBUG("Canvas texture güncellendi: {} tile (ID: {})", tiles.size(), canvasId);
+        }
+        
         void CanvasSystem::handleInput(const InputEvent& event, ECS::EntityID canvasId) {
             // Check if the canvas exists
             if (!m_scene.hasComponent<Canvas>(canvasId)) {
@@ -235,6 +339,34 @@ namespace AstralEngine {
             AE_DEBUG("Canvas transform güncellendi (ID: {})", canvasId);
         }
         
+        void CanvasSystem::setViewport(ECS::EntityID canvasId, const glm::vec2& size) {
+            m_canvasStates[canvasId].viewport = size;
+        }
+        
+        void CanvasSystem::prefetchVisibleTiles(const Canvas& canvas, const CanvasState& state, const Layer* active) {
+            if (!active || !active->pixels || state.viewport.x <= 0.0f || state.viewport.y <= 0.0f) {
+                return;
+            }
+            // The visible part of the layer being edited plus a tile around it, so panning and
+            // painting near the edge find their tiles in memory
+            const glm::vec2 a = canvas.screenToWorld({0.0f, 0.0f});
+            const glm::vec2 b = canvas.screenToWorld(state.viewport);
+            const float margin = static_cast<float>(TILE_SIZE);
+            const float x0 = std::max(std::min(a.x, b.x) - margin, 0.0f);
+            const float y0 = std::max(std::min(a.y, b.y) - margin, 0.0f);
+            const float x1 = std::min(std::max(a.x, b.x) + margin, static_cast<float>(active->pixels->getWidth()));
+            const float y1 = std::min(std::max(a.y, b.y) + margin, static_cast<float>(active->pixels->getHeight()));
+            if (x0 >= x1 || y0 >= y1) {
+                return;
+            }
+            TileRect visible;
+            visible.x0 = static_cast<uint32_t>(x0) / TILE_SIZE;
+            visible.y0 = static_cast<uint32_t>(y0) / TILE_SIZE;
+            visible.x1 = (static_cast<uint32_t>(std::ceil(x1)) + TILE_SIZE - 1) / TILE_SIZE;
+            visible.y1 = (static_cast<uint32_t>(std::ceil(y1)) + TILE_SIZE - 1) / TILE_SIZE;
+            TileStore::getInstance().prefetch(*active->pixels, visible);
+        }
+        
         void CanvasSystem::renderGrid(ECS::EntityID canvasId) {
             // Check if the canvas exists
             if (!m_scene.hasComponent<Canvas>(canvasId)) {
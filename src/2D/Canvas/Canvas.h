@@ -4,7 +4,10 @@
 #include "Renderer/RRenderer.h"
 #include "Events/InputEvent.h"
 #include "2D/Layers/Layer.h"
+#include "2D/Canvas/CanvasCompositor.h"
 #include <glm/glm.hpp>
+#include <memory>
+#include <unordered_map>
 
 namespace AstralEngine {
     namespace D2 {
@@ -45,8 +48,16 @@ namespace AstralEngine {
             ECS::EntityID createCanvas(uint32_t width, uint32_t height);
             void resizeCanvas(ECS::EntityID canvasId, uint32_t width, uint32_t height);
             
-            // Rendering
-            void renderCanvas(ECS::EntityID canvasId, const std::vector<ECS::EntityID>& layers);
+            // Rendering; recomposites and uploads only the tiles layers marked dirty.
+            // Passing the layer being edited lets the layers around it be cached flattened.
+            void renderCanvas(ECS::EntityID canvasId, const std::vector<ECS::EntityID>& layers,
+                              ECS::EntityID activeLayer = ECS::INVALID_ENTITY);
+            
+            // Flattened layers of a canvas in the document's format; the texture shows it as premultiplied sRGB RGBA8
+            const TiledImage* getComposite(ECS::EntityID canvasId) const;
+            std::shared_ptr<Texture> getCanvasTexture(ECS::EntityID canvasId) const;
+            // Mip level the texture holds for the current zoom; draw it scaled up by 2^level
+            uint32_t getCanvasTextureLevel(ECS::EntityID canvasId) const;
             
             // Input handling
             void handleInput(const InputEvent& event, ECS::EntityID canvasId);
@@ -55,6 +66,8 @@ namespace AstralEngine {
             void zoom(ECS::EntityID canvasId, float delta);
             void pan(ECS::EntityID canvasId, const glm::vec2& delta);
             void resetView(ECS::EntityID canvasId);
+            // Size of the area the canvas is shown in, in screen pixels; tiles coming into view are paged in ahead
+            void setViewport(ECS::EntityID canvasId, const glm::vec2& size);
             
             // Grid settings
             void setShowGrid(ECS::EntityID canvasId, bool show);
@@ -64,9 +77,22 @@ namespace AstralEngine {
             ECS::Scene& m_scene;
             Renderer* m_renderer; // Changed to pointer
             
+            // Composite and display texture of each canvas
+            struct CanvasState {
+                CanvasCompositor compositor;
+                std::shared_ptr<Texture> texture;
+                uint32_t textureLevel = 0;
+                std::vector<TextureRegion> regions;
+                std::vector<uint8_t> uploadBuffer;
+                glm::vec2 viewport = {0.0f, 0.0f};
+            };
+            std::unordered_map<ECS::EntityID, CanvasState> m_canvasStates;
+            
             // Internal methods
+            void uploadTiles(ECS::EntityID canvasId, CanvasState& state, const std::vector<uint32_t>& tiles);
             void updateCanvasTransform(ECS::EntityID canvasId);
             void renderGrid(ECS::EntityID canvasId);
+            void prefetchVisibleTiles(const Canvas& canvas, const CanvasState& state, const Layer* active);
         };
     }
 }
\ No newline at end of file
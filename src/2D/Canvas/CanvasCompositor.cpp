@@ -0,0 +1,304 @@
+#include "2D/Canvas/CanvasCompositor.h"
+#include "2D/Image/BlendKernels.h"
+#include "2D/Image/ColorSpace.h"
+#include "Core/JobSystem.h"
+#include <algorithm>
+#include <cstring>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            // Tiles per job; one tile is a few microseconds of blending per layer
+            constexpr size_t COMPOSITE_GRAIN = 4;
+            
+            // Alpha of a premultiplied pixel scaled to [0, 1]
+            float getAlpha(PixelFormat format, const uint8_t* pixel) {
+                switch (format) {
+                    case PixelFormat::RGBA8:
+                        return pixel[3] / 255.0f;
+                    case PixelFormat::RGBA16: {
+                        uint16_t alpha;
+                        std::memcpy(&alpha, pixel + 6, 2);
+                        return alpha / 65535.0f;
+                    }
+                    case PixelFormat::RGBA32F: {
+                        float alpha;
+                        std::memcpy(&alpha, pixel + 12, 4);
+                        return alpha;
+                    }
+                }
+                return 0.0f;
+            }
+            
+            // Checked a row at a time so mostly transparent tiles bail out early
+            template <typename T>
+            bool isOpaqueRows(const T* data, T full) {
+                for (uint32_t row = 0; row < TILE_SIZE; ++row) {
+                    bool opaque = true;
+                    for (uint32_t x = 0; x < TILE_SIZE; ++x) {
+                        opaque &= data[(row * TILE_SIZE + x) * 4 + 3] >= full;
+                    }
+                    if (!opaque) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        }
+        
+        void CanvasCompositor::resize(uint32_t width, uint32_t height, PixelFormat format) {
+            if (m_composite && m_composite->getWidth() == width && m_composite->getHeight() == height &&
+                m_composite->getFormat() == format) {
+                return;
+            }
+            m_composite = std::make_unique<TiledImage>(width, height, format);
+            m_display = format != PixelFormat::RGBA8 ? std::make_unique<TiledImage>(width, height, PixelFormat::RGBA8) : nullptr;
+            m_dirty.resize(m_composite->getTilesX(), m_composite->getTilesY());
+            m_dirty.addAll();
+            m_stackState.clear();
+            m_pyramid.resize(width, height, PixelFormat::RGBA8);
+        }
+        
+        void CanvasCompositor::invalidate(const TileRect& tiles) {
+            m_dirty.add(tiles);
+        }
+        
+        void CanvasCompositor::invalidateAll() {
+            m_dirty.addAll();
+        }
+        
+        void CanvasCompositor::LayerCache::reset(uint32_t width, uint32_t height, PixelFormat format) {
+            pixels = std::make_unique<TiledImage>(width, height, format);
+            valid.assign(pixels->getTileCount(), 0);
+        }
+        
+        const std::vector<uint32_t>& CanvasCompositor::update(const std::vector<Layer*>& layers, const Layer* activeLayer) {
+            m_updated.clear();
+            if (!m_composite) {
+                return m_updated;
+            }
+            
+            ptrdiff_t activeIndex = -1;
+            if (activeLayer) {
+                auto it = std::find(layers.begin(), layers.end(), activeLayer);
+                if (it != layers.end()) {
+                    activeIndex = it - layers.begin();
+                }
+            }
+            
+            std::vector<LayerState> stackState;
+            stackState.reserve(layers.size());
+            for (const Layer* layer : layers) {
+                stackState.push_back({layer->pixels.get(), layer->opacity, layer->visible, layer->blendMode});
+            }
+            
+            // Changing only the active layer's properties keeps the caches on both sides of it
+            bool stackChanged = stackState.size() != m_stackState.size() || activeIndex != m_activeIndex;
+            bool activeChanged = false;
+            for (size_t i = 0; !stackChanged && i < stackState.size(); ++i) {
+                if (!(stackState[i] == m_stackState[i])) {
+                    if (static_cast<ptrdiff_t>(i) == activeIndex) {
+                        activeChanged = true;
+                    } else {
+                        stackChanged = true;
+                    }
+                }
+            }
+            if (stackChanged || activeChanged) {
+                m_stackState = std::move(stackState);
+                m_dirty.addAll();
+            }
+            if (stackChanged) {
+                m_activeIndex = activeIndex;
+                m_below = LayerCache();
+                m_above = LayerCache();
+                m_aboveFlattened = false;
+                if (activeIndex >= 0) {
+                    m_below.reset(m_composite->getWidth(), m_composite->getHeight(), m_composite->getFormat());
+                    m_aboveFlattened = std::all_of(layers.begin() + activeIndex + 1, layers.end(), [](const Layer* layer) {
+                        return !layer->isVisible() || layer->blendMode == BlendMode::Normal;
+                    });
+                    if (m_aboveFlattened) {
+                        m_above.reset(m_composite->getWidth(), m_composite->getHeight(), m_composite->getFormat());
+                    }
+                }
+            }
+            
+            // Layer tiles map onto composite tiles with the same coordinates
+            const uint32_t tilesX = m_composite->getTilesX();
+            const uint32_t tilesY = m_composite->getTilesY();
+            for (size_t i = 0; i < layers.size(); ++i) {
+                Layer* layer = layers[i];
+                for (uint32_t index : layer->dirtyTiles.getIndices()) {
+                    const uint32_t tx = index % layer->dirtyTiles.getTilesX();
+                    const uint32_t ty = index / layer->dirtyTiles.getTilesX();
+                    if (tx >= tilesX || ty >= tilesY) {
+                        continue;
+                    }
+                    m_dirty.add(tx, ty);
+                    if (static_cast<ptrdiff_t>(i) < m_activeIndex) {
+                        m_below.invalidate(ty * tilesX + tx);
+                    } else if (static_cast<ptrdiff_t>(i) > m_activeIndex && m_activeIndex >= 0) {
+                        m_above.invalidate(ty * tilesX + tx);
+                    }
+                }
+                layer->dirtyTiles.clear();
+            }
+            
+            // Output tiles are independent; each job only writes its own composite and cache tiles
+            const std::vector<uint32_t>& dirty = m_dirty.getIndices();
+            Jobs::JobSystem::getInstance().parallelFor(dirty.size(), [&](size_t i) {
+                const uint32_t tx = dirty[i] % tilesX;
+                const uint32_t ty = dirty[i] / tilesX;
+                if (m_activeIndex >= 0) {
+                    compositeActiveTile(tx, ty, layers);
+                } else {
+                    compositeRange(layers, 0, layers.size(), tx, ty, *m_composite);
+                }
+                if (m_display) {
+                    updateDisplayTile(tx, ty);
+                }
+            }, COMPOSITE_GRAIN);
+            m_updated = m_dirty.getIndices();
+            m_pyramid.invalidate(m_updated);
+            m_dirty.clear();
+            return m_updated;
+        }
+        
+        const std::vector<uint32_t>& CanvasCompositor::updateLevel(uint32_t level) {
+            static const std::vector<uint32_t> none;
+            if (!m_composite || level == 0) {
+                return none;
+            }
+            return m_pyramid.update(*getDisplay(), level);
+        }
+        
+        const TiledImage* CanvasCompositor::getLevel(uint32_t level) const {
+            return level == 0 ? getDisplay() : m_pyramid.getLevel(level);
+        }
+        
+        void CanvasCompositor::updateDisplayTile(uint32_t tx, uint32_t ty) {
+            const Tile* tile = m_composite->getTile(tx, ty);
+            if (!tile) {
+                m_display->clearTile(tx, ty);
+                return;
+            }
+            ColorSpace::convertRow(m_composite->getFormat(), PixelFormat::RGBA8, tile->getData(),
+                                   m_display->getTileForWrite(tx, ty).getData(), TILE_PIXELS);
+        }
+        
+        void CanvasCompositor::compositeActiveTile(uint32_t tx, uint32_t ty, const std::vector<Layer*>& layers) {
+            const size_t active = static_cast<size_t>(m_activeIndex);
+            const uint32_t index = ty * m_composite->getTilesX() + tx;
+            if (!m_below.valid[index]) {
+                compositeRange(layers, 0, active, tx, ty, *m_below.pixels);
+                m_below.valid[index] = 1;
+            }
+            if (m_aboveFlattened && !m_above.valid[index]) {
+                compositeRange(layers, active + 1, layers.size(), tx, ty, *m_above.pixels);
+                m_above.valid[index] = 1;
+            }
+            
+            Tile* target = nullptr;
+            auto blend = [&](const Tile* source, BlendMode mode, float opacity) {
+                if (!target) {
+                    target = &m_composite->getTileForWrite(tx, ty);
+                    std::memset(target->getData(), 0, target->getByteSize());
+                }
+                BlendKernels::blendRow(mode, m_composite->getFormat(), target->getData(), source->getData(), TILE_PIXELS, opacity);
+            };
+            
+            if (const Tile* below = m_below.pixels->getTile(tx, ty)) {
+                target = &m_composite->getTileForWrite(tx, ty);
+                std::memcpy(target->getData(), below->getData(), target->getByteSize());
+            }
+            const PixelFormat format = m_composite->getFormat();
+            if (const Tile* source = getSourceTile(layers[active], format, tx, ty)) {
+                blend(source, layers[active]->blendMode, layers[active]->opacity);
+            }
+            if (m_aboveFlattened) {
+                if (const Tile* above = m_above.pixels->getTile(tx, ty)) {
+                    blend(above, BlendMode::Normal, 1.0f);
+                }
+            } else {
+                for (size_t i = active + 1; i < layers.size(); ++i) {
+                    if (const Tile* source = getSourceTile(layers[i], format, tx, ty)) {
+                        blend(source, layers[i]->blendMode, layers[i]->opacity);
+                    }
+                }
+            }
+            if (!target) {
+                m_composite->clearTile(tx, ty);
+            }
+        }
+        
+        bool CanvasCompositor::compositeRange(const std::vector<Layer*>& layers, size_t begin, size_t end,
+                                              uint32_t tx, uint32_t ty, TiledImage& target) {
+            // An opaque tile on a fully opaque Normal layer hides everything below it
+            const PixelFormat format = target.getFormat();
+            size_t first = begin;
+            bool opaqueBase = false;
+            for (size_t i = end; i-- > begin;) {
+                const Layer* layer = layers[i];
+                const Tile* tile = getSourceTile(layer, format, tx, ty);
+                if (tile && layer->blendMode == BlendMode::Normal && layer->opacity >= 1.0f && isOpaque(*tile)) {
+                    first = i;
+                    opaqueBase = true;
+                    break;
+                }
+            }
+            
+            Tile* output = nullptr;
+            for (size_t i = first; i < end; ++i) {
+                const Layer* layer = layers[i];
+                const Tile* source = getSourceTile(layer, format, tx, ty);
+                if (!source) {
+                    continue;
+                }
+                if (!output) {
+                    output = &target.getTileForWrite(tx, ty);
+                    if (opaqueBase) {
+                        std::memcpy(output->getData(), source->getData(), output->getByteSize());
+                        continue;
+                    }
+                    std::memset(output->getData(), 0, output->getByteSize());
+                }
+                BlendKernels::blendRow(layer->blendMode, format, output->getData(), source->getData(),
+                                       TILE_PIXELS, layer->opacity);
+            }
+            if (!output) {
+                target.clearTile(tx, ty);
+                return false;
+            }
+            return true;
+        }
+        
+        const Tile* CanvasCompositor::getSourceTile(const Layer* layer, PixelFormat format, uint32_t tx, uint32_t ty) {
+            if (!layer->isVisible() || !layer->pixels || layer->pixels->getFormat() != format ||
+                tx >= layer->pixels->getTilesX() || ty >= layer->pixels->getTilesY()) {
+                return nullptr;
+            }
+            const Tile* tile = layer->pixels->getTile(tx, ty);
+            // Fully transparent tiles contribute nothing in any blend mode
+            if (!tile || (tile->isUniform() && getAlpha(format, tile->getUniformPixel()) <= 0.0f)) {
+                return nullptr;
+            }
+            return tile;
+        }
+        
+        bool CanvasCompositor::isOpaque(const Tile& tile) {
+            if (tile.isUniform()) {
+                return getAlpha(tile.getFormat(), tile.getUniformPixel()) >= 1.0f;
+            }
+            switch (tile.getFormat()) {
+                case PixelFormat::RGBA8:
+                    return isOpaqueRows<uint8_t>(tile.getData(), 255);
+                case PixelFormat::RGBA16:
+                    return isOpaqueRows<uint16_t>(reinterpret_cast<const uint16_t*>(tile.getData()), 65535);
+                case PixelFormat::RGBA32F:
+                    return isOpaqueRows<float>(reinterpret_cast<const float*>(tile.getData()), 1.0f);
+            }
+            return false;
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "2D/Image/MipPyramid.h"
+#include "2D/Image/TiledImage.h"
+#include "2D/Layers/Layer.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        /**
+         * @brief Keeps the flattened image of a layer stack up to date
+         *
+         * Layers report the tiles they changed through Layer::dirtyTiles. Each update only
+         * recomposites those tiles, so painting costs time proportional to the brush area,
+         * not the canvas. Changing the stack itself (order, visibility, opacity, blend mode
+         * or a layer's pixel storage) recomposites everything once.
+         *
+         * Dirty tiles are composited in parallel on the job system. Each tile walks the
+         * visible layers bottom-up, skipping transparent tiles and starting at the topmost
+         * opaque tile of a fully opaque Normal layer, since nothing below it shows through.
+         *
+         * While a layer is being edited, the layers below it are cached flattened, and so
+         * are the layers above it when they all blend Normal (source-over is associative).
+         * A dirty tile then costs the active layer plus at most two cached blends, however
+         * deep the stack. The caches only drop tiles that layers below or above report
+         * dirty, and are rebuilt when the active layer or the rest of the stack changes.
+         *
+         * Layer pixels map onto the composite at the origin; tiles outside the composite
+         * are ignored. The composite is premultiplied and has the document's pixel format,
+         * so 16-bit and float documents blend in linear light. Those keep a second, RGBA8
+         * sRGB display image, converted from each changed tile. A mip pyramid of the display
+         * image serves zoomed-out views and is only reduced for the levels asked for.
+         */
+        class CanvasCompositor {
+        public:
+            // Layers in another format than the composite's are skipped
+            void resize(uint32_t width, uint32_t height, PixelFormat format = PixelFormat::RGBA8);
+            
+            void invalidate(const TileRect& tiles);
+            void invalidateAll();
+            
+            /**
+             * Recomposites dirty tiles of `layers` (bottom to top) and clears the layers'
+             * dirty sets. `activeLayer`, if part of the stack, is the layer being edited.
+             * Returns the row-major indices of the composite tiles that changed.
+             */
+            const std::vector<uint32_t>& update(const std::vector<Layer*>& layers, const Layer* activeLayer = nullptr);
+            
+            const TiledImage* getComposite() const { return m_composite.get(); }
+            // RGBA8 sRGB copy of the composite for display; the composite itself if that is RGBA8
+            const TiledImage* getDisplay() const { return m_display ? m_display.get() : m_composite.get(); }
+            
+            /**
+             * Brings mip `level` of the display image up to date and returns the indices of
+             * its tiles that changed since it was last updated. Level 0 is the display image
+             * itself, which update() already returns, so nothing is returned for it.
+             */
+            const std::vector<uint32_t>& updateLevel(uint32_t level);
+            // The display image (level 0) or one of its reductions; nullptr past the coarsest level
+            const TiledImage* getLevel(uint32_t level) const;
+            const MipPyramid& getPyramid() const { return m_pyramid; }
+            
+            // Flattens layers [begin, end) into the tile of `target`; returns false if nothing covers it.
+            // Safe to call for different tiles of one target in parallel; layer merging uses it too.
+            static bool compositeRange(const std::vector<Layer*>& layers, size_t begin, size_t end,
+                                       uint32_t tx, uint32_t ty, TiledImage& target);
+            // Tile a layer contributes at (tx, ty); nullptr if it is hidden, transparent there or in another format
+            static const Tile* getSourceTile(const Layer* layer, PixelFormat format, uint32_t tx, uint32_t ty);
+            static bool isOpaque(const Tile& tile);
+            
+        private:
+            // What a layer looked like to the last update, to detect stack changes
+            struct LayerState {
+                const TiledImage* pixels = nullptr;
+                float opacity = 1.0f;
+                bool visible = true;
+                BlendMode blendMode = BlendMode::Normal;
+                
+                bool operator==(const LayerState& other) const {
+                    return pixels == other.pixels && opacity == other.opacity &&
+                           visible == other.visible && blendMode == other.blendMode;
+                }
+            };
+            
+            // Flattened layers on one side of the active layer; tiles are built on demand
+            struct LayerCache {
+                std::unique_ptr<TiledImage> pixels;
+                std::vector<uint8_t> valid; // Per tile; jobs only touch their own entry
+                
+                void reset(uint32_t width, uint32_t height, PixelFormat format);
+                void invalidate(uint32_t index) { if (!valid.empty()) valid[index] = 0; }
+            };
+            
+            void compositeActiveTile(uint32_t tx, uint32_t ty, const std::vector<Layer*>& layers);
+            void updateDisplayTile(uint32_t tx, uint32_t ty);
+            
+            std::unique_ptr<TiledImage> m_composite;
+            std::unique_ptr<TiledImage> m_display; // Only for formats other than RGBA8
+            DirtyTileSet m_dirty;
+            std::vector<LayerState> m_stackState;
+            std::vector<uint32_t> m_updated;
+            MipPyramid m_pyramid;
+            
+            // Index of the active layer in the stack, or -1 without caching
+            ptrdiff_t m_activeIndex = -1;
+            bool m_aboveFlattened = false;
+            LayerCache m_below;
+            LayerCache m_above;
+        };
+    }
+}
@@ -0,0 +1,347 @@
+#include "2D/Filters/Adjustments.h"
+#include "2D/Image/ColorSpace.h"
+#include "2D/Image/Simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            // Pixels widened to floats at a time by the float paths
+            constexpr uint32_t CHUNK_PIXELS = 64;
+
+            inline float clamp01(float value) {
+                return std::min(std::max(value, 0.0f), 1.0f);
+            }
+
+            // Interpolated lookup in a curve of CURVE_SAMPLES + 1 entries over [0, 1]
+            inline float sampleCurve(const float* curve, float value) {
+                const float position = clamp01(value) * static_cast<float>(ToneCurveFilter::CURVE_SAMPLES);
+                const uint32_t index = std::min(static_cast<uint32_t>(position), ToneCurveFilter::CURVE_SAMPLES - 1);
+                const float t = position - static_cast<float>(index);
+                return curve[index] + (curve[index + 1] - curve[index]) * t;
+            }
+
+            void mapRowRgba8(const uint32_t* table, uint8_t* pixels, uint32_t count) {
+                for (uint32_t i = 0; i < count; ++i, pixels += 4) {
+                    const uint32_t alpha = pixels[3];
+                    if (alpha == 255) {
+                        pixels[0] = static_cast<uint8_t>(table[pixels[0]]);
+                        pixels[1] = static_cast<uint8_t>(table[pixels[1]]);
+                        pixels[2] = static_cast<uint8_t>(table[pixels[2]]);
+                    } else if (alpha != 0) {
+                        for (int c = 0; c < 3; ++c) {
+                            const uint32_t straight = std::min((pixels[c] * 255u + alpha / 2) / alpha, 255u);
+                            const uint32_t value = table[straight] * alpha + 128;
+                            pixels[c] = static_cast<uint8_t>((value + (value >> 8)) >> 8);
+                        }
+                    }
+                }
+            }
+
+            void mapRowRgba16(const uint16_t* table, uint8_t* pixels, uint32_t count) {
+                for (uint32_t i = 0; i < count; ++i, pixels += 8) {
+                    uint16_t values[4];
+                    std::memcpy(values, pixels, 8);
+                    const uint32_t alpha = values[3];
+                    if (alpha == 65535) {
+                        for (int c = 0; c < 3; ++c) {
+                            values[c] = table[values[c]];
+                        }
+                    } else if (alpha != 0) {
+                        for (int c = 0; c < 3; ++c) {
+                            const uint32_t straight = static_cast<uint32_t>(
+                                std::min<uint64_t>((values[c] * 65535ull + alpha / 2) / alpha, 65535));
+                            values[c] = static_cast<uint16_t>((static_cast<uint64_t>(table[straight]) * alpha + 32767) / 65535);
+                        }
+                    } else {
+                        continue;
+                    }
+                    std::memcpy(pixels, values, 8);
+                }
+            }
+
+#if defined(AE_SIMD_AVX2_DISPATCH)
+            // Opaque runs of 8 pixels with three gathers, others through mapRowRgba8; returns the pixels done
+            AE_TARGET_AVX2 uint32_t mapRowRgba8Avx2(const uint32_t* table, uint8_t* pixels, uint32_t count) {
+                const int* entries = reinterpret_cast<const int*>(table);
+                const __m256i low = _mm256_set1_epi32(0xFF);
+                const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+                uint32_t i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    uint8_t* run = pixels + static_cast<size_t>(i) * 4;
+                    const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(run));
+                    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(p, alphaMask), alphaMask)) != -1) {
+                        mapRowRgba8(table, run, 8);
+                        continue;
+                    }
+                    const __m256i r = _mm256_i32gather_epi32(entries, _mm256_and_si256(p, low), 4);
+                    const __m256i g = _mm256_i32gather_epi32(entries, _mm256_and_si256(_mm256_srli_epi32(p, 8), low), 4);
+                    const __m256i b = _mm256_i32gather_epi32(entries, _mm256_and_si256(_mm256_srli_epi32(p, 16), low), 4);
+                    __m256i out = _mm256_or_si256(_mm256_and_si256(p, alphaMask), r);
+                    out = _mm256_or_si256(out, _mm256_or_si256(_mm256_slli_epi32(g, 8), _mm256_slli_epi32(b, 16)));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(run), out);
+                }
+                return i;
+            }
+
+            // Opaque runs of 4 pixels, two per 128 bits widened to 32-bit lanes; alpha lanes (3 and 7) are kept.
+            // Returns the pixels done.
+            AE_TARGET_AVX2 uint32_t mapRowRgba16Avx2(const uint16_t* table, uint8_t* pixels, uint32_t count) {
+                const int* entries = reinterpret_cast<const int*>(table);
+                const __m256i low = _mm256_set1_epi32(0xFFFF);
+                uint32_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    uint8_t* run = pixels + static_cast<size_t>(i) * 8;
+                    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(run));
+                    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(run + 16));
+                    const int opaque = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(a, b), _mm_set1_epi16(-1)));
+                    if ((opaque & 0xC0C0) != 0xC0C0) {
+                        mapRowRgba16(table, run, 4);
+                        continue;
+                    }
+                    const __m256i wa = _mm256_cvtepu16_epi32(a);
+                    const __m256i wb = _mm256_cvtepu16_epi32(b);
+                    const __m256i ma = _mm256_blend_epi32(_mm256_and_si256(_mm256_i32gather_epi32(entries, wa, 2), low), wa, 0x88);
+                    const __m256i mb = _mm256_blend_epi32(_mm256_and_si256(_mm256_i32gather_epi32(entries, wb, 2), low), wb, 0x88);
+                    // The pack interleaves 128-bit lanes; put the pixels back in order
+                    const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(ma, mb), _MM_SHUFFLE(3, 1, 2, 0));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(run), packed);
+                }
+                return i;
+            }
+#endif
+        }
+
+        void ToneCurveFilter::buildTables(const std::function<float(float)>& curve) {
+            for (uint32_t i = 0; i < 256; ++i) {
+                m_table[i] = static_cast<uint32_t>(std::lround(clamp01(curve(static_cast<float>(i) / 255.0f)) * 255.0f));
+            }
+            m_linearCurve.resize(CURVE_SAMPLES + 1);
+            for (uint32_t i = 0; i <= CURVE_SAMPLES; ++i) {
+                const float encoded = ColorSpace::linearToSrgb(static_cast<float>(i) / CURVE_SAMPLES);
+                m_linearCurve[i] = ColorSpace::srgbToLinear(clamp01(curve(encoded)));
+            }
+            // From the float curve rather than `curve`, which would cost a transfer function pair per entry
+            m_table16.resize(65537);
+            for (uint32_t i = 0; i < 65536; ++i) {
+                m_table16[i] = static_cast<uint16_t>(std::lround(sampleCurve(m_linearCurve.data(), static_cast<float>(i) / 65535.0f) * 65535.0f));
+            }
+            m_table16[65536] = m_table16[65535];
+        }
+
+        void ToneCurveFilter::processRow(PixelFormat format, uint8_t* pixels, uint32_t count) const {
+            // Without AVX2 gathers a table lookup is a scalar load per channel either way
+            if (format == PixelFormat::RGBA8) {
+                uint32_t i = 0;
+#if defined(AE_SIMD_AVX2_DISPATCH)
+                if (Simd::hasAvx2()) {
+                    i = mapRowRgba8Avx2(m_table, pixels, count);
+                }
+#endif
+                mapRowRgba8(m_table, pixels + static_cast<size_t>(i) * 4, count - i);
+                return;
+            }
+
+            if (format == PixelFormat::RGBA16) {
+                uint32_t i = 0;
+#if defined(AE_SIMD_AVX2_DISPATCH)
+                if (Simd::hasAvx2()) {
+                    i = mapRowRgba16Avx2(m_table16.data(), pixels, count);
+                }
+#endif
+                mapRowRgba16(m_table16.data(), pixels + static_cast<size_t>(i) * 8, count - i);
+                return;
+            }
+
+            const uint32_t bpp = getBytesPerPixel(format);
+            alignas(16) float values[CHUNK_PIXELS * 4];
+            for (uint32_t start = 0; start < count; start += CHUNK_PIXELS) {
+                const uint32_t n = std::min(CHUNK_PIXELS, count - start);
+                uint8_t* chunk = pixels + static_cast<size_t>(start) * bpp;
+                FilterKernels::loadRow(format, chunk, values, n);
+                for (uint32_t i = 0; i < n; ++i) {
+                    float* pixel = values + i * 4;
+                    const float alpha = pixel[3];
+                    if (alpha <= 0.0f) {
+                        continue;
+                    }
+                    const float inverse = 1.0f / alpha;
+                    for (int c = 0; c < 3; ++c) {
+                        pixel[c] = sampleCurve(m_linearCurve.data(), pixel[c] * inverse) * alpha;
+                    }
+                }
+                FilterKernels::storeRow(format, values, chunk, n);
+            }
+        }
+
+        LevelsFilter::LevelsFilter(float inputBlack, float inputWhite, float gamma, float outputBlack, float outputWhite) {
+            const float range = std::max(inputWhite - inputBlack, 1e-6f);
+            const float exponent = 1.0f / std::max(gamma, 1e-3f);
+            buildTables([=](float value) {
+                const float stretched = std::pow(clamp01((value - inputBlack) / range), exponent);
+                return outputBlack + stretched * (outputWhite - outputBlack);
+            });
+        }
+
+        ExposureFilter::ExposureFilter(float exposure, float offset, float gamma)
+            : m_scale(std::exp2(exposure)), m_offset(offset), m_exponent(1.0f / std::max(gamma, 1e-3f)) {
+            buildTables([this](float value) {
+                const float linear = std::max(ColorSpace::srgbToLinear(value) * m_scale + m_offset, 0.0f);
+                return ColorSpace::linearToSrgb(clamp01(std::pow(linear, m_exponent)));
+            });
+        }
+
+        void ExposureFilter::processRow(PixelFormat format, uint8_t* pixels, uint32_t count) const {
+            if (format != PixelFormat::RGBA32F) {
+                ToneCurveFilter::processRow(format, pixels, count);
+                return;
+            }
+            for (uint32_t i = 0; i < count; ++i, pixels += 16) {
+                float pixel[4];
+                std::memcpy(pixel, pixels, 16);
+                if (pixel[3] <= 0.0f) {
+                    continue;
+                }
+                for (int c = 0; c < 3; ++c) {
+                    const float linear = std::max(pixel[c] / pixel[3] * m_scale + m_offset, 0.0f);
+                    pixel[c] = (m_exponent == 1.0f ? linear : std::pow(linear, m_exponent)) * pixel[3];
+                }
+                std::memcpy(pixels, pixel, 16);
+            }
+        }
+
+        CurvesFilter::CurvesFilter(std::vector<glm::vec2> points) : m_points(std::move(points)) {
+            std::vector<glm::vec2> sorted = m_points;
+            std::stable_sort(sorted.begin(), sorted.end(), [](const glm::vec2& a, const glm::vec2& b) { return a.x < b.x; });
+            // Points sharing an input keep the last one given
+            std::vector<glm::vec2> knots;
+            for (const glm::vec2& point : sorted) {
+                if (!knots.empty() && knots.back().x == point.x) {
+                    knots.back() = point;
+                } else {
+                    knots.push_back(point);
+                }
+            }
+
+            if (knots.empty()) {
+                buildTables([](float value) { return value; });
+                return;
+            }
+
+            // Fritsch-Carlson tangents: averaged secants, zero at extrema, limited so no segment overshoots
+            const size_t n = knots.size();
+            std::vector<float> tangents(n, 0.0f);
+            if (n > 1) {
+                std::vector<float> secants(n - 1);
+                for (size_t k = 0; k + 1 < n; ++k) {
+                    secants[k] = (knots[k + 1].y - knots[k].y) / (knots[k + 1].x - knots[k].x);
+                }
+                tangents[0] = secants[0];
+                tangents[n - 1] = secants[n - 2];
+                for (size_t k = 1; k + 1 < n; ++k) {
+                    tangents[k] = secants[k - 1] * secants[k] > 0.0f ? (secants[k - 1] + secants[k]) * 0.5f : 0.0f;
+                }
+                for (size_t k = 0; k + 1 < n; ++k) {
+                    if (secants[k] == 0.0f) {
+                        tangents[k] = tangents[k + 1] = 0.0f;
+                        continue;
+                    }
+                    const float a = tangents[k] / secants[k];
+                    const float b = tangents[k + 1] / secants[k];
+                    const float length = a * a + b * b;
+                    if (length > 9.0f) {
+                        const float t = 3.0f / std::sqrt(length);
+                        tangents[k] = t * a * secants[k];
+                        tangents[k + 1] = t * b * secants[k];
+                    }
+                }
+            }
+
+            buildTables([&](float value) {
+                if (value <= knots.front().x) {
+                    return knots.front().y;
+                }
+                if (value >= knots.back().x) {
+                    return knots.back().y;
+                }
+                const size_t k = static_cast<size_t>(std::upper_bound(knots.begin(), knots.end(), value,
+                    [](float v, const glm::vec2& knot) { return v < knot.x; }) - knots.begin()) - 1;
+                const float h = knots[k + 1].x - knots[k].x;
+                const float t = (value - knots[k].x) / h;
+                const float t2 = t * t, t3 = t2 * t;
+                return (2.0f * t3 - 3.0f * t2 + 1.0f) * knots[k].y + (t3 - 2.0f * t2 + t) * h * tangents[k] +
+                       (-2.0f * t3 + 3.0f * t2) * knots[k + 1].y + (t3 - t2) * h * tangents[k + 1];
+            });
+        }
+
+        HueSaturationFilter::HueSaturationFilter(float hue, float saturation, float lightness) {
+            const float angle = hue * 3.14159265358979f / 180.0f;
+            const float c = std::cos(angle), s = std::sin(angle);
+            const float rotate[3][3] = {
+                {0.213f + c * 0.787f - s * 0.213f, 0.715f - c * 0.715f - s * 0.715f, 0.072f - c * 0.072f + s * 0.928f},
+                {0.213f - c * 0.213f + s * 0.143f, 0.715f + c * 0.285f + s * 0.140f, 0.072f - c * 0.072f - s * 0.283f},
+                {0.213f - c * 0.213f - s * 0.787f, 0.715f - c * 0.715f + s * 0.715f, 0.072f + c * 0.928f + s * 0.072f},
+            };
+            const float v = 1.0f + std::min(std::max(saturation, -1.0f), 1.0f);
+            const float saturate[3][3] = {
+                {0.213f + 0.787f * v, 0.715f - 0.715f * v, 0.072f - 0.072f * v},
+                {0.213f - 0.213f * v, 0.715f + 0.285f * v, 0.072f - 0.072f * v},
+                {0.213f - 0.213f * v, 0.715f - 0.715f * v, 0.072f + 0.928f * v},
+            };
+
+            // Lightness scales the color towards black, and above zero lifts it towards alpha (white)
+            const float light = std::min(std::max(lightness, -1.0f), 1.0f);
+            const float keep = 1.0f - std::abs(light);
+            for (int row = 0; row < 3; ++row) {
+                for (int column = 0; column < 3; ++column) {
+                    float sum = 0.0f;
+                    for (int k = 0; k < 3; ++k) {
+                        sum += saturate[row][k] * rotate[k][column];
+                    }
+                    m_columns[column][row] = sum * keep;
+                }
+                m_columns[3][row] = std::max(light, 0.0f);
+            }
+            m_columns[3][3] = 1.0f;
+        }
+
+        void HueSaturationFilter::processRow(PixelFormat format, uint8_t* pixels, uint32_t count) const {
+            const uint32_t bpp = getBytesPerPixel(format);
+            alignas(16) float values[CHUNK_PIXELS * 4];
+#if defined(AE_SIMD_SSE2)
+            const __m128 c0 = _mm_loadu_ps(m_columns[0]);
+            const __m128 c1 = _mm_loadu_ps(m_columns[1]);
+            const __m128 c2 = _mm_loadu_ps(m_columns[2]);
+            const __m128 c3 = _mm_loadu_ps(m_columns[3]);
+#endif
+            for (uint32_t start = 0; start < count; start += CHUNK_PIXELS) {
+                const uint32_t n = std::min(CHUNK_PIXELS, count - start);
+                uint8_t* chunk = pixels + static_cast<size_t>(start) * bpp;
+                FilterKernels::loadRow(format, chunk, values, n);
+                for (uint32_t i = 0; i < n; ++i) {
+                    float* pixel = values + i * 4;
+#if defined(AE_SIMD_SSE2)
+                    const __m128 p = _mm_load_ps(pixel);
+                    __m128 out = _mm_mul_ps(c0, _mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0)));
+                    out = _mm_add_ps(out, _mm_mul_ps(c1, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1))));
+                    out = _mm_add_ps(out, _mm_mul_ps(c2, _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2))));
+                    out = _mm_add_ps(out, _mm_mul_ps(c3, _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 3, 3))));
+                    _mm_store_ps(pixel, out);
+#else
+                    float out[4] = {};
+                    for (int column = 0; column < 4; ++column) {
+                        for (int row = 0; row < 4; ++row) {
+                            out[row] += m_columns[column][row] * pixel[column];
+                        }
+                    }
+                    std::memcpy(pixel, out, sizeof(out));
+#endif
+                }
+                // storeRow keeps color within [0, alpha] for the integer formats
+                FilterKernels::storeRow(format, values, chunk, n);
+            }
+        }
+    }
+}
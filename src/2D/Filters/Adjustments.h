@@ -0,0 +1,119 @@
+#pragma once
+
+#include "2D/Filters/Filter.h"
+#include <glm/glm.hpp>
+#include <functional>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        /**
+         * @brief Point filter mapping every color channel through one tone curve
+         *
+         * The curve works on straight (unpremultiplied) values in [0, 1] of the sRGB
+         * encoding, so its parameters mean the same on every document. It is tabulated once
+         * per format, with the transfer functions baked in for the linear ones: 256 entries
+         * for RGBA8, 65536 for RGBA16 and a float curve looked up with interpolation for
+         * RGBA32F. Opaque pixels index the tables directly, 8 RGBA8 or 4 RGBA16 pixels at a
+         * time with AVX2 gathers; others are unpremultiplied first. Alpha is never changed.
+         */
+        class ToneCurveFilter : public PointFilter {
+        public:
+            // Samples across [0, 1] of the float curves
+            static constexpr uint32_t CURVE_SAMPLES = 4096;
+
+        protected:
+            // Tabulates `curve`; derived classes call this from their constructor
+            void buildTables(const std::function<float(float)>& curve);
+
+            void processRow(PixelFormat format, uint8_t* pixels, uint32_t count) const override;
+
+        private:
+            std::vector<float> m_linearCurve; // Linear light in and out, CURVE_SAMPLES + 1 entries
+            // Padded by one entry, as gathers read 32 bits at the last index
+            std::vector<uint16_t> m_table16;
+            uint32_t m_table[256] = {}; // Bytes, widened so gathers can read them
+        };
+
+        /**
+         * @brief Input/output levels with a midtone gamma
+         *
+         * Input black and white are stretched to the output range; gamma above 1 brightens
+         * the midtones.
+         */
+        class LevelsFilter : public ToneCurveFilter {
+        public:
+            LevelsFilter(float inputBlack, float inputWhite, float gamma = 1.0f, float outputBlack = 0.0f, float outputWhite = 1.0f);
+
+            const char* getName() const override { return "Levels"; }
+            std::unique_ptr<Filter> clone() const override { return std::make_unique<LevelsFilter>(*this); }
+        };
+
+        /**
+         * @brief Exposure in stops, with an offset and a gamma correction
+         *
+         * Works in linear light: out = (in * 2^exposure + offset)^(1 / gamma). Float
+         * documents are computed exactly and keep values above 1; the others go through the
+         * tone curve tables.
+         */
+        class ExposureFilter : public ToneCurveFilter {
+        public:
+            ExposureFilter(float exposure, float offset = 0.0f, float gamma = 1.0f);
+
+            const char* getName() const override { return "Exposure"; }
+            std::unique_ptr<Filter> clone() const override { return std::make_unique<ExposureFilter>(*this); }
+
+        protected:
+            void processRow(PixelFormat format, uint8_t* pixels, uint32_t count) const override;
+
+        private:
+            float m_scale;
+            float m_offset;
+            float m_exponent;
+        };
+
+        /**
+         * @brief Tone curve through control points
+         *
+         * Points are (input, output) pairs in [0, 1]. The curve interpolates them with a
+         * monotone cubic (Fritsch-Carlson), so it never overshoots between points, and it
+         * is flat beyond the first and last point.
+         */
+        class CurvesFilter : public ToneCurveFilter {
+        public:
+            explicit CurvesFilter(std::vector<glm::vec2> points);
+
+            const std::vector<glm::vec2>& getPoints() const { return m_points; }
+
+            const char* getName() const override { return "Curves"; }
+            std::unique_ptr<Filter> clone() const override { return std::make_unique<CurvesFilter>(*this); }
+
+        private:
+            std::vector<glm::vec2> m_points;
+        };
+
+        /**
+         * @brief Hue rotation, saturation and lightness
+         *
+         * Hue and saturation are the luminance-preserving color matrices of SVG
+         * (feColorMatrix hueRotate and saturate) combined into one. Lightness fades towards
+         * black or white. All of it is linear in the color, so it runs directly on
+         * premultiplied pixels in the document's own encoding.
+         */
+        class HueSaturationFilter : public PointFilter {
+        public:
+            // `hue` in degrees; `saturation` and `lightness` in [-1, 1]
+            HueSaturationFilter(float hue, float saturation, float lightness = 0.0f);
+
+            const char* getName() const override { return "Hue/Saturation"; }
+            std::unique_ptr<Filter> clone() const override { return std::make_unique<HueSaturationFilter>(*this); }
+
+        protected:
+            void processRow(PixelFormat format, uint8_t* pixels, uint32_t count) const override;
+
+        private:
+            // Columns of the matrix applied to premultiplied (r, g, b, a); lightness is folded in
+            float m_columns[4][4] = {};
+        };
+    }
+}
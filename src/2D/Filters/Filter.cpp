@@ -0,0 +1,252 @@
+#include "2D/Filters/Filter.h"
+#include "2D/Image/Simd.h"
+#include "Core/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            // Tiles per job for per-tile passes
+            constexpr size_t FILTER_GRAIN = 4;
+
+            // Stand-in pixels for missing tiles, large enough for a tile of any format
+            const uint8_t* getTransparentTile() {
+                static const std::vector<uint8_t> s_zero(static_cast<size_t>(TILE_PIXELS) * getBytesPerPixel(PixelFormat::RGBA32F), 0);
+                return s_zero.data();
+            }
+
+            AE_FORCE_INLINE uint8_t div255(uint32_t value) {
+                value += 128;
+                return static_cast<uint8_t>((value + (value >> 8)) >> 8);
+            }
+        }
+
+        std::shared_ptr<TiledImage> PointFilter::apply(const TiledImage& source, const std::atomic<bool>* cancel) const {
+            auto result = std::make_shared<TiledImage>(source);
+            const PixelFormat format = source.getFormat();
+            const uint32_t bpp = getBytesPerPixel(format);
+            const uint32_t tilesX = source.getTilesX();
+
+            Jobs::JobSystem::getInstance().parallelFor(source.getTileCount(), [&](size_t index) {
+                if (cancel && cancel->load(std::memory_order_relaxed)) {
+                    return;
+                }
+                const uint32_t tx = static_cast<uint32_t>(index % tilesX);
+                const uint32_t ty = static_cast<uint32_t>(index / tilesX);
+                const Tile* tile = source.getTile(tx, ty);
+
+                // Missing and uniform tiles are one pixel repeated
+                if (!tile || tile->isUniform()) {
+                    uint8_t pixel[16] = {};
+                    if (tile) {
+                        std::memcpy(pixel, tile->getUniformPixel(), bpp);
+                    }
+                    uint8_t filtered[16];
+                    std::memcpy(filtered, pixel, sizeof(pixel));
+                    processRow(format, filtered, 1);
+                    if (std::memcmp(filtered, pixel, bpp) != 0) {
+                        result->fillTile(tx, ty, filtered);
+                    }
+                    return;
+                }
+
+                // Tile rows are contiguous, so the whole tile is one row to the kernel
+                processRow(format, result->getTileForWrite(tx, ty).getData(), TILE_PIXELS);
+            }, FILTER_GRAIN);
+
+            if (cancel && cancel->load()) {
+                return nullptr;
+            }
+            return result;
+        }
+
+        namespace FilterKernels {
+            float getChannelScale(PixelFormat format) {
+                switch (format) {
+                    case PixelFormat::RGBA8:   return 255.0f;
+                    case PixelFormat::RGBA16:  return 65535.0f;
+                    case PixelFormat::RGBA32F: return 1.0f;
+                }
+                return 1.0f;
+            }
+
+            void loadRow(PixelFormat format, const uint8_t* src, float* dst, uint32_t count, size_t stride) {
+                switch (format) {
+                    case PixelFormat::RGBA8:
+                        for (uint32_t i = 0; i < count; ++i, src += 4, dst += stride) {
+#if defined(AE_SIMD_SSE2)
+                            int32_t value;
+                            std::memcpy(&value, src, 4);
+                            const __m128i zero = _mm_setzero_si128();
+                            const __m128i p = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero), zero);
+                            _mm_storeu_ps(dst, _mm_cvtepi32_ps(p));
+#else
+                            for (int c = 0; c < 4; ++c) {
+                                dst[c] = static_cast<float>(src[c]);
+                            }
+#endif
+                        }
+                        break;
+                    case PixelFormat::RGBA16:
+                        for (uint32_t i = 0; i < count; ++i, src += 8, dst += stride) {
+#if defined(AE_SIMD_SSE2)
+                            const __m128i p = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+                            _mm_storeu_ps(dst, _mm_cvtepi32_ps(_mm_unpacklo_epi16(p, _mm_setzero_si128())));
+#else
+                            uint16_t values[4];
+                            std::memcpy(values, src, 8);
+                            for (int c = 0; c < 4; ++c) {
+                                dst[c] = static_cast<float>(values[c]);
+                            }
+#endif
+                        }
+                        break;
+                    case PixelFormat::RGBA32F:
+                        for (uint32_t i = 0; i < count; ++i, src += 16, dst += stride) {
+                            std::memcpy(dst, src, 16);
+                        }
+                        break;
+                }
+            }
+
+            void storeRow(PixelFormat format, const float* src, uint8_t* dst, uint32_t count, size_t stride) {
+                const float scale = getChannelScale(format);
+                switch (format) {
+                    case PixelFormat::RGBA8:
+                    case PixelFormat::RGBA16: {
+                        const uint32_t bpp = getBytesPerPixel(format);
+                        for (uint32_t i = 0; i < count; ++i, src += stride, dst += bpp) {
+#if defined(AE_SIMD_SSE2)
+                            __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src), _mm_setzero_ps()), _mm_set1_ps(scale));
+                            v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)));
+                            const __m128i x = _mm_cvtps_epi32(v);
+                            if (format == PixelFormat::RGBA8) {
+                                const __m128i p = _mm_packus_epi16(_mm_packs_epi32(x, x), _mm_setzero_si128());
+                                const int32_t value = _mm_cvtsi128_si32(p);
+                                std::memcpy(dst, &value, 4);
+                            } else {
+                                // Biased so the signed pack keeps the full unsigned range
+                                const __m128i biased = _mm_sub_epi32(x, _mm_set1_epi32(32768));
+                                const __m128i p = _mm_xor_si128(_mm_packs_epi32(biased, biased), _mm_set1_epi16(static_cast<short>(0x8000)));
+                                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), p);
+                            }
+#else
+                            const float alpha = std::min(std::max(src[3], 0.0f), scale);
+                            for (int c = 0; c < 4; ++c) {
+                                const float v = std::min(std::max(src[c], 0.0f), alpha);
+                                const uint32_t value = static_cast<uint32_t>(std::lrint(v));
+                                if (format == PixelFormat::RGBA8) {
+                                    dst[c] = static_cast<uint8_t>(value);
+                                } else {
+                                    const uint16_t wide = static_cast<uint16_t>(value);
+                                    std::memcpy(dst + c * 2, &wide, 2);
+                                }
+                            }
+#endif
+                        }
+                        break;
+                    }
+                    case PixelFormat::RGBA32F:
+                        // Linear float keeps values above 1; only negative lobes and alpha are clamped
+                        for (uint32_t i = 0; i < count; ++i, src += stride, dst += 16) {
+                            float values[4];
+                            for (int c = 0; c < 3; ++c) {
+                                values[c] = std::max(src[c], 0.0f);
+                            }
+                            values[3] = std::min(std::max(src[3], 0.0f), 1.0f);
+                            std::memcpy(dst, values, 16);
+                        }
+                        break;
+                }
+            }
+
+            void lerpRow(PixelFormat format, uint8_t* filtered, const uint8_t* original, const uint8_t* coverage, uint32_t count) {
+                uint32_t i = 0;
+                switch (format) {
+                    case PixelFormat::RGBA8: {
+#if defined(AE_SIMD_SSE2)
+                        // Two pixels per step in 16-bit lanes: original * (255 - c) + filtered * c fits unsigned
+                        const __m128i zero = _mm_setzero_si128();
+                        const __m128i full = _mm_set1_epi16(255);
+                        const __m128i half = _mm_set1_epi16(128);
+                        for (; i + 2 <= count; i += 2) {
+                            const short c0 = coverage[i], c1 = coverage[i + 1];
+                            if ((c0 & c1) == 255) {
+                                continue;
+                            }
+                            const __m128i c = _mm_set_epi16(c1, c1, c1, c1, c0, c0, c0, c0);
+                            const __m128i f = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(filtered + i * 4)), zero);
+                            const __m128i o = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(original + i * 4)), zero);
+                            __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(f, c), _mm_mullo_epi16(o, _mm_sub_epi16(full, c))), half);
+                            sum = _mm_srli_epi16(_mm_add_epi16(sum, _mm_srli_epi16(sum, 8)), 8);
+                            _mm_storel_epi64(reinterpret_cast<__m128i*>(filtered + i * 4), _mm_packus_epi16(sum, zero));
+                        }
+#endif
+                        for (; i < count; ++i) {
+                            const uint32_t c = coverage[i];
+                            for (int k = 0; k < 4; ++k) {
+                                uint8_t& f = filtered[i * 4 + k];
+                                f = div255(f * c + original[i * 4 + k] * (255 - c));
+                            }
+                        }
+                        break;
+                    }
+                    case PixelFormat::RGBA16:
+                        for (; i < count; ++i) {
+                            if (coverage[i] == 255) {
+                                continue;
+                            }
+                            const float t = coverage[i] * (1.0f / 255.0f);
+                            uint16_t f[4], o[4];
+                            std::memcpy(f, filtered + i * 8, 8);
+                            std::memcpy(o, original + i * 8, 8);
+                            for (int k = 0; k < 4; ++k) {
+                                f[k] = static_cast<uint16_t>(std::lrint(o[k] + (f[k] - static_cast<float>(o[k])) * t));
+                            }
+                            std::memcpy(filtered + i * 8, f, 8);
+                        }
+                        break;
+                    case PixelFormat::RGBA32F:
+                        for (; i < count; ++i) {
+                            if (coverage[i] == 255) {
+                                continue;
+                            }
+                            const float t = coverage[i] * (1.0f / 255.0f);
+                            float f[4], o[4];
+                            std::memcpy(f, filtered + i * 16, 16);
+                            std::memcpy(o, original + i * 16, 16);
+                            for (int k = 0; k < 4; ++k) {
+                                f[k] = o[k] + (f[k] - o[k]) * t;
+                            }
+                            std::memcpy(filtered + i * 16, f, 16);
+                        }
+                        break;
+                }
+            }
+
+            void clipToMask(TiledImage& filtered, const TiledImage& original, const TiledMask& mask) {
+                const uint32_t tilesX = filtered.getTilesX();
+                Jobs::JobSystem::getInstance().parallelFor(filtered.getTileCount(), [&](size_t index) {
+                    const uint32_t tx = static_cast<uint32_t>(index % tilesX);
+                    const uint32_t ty = static_cast<uint32_t>(index / tilesX);
+                    if (mask.isTileFull(tx, ty)) {
+                        return;
+                    }
+                    const Tile* before = original.getTile(tx, ty);
+                    if (mask.isTileEmpty(tx, ty) || filtered.getTile(tx, ty) == before) {
+                        std::shared_ptr<const Tile> tile = original.shareTile(tx, ty);
+                        filtered.swapTile(tx, ty, tile);
+                        return;
+                    }
+                    const uint8_t* originalPixels = before ? before->getData() : getTransparentTile();
+                    lerpRow(filtered.getFormat(), filtered.getTileForWrite(tx, ty).getData(), originalPixels,
+                            mask.getTile(tx, ty), TILE_PIXELS);
+                    filtered.compactTile(tx, ty);
+                }, FILTER_GRAIN);
+            }
+        }
+    }
+}
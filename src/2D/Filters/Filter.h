@@ -0,0 +1,69 @@
+#pragma once
+
+#include "2D/Image/TiledImage.h"
+#include "2D/Image/TiledMask.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace AstralEngine {
+    namespace D2 {
+        /**
+         * @brief Image filter run over a whole layer
+         *
+         * apply() never modifies its source: it returns a new image that shares every tile
+         * the filter leaves unchanged. Work is split into tiles or bands of tiles on the job
+         * system, and `cancel` is polled between them so an outdated preview or refinement
+         * can be dropped early.
+         */
+        class Filter {
+        public:
+            virtual ~Filter() = default;
+
+            // Operation name shown in the history
+            virtual const char* getName() const = 0;
+            virtual std::unique_ptr<Filter> clone() const = 0;
+
+            // Copy set up for a preview of the image reduced by `scale` (< 1); radii shrink with it
+            virtual std::unique_ptr<Filter> scaled(float scale) const { (void)scale; return clone(); }
+
+            // Filtered copy of `source`; nullptr if `cancel` was raised before it finished
+            virtual std::shared_ptr<TiledImage> apply(const TiledImage& source, const std::atomic<bool>* cancel = nullptr) const = 0;
+        };
+
+        /**
+         * @brief Filter whose output pixel depends only on the same input pixel
+         *
+         * Tiles are filtered in parallel without halos. Missing and uniform tiles are
+         * decided from a single pixel and stay sparse.
+         */
+        class PointFilter : public Filter {
+        public:
+            std::shared_ptr<TiledImage> apply(const TiledImage& source, const std::atomic<bool>* cancel = nullptr) const override;
+
+        protected:
+            // Filters `count` premultiplied pixels in place
+            virtual void processRow(PixelFormat format, uint8_t* pixels, uint32_t count) const = 0;
+        };
+
+        namespace FilterKernels {
+            // Channel value of full intensity in a format: 255, 65535 or 1
+            float getChannelScale(PixelFormat format);
+
+            // Widens `count` pixels to four floats each, `stride` floats apart, keeping the format's scale
+            void loadRow(PixelFormat format, const uint8_t* src, float* dst, uint32_t count, size_t stride = 4);
+            // Rounds and clamps back; integer formats also keep premultiplied color at or below alpha
+            void storeRow(PixelFormat format, const float* src, uint8_t* dst, uint32_t count, size_t stride = 4);
+
+            // filtered = original + (filtered - original) * coverage / 255
+            void lerpRow(PixelFormat format, uint8_t* filtered, const uint8_t* original, const uint8_t* coverage, uint32_t count);
+
+            /**
+             * Limits a filter result to `mask`: uncovered tiles go back to sharing the
+             * original's tiles and edge tiles are blended by coverage. Both images must have
+             * the mask's size.
+             */
+            void clipToMask(TiledImage& filtered, const TiledImage& original, const TiledMask& mask);
+        }
+    }
+}
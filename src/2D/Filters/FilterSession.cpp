@@ -0,0 +1,163 @@
+#include "2D/Filters/FilterSession.h"
+#include "2D/Image/Resample.h"
+#include "2D/Selection/Selection.h"
+#include "Core/JobSystem.h"
+#include "Core/Logger.h"
+#include <algorithm>
+#include <chrono>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            // Deepest proxy level; one tile of it still covers whole pixels of a level-0 tile
+            constexpr uint32_t MAX_PROXY_LEVEL = 6;
+        }
+
+        FilterSession::FilterSession(ECS::Scene& scene, LayerSystem& layerSystem, ECS::EntityID layerId)
+            : m_scene(scene), m_layerSystem(layerSystem), m_layerId(layerId) {
+            Layer* layer = getLayerComponent();
+            if (!layer || !layer->pixels) {
+                AE_WARN("Filtre için layer piksel verisi yok: {}", layerId);
+                return;
+            }
+            m_original = layer->pixels;
+
+            const SelectionSystem* selection = layerSystem.getSelection();
+            const TiledMask* clip = selection ? selection->getClipMask() : nullptr;
+            if (clip && clip->getWidth() == m_original->getWidth() && clip->getHeight() == m_original->getHeight()) {
+                m_clip = std::make_unique<TiledMask>(*clip);
+            }
+
+            // Smallest reduction that keeps the proxy within the preview budget
+            const uint64_t pixels = static_cast<uint64_t>(m_original->getWidth()) * m_original->getHeight();
+            while (m_proxyLevel < MAX_PROXY_LEVEL && (pixels >> (m_proxyLevel * 2)) > PREVIEW_MAX_PIXELS) {
+                ++m_proxyLevel;
+            }
+            if (m_proxyLevel > 0) {
+                m_proxies.resize(m_original->getWidth(), m_original->getHeight(), m_original->getFormat());
+                m_proxyLevel = std::min(m_proxyLevel, m_proxies.getLevelCount() - 1);
+            }
+        }
+
+        FilterSession::~FilterSession() {
+            cancel();
+        }
+
+        Layer* FilterSession::getLayerComponent() const {
+            if (!m_scene.hasComponent<Layer>(m_layerId)) {
+                return nullptr;
+            }
+            return &m_scene.getComponent<Layer>(m_layerId);
+        }
+
+        void FilterSession::showPixels(std::shared_ptr<TiledImage> pixels) {
+            if (Layer* layer = getLayerComponent()) {
+                layer->pixels = std::move(pixels);
+                layer->markAllDirty();
+            }
+        }
+
+        void FilterSession::cancelJob(bool wait) {
+            if (!m_job) {
+                return;
+            }
+            // The job owns what it reads, so a superseded one can wind down on its own;
+            // closing the session waits so no job outlives it
+            m_job->cancel.store(true);
+            if (wait) {
+                m_jobDone.wait();
+            }
+            m_job.reset();
+        }
+
+        std::shared_ptr<TiledImage> FilterSession::makePreview(const Filter& filter) {
+            if (m_proxyLevel == 0) {
+                return filter.apply(*m_original);
+            }
+            m_proxies.update(*m_original, m_proxyLevel);
+            const TiledImage* proxy = m_proxies.getLevel(m_proxyLevel);
+            auto reduced = filter.scaled(1.0f / static_cast<float>(1u << m_proxyLevel))->apply(*proxy);
+            auto preview = std::make_shared<TiledImage>(m_original->getWidth(), m_original->getHeight(), m_original->getFormat());
+            Resample::upsampleLevel(*reduced, m_proxyLevel, *preview, {0, 0, preview->getTilesX(), preview->getTilesY()});
+            return preview;
+        }
+
+        void FilterSession::setFilter(std::unique_ptr<Filter> filter) {
+            if (!isActive() || !filter) {
+                return;
+            }
+            cancelJob(false);
+            m_filter = std::move(filter);
+
+            auto preview = makePreview(*m_filter);
+            if (m_clip) {
+                FilterKernels::clipToMask(*preview, *m_original, *m_clip);
+            }
+            showPixels(preview);
+            if (m_proxyLevel == 0) {
+                return;
+            }
+
+            // Refine at full resolution; the closure keeps its inputs alive past a cancel
+            auto job = std::make_shared<Job>();
+            std::shared_ptr<const Filter> jobFilter = m_filter->clone();
+            std::shared_ptr<const TiledImage> original = m_original;
+            std::shared_ptr<const TiledMask> clip = m_clip ? std::make_shared<TiledMask>(*m_clip) : nullptr;
+            m_jobDone = Jobs::JobSystem::getInstance().submit([job, jobFilter, original, clip] {
+                auto result = jobFilter->apply(*original, &job->cancel);
+                if (result && clip && !job->cancel.load()) {
+                    FilterKernels::clipToMask(*result, *original, *clip);
+                }
+                job->result = std::move(result);
+            });
+            m_job = std::move(job);
+        }
+
+        bool FilterSession::update() {
+            if (!m_job || m_jobDone.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return false;
+            }
+            auto result = std::move(m_job->result);
+            m_job.reset();
+            if (!result) {
+                return false;
+            }
+            showPixels(std::move(result));
+            return true;
+        }
+
+        void FilterSession::commit() {
+            if (!isActive()) {
+                return;
+            }
+            if (m_job) {
+                m_jobDone.wait();
+                update();
+            }
+            Layer* layer = getLayerComponent();
+            std::shared_ptr<TiledImage> result = layer ? layer->pixels : nullptr;
+            std::shared_ptr<TiledImage> original = std::move(m_original);
+            m_proxies = MipPyramid();
+            if (!layer || !m_filter || result == original) {
+                if (layer) {
+                    showPixels(original);
+                }
+                return;
+            }
+
+            // The history records the stack as it was, so the original goes back in first
+            layer->pixels = original;
+            m_layerSystem.replaceLayerPixels(m_layerId, result, m_filter->getName());
+            AE_DEBUG("Filtre uygulandı: {} (Layer: {})", m_filter->getName(), m_layerId);
+        }
+
+        void FilterSession::cancel() {
+            if (!isActive()) {
+                return;
+            }
+            cancelJob(true);
+            showPixels(std::move(m_original));
+            m_proxies = MipPyramid();
+        }
+    }
+}
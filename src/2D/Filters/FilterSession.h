@@ -0,0 +1,79 @@
+#pragma once
+
+#include "2D/Filters/Filter.h"
+#include "2D/Image/MipPyramid.h"
+#include "2D/Layers/Layer.h"
+#include <future>
+#include <memory>
+
+namespace AstralEngine {
+    namespace D2 {
+        /**
+         * @brief Live preview of a filter on one layer, committed as a single undo step
+         *
+         * While the session is open the layer shows a preview in place of its pixels. Every
+         * setFilter() first filters a mip level of the original of at most
+         * PREVIEW_MAX_PIXELS, which is quick enough for slider drags, and shows it scaled
+         * up. The full-resolution result is computed in the background on the job system
+         * and replaces the preview from update() once it is ready; changing the filter
+         * again cancels a refinement still running. Both are clipped to the selection.
+         *
+         * commit() puts the original back and replaces it with the result through the
+         * layer system, so the history sees one operation; cancel() and the destructor
+         * just put the original back.
+         */
+        class FilterSession {
+        public:
+            // Proxy size the quick preview aims for
+            static constexpr uint64_t PREVIEW_MAX_PIXELS = 1u << 20;
+
+            FilterSession(ECS::Scene& scene, LayerSystem& layerSystem, ECS::EntityID layerId);
+            ~FilterSession();
+
+            FilterSession(const FilterSession&) = delete;
+            FilterSession& operator=(const FilterSession&) = delete;
+
+            // False once committed or cancelled, or if the layer had no pixels
+            bool isActive() const { return m_original != nullptr; }
+            ECS::EntityID getLayer() const { return m_layerId; }
+            const Filter* getFilter() const { return m_filter.get(); }
+
+            // Shows a quick preview of `filter` and starts refining it at full resolution
+            void setFilter(std::unique_ptr<Filter> filter);
+
+            // Call once per frame; returns true when the full-resolution result was swapped in
+            bool update();
+            bool isRefining() const { return m_job != nullptr; }
+
+            // Waits for the full-resolution result and applies it as one undoable operation
+            void commit();
+            // Restores the layer's pixels
+            void cancel();
+
+        private:
+            // Shared with the running job; its future stays here, as the job's state owns the closure
+            struct Job {
+                std::atomic<bool> cancel{false};
+                std::shared_ptr<TiledImage> result;
+            };
+
+            Layer* getLayerComponent() const;
+            void showPixels(std::shared_ptr<TiledImage> pixels);
+            void cancelJob(bool wait);
+            std::shared_ptr<TiledImage> makePreview(const Filter& filter);
+
+            ECS::Scene& m_scene;
+            LayerSystem& m_layerSystem;
+            ECS::EntityID m_layerId;
+
+            std::shared_ptr<TiledImage> m_original;
+            std::unique_ptr<TiledMask> m_clip; // Selection when the session opened; null edits the whole layer
+            std::unique_ptr<Filter> m_filter;
+            std::shared_ptr<Job> m_job;
+            std::future<void> m_jobDone;
+
+            MipPyramid m_proxies;
+            uint32_t m_proxyLevel = 0;
+        };
+    }
+}
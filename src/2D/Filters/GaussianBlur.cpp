@@ -0,0 +1,604 @@
+#include "2D/Filters/GaussianBlur.h"
+#include "2D/Image/Simd.h"
+#include "Core/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            // Pixels side by side at one position of a band, and their floats
+            constexpr uint32_t LINE_PIXELS = 4;
+            constexpr size_t LINE_FLOATS = LINE_PIXELS * 4;
+            constexpr size_t LINE_BYTES = LINE_FLOATS * sizeof(float);
+
+            struct BlurPlan {
+                std::vector<float> weights; // Exact kernel, 2 * halo + 1 taps; empty when boxes are used
+                uint32_t boxes[3] = {};     // Box radii
+                uint32_t halo = 0;          // Reach of the whole blur on either side
+            };
+
+            BlurPlan makePlan(float sigma) {
+                BlurPlan plan;
+                const uint32_t radius = static_cast<uint32_t>(std::ceil(sigma * 3.0f));
+                if (radius <= GaussianBlurFilter::EXACT_MAX_RADIUS) {
+                    plan.halo = radius;
+                    plan.weights.resize(radius * 2 + 1);
+                    float total = 0.0f;
+                    for (uint32_t k = 0; k < plan.weights.size(); ++k) {
+                        const float d = static_cast<float>(k) - static_cast<float>(radius);
+                        plan.weights[k] = std::exp(-d * d / (2.0f * sigma * sigma));
+                        total += plan.weights[k];
+                    }
+                    for (float& weight : plan.weights) {
+                        weight /= total;
+                    }
+                    return plan;
+                }
+
+                // Odd box widths whose three-fold convolution has a variance closest to sigma^2
+                const float variance = sigma * sigma;
+                int lower = static_cast<int>(std::floor(std::sqrt(4.0f * variance + 1.0f)));
+                if (lower % 2 == 0) {
+                    --lower;
+                }
+                const int lowerCount = static_cast<int>(std::lround((12.0f * variance - 3.0f * lower * lower - 12.0f * lower - 9.0f) /
+                                                                    (-4.0f * lower - 4.0f)));
+                for (int i = 0; i < 3; ++i) {
+                    const int width = i < lowerCount ? lower : lower + 2;
+                    plan.boxes[i] = static_cast<uint32_t>(width - 1) / 2;
+                    plan.halo += plan.boxes[i];
+                }
+                return plan;
+            }
+
+            AE_FORCE_INLINE size_t advance(size_t cursor, size_t size) {
+                return ++cursor == size ? 0 : cursor;
+            }
+
+            // Running sums, rings and fill state of the three boxes along one band
+            struct CascadeState {
+                alignas(32) float sums[3][LINE_FLOATS] = {};
+                float* ring[3];
+                uint32_t width[3];
+                float scale[3];
+                size_t cursor[3] = {};
+                size_t filled[3] = {};
+
+                /**
+                 * Feeds one input value through the boxes whose windows are filled far enough
+                 * to pass it on; returns true and leaves the blurred value in `value` once all
+                 * three windows are full.
+                 */
+                bool step(float* value) {
+                    for (int k = 0; k < 3; ++k) {
+                        float* slot = ring[k] + cursor[k] * LINE_FLOATS;
+                        for (size_t h = 0; h < LINE_FLOATS; ++h) {
+                            sums[k][h] += value[h] - slot[h];
+                            slot[h] = value[h];
+                            value[h] = sums[k][h] * scale[k];
+                        }
+                        cursor[k] = advance(cursor[k], width[k]);
+                        if (filled[k] < width[k] && ++filled[k] < width[k]) {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+            };
+
+#if defined(AE_SIMD_AVX2_DISPATCH)
+            // boxCascade once every window is full, a line per two AVX2 registers
+            AE_TARGET_AVX2 void boxSweepAvx2(CascadeState& state, const float* line, float* out, size_t count) {
+                const uint32_t* widths = state.width;
+                float* ring0 = state.ring[0];
+                float* ring1 = state.ring[1];
+                float* ring2 = state.ring[2];
+                size_t c0 = state.cursor[0], c1 = state.cursor[1], c2 = state.cursor[2];
+                const __m256 scale0 = _mm256_set1_ps(1.0f / static_cast<float>(widths[0]));
+                const __m256 scale1 = _mm256_set1_ps(1.0f / static_cast<float>(widths[1]));
+                const __m256 scale2 = _mm256_set1_ps(1.0f / static_cast<float>(widths[2]));
+                __m256 a0 = _mm256_load_ps(state.sums[0]), a1 = _mm256_load_ps(state.sums[0] + 8);
+                __m256 b0 = _mm256_load_ps(state.sums[1]), b1 = _mm256_load_ps(state.sums[1] + 8);
+                __m256 d0 = _mm256_load_ps(state.sums[2]), d1 = _mm256_load_ps(state.sums[2] + 8);
+                for (size_t n = 0; n < count; ++n, line += LINE_FLOATS, out += LINE_FLOATS) {
+                    float* slot0 = ring0 + c0 * LINE_FLOATS;
+                    float* slot1 = ring1 + c1 * LINE_FLOATS;
+                    float* slot2 = ring2 + c2 * LINE_FLOATS;
+                    __m256 v0 = _mm256_loadu_ps(line), v1 = _mm256_loadu_ps(line + 8);
+                    a0 = _mm256_add_ps(a0, _mm256_sub_ps(v0, _mm256_loadu_ps(slot0)));
+                    a1 = _mm256_add_ps(a1, _mm256_sub_ps(v1, _mm256_loadu_ps(slot0 + 8)));
+                    _mm256_storeu_ps(slot0, v0);
+                    _mm256_storeu_ps(slot0 + 8, v1);
+                    v0 = _mm256_mul_ps(a0, scale0);
+                    v1 = _mm256_mul_ps(a1, scale0);
+                    b0 = _mm256_add_ps(b0, _mm256_sub_ps(v0, _mm256_loadu_ps(slot1)));
+                    b1 = _mm256_add_ps(b1, _mm256_sub_ps(v1, _mm256_loadu_ps(slot1 + 8)));
+                    _mm256_storeu_ps(slot1, v0);
+                    _mm256_storeu_ps(slot1 + 8, v1);
+                    v0 = _mm256_mul_ps(b0, scale1);
+                    v1 = _mm256_mul_ps(b1, scale1);
+                    d0 = _mm256_add_ps(d0, _mm256_sub_ps(v0, _mm256_loadu_ps(slot2)));
+                    d1 = _mm256_add_ps(d1, _mm256_sub_ps(v1, _mm256_loadu_ps(slot2 + 8)));
+                    _mm256_storeu_ps(slot2, v0);
+                    _mm256_storeu_ps(slot2 + 8, v1);
+                    _mm256_storeu_ps(out, _mm256_mul_ps(d0, scale2));
+                    _mm256_storeu_ps(out + 8, _mm256_mul_ps(d1, scale2));
+                    c0 = advance(c0, widths[0]);
+                    c1 = advance(c1, widths[1]);
+                    c2 = advance(c2, widths[2]);
+                }
+            }
+#endif
+
+            /**
+             * Three running-sum boxes in one sweep along a band. Each box keeps the last `width`
+             * values it read in a ring, which is all it needs to drop the value leaving its
+             * window, so the rings fit in L1 and the sums stay in registers. Output position o
+             * overwrites line o, which the sweep has already read.
+             */
+            void boxCascade(float* band, size_t length, const uint32_t* widths, float* rings) {
+                CascadeState state;
+                state.ring[0] = rings;
+                state.ring[1] = rings + widths[0] * LINE_FLOATS;
+                state.ring[2] = rings + (widths[0] + widths[1]) * LINE_FLOATS;
+                for (int k = 0; k < 3; ++k) {
+                    state.width[k] = widths[k];
+                    state.scale[k] = 1.0f / static_cast<float>(widths[k]);
+                }
+                std::fill(rings, rings + (widths[0] + widths[1] + widths[2]) * LINE_FLOATS, 0.0f);
+
+                // Until every window is full the boxes start one after another
+                const size_t warmUp = widths[0] + widths[1] + widths[2] - 2;
+                size_t n = 0;
+                size_t output = 0;
+                float* line = band;
+                for (; n < warmUp && n < length; ++n, line += LINE_FLOATS) {
+                    float value[LINE_FLOATS];
+                    std::memcpy(value, line, sizeof(value));
+                    if (state.step(value)) {
+                        std::memcpy(band + output++ * LINE_FLOATS, value, sizeof(value));
+                    }
+                }
+
+                float* out = band + output * LINE_FLOATS;
+                float* ring0 = state.ring[0];
+                float* ring1 = state.ring[1];
+                float* ring2 = state.ring[2];
+                size_t c0 = state.cursor[0], c1 = state.cursor[1], c2 = state.cursor[2];
+#if defined(AE_SIMD_AVX2_DISPATCH)
+                if (Simd::hasAvx2()) {
+                    boxSweepAvx2(state, line, out, length - n);
+                    return;
+                }
+#endif
+#if defined(AE_SIMD_SSE2)
+                const __m128 scale0 = _mm_set1_ps(1.0f / static_cast<float>(widths[0]));
+                const __m128 scale1 = _mm_set1_ps(1.0f / static_cast<float>(widths[1]));
+                const __m128 scale2 = _mm_set1_ps(1.0f / static_cast<float>(widths[2]));
+                __m128 sums[3][4];
+                for (int k = 0; k < 3; ++k) {
+                    for (int h = 0; h < 4; ++h) {
+                        sums[k][h] = _mm_load_ps(state.sums[k] + h * 4);
+                    }
+                }
+                for (; n < length; ++n, line += LINE_FLOATS, out += LINE_FLOATS) {
+                    float* slot0 = ring0 + c0 * LINE_FLOATS;
+                    float* slot1 = ring1 + c1 * LINE_FLOATS;
+                    float* slot2 = ring2 + c2 * LINE_FLOATS;
+                    for (int h = 0; h < 4; ++h) {
+                        __m128 v = _mm_loadu_ps(line + h * 4);
+                        sums[0][h] = _mm_add_ps(sums[0][h], _mm_sub_ps(v, _mm_loadu_ps(slot0 + h * 4)));
+                        _mm_storeu_ps(slot0 + h * 4, v);
+                        v = _mm_mul_ps(sums[0][h], scale0);
+                        sums[1][h] = _mm_add_ps(sums[1][h], _mm_sub_ps(v, _mm_loadu_ps(slot1 + h * 4)));
+                        _mm_storeu_ps(slot1 + h * 4, v);
+                        v = _mm_mul_ps(sums[1][h], scale1);
+                        sums[2][h] = _mm_add_ps(sums[2][h], _mm_sub_ps(v, _mm_loadu_ps(slot2 + h * 4)));
+                        _mm_storeu_ps(slot2 + h * 4, v);
+                        _mm_storeu_ps(out + h * 4, _mm_mul_ps(sums[2][h], scale2));
+                    }
+                    c0 = advance(c0, widths[0]);
+                    c1 = advance(c1, widths[1]);
+                    c2 = advance(c2, widths[2]);
+                }
+#else
+                (void)ring0; (void)ring1; (void)ring2; (void)c0; (void)c1; (void)c2;
+                for (; n < length; ++n, line += LINE_FLOATS, out += LINE_FLOATS) {
+                    float value[LINE_FLOATS];
+                    std::memcpy(value, line, sizeof(value));
+                    state.step(value);
+                    std::memcpy(out, value, sizeof(value));
+                }
+#endif
+            }
+
+#if defined(AE_SIMD_AVX2_DISPATCH)
+            // kernelSweep with a line per two AVX2 registers
+            AE_TARGET_AVX2 void kernelSweepAvx2(float* band, size_t length, const std::vector<float>& weights, float* ring) {
+                const size_t taps = weights.size();
+                size_t cursor = 0;
+                const float* line = band;
+                for (size_t n = 0; n < length; ++n, line += LINE_FLOATS) {
+                    std::memcpy(ring + cursor * LINE_FLOATS, line, LINE_BYTES);
+                    std::memcpy(ring + (cursor + taps) * LINE_FLOATS, line, LINE_BYTES);
+                    cursor = advance(cursor, taps);
+                    if (n + 1 < taps) {
+                        continue;
+                    }
+                    const float* window = ring + cursor * LINE_FLOATS;
+                    float* out = band + (n + 1 - taps) * LINE_FLOATS;
+                    __m256 sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+                    for (size_t k = 0; k < taps; ++k, window += LINE_FLOATS) {
+                        const __m256 weight = _mm256_set1_ps(weights[k]);
+                        sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_loadu_ps(window), weight));
+                        sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_loadu_ps(window + 8), weight));
+                    }
+                    _mm256_storeu_ps(out, sum0);
+                    _mm256_storeu_ps(out + 8, sum1);
+                }
+            }
+#endif
+
+            /**
+             * Exact convolution in place like boxCascade. Every line is kept twice in a ring of
+             * 2 * taps lines, so the window is always `taps` consecutive lines of the ring.
+             */
+            void kernelSweep(float* band, size_t length, const std::vector<float>& weights, float* ring) {
+#if defined(AE_SIMD_AVX2_DISPATCH)
+                if (Simd::hasAvx2()) {
+                    kernelSweepAvx2(band, length, weights, ring);
+                    return;
+                }
+#endif
+                const size_t taps = weights.size();
+                size_t cursor = 0;
+                const float* line = band;
+                for (size_t n = 0; n < length; ++n, line += LINE_FLOATS) {
+                    std::memcpy(ring + cursor * LINE_FLOATS, line, LINE_BYTES);
+                    std::memcpy(ring + (cursor + taps) * LINE_FLOATS, line, LINE_BYTES);
+                    cursor = advance(cursor, taps);
+                    if (n + 1 < taps) {
+                        continue;
+                    }
+                    // The oldest line sits at the cursor, the newest just before it
+                    const float* window = ring + cursor * LINE_FLOATS;
+                    float* out = band + (n + 1 - taps) * LINE_FLOATS;
+#if defined(AE_SIMD_SSE2)
+                    __m128 sum[4] = {_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps()};
+                    for (size_t k = 0; k < taps; ++k, window += LINE_FLOATS) {
+                        const __m128 weight = _mm_set1_ps(weights[k]);
+                        for (int h = 0; h < 4; ++h) {
+                            sum[h] = _mm_add_ps(sum[h], _mm_mul_ps(_mm_loadu_ps(window + h * 4), weight));
+                        }
+                    }
+                    for (int h = 0; h < 4; ++h) {
+                        _mm_storeu_ps(out + h * 4, sum[h]);
+                    }
+#else
+                    float sum[LINE_FLOATS] = {};
+                    for (size_t k = 0; k < taps; ++k, window += LINE_FLOATS) {
+                        for (size_t h = 0; h < LINE_FLOATS; ++h) {
+                            sum[h] += window[h] * weights[k];
+                        }
+                    }
+                    std::memcpy(out, sum, sizeof(sum));
+#endif
+                }
+            }
+
+            // Per-thread band buffers, kept between bands and filters
+            struct BandScratch {
+                std::vector<float> band;
+                std::vector<float> rings;
+
+                float* reserve(size_t length) {
+                    if (band.size() < length * LINE_FLOATS) {
+                        band.resize(length * LINE_FLOATS);
+                    }
+                    return band.data();
+                }
+            };
+
+            thread_local BandScratch t_scratch;
+
+            /**
+             * Blurs a band gathered at positions [halo, halo + count) of `band`. The padding on
+             * either side repeats the first and last position; the result for position i ends
+             * up at line i.
+             */
+            void blurBand(const BlurPlan& plan, BandScratch& scratch, float* band, size_t count) {
+                const size_t halo = plan.halo;
+                const size_t length = count + halo * 2;
+                for (size_t p = 0; p < halo; ++p) {
+                    std::memcpy(band + p * LINE_FLOATS, band + halo * LINE_FLOATS, LINE_BYTES);
+                    std::memcpy(band + (halo + count + p) * LINE_FLOATS, band + (halo + count - 1) * LINE_FLOATS, LINE_BYTES);
+                }
+
+                if (!plan.weights.empty()) {
+                    scratch.rings.resize(plan.weights.size() * 2 * LINE_FLOATS);
+                    kernelSweep(band, length, plan.weights, scratch.rings.data());
+                    return;
+                }
+                const uint32_t widths[3] = {plan.boxes[0] * 2 + 1, plan.boxes[1] * 2 + 1, plan.boxes[2] * 2 + 1};
+                scratch.rings.resize((widths[0] + widths[1] + widths[2]) * LINE_FLOATS);
+                boxCascade(band, length, widths, scratch.rings.data());
+            }
+
+            const uint8_t* getTransparentTile() {
+                static const std::vector<uint8_t> s_zero(static_cast<size_t>(TILE_PIXELS) * getBytesPerPixel(PixelFormat::RGBA32F), 0);
+                return s_zero.data();
+            }
+
+#if defined(AE_SIMD_SSE2)
+            // Four RGBA8 pixels to one band line
+            AE_FORCE_INLINE void widenLine(__m128i pixels, float* line) {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i lo = _mm_unpacklo_epi8(pixels, zero);
+                const __m128i hi = _mm_unpackhi_epi8(pixels, zero);
+                _mm_storeu_ps(line, _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)));
+                _mm_storeu_ps(line + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)));
+                _mm_storeu_ps(line + 8, _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)));
+                _mm_storeu_ps(line + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)));
+            }
+
+            // One band line back to four RGBA8 pixels, clamped to [0, alpha]
+            AE_FORCE_INLINE __m128i narrowLine(const float* line) {
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 full = _mm_set1_ps(255.0f);
+                __m128i p[4];
+                for (int j = 0; j < 4; ++j) {
+                    __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(line + j * 4), zero), full);
+                    v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)));
+                    p[j] = _mm_cvtps_epi32(v);
+                }
+                return _mm_packus_epi16(_mm_packs_epi32(p[0], p[1]), _mm_packs_epi32(p[2], p[3]));
+            }
+
+            // Transposes a 4x4 block of 32-bit pixels
+            AE_FORCE_INLINE void transpose4(__m128i& a, __m128i& b, __m128i& c, __m128i& d) {
+                const __m128i ab0 = _mm_unpacklo_epi32(a, b), ab1 = _mm_unpackhi_epi32(a, b);
+                const __m128i cd0 = _mm_unpacklo_epi32(c, d), cd1 = _mm_unpackhi_epi32(c, d);
+                a = _mm_unpacklo_epi64(ab0, cd0);
+                b = _mm_unpackhi_epi64(ab0, cd0);
+                c = _mm_unpacklo_epi64(ab1, cd1);
+                d = _mm_unpackhi_epi64(ab1, cd1);
+            }
+#endif
+
+            /**
+             * Widens `count` rows starting at tile row `row0` into band positions: position x
+             * holds column x of those rows side by side. Full RGBA8 blocks go through 4x4 pixel
+             * transposes.
+             */
+            void loadRowGroup(PixelFormat format, const uint8_t* pixels, uint32_t row0, uint32_t count, uint32_t columns, float* band) {
+                const size_t rowBytes = static_cast<size_t>(TILE_SIZE) * getBytesPerPixel(format);
+                const uint8_t* row = pixels + row0 * rowBytes;
+#if defined(AE_SIMD_SSE2)
+                if (format == PixelFormat::RGBA8 && count == LINE_PIXELS && columns == TILE_SIZE) {
+                    for (uint32_t x = 0; x < TILE_SIZE; x += 4) {
+                        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x * 4));
+                        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + rowBytes + x * 4));
+                        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + rowBytes * 2 + x * 4));
+                        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + rowBytes * 3 + x * 4));
+                        transpose4(a, b, c, d);
+                        widenLine(a, band + (x + 0) * LINE_FLOATS);
+                        widenLine(b, band + (x + 1) * LINE_FLOATS);
+                        widenLine(c, band + (x + 2) * LINE_FLOATS);
+                        widenLine(d, band + (x + 3) * LINE_FLOATS);
+                    }
+                    return;
+                }
+#endif
+                for (uint32_t r = 0; r < count; ++r) {
+                    FilterKernels::loadRow(format, row + r * rowBytes, band + r * 4, columns, LINE_FLOATS);
+                }
+            }
+
+            // Inverse of loadRowGroup
+            void storeRowGroup(PixelFormat format, const float* band, uint32_t row0, uint32_t count, uint32_t columns, uint8_t* pixels) {
+                const size_t rowBytes = static_cast<size_t>(TILE_SIZE) * getBytesPerPixel(format);
+                uint8_t* row = pixels + row0 * rowBytes;
+#if defined(AE_SIMD_SSE2)
+                if (format == PixelFormat::RGBA8 && count == LINE_PIXELS && columns == TILE_SIZE) {
+                    for (uint32_t x = 0; x < TILE_SIZE; x += 4) {
+                        __m128i a = narrowLine(band + (x + 0) * LINE_FLOATS);
+                        __m128i b = narrowLine(band + (x + 1) * LINE_FLOATS);
+                        __m128i c = narrowLine(band + (x + 2) * LINE_FLOATS);
+                        __m128i d = narrowLine(band + (x + 3) * LINE_FLOATS);
+                        transpose4(a, b, c, d);
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + x * 4), a);
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + rowBytes + x * 4), b);
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + rowBytes * 2 + x * 4), c);
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + rowBytes * 3 + x * 4), d);
+                    }
+                    return;
+                }
+#endif
+                for (uint32_t r = 0; r < count; ++r) {
+                    FilterKernels::storeRow(format, band + r * 4, row + r * rowBytes, columns, LINE_FLOATS);
+                }
+            }
+
+            // Widens pixels [column0, column0 + count) of every tile row into consecutive band positions
+            void loadColumnGroup(PixelFormat format, const uint8_t* pixels, uint32_t column0, uint32_t count, uint32_t rows, float* band) {
+                const uint32_t bpp = getBytesPerPixel(format);
+                const size_t rowBytes = static_cast<size_t>(TILE_SIZE) * bpp;
+                const uint8_t* row = pixels + column0 * bpp;
+#if defined(AE_SIMD_SSE2)
+                if (format == PixelFormat::RGBA8 && count == LINE_PIXELS) {
+                    for (uint32_t r = 0; r < rows; ++r, row += rowBytes, band += LINE_FLOATS) {
+                        widenLine(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row)), band);
+                    }
+                    return;
+                }
+#endif
+                for (uint32_t r = 0; r < rows; ++r, row += rowBytes, band += LINE_FLOATS) {
+                    FilterKernels::loadRow(format, row, band, count);
+                }
+            }
+
+            // Inverse of loadColumnGroup
+            void storeColumnGroup(PixelFormat format, const float* band, uint32_t column0, uint32_t count, uint32_t rows, uint8_t* pixels) {
+                const uint32_t bpp = getBytesPerPixel(format);
+                const size_t rowBytes = static_cast<size_t>(TILE_SIZE) * bpp;
+                uint8_t* row = pixels + column0 * bpp;
+#if defined(AE_SIMD_SSE2)
+                if (format == PixelFormat::RGBA8 && count == LINE_PIXELS) {
+                    for (uint32_t r = 0; r < rows; ++r, row += rowBytes, band += LINE_FLOATS) {
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(row), narrowLine(band));
+                    }
+                    return;
+                }
+#endif
+                for (uint32_t r = 0; r < rows; ++r, row += rowBytes, band += LINE_FLOATS) {
+                    FilterKernels::storeRow(format, band, row, count);
+                }
+            }
+
+            /**
+             * Blurs one tile row of `source` along x into `target`, LINE_PIXELS rows at a time.
+             * A band of four rows across a 16K image is 1 MB of floats, so it is gathered,
+             * blurred and written back while it is still in cache.
+             */
+            void blurRows(const BlurPlan& plan, const TiledImage& source, TiledImage& target, uint32_t ty) {
+                const uint32_t tilesX = source.getTilesX();
+                bool empty = true;
+                for (uint32_t tx = 0; tx < tilesX && empty; ++tx) {
+                    empty = source.getTile(tx, ty) == nullptr;
+                }
+                if (empty) {
+                    return;
+                }
+
+                const PixelFormat format = source.getFormat();
+                const uint32_t width = source.getWidth();
+                const uint32_t rows = std::min(TILE_SIZE, source.getHeight() - ty * TILE_SIZE);
+                BandScratch& scratch = t_scratch;
+                float* band = scratch.reserve(static_cast<size_t>(width) + plan.halo * 2);
+
+                for (uint32_t row0 = 0; row0 < rows; row0 += LINE_PIXELS) {
+                    const uint32_t count = std::min(LINE_PIXELS, rows - row0);
+                    for (uint32_t tx = 0; tx < tilesX; ++tx) {
+                        const Tile* tile = source.getTile(tx, ty);
+                        loadRowGroup(format, tile ? tile->getData() : getTransparentTile(), row0, count,
+                                     std::min(TILE_SIZE, width - tx * TILE_SIZE), band + (plan.halo + tx * TILE_SIZE) * LINE_FLOATS);
+                    }
+                    blurBand(plan, scratch, band, width);
+                    for (uint32_t tx = 0; tx < tilesX; ++tx) {
+                        storeRowGroup(format, band + tx * TILE_SIZE * LINE_FLOATS, row0, count,
+                                      std::min(TILE_SIZE, width - tx * TILE_SIZE), target.getTileForWrite(tx, ty).getData());
+                    }
+                }
+                for (uint32_t tx = 0; tx < tilesX; ++tx) {
+                    target.compactTile(tx, ty);
+                }
+            }
+
+            // Blurs one tile column of `source` along y into `target`, LINE_PIXELS columns at a time
+            void blurColumns(const BlurPlan& plan, const TiledImage& source, TiledImage& target, uint32_t tx) {
+                const uint32_t tilesY = source.getTilesY();
+                bool empty = true;
+                for (uint32_t ty = 0; ty < tilesY && empty; ++ty) {
+                    empty = source.getTile(tx, ty) == nullptr;
+                }
+                if (empty) {
+                    return;
+                }
+
+                const PixelFormat format = source.getFormat();
+                const uint32_t height = source.getHeight();
+                const uint32_t columns = std::min(TILE_SIZE, source.getWidth() - tx * TILE_SIZE);
+                BandScratch& scratch = t_scratch;
+                float* band = scratch.reserve(static_cast<size_t>(height) + plan.halo * 2);
+
+                for (uint32_t column0 = 0; column0 < columns; column0 += LINE_PIXELS) {
+                    const uint32_t count = std::min(LINE_PIXELS, columns - column0);
+                    for (uint32_t ty = 0; ty < tilesY; ++ty) {
+                        const Tile* tile = source.getTile(tx, ty);
+                        loadColumnGroup(format, tile ? tile->getData() : getTransparentTile(), column0, count,
+                                        std::min(TILE_SIZE, height - ty * TILE_SIZE), band + (plan.halo + ty * TILE_SIZE) * LINE_FLOATS);
+                    }
+                    blurBand(plan, scratch, band, height);
+                    for (uint32_t ty = 0; ty < tilesY; ++ty) {
+                        storeColumnGroup(format, band + ty * TILE_SIZE * LINE_FLOATS, column0, count,
+                                         std::min(TILE_SIZE, height - ty * TILE_SIZE), target.getTileForWrite(tx, ty).getData());
+                    }
+                }
+                for (uint32_t ty = 0; ty < tilesY; ++ty) {
+                    target.compactTile(tx, ty);
+                }
+            }
+        }
+
+        std::shared_ptr<TiledImage> GaussianBlurFilter::apply(const TiledImage& source, const std::atomic<bool>* cancel) const {
+            if (m_radius <= 0.0f) {
+                return std::make_shared<TiledImage>(source);
+            }
+            const BlurPlan plan = makePlan(m_radius);
+            auto& jobs = Jobs::JobSystem::getInstance();
+            auto cancelled = [cancel] { return cancel && cancel->load(std::memory_order_relaxed); };
+
+            TiledImage rows(source.getWidth(), source.getHeight(), source.getFormat());
+            jobs.parallelFor(source.getTilesY(), [&](size_t ty) {
+                if (!cancelled()) {
+                    blurRows(plan, source, rows, static_cast<uint32_t>(ty));
+                }
+            });
+            if (cancelled()) {
+                return nullptr;
+            }
+
+            auto result = std::make_shared<TiledImage>(source.getWidth(), source.getHeight(), source.getFormat());
+            jobs.parallelFor(source.getTilesX(), [&](size_t tx) {
+                if (!cancelled()) {
+                    blurColumns(plan, rows, *result, static_cast<uint32_t>(tx));
+                }
+            });
+            if (cancelled()) {
+                return nullptr;
+            }
+            return result;
+        }
+
+        std::shared_ptr<TiledImage> UnsharpMaskFilter::apply(const TiledImage& source, const std::atomic<bool>* cancel) const {
+            std::shared_ptr<TiledImage> blurred = GaussianBlurFilter(m_radius).apply(source, cancel);
+            if (!blurred) {
+                return nullptr;
+            }
+
+            auto result = std::make_shared<TiledImage>(source);
+            const PixelFormat format = source.getFormat();
+            const float threshold = m_threshold * FilterKernels::getChannelScale(format);
+            const uint32_t tilesX = source.getTilesX();
+            Jobs::JobSystem::getInstance().parallelFor(source.getTileCount(), [&](size_t index) {
+                const uint32_t tx = static_cast<uint32_t>(index % tilesX);
+                const uint32_t ty = static_cast<uint32_t>(index / tilesX);
+                const Tile* original = source.getTile(tx, ty);
+                const Tile* blur = blurred->getTile(tx, ty);
+                // Flat areas blur to themselves (uniform tiles are interned), so there is no difference to add
+                if (original == blur) {
+                    return;
+                }
+
+                float* o = t_scratch.reserve(TILE_PIXELS * 2 / LINE_PIXELS);
+                float* b = o + TILE_PIXELS * 4;
+                FilterKernels::loadRow(format, original ? original->getData() : getTransparentTile(), o, TILE_PIXELS);
+                FilterKernels::loadRow(format, blur ? blur->getData() : getTransparentTile(), b, TILE_PIXELS);
+                for (size_t i = 0; i < static_cast<size_t>(TILE_PIXELS) * 4; i += 4) {
+                    for (size_t c = 0; c < 3; ++c) {
+                        const float difference = o[i + c] - b[i + c];
+                        if (std::fabs(difference) > threshold) {
+                            o[i + c] += difference * m_amount;
+                        }
+                    }
+                }
+                FilterKernels::storeRow(format, o, result->getTileForWrite(tx, ty).getData(), TILE_PIXELS);
+                result->compactTile(tx, ty);
+            }, 4);
+            return result;
+        }
+    }
+}
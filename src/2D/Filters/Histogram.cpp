@@ -0,0 +1,220 @@
+#include "2D/Filters/Histogram.h"
+#include "2D/Image/ColorSpace.h"
+#include "Core/JobSystem.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            // Slices per worker, so uneven tiles still spread evenly
+            constexpr uint32_t SLICES_PER_WORKER = 4;
+
+            inline void hashCombine(uint64_t& seed, uint64_t value) {
+                seed ^= std::hash<uint64_t>()(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+            }
+
+            // Counts `weight` copies of a premultiplied sRGB RGBA8 pixel
+            inline void countPixel(Histogram& histogram, const uint8_t* pixel, uint32_t weight) {
+                const uint32_t alpha = pixel[3];
+                if (alpha == 0) {
+                    return;
+                }
+                uint32_t rgb[3] = {pixel[0], pixel[1], pixel[2]};
+                if (alpha != 255) {
+                    for (uint32_t& c : rgb) {
+                        c = std::min((c * 255u + alpha / 2) / alpha, 255u);
+                    }
+                }
+                const uint32_t luminance = (54u * rgb[0] + 183u * rgb[1] + 19u * rgb[2] + 128u) >> 8;
+                histogram.bins[Histogram::Red][rgb[0]] += weight;
+                histogram.bins[Histogram::Green][rgb[1]] += weight;
+                histogram.bins[Histogram::Blue][rgb[2]] += weight;
+                histogram.bins[Histogram::Luminance][luminance] += weight;
+                histogram.pixelCount += weight;
+            }
+
+            // Counts the part of one tile inside the image and the mask
+            void countTile(Histogram& histogram, const TiledImage& image, const TiledMask* mask, uint32_t tx, uint32_t ty,
+                           std::vector<uint8_t>& converted) {
+                const Tile* tile = image.getTile(tx, ty);
+                if (!tile || (mask && mask->isTileEmpty(tx, ty))) {
+                    return;
+                }
+                const uint8_t* coverage = mask && !mask->isTileFull(tx, ty) ? mask->getTile(tx, ty) : nullptr;
+                const uint32_t width = std::min(TILE_SIZE, image.getWidth() - tx * TILE_SIZE);
+                const uint32_t height = std::min(TILE_SIZE, image.getHeight() - ty * TILE_SIZE);
+                const PixelFormat format = image.getFormat();
+
+                if (tile->isUniform()) {
+                    uint32_t count = width * height;
+                    if (coverage) {
+                        count = 0;
+                        for (uint32_t y = 0; y < height; ++y) {
+                            for (uint32_t x = 0; x < width; ++x) {
+                                count += coverage[y * TILE_SIZE + x] >= 128;
+                            }
+                        }
+                    }
+                    uint8_t pixel[4];
+                    ColorSpace::convertRow(format, PixelFormat::RGBA8, tile->getUniformPixel(), pixel, 1);
+                    if (count > 0) {
+                        countPixel(histogram, pixel, count);
+                    }
+                    return;
+                }
+
+                // Bins are 8-bit sRGB, so deeper formats are reduced to that first
+                const uint8_t* pixels = tile->getData();
+                if (format != PixelFormat::RGBA8) {
+                    converted.resize(static_cast<size_t>(TILE_PIXELS) * 4);
+                    ColorSpace::convertRow(format, PixelFormat::RGBA8, pixels, converted.data(), TILE_PIXELS);
+                    pixels = converted.data();
+                }
+                for (uint32_t y = 0; y < height; ++y) {
+                    const uint8_t* row = pixels + static_cast<size_t>(y) * TILE_SIZE * 4;
+                    const uint8_t* rowCoverage = coverage ? coverage + y * TILE_SIZE : nullptr;
+                    for (uint32_t x = 0; x < width; ++x) {
+                        if (!rowCoverage || rowCoverage[x] >= 128) {
+                            countPixel(histogram, row + x * 4, 1);
+                        }
+                    }
+                }
+            }
+        }
+
+        void Histogram::merge(const Histogram& other) {
+            for (uint32_t channel = 0; channel < CHANNEL_COUNT; ++channel) {
+                for (uint32_t bin = 0; bin < BIN_COUNT; ++bin) {
+                    bins[channel][bin] += other.bins[channel][bin];
+                }
+            }
+            pixelCount += other.pixelCount;
+        }
+
+        uint32_t Histogram::getPeak(Channel channel) const {
+            return *std::max_element(bins[channel], bins[channel] + BIN_COUNT);
+        }
+
+        Histogram Histogram::compute(const TiledImage& image, const TiledMask* mask, const std::atomic<bool>* cancel) {
+            if (mask && (mask->getWidth() != image.getWidth() || mask->getHeight() != image.getHeight())) {
+                mask = nullptr;
+            }
+            const uint32_t tileCount = image.getTileCount();
+            const uint32_t tilesX = image.getTilesX();
+            auto& jobs = Jobs::JobSystem::getInstance();
+            const uint32_t sliceCount = std::max(1u, std::min(tileCount, (jobs.getWorkerCount() + 1) * SLICES_PER_WORKER));
+
+            std::vector<Histogram> slices(sliceCount);
+            jobs.parallelFor(sliceCount, [&](size_t slice) {
+                Histogram& histogram = slices[slice];
+                std::vector<uint8_t> converted;
+                const uint32_t begin = static_cast<uint32_t>(static_cast<uint64_t>(tileCount) * slice / sliceCount);
+                const uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(tileCount) * (slice + 1) / sliceCount);
+                for (uint32_t index = begin; index < end; ++index) {
+                    if (cancel && cancel->load(std::memory_order_relaxed)) {
+                        return;
+                    }
+                    countTile(histogram, image, mask, index % tilesX, index / tilesX, converted);
+                }
+            });
+
+            Histogram result;
+            if (cancel && cancel->load()) {
+                return result;
+            }
+            for (const Histogram& slice : slices) {
+                result.merge(slice);
+            }
+            return result;
+        }
+
+        HistogramMonitor::~HistogramMonitor() {
+            cancelJob();
+        }
+
+        uint64_t HistogramMonitor::fingerprint(const TiledImage& image) {
+            uint64_t seed = image.getWidth();
+            hashCombine(seed, image.getHeight());
+            hashCombine(seed, static_cast<uint64_t>(image.getFormat()));
+            for (uint32_t ty = 0; ty < image.getTilesY(); ++ty) {
+                for (uint32_t tx = 0; tx < image.getTilesX(); ++tx) {
+                    const Tile* tile = image.getTile(tx, ty);
+                    hashCombine(seed, tile ? tile->getRevision() : 0);
+                }
+            }
+            return seed;
+        }
+
+        uint64_t HistogramMonitor::fingerprint(const TiledMask* mask) {
+            if (!mask) {
+                return 0;
+            }
+            uint64_t seed = mask->getWidth();
+            hashCombine(seed, mask->getHeight());
+            for (uint32_t ty = 0; ty < mask->getTilesY(); ++ty) {
+                for (uint32_t tx = 0; tx < mask->getTilesX(); ++tx) {
+                    hashCombine(seed, reinterpret_cast<uintptr_t>(mask->getTile(tx, ty)));
+                }
+            }
+            return seed;
+        }
+
+        void HistogramMonitor::cancelJob() {
+            if (!m_job) {
+                return;
+            }
+            m_job->cancel.store(true);
+            m_jobDone.wait();
+            m_job.reset();
+        }
+
+        bool HistogramMonitor::update(const TiledImage* image, const TiledMask* mask) {
+            bool updated = false;
+            if (m_job && m_jobDone.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                m_histogram = m_job->result;
+                m_job.reset();
+                updated = true;
+            }
+
+            if (image != m_image) {
+                // Another layer; what is running or shown belongs to the old one
+                cancelJob();
+                m_image = image;
+                m_histogram = Histogram();
+                m_counted = false;
+                updated = true;
+            }
+            if (!image || m_job) {
+                return updated;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            if (m_counted && now - m_lastStart < MIN_INTERVAL) {
+                return updated;
+            }
+            const uint64_t imageFingerprint = fingerprint(*image);
+            const uint64_t maskFingerprint = fingerprint(mask);
+            if (m_counted && imageFingerprint == m_imageFingerprint && maskFingerprint == m_maskFingerprint) {
+                return updated;
+            }
+
+            m_imageFingerprint = imageFingerprint;
+            m_maskFingerprint = maskFingerprint;
+            m_mask = mask ? std::make_shared<TiledMask>(*mask) : nullptr;
+            m_counted = true;
+            m_lastStart = now;
+
+            auto job = std::make_shared<Job>();
+            std::shared_ptr<const TiledImage> snapshot = std::make_shared<TiledImage>(*image);
+            std::shared_ptr<const TiledMask> clip = m_mask;
+            m_jobDone = Jobs::JobSystem::getInstance().submit([job, snapshot, clip] {
+                job->result = Histogram::compute(*snapshot, clip.get(), &job->cancel);
+            });
+            m_job = std::move(job);
+            return updated;
+        }
+    }
+}
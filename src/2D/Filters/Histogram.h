@@ -0,0 +1,98 @@
+#pragma once
+
+#include "2D/Image/TiledImage.h"
+#include "2D/Image/TiledMask.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+
+namespace AstralEngine {
+    namespace D2 {
+        /**
+         * @brief Per-channel and luminance histogram of a layer
+         *
+         * Bins are straight (unpremultiplied) values of the sRGB encoding, 256 per channel,
+         * whatever the document's format, so levels and curves read the same on every
+         * document. Luminance is the Rec. 709 weighting of the encoded channels. Transparent
+         * pixels have no color and are not counted; with a selection, only pixels it covers
+         * at least half are.
+         */
+        struct Histogram {
+            static constexpr uint32_t BIN_COUNT = 256;
+
+            enum Channel : uint32_t {
+                Red,
+                Green,
+                Blue,
+                Luminance,
+                CHANNEL_COUNT
+            };
+
+            uint32_t bins[CHANNEL_COUNT][BIN_COUNT] = {};
+            uint64_t pixelCount = 0;
+
+            void merge(const Histogram& other);
+            uint32_t getPeak(Channel channel) const;
+
+            /**
+             * Counts `image` inside `mask` (the whole image if null; otherwise it must have the
+             * image's size). Tiles are split into slices counted in parallel, each into its own
+             * histogram, and the slices are summed at the end, so no counter is shared between
+             * threads. Missing tiles are skipped and uniform ones counted from a single pixel.
+             * Returns an empty histogram if `cancel` was raised.
+             */
+            static Histogram compute(const TiledImage& image, const TiledMask* mask = nullptr,
+                                     const std::atomic<bool>* cancel = nullptr);
+        };
+
+        /**
+         * @brief Keeps a histogram of a changing layer up to date in the background
+         *
+         * update() is cheap enough for every frame: it fingerprints the image by its tile
+         * revisions and the mask by its tile identities, and only when either changed starts
+         * a recount on the job system, of copy-on-write snapshots so painting carries on
+         * meanwhile. One recount runs at a time, at most one per MIN_INTERVAL, so a long
+         * stroke on a large document refreshes a few times a second without stalling frames.
+         */
+        class HistogramMonitor {
+        public:
+            static constexpr std::chrono::milliseconds MIN_INTERVAL{100};
+
+            HistogramMonitor() = default;
+            ~HistogramMonitor();
+
+            HistogramMonitor(const HistogramMonitor&) = delete;
+            HistogramMonitor& operator=(const HistogramMonitor&) = delete;
+
+            // Call once per frame; returns true when a newer histogram became available
+            bool update(const TiledImage* image, const TiledMask* mask);
+
+            const Histogram& getHistogram() const { return m_histogram; }
+            bool isCounting() const { return m_job != nullptr; }
+
+        private:
+            struct Job {
+                std::atomic<bool> cancel{false};
+                Histogram result;
+            };
+
+            static uint64_t fingerprint(const TiledImage& image);
+            static uint64_t fingerprint(const TiledMask* mask);
+            void cancelJob();
+
+            Histogram m_histogram;
+            const TiledImage* m_image = nullptr;
+            uint64_t m_imageFingerprint = 0;
+            uint64_t m_maskFingerprint = 0;
+            // Kept so the mask's tiles are shared and a write gives them a new identity
+            std::shared_ptr<const TiledMask> m_mask;
+            bool m_counted = false;
+
+            std::shared_ptr<Job> m_job;
+            std::future<void> m_jobDone;
+            std::chrono::steady_clock::time_point m_lastStart;
+        };
+    }
+}
@@ -0,0 +1,21 @@
+#include "2D/Image/BlendKernelsImpl.h"
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace BlendKernels {
+            void blendRow(BlendMode mode, PixelFormat format, void* dst, const void* src, uint32_t count, float opacity) {
+#if defined(AE_SIMD_AVX2_DISPATCH) && !defined(AE_SIMD_AVX2)
+                if (Simd::hasAvx2()) {
+                    blendRowAvx2(mode, format, dst, src, count, opacity);
+                    return;
+                }
+#endif
+                blendRowWith<true>(mode, format, dst, src, count, opacity);
+            }
+
+            void blendRowScalar(BlendMode mode, PixelFormat format, void* dst, const void* src, uint32_t count, float opacity) {
+                blendRowWith<false>(mode, format, dst, src, count, opacity);
+            }
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "2D/Image/TiledImage.h"
+#include <cstdint>
+
+namespace AstralEngine {
+    namespace D2 {
+        // Blend modes for layers
+        enum class BlendMode {
+            Normal,
+            Multiply,
+            Screen,
+            Overlay,
+            Darken,
+            Lighten,
+            ColorDodge,
+            ColorBurn,
+            HardLight,
+            SoftLight,
+            Difference,
+            Exclusion,
+            Hue,
+            Saturation,
+            Color,
+            Luminosity
+        };
+        
+        /**
+         * @brief Pixel kernels compositing one row of a layer onto another
+         *
+         * All modes follow the W3C compositing formulas on premultiplied RGBA with
+         * source-over alpha. Pixels are converted to float and blended 8 at a time on
+         * CPUs with AVX2 or 4 at a time on SSE2, including the non-separable modes; the
+         * scalar path is the reference the SIMD paths are checked against. Integer
+         * results are rounded to nearest and clamped to a valid premultiplied pixel,
+         * float results are stored as computed.
+         */
+        namespace BlendKernels {
+            // Composites `count` pixels of `src`, scaled by `opacity`, onto `dst` (both in `format`)
+            void blendRow(BlendMode mode, PixelFormat format, void* dst, const void* src, uint32_t count, float opacity);
+            
+            // Same result one pixel at a time without SIMD
+            void blendRowScalar(BlendMode mode, PixelFormat format, void* dst, const void* src, uint32_t count, float opacity);
+        }
+    }
+}
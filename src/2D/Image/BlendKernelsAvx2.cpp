@@ -0,0 +1,16 @@
+// Built with AVX2 and FMA enabled (see src/2D/CMakeLists.txt), so the kernels from
+// BlendKernelsImpl.h instantiate their 8-wide lane here; blendRow calls in only when
+// Simd::hasAvx2().
+#include "2D/Image/BlendKernelsImpl.h"
+
+namespace AstralEngine {
+    namespace D2 {
+#if defined(AE_SIMD_AVX2_DISPATCH)
+        namespace BlendKernels {
+            void blendRowAvx2(BlendMode mode, PixelFormat format, void* dst, const void* src, uint32_t count, float opacity) {
+                blendRowWith<true>(mode, format, dst, src, count, opacity);
+            }
+        }
+#endif
+    }
+}
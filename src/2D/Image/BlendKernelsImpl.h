@@ -0,0 +1,635 @@
+#pragma once
+
+// Blend kernel internals shared by BlendKernels.cpp and BlendKernelsAvx2.cpp, which is built
+// for AVX2 and provides the 8-wide lane. Not for use elsewhere.
+//
+// Everything here has internal linkage and every building block is force-inlined, so none of
+// the AVX2 build's code can stand in for the baseline build's copy of a shared inline
+// function. Keep it that way: no functions with external linkage, and no library calls that
+// may compile out of line (the scalar kernels, which use them, are never instantiated for AVX2).
+
+#include "2D/Image/BlendKernels.h"
+#include "2D/Image/Simd.h"
+#include <cmath>
+#include <cstring>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            // Guards divisions by alpha and by color ranges
+            constexpr float EPSILON = 1e-7f;
+
+            // Lane operations shared by the scalar and SIMD code, so every mode is written once
+            AE_FORCE_INLINE float vmin(float a, float b) { return a < b ? a : b; }
+            AE_FORCE_INLINE float vmax(float a, float b) { return a > b ? a : b; }
+            AE_FORCE_INLINE float vselect(bool mask, float a, float b) { return mask ? a : b; }
+            AE_FORCE_INLINE float vsqrt(float a) { return std::sqrt(a); }
+
+#if defined(AE_SIMD_SSE2)
+            struct F4 {
+                __m128 v;
+                F4() = default;
+                F4(__m128 x) : v(x) {}
+                F4(float f) : v(_mm_set1_ps(f)) {}
+            };
+            struct M4 { __m128 v; };
+
+            AE_FORCE_INLINE F4 operator+(F4 a, F4 b) { return _mm_add_ps(a.v, b.v); }
+            AE_FORCE_INLINE F4 operator-(F4 a, F4 b) { return _mm_sub_ps(a.v, b.v); }
+            AE_FORCE_INLINE F4 operator*(F4 a, F4 b) { return _mm_mul_ps(a.v, b.v); }
+            AE_FORCE_INLINE F4 operator/(F4 a, F4 b) { return _mm_div_ps(a.v, b.v); }
+            AE_FORCE_INLINE M4 operator<(F4 a, F4 b) { return {_mm_cmplt_ps(a.v, b.v)}; }
+            AE_FORCE_INLINE M4 operator<=(F4 a, F4 b) { return {_mm_cmple_ps(a.v, b.v)}; }
+            AE_FORCE_INLINE M4 operator>(F4 a, F4 b) { return {_mm_cmpgt_ps(a.v, b.v)}; }
+            AE_FORCE_INLINE M4 operator>=(F4 a, F4 b) { return {_mm_cmpge_ps(a.v, b.v)}; }
+            AE_FORCE_INLINE F4 vmin(F4 a, F4 b) { return _mm_min_ps(a.v, b.v); }
+            AE_FORCE_INLINE F4 vmax(F4 a, F4 b) { return _mm_max_ps(a.v, b.v); }
+            // Compare masks are all ones or all zeros per lane, so SSE2 can select without blendv
+            AE_FORCE_INLINE F4 vselect(M4 mask, F4 a, F4 b) { return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); }
+            AE_FORCE_INLINE F4 vsqrt(F4 a) { return _mm_sqrt_ps(a.v); }
+#endif
+
+#if defined(AE_SIMD_AVX2)
+            struct F8 {
+                __m256 v;
+                F8() = default;
+                F8(__m256 x) : v(x) {}
+                F8(float f) : v(_mm256_set1_ps(f)) {}
+            };
+            struct M8 { __m256 v; };
+
+            AE_FORCE_INLINE F8 operator+(F8 a, F8 b) { return _mm256_add_ps(a.v, b.v); }
+            AE_FORCE_INLINE F8 operator-(F8 a, F8 b) { return _mm256_sub_ps(a.v, b.v); }
+            AE_FORCE_INLINE F8 operator*(F8 a, F8 b) { return _mm256_mul_ps(a.v, b.v); }
+            AE_FORCE_INLINE F8 operator/(F8 a, F8 b) { return _mm256_div_ps(a.v, b.v); }
+            AE_FORCE_INLINE M8 operator<(F8 a, F8 b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+            AE_FORCE_INLINE M8 operator<=(F8 a, F8 b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)}; }
+            AE_FORCE_INLINE M8 operator>(F8 a, F8 b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)}; }
+            AE_FORCE_INLINE M8 operator>=(F8 a, F8 b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)}; }
+            AE_FORCE_INLINE F8 vmin(F8 a, F8 b) { return _mm256_min_ps(a.v, b.v); }
+            AE_FORCE_INLINE F8 vmax(F8 a, F8 b) { return _mm256_max_ps(a.v, b.v); }
+            AE_FORCE_INLINE F8 vselect(M8 mask, F8 a, F8 b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+            AE_FORCE_INLINE F8 vsqrt(F8 a) { return _mm256_sqrt_ps(a.v); }
+#endif
+
+            template <typename V>
+            AE_FORCE_INLINE V safeDivide(V a, V b) {
+                return vselect(b > V(0.0f), a / vmax(b, V(EPSILON)), V(0.0f));
+            }
+
+            // ---- Separable modes -------------------------------------------------------
+            // Each returns sa * da * B(Sc, Dc) for one channel, written in premultiplied terms
+            // where possible so most modes need no division.
+
+            template <BlendMode M, typename V>
+            AE_FORCE_INLINE V blendChannel(V s, V d, V sa, V da, V sada) {
+                if constexpr (M == BlendMode::Multiply) {
+                    return s * d;
+                } else if constexpr (M == BlendMode::Screen) {
+                    return s * da + d * sa - s * d;
+                } else if constexpr (M == BlendMode::Overlay) {
+                    return vselect(d + d <= da, V(2.0f) * s * d, sada - V(2.0f) * (da - d) * (sa - s));
+                } else if constexpr (M == BlendMode::Darken) {
+                    return vmin(s * da, d * sa);
+                } else if constexpr (M == BlendMode::Lighten) {
+                    return vmax(s * da, d * sa);
+                } else if constexpr (M == BlendMode::ColorDodge) {
+                    // B = min(1, Dc / (1 - Sc)), 1 once Sc reaches 1, 0 on a black backdrop
+                    V headroom = sa - s;
+                    V result = vmin(sada, d * sa * sa / vmax(headroom, V(EPSILON)));
+                    result = vselect(headroom <= V(0.0f), sada, result);
+                    return vselect(d <= V(0.0f), V(0.0f), result);
+                } else if constexpr (M == BlendMode::ColorBurn) {
+                    // B = 1 - min(1, (1 - Dc) / Sc), 1 on a white backdrop, 0 for a black source
+                    V result = vmax(V(0.0f), sada - sa * sa * (da - d) / vmax(s, V(EPSILON)));
+                    result = vselect(s <= V(0.0f), V(0.0f), result);
+                    return vselect(d >= da, sada, result);
+                } else if constexpr (M == BlendMode::HardLight) {
+                    return vselect(s + s <= sa, V(2.0f) * s * d, sada - V(2.0f) * (da - d) * (sa - s));
+                } else if constexpr (M == BlendMode::SoftLight) {
+                    V sc = safeDivide(s, sa);
+                    V dc = safeDivide(d, da);
+                    V curve = vselect(dc <= V(0.25f), ((V(16.0f) * dc - V(12.0f)) * dc + V(4.0f)) * dc, vsqrt(dc));
+                    V result = vselect(sc <= V(0.5f),
+                                       dc - (V(1.0f) - V(2.0f) * sc) * dc * (V(1.0f) - dc),
+                                       dc + (V(2.0f) * sc - V(1.0f)) * (curve - dc));
+                    return sada * result;
+                } else if constexpr (M == BlendMode::Difference) {
+                    return s * da + d * sa - V(2.0f) * vmin(s * da, d * sa);
+                } else if constexpr (M == BlendMode::Exclusion) {
+                    return s * da + d * sa - V(2.0f) * s * d;
+                } else {
+                    return s * da;
+                }
+            }
+
+            // ---- Non-separable helpers -------------------------------------------------
+
+            template <typename V>
+            AE_FORCE_INLINE V luminance(V r, V g, V b) {
+                return r * V(0.3f) + g * V(0.59f) + b * V(0.11f);
+            }
+
+            template <typename V>
+            AE_FORCE_INLINE void clipColor(V& r, V& g, V& b) {
+                V l = luminance(r, g, b);
+                V low = vmin(vmin(r, g), b);
+                V high = vmax(vmax(r, g), b);
+
+                auto below = low < V(0.0f);
+                V lowScale = l / vmax(l - low, V(EPSILON));
+                r = vselect(below, l + (r - l) * lowScale, r);
+                g = vselect(below, l + (g - l) * lowScale, g);
+                b = vselect(below, l + (b - l) * lowScale, b);
+
+                auto above = high > V(1.0f);
+                V highScale = (V(1.0f) - l) / vmax(high - l, V(EPSILON));
+                r = vselect(above, l + (r - l) * highScale, r);
+                g = vselect(above, l + (g - l) * highScale, g);
+                b = vselect(above, l + (b - l) * highScale, b);
+            }
+
+            template <typename V>
+            AE_FORCE_INLINE void setLuminance(V& r, V& g, V& b, V l) {
+                V delta = l - luminance(r, g, b);
+                r = r + delta;
+                g = g + delta;
+                b = b + delta;
+                clipColor(r, g, b);
+            }
+
+            template <typename V>
+            AE_FORCE_INLINE V saturation(V r, V g, V b) {
+                return vmax(vmax(r, g), b) - vmin(vmin(r, g), b);
+            }
+
+            // Rescales the channels so max - min equals `s`; the minimum lands on 0
+            template <typename V>
+            AE_FORCE_INLINE void setSaturation(V& r, V& g, V& b, V s) {
+                V low = vmin(vmin(r, g), b);
+                V range = vmax(vmax(r, g), b) - low;
+                auto chromatic = range > V(0.0f);
+                V scale = s / vmax(range, V(EPSILON));
+                r = vselect(chromatic, (r - low) * scale, V(0.0f));
+                g = vselect(chromatic, (g - low) * scale, V(0.0f));
+                b = vselect(chromatic, (b - low) * scale, V(0.0f));
+            }
+
+            // ---- Pixel kernel ----------------------------------------------------------
+
+            // dst = src over dst with mode M; all values premultiplied, src already scaled by opacity
+            template <BlendMode M, typename V>
+            AE_FORCE_INLINE void blendPixel(V& dr, V& dg, V& db, V& da, V sr, V sg, V sb, V sa) {
+                const V sada = sa * da;
+                V xr, xg, xb;
+                if constexpr (M == BlendMode::Hue || M == BlendMode::Saturation ||
+                              M == BlendMode::Color || M == BlendMode::Luminosity) {
+                    V scr = safeDivide(sr, sa), scg = safeDivide(sg, sa), scb = safeDivide(sb, sa);
+                    V dcr = safeDivide(dr, da), dcg = safeDivide(dg, da), dcb = safeDivide(db, da);
+                    if constexpr (M == BlendMode::Hue) {
+                        xr = scr; xg = scg; xb = scb;
+                        setSaturation(xr, xg, xb, saturation(dcr, dcg, dcb));
+                        setLuminance(xr, xg, xb, luminance(dcr, dcg, dcb));
+                    } else if constexpr (M == BlendMode::Saturation) {
+                        xr = dcr; xg = dcg; xb = dcb;
+                        setSaturation(xr, xg, xb, saturation(scr, scg, scb));
+                        setLuminance(xr, xg, xb, luminance(dcr, dcg, dcb));
+                    } else if constexpr (M == BlendMode::Color) {
+                        xr = scr; xg = scg; xb = scb;
+                        setLuminance(xr, xg, xb, luminance(dcr, dcg, dcb));
+                    } else {
+                        xr = dcr; xg = dcg; xb = dcb;
+                        setLuminance(xr, xg, xb, luminance(scr, scg, scb));
+                    }
+                    xr = sada * xr;
+                    xg = sada * xg;
+                    xb = sada * xb;
+                } else {
+                    xr = blendChannel<M>(sr, dr, sa, da, sada);
+                    xg = blendChannel<M>(sg, dg, sa, da, sada);
+                    xb = blendChannel<M>(sb, db, sa, da, sada);
+                }
+                const V one(1.0f);
+                const V keepDst = one - sa;
+                const V keepSrc = one - da;
+                dr = sr * keepSrc + dr * keepDst + xr;
+                dg = sg * keepSrc + dg * keepDst + xg;
+                db = sb * keepSrc + db * keepDst + xb;
+                da = sa + da - sada;
+            }
+
+            // ---- Scalar pixel access ---------------------------------------------------
+
+            template <PixelFormat F>
+            AE_FORCE_INLINE void loadPixel(const uint8_t* data, float& r, float& g, float& b, float& a) {
+                if constexpr (F == PixelFormat::RGBA8) {
+                    constexpr float scale = 1.0f / 255.0f;
+                    r = data[0] * scale; g = data[1] * scale; b = data[2] * scale; a = data[3] * scale;
+                } else if constexpr (F == PixelFormat::RGBA16) {
+                    constexpr float scale = 1.0f / 65535.0f;
+                    uint16_t c[4];
+                    std::memcpy(c, data, sizeof(c));
+                    r = c[0] * scale; g = c[1] * scale; b = c[2] * scale; a = c[3] * scale;
+                } else {
+                    float c[4];
+                    std::memcpy(c, data, sizeof(c));
+                    r = c[0]; g = c[1]; b = c[2]; a = c[3];
+                }
+            }
+
+            template <PixelFormat F>
+            AE_FORCE_INLINE void storePixel(uint8_t* data, float r, float g, float b, float a) {
+                if constexpr (F == PixelFormat::RGBA32F) {
+                    float c[4] = {r, g, b, a};
+                    std::memcpy(data, c, sizeof(c));
+                } else {
+                    // Same clamping and round-to-nearest-even as the SIMD stores
+                    constexpr float maximum = F == PixelFormat::RGBA8 ? 255.0f : 65535.0f;
+                    a = vmin(vmax(a, 0.0f), 1.0f);
+                    float c[4] = {vmin(vmax(r, 0.0f), a), vmin(vmax(g, 0.0f), a), vmin(vmax(b, 0.0f), a), a};
+                    for (int i = 0; i < 4; ++i) {
+                        long value = std::lrint(c[i] * maximum);
+                        if constexpr (F == PixelFormat::RGBA8) {
+                            data[i] = static_cast<uint8_t>(value);
+                        } else {
+                            uint16_t v16 = static_cast<uint16_t>(value);
+                            std::memcpy(data + i * 2, &v16, sizeof(v16));
+                        }
+                    }
+                }
+            }
+
+            template <BlendMode M, PixelFormat F>
+            void blendPixelsScalar(uint8_t* dst, const uint8_t* src, uint32_t count, float opacity) {
+                constexpr uint32_t bpp = getBytesPerPixel(F);
+                for (uint32_t i = 0; i < count; ++i, dst += bpp, src += bpp) {
+                    float sr, sg, sb, sa, dr, dg, db, da;
+                    loadPixel<F>(src, sr, sg, sb, sa);
+                    if (sa <= 0.0f) {
+                        continue; // Premultiplied: nothing to composite
+                    }
+                    loadPixel<F>(dst, dr, dg, db, da);
+                    blendPixel<M>(dr, dg, db, da, sr * opacity, sg * opacity, sb * opacity, sa * opacity);
+                    storePixel<F>(dst, dr, dg, db, da);
+                }
+            }
+
+            // ---- SSE2: 4 pixels --------------------------------------------------------
+
+#if defined(AE_SIMD_SSE2)
+            template <PixelFormat F>
+            AE_FORCE_INLINE void load4(const uint8_t* data, F4& r, F4& g, F4& b, F4& a) {
+                if constexpr (F == PixelFormat::RGBA8) {
+                    const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+                    const __m128i mask = _mm_set1_epi32(0xFF);
+                    const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+                    r = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(pixels, mask)), scale);
+                    g = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 8), mask)), scale);
+                    b = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 16), mask)), scale);
+                    a = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(pixels, 24)), scale);
+                } else {
+                    __m128 p0, p1, p2, p3;
+                    if constexpr (F == PixelFormat::RGBA16) {
+                        const __m128 scale = _mm_set1_ps(1.0f / 65535.0f);
+                        const __m128i* words = reinterpret_cast<const __m128i*>(data);
+                        const __m128i lo = _mm_loadu_si128(words);
+                        const __m128i hi = _mm_loadu_si128(words + 1);
+                        const __m128i zero = _mm_setzero_si128();
+                        p0 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale);
+                        p1 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale);
+                        p2 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale);
+                        p3 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale);
+                    } else {
+                        const float* floats = reinterpret_cast<const float*>(data);
+                        p0 = _mm_loadu_ps(floats);
+                        p1 = _mm_loadu_ps(floats + 4);
+                        p2 = _mm_loadu_ps(floats + 8);
+                        p3 = _mm_loadu_ps(floats + 12);
+                    }
+                    _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+                    r = p0; g = p1; b = p2; a = p3;
+                }
+            }
+
+            template <PixelFormat F>
+            AE_FORCE_INLINE void store4(uint8_t* data, F4 r, F4 g, F4 b, F4 a) {
+                if constexpr (F != PixelFormat::RGBA32F) {
+                    const F4 zero(0.0f);
+                    a = vmin(vmax(a, zero), F4(1.0f));
+                    r = vmin(vmax(r, zero), a);
+                    g = vmin(vmax(g, zero), a);
+                    b = vmin(vmax(b, zero), a);
+                }
+                if constexpr (F == PixelFormat::RGBA8) {
+                    const __m128 scale = _mm_set1_ps(255.0f);
+                    __m128i pixels = _mm_cvtps_epi32(_mm_mul_ps(r.v, scale));
+                    pixels = _mm_or_si128(pixels, _mm_slli_epi32(_mm_cvtps_epi32(_mm_mul_ps(g.v, scale)), 8));
+                    pixels = _mm_or_si128(pixels, _mm_slli_epi32(_mm_cvtps_epi32(_mm_mul_ps(b.v, scale)), 16));
+                    pixels = _mm_or_si128(pixels, _mm_slli_epi32(_mm_cvtps_epi32(_mm_mul_ps(a.v, scale)), 24));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(data), pixels);
+                } else {
+                    __m128 p0 = r.v, p1 = g.v, p2 = b.v, p3 = a.v;
+                    _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+                    if constexpr (F == PixelFormat::RGBA16) {
+                        // Values are clamped to 0-65535 above, so a signed pack around 32768 is exact
+                        const __m128 scale = _mm_set1_ps(65535.0f);
+                        const __m128i bias = _mm_set1_epi32(32768);
+                        const __m128i flip = _mm_set1_epi16(static_cast<int16_t>(0x8000));
+                        const __m128i i0 = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(p0, scale)), bias);
+                        const __m128i i1 = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(p1, scale)), bias);
+                        const __m128i i2 = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(p2, scale)), bias);
+                        const __m128i i3 = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(p3, scale)), bias);
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(data), _mm_xor_si128(_mm_packs_epi32(i0, i1), flip));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + 16), _mm_xor_si128(_mm_packs_epi32(i2, i3), flip));
+                    } else {
+                        float* floats = reinterpret_cast<float*>(data);
+                        _mm_storeu_ps(floats, p0);
+                        _mm_storeu_ps(floats + 4, p1);
+                        _mm_storeu_ps(floats + 8, p2);
+                        _mm_storeu_ps(floats + 12, p3);
+                    }
+                }
+            }
+#endif
+
+            // ---- AVX2: 8 pixels --------------------------------------------------------
+
+#if defined(AE_SIMD_AVX2)
+            // 4x4 transpose inside each 128-bit lane. Applied to 8 AoS pixels it yields
+            // channel vectors with the lanes ordered 0,2,4,6,1,3,5,7; applying it again undoes it.
+            AE_FORCE_INLINE void transposeLanes(__m256& p0, __m256& p1, __m256& p2, __m256& p3) {
+                const __m256 t0 = _mm256_unpacklo_ps(p0, p1);
+                const __m256 t1 = _mm256_unpackhi_ps(p0, p1);
+                const __m256 t2 = _mm256_unpacklo_ps(p2, p3);
+                const __m256 t3 = _mm256_unpackhi_ps(p2, p3);
+                p0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+                p1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+                p2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+                p3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+            }
+
+            template <PixelFormat F>
+            AE_FORCE_INLINE void load8(const uint8_t* data, F8& r, F8& g, F8& b, F8& a) {
+                if constexpr (F == PixelFormat::RGBA8) {
+                    const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+                    const __m256i mask = _mm256_set1_epi32(0xFF);
+                    const __m256 scale = _mm256_set1_ps(1.0f / 255.0f);
+                    r = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(pixels, mask)), scale);
+                    g = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(pixels, 8), mask)), scale);
+                    b = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(pixels, 16), mask)), scale);
+                    a = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(pixels, 24)), scale);
+                } else {
+                    // Each register holds two pixels, one per 128-bit lane
+                    __m256 p0, p1, p2, p3;
+                    if constexpr (F == PixelFormat::RGBA16) {
+                        const __m256 scale = _mm256_set1_ps(1.0f / 65535.0f);
+                        const __m128i* words = reinterpret_cast<const __m128i*>(data);
+                        p0 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(words))), scale);
+                        p1 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(words + 1))), scale);
+                        p2 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(words + 2))), scale);
+                        p3 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(words + 3))), scale);
+                    } else {
+                        const float* floats = reinterpret_cast<const float*>(data);
+                        p0 = _mm256_loadu_ps(floats);
+                        p1 = _mm256_loadu_ps(floats + 8);
+                        p2 = _mm256_loadu_ps(floats + 16);
+                        p3 = _mm256_loadu_ps(floats + 24);
+                    }
+                    transposeLanes(p0, p1, p2, p3);
+                    r = p0; g = p1; b = p2; a = p3;
+                }
+            }
+
+            template <PixelFormat F>
+            AE_FORCE_INLINE void store8(uint8_t* data, F8 r, F8 g, F8 b, F8 a) {
+                if constexpr (F != PixelFormat::RGBA32F) {
+                    const F8 zero(0.0f);
+                    a = vmin(vmax(a, zero), F8(1.0f));
+                    r = vmin(vmax(r, zero), a);
+                    g = vmin(vmax(g, zero), a);
+                    b = vmin(vmax(b, zero), a);
+                }
+                if constexpr (F == PixelFormat::RGBA8) {
+                    const __m256 scale = _mm256_set1_ps(255.0f);
+                    __m256i pixels = _mm256_cvtps_epi32(_mm256_mul_ps(r.v, scale));
+                    pixels = _mm256_or_si256(pixels, _mm256_slli_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(g.v, scale)), 8));
+                    pixels = _mm256_or_si256(pixels, _mm256_slli_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(b.v, scale)), 16));
+                    pixels = _mm256_or_si256(pixels, _mm256_slli_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(a.v, scale)), 24));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data), pixels);
+                } else {
+                    __m256 p0 = r.v, p1 = g.v, p2 = b.v, p3 = a.v;
+                    transposeLanes(p0, p1, p2, p3);
+                    if constexpr (F == PixelFormat::RGBA16) {
+                        // packus interleaves the lanes as 0,2,1,3; the permute restores pixel order
+                        const __m256 scale = _mm256_set1_ps(65535.0f);
+                        const __m256i i0 = _mm256_cvtps_epi32(_mm256_mul_ps(p0, scale));
+                        const __m256i i1 = _mm256_cvtps_epi32(_mm256_mul_ps(p1, scale));
+                        const __m256i i2 = _mm256_cvtps_epi32(_mm256_mul_ps(p2, scale));
+                        const __m256i i3 = _mm256_cvtps_epi32(_mm256_mul_ps(p3, scale));
+                        __m256i* words = reinterpret_cast<__m256i*>(data);
+                        _mm256_storeu_si256(words, _mm256_permute4x64_epi64(_mm256_packus_epi32(i0, i1), _MM_SHUFFLE(3, 1, 2, 0)));
+                        _mm256_storeu_si256(words + 1, _mm256_permute4x64_epi64(_mm256_packus_epi32(i2, i3), _MM_SHUFFLE(3, 1, 2, 0)));
+                    } else {
+                        float* floats = reinterpret_cast<float*>(data);
+                        _mm256_storeu_ps(floats, p0);
+                        _mm256_storeu_ps(floats + 8, p1);
+                        _mm256_storeu_ps(floats + 16, p2);
+                        _mm256_storeu_ps(floats + 24, p3);
+                    }
+                }
+            }
+#endif
+
+            // ---- Normal RGBA8 ------------------------------------------------------------
+            // The most common case stays in 16-bit integers: dst = src * o + dst * (1 - sa * o),
+            // rounded through div255. Results are within one step of the float kernel.
+
+#if defined(AE_SIMD_SSE2)
+            // (x + 127) / 255 per 16-bit lane, for x <= 255 * 255
+            AE_FORCE_INLINE __m128i div255Epi16(__m128i x) {
+                x = _mm_add_epi16(x, _mm_set1_epi16(128));
+                return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+            }
+
+            // Two pixels widened to 16 bits
+            AE_FORCE_INLINE __m128i blendNormalWide(__m128i d, __m128i s, __m128i opacity) {
+                s = div255Epi16(_mm_mullo_epi16(s, opacity));
+                __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+                return _mm_add_epi16(s, div255Epi16(_mm_mullo_epi16(d, inverse)));
+            }
+
+            AE_FORCE_INLINE void blendNormal8x4(uint8_t* dst, const uint8_t* src, __m128i opacity) {
+                const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i alpha = _mm_and_si128(s, _mm_set1_epi32(static_cast<int>(0xFF000000u)));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, zero)) == 0xFFFF) {
+                    return;
+                }
+                const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst));
+                const __m128i lo = blendNormalWide(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(s, zero), opacity);
+                const __m128i hi = blendNormalWide(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(s, zero), opacity);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(lo, hi));
+            }
+#endif
+
+#if defined(AE_SIMD_AVX2)
+            AE_FORCE_INLINE __m256i div255Epi16(__m256i x) {
+                x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+                return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+            }
+
+            AE_FORCE_INLINE __m256i blendNormalWide(__m256i d, __m256i s, __m256i opacity) {
+                s = div255Epi16(_mm256_mullo_epi16(s, opacity));
+                __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                __m256i inverse = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+                return _mm256_add_epi16(s, div255Epi16(_mm256_mullo_epi16(d, inverse)));
+            }
+
+            AE_FORCE_INLINE void blendNormal8x8(uint8_t* dst, const uint8_t* src, __m256i opacity) {
+                const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+                if (_mm256_testz_si256(s, _mm256_set1_epi32(static_cast<int>(0xFF000000u)))) {
+                    return;
+                }
+                const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst));
+                const __m256i zero = _mm256_setzero_si256();
+                // Unpack and pack both work within 128-bit lanes, so the pixel order survives
+                const __m256i lo = blendNormalWide(_mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi8(s, zero), opacity);
+                const __m256i hi = blendNormalWide(_mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi8(s, zero), opacity);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_packus_epi16(lo, hi));
+            }
+#endif
+
+            // Blends `count` pixels a SIMD block at a time; the tail goes through a zeroed scratch
+            // block, where transparent source pixels leave the copied destination unchanged.
+            template <BlendMode M, PixelFormat F>
+            void blendPixelsSimd(uint8_t* dst, const uint8_t* src, uint32_t count, float opacity) {
+#if defined(AE_SIMD_AVX2)
+                constexpr uint32_t block = 8;
+#elif defined(AE_SIMD_SSE2)
+                constexpr uint32_t block = 4;
+#else
+                constexpr uint32_t block = 1;
+#endif
+                constexpr uint32_t bpp = getBytesPerPixel(F);
+
+                // Opacity is within (0, 1], so adding a half rounds; no library call reaches the AVX2 build
+                const int16_t opacity8 = static_cast<int16_t>(opacity * 255.0f + 0.5f);
+                auto blendBlock = [opacity, opacity8](uint8_t* d, const uint8_t* s) {
+#if defined(AE_SIMD_AVX2)
+                    if constexpr (M == BlendMode::Normal && F == PixelFormat::RGBA8) {
+                        blendNormal8x8(d, s, _mm256_set1_epi16(opacity8));
+                        return;
+                    }
+                    F8 sr, sg, sb, sa, dr, dg, db, da;
+                    load8<F>(s, sr, sg, sb, sa);
+                    if (_mm256_testz_ps(_mm256_cmp_ps(sa.v, _mm256_setzero_ps(), _CMP_GT_OQ),
+                                        _mm256_castsi256_ps(_mm256_set1_epi32(-1)))) {
+                        return;
+                    }
+                    load8<F>(d, dr, dg, db, da);
+                    const F8 o(opacity);
+                    blendPixel<M>(dr, dg, db, da, sr * o, sg * o, sb * o, sa * o);
+                    store8<F>(d, dr, dg, db, da);
+#elif defined(AE_SIMD_SSE2)
+                    if constexpr (M == BlendMode::Normal && F == PixelFormat::RGBA8) {
+                        blendNormal8x4(d, s, _mm_set1_epi16(opacity8));
+                        return;
+                    }
+                    F4 sr, sg, sb, sa, dr, dg, db, da;
+                    load4<F>(s, sr, sg, sb, sa);
+                    if (_mm_movemask_ps(_mm_cmpgt_ps(sa.v, _mm_setzero_ps())) == 0) {
+                        return;
+                    }
+                    load4<F>(d, dr, dg, db, da);
+                    const F4 o(opacity);
+                    blendPixel<M>(dr, dg, db, da, sr * o, sg * o, sb * o, sa * o);
+                    store4<F>(d, dr, dg, db, da);
+#else
+                    blendPixelsScalar<M, F>(d, s, 1, opacity);
+#endif
+                };
+
+                uint32_t i = 0;
+                for (; i + block <= count; i += block) {
+                    blendBlock(dst + i * bpp, src + i * bpp);
+                }
+                if (i < count) {
+                    uint8_t scratchDst[block * bpp] = {};
+                    uint8_t scratchSrc[block * bpp] = {};
+                    const size_t bytes = static_cast<size_t>(count - i) * bpp;
+                    std::memcpy(scratchDst, dst + i * bpp, bytes);
+                    std::memcpy(scratchSrc, src + i * bpp, bytes);
+                    blendBlock(scratchDst, scratchSrc);
+                    std::memcpy(dst + i * bpp, scratchDst, bytes);
+                }
+            }
+
+            using RowFunction = void (*)(uint8_t*, const uint8_t*, uint32_t, float);
+
+            // SIMD picks the vector or the scalar kernels at compile time, so a translation unit built
+            // for AVX2 instantiates nothing but its own lane
+            template <BlendMode M, PixelFormat F, bool SIMD>
+            RowFunction rowFunction() {
+                if constexpr (SIMD) {
+                    return &blendPixelsSimd<M, F>;
+                } else {
+                    return &blendPixelsScalar<M, F>;
+                }
+            }
+
+            template <BlendMode M, bool SIMD>
+            RowFunction selectFormat(PixelFormat format) {
+                switch (format) {
+                    case PixelFormat::RGBA8:   return rowFunction<M, PixelFormat::RGBA8, SIMD>();
+                    case PixelFormat::RGBA16:  return rowFunction<M, PixelFormat::RGBA16, SIMD>();
+                    case PixelFormat::RGBA32F: return rowFunction<M, PixelFormat::RGBA32F, SIMD>();
+                }
+                return nullptr;
+            }
+
+            template <bool SIMD>
+            RowFunction selectKernel(BlendMode mode, PixelFormat format) {
+                switch (mode) {
+                    case BlendMode::Normal:     return selectFormat<BlendMode::Normal, SIMD>(format);
+                    case BlendMode::Multiply:   return selectFormat<BlendMode::Multiply, SIMD>(format);
+                    case BlendMode::Screen:     return selectFormat<BlendMode::Screen, SIMD>(format);
+                    case BlendMode::Overlay:    return selectFormat<BlendMode::Overlay, SIMD>(format);
+                    case BlendMode::Darken:     return selectFormat<BlendMode::Darken, SIMD>(format);
+                    case BlendMode::Lighten:    return selectFormat<BlendMode::Lighten, SIMD>(format);
+                    case BlendMode::ColorDodge: return selectFormat<BlendMode::ColorDodge, SIMD>(format);
+                    case BlendMode::ColorBurn:  return selectFormat<BlendMode::ColorBurn, SIMD>(format);
+                    case BlendMode::HardLight:  return selectFormat<BlendMode::HardLight, SIMD>(format);
+                    case BlendMode::SoftLight:  return selectFormat<BlendMode::SoftLight, SIMD>(format);
+                    case BlendMode::Difference: return selectFormat<BlendMode::Difference, SIMD>(format);
+                    case BlendMode::Exclusion:  return selectFormat<BlendMode::Exclusion, SIMD>(format);
+                    case BlendMode::Hue:        return selectFormat<BlendMode::Hue, SIMD>(format);
+                    case BlendMode::Saturation: return selectFormat<BlendMode::Saturation, SIMD>(format);
+                    case BlendMode::Color:      return selectFormat<BlendMode::Color, SIMD>(format);
+                    case BlendMode::Luminosity: return selectFormat<BlendMode::Luminosity, SIMD>(format);
+                }
+                return nullptr;
+            }
+
+            // Clamps the opacity and runs the kernel; nothing to do for empty rows or zero opacity
+            template <bool SIMD>
+            void blendRowWith(BlendMode mode, PixelFormat format, void* dst, const void* src, uint32_t count, float opacity) {
+                opacity = opacity < 0.0f ? 0.0f : opacity > 1.0f ? 1.0f : opacity;
+                if (count == 0 || opacity <= 0.0f) {
+                    return;
+                }
+                RowFunction function = selectKernel<SIMD>(mode, format);
+                if (function) {
+                    function(static_cast<uint8_t*>(dst), static_cast<const uint8_t*>(src), count, opacity);
+                }
+            }
+        }
+
+#if defined(AE_SIMD_AVX2_DISPATCH)
+        namespace BlendKernels {
+            // blendRow with the 8-wide lane, from BlendKernelsAvx2.cpp; only when Simd::hasAvx2()
+            void blendRowAvx2(BlendMode mode, PixelFormat format, void* dst, const void* src, uint32_t count, float opacity);
+        }
+#endif
+    }
+}
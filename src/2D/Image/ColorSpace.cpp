@@ -0,0 +1,348 @@
+#include "2D/Image/ColorSpace.h"
+#include "2D/Image/Simd.h"
+#include "Core/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            // Tiles per job when converting whole images
+            constexpr size_t CONVERT_GRAIN = 16;
+            constexpr float INV_255 = 1.0f / 255.0f;
+            constexpr float INV_65535 = 1.0f / 65535.0f;
+
+            struct TransferTables {
+                float toLinear[256];
+                // Indexed by linear light quantized to 16 bits; padded so 32-bit gathers
+                // at the last index stay inside the table
+                uint8_t toSrgb[65536 + 4];
+            };
+
+            const TransferTables& getTables() {
+                static const TransferTables tables = [] {
+                    TransferTables t = {};
+                    for (uint32_t i = 0; i < 256; ++i) {
+                        t.toLinear[i] = ColorSpace::srgbToLinear(static_cast<float>(i) / 255.0f);
+                    }
+                    for (uint32_t i = 0; i < 65536; ++i) {
+                        t.toSrgb[i] = static_cast<uint8_t>(ColorSpace::linearToSrgb(static_cast<float>(i) / 65535.0f) * 255.0f + 0.5f);
+                    }
+                    return t;
+                }();
+                return tables;
+            }
+
+            inline float clamp01(float value) {
+                return std::min(std::max(value, 0.0f), 1.0f);
+            }
+
+            // Rounds to nearest even, matching _mm256_cvtps_epi32
+            inline int32_t roundToInt(float value) {
+                return static_cast<int32_t>(std::nearbyint(value));
+            }
+
+            // (x + 127) / 255 for x in [0, 255 * 255]
+            inline uint32_t div255(uint32_t x) {
+                x += 128;
+                return (x + (x >> 8)) >> 8;
+            }
+
+            template <PixelFormat F>
+            inline float loadChannel(const uint8_t* pixel, int channel) {
+                if constexpr (F == PixelFormat::RGBA16) {
+                    uint16_t value;
+                    std::memcpy(&value, pixel + channel * 2, 2);
+                    return static_cast<float>(value) * INV_65535;
+                } else {
+                    float value;
+                    std::memcpy(&value, pixel + channel * 4, 4);
+                    return value;
+                }
+            }
+
+            template <PixelFormat F>
+            inline void storeChannel(uint8_t* pixel, int channel, float value) {
+                if constexpr (F == PixelFormat::RGBA16) {
+                    const uint16_t stored = static_cast<uint16_t>(roundToInt(clamp01(value) * 65535.0f));
+                    std::memcpy(pixel + channel * 2, &stored, 2);
+                } else {
+                    std::memcpy(pixel + channel * 4, &value, 4);
+                }
+            }
+
+            // Linear RGBA16/RGBA32F -> sRGB RGBA8
+            template <PixelFormat F>
+            void encodePixelsScalar(const uint8_t* src, uint8_t* dst, uint32_t count) {
+                const TransferTables& tables = getTables();
+                constexpr uint32_t bpp = getBytesPerPixel(F);
+                for (uint32_t i = 0; i < count; ++i, src += bpp, dst += 4) {
+                    const float a = clamp01(loadChannel<F>(src, 3));
+                    const float inv = a > 0.0f ? 1.0f / a : 0.0f;
+                    const uint32_t a8 = static_cast<uint32_t>(roundToInt(a * 255.0f));
+                    for (int c = 0; c < 3; ++c) {
+                        const float straight = clamp01(loadChannel<F>(src, c) * inv);
+                        dst[c] = static_cast<uint8_t>(div255(tables.toSrgb[roundToInt(straight * 65535.0f)] * a8));
+                    }
+                    dst[3] = static_cast<uint8_t>(a8);
+                }
+            }
+
+            // sRGB RGBA8 -> linear RGBA16/RGBA32F
+            template <PixelFormat F>
+            void decodePixelsScalar(const uint8_t* src, uint8_t* dst, uint32_t count) {
+                const TransferTables& tables = getTables();
+                constexpr uint32_t bpp = getBytesPerPixel(F);
+                for (uint32_t i = 0; i < count; ++i, src += 4, dst += bpp) {
+                    const float alpha = static_cast<float>(src[3]);
+                    const float scale = src[3] > 0 ? 255.0f / alpha : 0.0f;
+                    const float a = alpha * INV_255;
+                    for (int c = 0; c < 3; ++c) {
+                        const int32_t straight = std::min(roundToInt(static_cast<float>(src[c]) * scale), 255);
+                        storeChannel<F>(dst, c, tables.toLinear[straight] * a);
+                    }
+                    storeChannel<F>(dst, 3, a);
+                }
+            }
+
+            // Between the two linear formats only the channel type changes
+            template <PixelFormat From, PixelFormat To>
+            void convertLinear(const uint8_t* src, uint8_t* dst, uint32_t count) {
+                for (uint32_t i = 0; i < count; ++i, src += getBytesPerPixel(From), dst += getBytesPerPixel(To)) {
+                    for (int c = 0; c < 4; ++c) {
+                        storeChannel<To>(dst, c, loadChannel<From>(src, c));
+                    }
+                }
+            }
+
+#if defined(AE_SIMD_AVX2_DISPATCH)
+            // Four registers of two pixels each (one per 128-bit lane) to planar R, G, B, A and
+            // back. Planes come out as pixels 0 2 4 6 | 1 3 5 7; the transform is its own inverse.
+            AE_FORCE_INLINE AE_TARGET_AVX2 void transpose(__m256& p0, __m256& p1, __m256& p2, __m256& p3) {
+                __m256 t0 = _mm256_unpacklo_ps(p0, p1);
+                __m256 t1 = _mm256_unpackhi_ps(p0, p1);
+                __m256 t2 = _mm256_unpacklo_ps(p2, p3);
+                __m256 t3 = _mm256_unpackhi_ps(p2, p3);
+                p0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+                p1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+                p2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+                p3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+            }
+
+            AE_FORCE_INLINE AE_TARGET_AVX2 void transposeBack(__m256& r, __m256& g, __m256& b, __m256& a) {
+                __m256 t0 = _mm256_unpacklo_ps(r, g);
+                __m256 t1 = _mm256_unpacklo_ps(b, a);
+                __m256 t2 = _mm256_unpackhi_ps(r, g);
+                __m256 t3 = _mm256_unpackhi_ps(b, a);
+                r = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+                g = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+                b = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+                a = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+            }
+
+            AE_FORCE_INLINE AE_TARGET_AVX2 __m256 clamp01(__m256 value) {
+                return _mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+            }
+
+            AE_FORCE_INLINE AE_TARGET_AVX2 __m256i div255(__m256i x) {
+                x = _mm256_add_epi32(x, _mm256_set1_epi32(128));
+                return _mm256_srli_epi32(_mm256_add_epi32(x, _mm256_srli_epi32(x, 8)), 8);
+            }
+
+            template <PixelFormat F>
+            AE_FORCE_INLINE AE_TARGET_AVX2 __m256 loadPair(const uint8_t* src) {
+                if constexpr (F == PixelFormat::RGBA16) {
+                    __m256i wide = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+                    return _mm256_mul_ps(_mm256_cvtepi32_ps(wide), _mm256_set1_ps(INV_65535));
+                } else {
+                    return _mm256_loadu_ps(reinterpret_cast<const float*>(src));
+                }
+            }
+
+            // One channel of 8 pixels: straight value -> sRGB byte from the table -> premultiplied by a8
+            AE_FORCE_INLINE AE_TARGET_AVX2 __m256i encodeChannel(const int* table, __m256 channel, __m256 inv, __m256i a8) {
+                __m256i index = _mm256_cvtps_epi32(_mm256_mul_ps(clamp01(_mm256_mul_ps(channel, inv)), _mm256_set1_ps(65535.0f)));
+                __m256i srgb = _mm256_and_si256(_mm256_i32gather_epi32(table, index, 1), _mm256_set1_epi32(0xFF));
+                return div255(_mm256_mullo_epi32(srgb, a8));
+            }
+
+            // One channel of 8 pixels: byte unpremultiplied by `scale` -> linear from the table -> times a
+            AE_FORCE_INLINE AE_TARGET_AVX2 __m256 decodeChannel(const float* table, __m256i channel, __m256 scale, __m256 a) {
+                __m256 value = _mm256_cvtepi32_ps(_mm256_and_si256(channel, _mm256_set1_epi32(0xFF)));
+                __m256i index = _mm256_min_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(value, scale)), _mm256_set1_epi32(255));
+                return _mm256_mul_ps(_mm256_i32gather_ps(table, index, 4), a);
+            }
+
+            // 8 pixels per step; the planar order is undone by the final permute
+            template <PixelFormat F>
+            AE_TARGET_AVX2 uint32_t encodePixelsAvx2(const uint8_t* src, uint8_t* dst, uint32_t count) {
+                const TransferTables& tables = getTables();
+                const int* table = reinterpret_cast<const int*>(tables.toSrgb);
+                constexpr uint32_t pairBytes = getBytesPerPixel(F) * 2;
+                const __m256 zero = _mm256_setzero_ps();
+                const __m256 one = _mm256_set1_ps(1.0f);
+                const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+                uint32_t i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    const uint8_t* p = src + static_cast<size_t>(i) * getBytesPerPixel(F);
+                    __m256 r = loadPair<F>(p);
+                    __m256 g = loadPair<F>(p + pairBytes);
+                    __m256 b = loadPair<F>(p + pairBytes * 2);
+                    __m256 a = loadPair<F>(p + pairBytes * 3);
+                    transpose(r, g, b, a);
+
+                    a = clamp01(a);
+                    __m256 inv = _mm256_and_ps(_mm256_div_ps(one, a), _mm256_cmp_ps(a, zero, _CMP_GT_OQ));
+                    __m256i a8 = _mm256_cvtps_epi32(_mm256_mul_ps(a, _mm256_set1_ps(255.0f)));
+
+                    __m256i packed = encodeChannel(table, r, inv, a8);
+                    packed = _mm256_or_si256(packed, _mm256_slli_epi32(encodeChannel(table, g, inv, a8), 8));
+                    packed = _mm256_or_si256(packed, _mm256_slli_epi32(encodeChannel(table, b, inv, a8), 16));
+                    packed = _mm256_or_si256(packed, _mm256_slli_epi32(a8, 24));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_permutevar8x32_epi32(packed, order));
+                }
+                return i;
+            }
+
+            template <PixelFormat F>
+            AE_TARGET_AVX2 uint32_t decodePixelsAvx2(const uint8_t* src, uint8_t* dst, uint32_t count) {
+                const TransferTables& tables = getTables();
+                constexpr uint32_t pairBytes = getBytesPerPixel(F) * 2;
+                const __m256 zero = _mm256_setzero_ps();
+                const __m256i order = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+                uint32_t i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    // Planar order up front so transposeBack() yields pixel pairs
+                    __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+                    pixels = _mm256_permutevar8x32_epi32(pixels, order);
+
+                    __m256 alpha = _mm256_cvtepi32_ps(_mm256_srli_epi32(pixels, 24));
+                    __m256 scale = _mm256_and_ps(_mm256_div_ps(_mm256_set1_ps(255.0f), alpha), _mm256_cmp_ps(alpha, zero, _CMP_GT_OQ));
+                    __m256 a = _mm256_mul_ps(alpha, _mm256_set1_ps(INV_255));
+
+                    __m256 r = decodeChannel(tables.toLinear, pixels, scale, a);
+                    __m256 g = decodeChannel(tables.toLinear, _mm256_srli_epi32(pixels, 8), scale, a);
+                    __m256 b = decodeChannel(tables.toLinear, _mm256_srli_epi32(pixels, 16), scale, a);
+                    transposeBack(r, g, b, a);
+
+                    uint8_t* out = dst + static_cast<size_t>(i) * getBytesPerPixel(F);
+                    if constexpr (F == PixelFormat::RGBA16) {
+                        const __m256 full = _mm256_set1_ps(65535.0f);
+                        __m256i p01 = _mm256_packus_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(r, full)), _mm256_cvtps_epi32(_mm256_mul_ps(g, full)));
+                        __m256i p23 = _mm256_packus_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(b, full)), _mm256_cvtps_epi32(_mm256_mul_ps(a, full)));
+                        // Packing is per lane: pixels 0 2 1 3 -> 0 1 2 3
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute4x64_epi64(p01, _MM_SHUFFLE(3, 1, 2, 0)));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), _mm256_permute4x64_epi64(p23, _MM_SHUFFLE(3, 1, 2, 0)));
+                    } else {
+                        _mm256_storeu_ps(reinterpret_cast<float*>(out), r);
+                        _mm256_storeu_ps(reinterpret_cast<float*>(out + pairBytes), g);
+                        _mm256_storeu_ps(reinterpret_cast<float*>(out + pairBytes * 2), b);
+                        _mm256_storeu_ps(reinterpret_cast<float*>(out + pairBytes * 3), a);
+                    }
+                }
+                return i;
+            }
+#endif
+
+            template <PixelFormat F>
+            void encodePixels(const uint8_t* src, uint8_t* dst, uint32_t count) {
+                uint32_t i = 0;
+#if defined(AE_SIMD_AVX2_DISPATCH)
+                if (Simd::hasAvx2()) {
+                    i = encodePixelsAvx2<F>(src, dst, count);
+                }
+#endif
+                encodePixelsScalar<F>(src + static_cast<size_t>(i) * getBytesPerPixel(F), dst + i * 4, count - i);
+            }
+
+            template <PixelFormat F>
+            void decodePixels(const uint8_t* src, uint8_t* dst, uint32_t count) {
+                uint32_t i = 0;
+#if defined(AE_SIMD_AVX2_DISPATCH)
+                if (Simd::hasAvx2()) {
+                    i = decodePixelsAvx2<F>(src, dst, count);
+                }
+#endif
+                decodePixelsScalar<F>(src + i * 4, dst + static_cast<size_t>(i) * getBytesPerPixel(F), count - i);
+            }
+
+            void convert(PixelFormat srcFormat, PixelFormat dstFormat, const uint8_t* src, uint8_t* dst,
+                         uint32_t count, bool simd) {
+                if (srcFormat == dstFormat) {
+                    std::memcpy(dst, src, static_cast<size_t>(count) * getBytesPerPixel(srcFormat));
+                    return;
+                }
+                switch (srcFormat) {
+                    case PixelFormat::RGBA8:
+                        if (dstFormat == PixelFormat::RGBA16) {
+                            simd ? decodePixels<PixelFormat::RGBA16>(src, dst, count) : decodePixelsScalar<PixelFormat::RGBA16>(src, dst, count);
+                        } else {
+                            simd ? decodePixels<PixelFormat::RGBA32F>(src, dst, count) : decodePixelsScalar<PixelFormat::RGBA32F>(src, dst, count);
+                        }
+                        break;
+                    case PixelFormat::RGBA16:
+                        if (dstFormat == PixelFormat::RGBA8) {
+                            simd ? encodePixels<PixelFormat::RGBA16>(src, dst, count) : encodePixelsScalar<PixelFormat::RGBA16>(src, dst, count);
+                        } else {
+                            convertLinear<PixelFormat::RGBA16, PixelFormat::RGBA32F>(src, dst, count);
+                        }
+                        break;
+                    case PixelFormat::RGBA32F:
+                        if (dstFormat == PixelFormat::RGBA8) {
+                            simd ? encodePixels<PixelFormat::RGBA32F>(src, dst, count) : encodePixelsScalar<PixelFormat::RGBA32F>(src, dst, count);
+                        } else {
+                            convertLinear<PixelFormat::RGBA32F, PixelFormat::RGBA16>(src, dst, count);
+                        }
+                        break;
+                }
+            }
+        }
+
+        namespace ColorSpace {
+            float srgbToLinear(float value) {
+                return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+            }
+
+            float linearToSrgb(float value) {
+                return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+            }
+
+            void convertRow(PixelFormat srcFormat, PixelFormat dstFormat, const void* src, void* dst, uint32_t count) {
+                convert(srcFormat, dstFormat, static_cast<const uint8_t*>(src), static_cast<uint8_t*>(dst), count, true);
+            }
+
+            void convertRowScalar(PixelFormat srcFormat, PixelFormat dstFormat, const void* src, void* dst, uint32_t count) {
+                convert(srcFormat, dstFormat, static_cast<const uint8_t*>(src), static_cast<uint8_t*>(dst), count, false);
+            }
+
+            std::shared_ptr<TiledImage> convertImage(const TiledImage& image, PixelFormat format) {
+                auto result = std::make_shared<TiledImage>(image.getWidth(), image.getHeight(), format);
+                if (format == image.getFormat()) {
+                    *result = image;
+                    return result;
+                }
+
+                const uint32_t tilesX = image.getTilesX();
+                Jobs::JobSystem::getInstance().parallelFor(image.getTileCount(), [&](size_t index) {
+                    const uint32_t tx = static_cast<uint32_t>(index) % tilesX;
+                    const uint32_t ty = static_cast<uint32_t>(index) / tilesX;
+                    const Tile* tile = image.getTile(tx, ty);
+                    if (!tile) {
+                        return;
+                    }
+                    if (tile->isUniform()) {
+                        uint8_t pixel[16];
+                        convertRowScalar(image.getFormat(), format, tile->getUniformPixel(), pixel, 1);
+                        result->fillTile(tx, ty, pixel);
+                        return;
+                    }
+                    convertRow(image.getFormat(), format, tile->getData(), result->getTileForWrite(tx, ty).getData(), TILE_PIXELS);
+                }, CONVERT_GRAIN);
+                return result;
+            }
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "2D/Image/TiledImage.h"
+#include <cstdint>
+#include <memory>
+
+namespace AstralEngine {
+    namespace D2 {
+        /**
+         * @brief sRGB / linear-light conversions between pixel formats
+         *
+         * RGBA8 documents store sRGB-encoded values and blend in that space, as 8-bit
+         * editors traditionally do. RGBA16 and RGBA32F store linear light, so blending,
+         * filtering and mip reduction there are physically correct and gradients do not band.
+         *
+         * Pixels stay premultiplied across a conversion: color is unpremultiplied, re-encoded
+         * and multiplied by alpha again. The transfer curves are table driven, a 256-entry
+         * table towards linear and a 65536-entry one towards sRGB, and rows are converted
+         * 8 pixels at a time with table gathers on CPUs with AVX2, picked at runtime. SSE2
+         * has no gathers, so other CPUs run the same arithmetic per pixel, with identical
+         * results.
+         */
+        namespace ColorSpace {
+            // Whether a format holds linear light rather than sRGB-encoded values
+            constexpr bool isLinear(PixelFormat format) {
+                return format != PixelFormat::RGBA8;
+            }
+
+            // Exact transfer functions on straight (non-premultiplied) values in [0, 1]
+            float srgbToLinear(float value);
+            float linearToSrgb(float value);
+
+            // Converts `count` premultiplied pixels, re-encoding when the formats' spaces differ
+            void convertRow(PixelFormat srcFormat, PixelFormat dstFormat, const void* src, void* dst, uint32_t count);
+
+            // Same result one pixel at a time without SIMD
+            void convertRowScalar(PixelFormat srcFormat, PixelFormat dstFormat, const void* src, void* dst, uint32_t count);
+
+            // Converts every tile; missing and uniform tiles stay sparse
+            std::shared_ptr<TiledImage> convertImage(const TiledImage& image, PixelFormat format);
+        }
+    }
+}
@@ -0,0 +1,161 @@
+#include "2D/Image/DabMaskCache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            constexpr float PI = 3.14159265358979f;
+            constexpr float ANGLE_STEP = PI / 180.0f;
+            constexpr float SHAPE_STEPS = 64.0f; // Hardness and roundness levels
+
+            // Quarter pixels up to 32 pixels across, then a step that doubles every octave;
+            // sub-pixel dabs fade by area and get finer steps
+            float quantizeDiameter(float diameter) {
+                if (!(diameter > 0.0f)) {
+                    return 0.0f;
+                }
+                float step = 0.25f;
+                if (diameter < 1.0f) {
+                    step = 1.0f / 32.0f;
+                } else if (diameter >= 32.0f) {
+                    int exponent;
+                    std::frexp(diameter / 32.0f, &exponent);
+                    step = std::ldexp(0.25f, exponent - 1);
+                }
+                return std::round(diameter / step) * step;
+            }
+
+            inline void hashCombine(size_t& seed, uint32_t value) {
+                seed ^= std::hash<uint32_t>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            }
+
+            inline uint32_t floatBits(float value) {
+                uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                return bits;
+            }
+        }
+
+        Dab DabMaskCache::quantize(const Dab& dab) {
+            Dab snapped = dab;
+            const float steps = static_cast<float>(SUBPIXEL_STEPS);
+            snapped.center.x = std::round(dab.center.x * steps) / steps;
+            snapped.center.y = std::round(dab.center.y * steps) / steps;
+            snapped.radius = quantizeDiameter(dab.radius * 2.0f) * 0.5f;
+            snapped.hardness = std::round(std::clamp(dab.hardness, 0.0f, 1.0f) * SHAPE_STEPS) / SHAPE_STEPS;
+            snapped.roundness = std::max(std::round(std::clamp(dab.roundness, 0.0f, 1.0f) * SHAPE_STEPS), 1.0f) / SHAPE_STEPS;
+
+            // A circle has no direction, and square and elliptic footprints repeat every quarter and half turn
+            if (snapped.roundness >= 1.0f && dab.shape == DabShape::Round) {
+                snapped.angle = 0.0f;
+            } else {
+                const float period = snapped.roundness >= 1.0f ? PI * 0.5f : PI;
+                float angle = std::fmod(dab.angle, period);
+                if (angle < 0.0f) {
+                    angle += period;
+                }
+                const long index = std::lround(angle / ANGLE_STEP);
+                snapped.angle = static_cast<float>(index) * ANGLE_STEP < period ? static_cast<float>(index) * ANGLE_STEP : 0.0f;
+            }
+            return snapped;
+        }
+
+        size_t DabMaskCache::KeyHash::operator()(const Key& key) const {
+            size_t seed = 0;
+            hashCombine(seed, floatBits(key.diameter));
+            hashCombine(seed, floatBits(key.hardness));
+            hashCombine(seed, floatBits(key.roundness));
+            hashCombine(seed, floatBits(key.angle));
+            hashCombine(seed, (static_cast<uint32_t>(key.phaseX) << 16) | (static_cast<uint32_t>(key.phaseY) << 8) |
+                              static_cast<uint32_t>(key.shape));
+            return seed;
+        }
+
+        std::shared_ptr<const DabMask> DabMaskCache::getMask(const Dab& dab) {
+            const Dab snapped = quantize(dab);
+            const float steps = static_cast<float>(SUBPIXEL_STEPS);
+            Key key;
+            key.diameter = snapped.radius * 2.0f;
+            key.hardness = snapped.hardness;
+            key.roundness = snapped.roundness;
+            key.angle = snapped.angle;
+            key.phaseX = static_cast<uint8_t>((snapped.center.x - std::floor(snapped.center.x)) * steps);
+            key.phaseY = static_cast<uint8_t>((snapped.center.y - std::floor(snapped.center.y)) * steps);
+            key.shape = snapped.shape;
+
+            auto found = m_index.find(key);
+            if (found != m_index.end()) {
+                ++m_hits;
+                m_entries.splice(m_entries.begin(), m_entries, found->second);
+                return found->second->mask;
+            }
+
+            ++m_misses;
+            std::shared_ptr<const DabMask> mask = generate(snapped);
+            const size_t size = mask->getMemorySize();
+            if (size <= m_memoryLimit) {
+                m_entries.push_front({key, mask});
+                m_index.emplace(key, m_entries.begin());
+                m_memoryUsage += size;
+                evict();
+            }
+            return mask;
+        }
+
+        std::shared_ptr<DabMask> DabMaskCache::generate(const Dab& dab) {
+            // The same dab at unit opacity, moved to the pixel holding its center
+            Dab unit = dab;
+            unit.center = {dab.center.x - std::floor(dab.center.x), dab.center.y - std::floor(dab.center.y)};
+            unit.opacity = 1.0f;
+            unit.color = {0.0f, 0.0f, 0.0f, 1.0f};
+            unit.blend = DabBlend::Paint;
+
+            auto mask = std::make_shared<DabMask>();
+            const glm::vec2 reach = DabRasterizer::getReach(unit);
+            mask->x0 = static_cast<int32_t>(std::floor(unit.center.x - reach.x));
+            mask->y0 = static_cast<int32_t>(std::floor(unit.center.y - reach.y));
+            mask->width = static_cast<uint32_t>(static_cast<int32_t>(std::ceil(unit.center.x + reach.x)) - mask->x0);
+            mask->height = static_cast<uint32_t>(static_cast<int32_t>(std::ceil(unit.center.y + reach.y)) - mask->y0);
+            mask->coverage.resize(static_cast<size_t>(mask->width) * mask->height);
+            mask->spans.resize(mask->height);
+
+            for (uint32_t y = 0; y < mask->height; ++y) {
+                uint8_t* row = mask->coverage.data() + static_cast<size_t>(y) * mask->width;
+                DabRasterizer::computeCoverageRow(unit, mask->x0, mask->y0 + static_cast<int32_t>(y), mask->width, row);
+                // Trimmed to the covered pixels, so stamping skips the empty corners
+                uint32_t begin = 0, end = mask->width;
+                while (begin < end && row[begin] == 0) {
+                    ++begin;
+                }
+                while (end > begin && row[end - 1] == 0) {
+                    --end;
+                }
+                mask->spans[y] = {begin, end};
+            }
+            return mask;
+        }
+
+        void DabMaskCache::setMemoryLimit(size_t bytes) {
+            m_memoryLimit = bytes;
+            evict();
+        }
+
+        void DabMaskCache::clear() {
+            m_entries.clear();
+            m_index.clear();
+            m_memoryUsage = 0;
+        }
+
+        void DabMaskCache::evict() {
+            while (m_memoryUsage > m_memoryLimit && !m_entries.empty()) {
+                const Entry& oldest = m_entries.back();
+                m_memoryUsage -= oldest.mask->getMemorySize();
+                m_index.erase(oldest.key);
+                m_entries.pop_back();
+            }
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "2D/Image/DabRasterizer.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        // Unit-opacity coverage of one dab footprint
+        struct DabMask {
+            // Pixels covered by a row, [begin, end) in mask columns; empty rows have begin == end
+            struct Span {
+                uint32_t begin = 0, end = 0;
+            };
+
+            int32_t x0 = 0, y0 = 0; // Offset of mask pixel (0, 0) from the whole pixel holding the dab center
+            uint32_t width = 0, height = 0;
+            std::vector<uint8_t> coverage; // width * height, 0-255
+            std::vector<Span> spans;       // One per row
+
+            size_t getMemorySize() const { return sizeof(DabMask) + coverage.size() + spans.size() * sizeof(Span); }
+        };
+
+        /**
+         * @brief Least recently used cache of dab coverage masks
+         *
+         * A stroke stamps the same footprint over and over, and evaluating the falloff per
+         * pixel dominates the cost of large soft dabs. Dabs are snapped onto a grid first:
+         * the center to 1/SUBPIXEL_STEPS of a pixel, the diameter to quarter pixels (halving
+         * the step every octave past 32 pixels, so the error stays below 1%), hardness and
+         * roundness to 1/64 and the angle to whole degrees. Each grid point is a mask,
+         * generated on first use and evicted least recently used first once the masks
+         * outgrow the memory limit.
+         *
+         * Masks are immutable and shared, so one handed out stays valid after eviction.
+         * The cache itself is not synchronized; each painting thread keeps its own.
+         */
+        class DabMaskCache {
+        public:
+            static constexpr size_t DEFAULT_MEMORY_LIMIT = size_t(32) << 20;
+            static constexpr uint32_t SUBPIXEL_STEPS = 4;
+
+            explicit DabMaskCache(size_t memoryLimit = DEFAULT_MEMORY_LIMIT) : m_memoryLimit(memoryLimit) {}
+
+            DabMaskCache(const DabMaskCache&) = delete;
+            DabMaskCache& operator=(const DabMaskCache&) = delete;
+
+            // `dab` with its center and footprint parameters snapped to the grid masks are cached on
+            static Dab quantize(const Dab& dab);
+
+            // Mask of quantize(`dab`), generated on a miss; masks larger than the limit are not kept
+            std::shared_ptr<const DabMask> getMask(const Dab& dab);
+
+            // Lowering the limit evicts right away
+            void setMemoryLimit(size_t bytes);
+            size_t getMemoryLimit() const { return m_memoryLimit; }
+            size_t getMemoryUsage() const { return m_memoryUsage; }
+            size_t getMaskCount() const { return m_entries.size(); }
+            uint64_t getHits() const { return m_hits; }
+            uint64_t getMisses() const { return m_misses; }
+
+            void clear();
+
+        private:
+            struct Key {
+                float diameter, hardness, roundness, angle;
+                uint8_t phaseX, phaseY;
+                DabShape shape;
+
+                bool operator==(const Key& other) const {
+                    return diameter == other.diameter && hardness == other.hardness && roundness == other.roundness &&
+                           angle == other.angle && phaseX == other.phaseX && phaseY == other.phaseY && shape == other.shape;
+                }
+            };
+
+            struct KeyHash {
+                size_t operator()(const Key& key) const;
+            };
+
+            struct Entry {
+                Key key;
+                std::shared_ptr<const DabMask> mask;
+            };
+
+            static std::shared_ptr<DabMask> generate(const Dab& dab);
+            void evict();
+
+            std::list<Entry> m_entries; // Most recently used first
+            std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_index;
+            size_t m_memoryLimit;
+            size_t m_memoryUsage = 0;
+            uint64_t m_hits = 0;
+            uint64_t m_misses = 0;
+        };
+    }
+}
@@ -0,0 +1,628 @@
+#include "2D/Image/DabRasterizer.h"
+#include "2D/Image/ColorSpace.h"
+#include "2D/Image/DabMaskCache.h"
+#include "2D/Image/MaskOps.h"
+#include "2D/Image/Simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            // Per-dab constants shared by the coverage kernels
+            struct CoverageParams {
+                float cx, cy;
+                float edge;       // Radius + half a pixel: where anti-aliased coverage reaches zero
+                float inner;      // Radius up to which the falloff is 1
+                float invFalloff; // 1 / (radius - inner), 0 for hard dabs
+                float strength;   // Opacity scaled to 0-255
+                bool square;
+                // Squashed or rotated footprints are measured in the brush's own axes
+                bool oriented;
+                float cosAngle, sinAngle;
+                float invRoundness;
+                float minorEdge;  // Minor radius + half a pixel
+            };
+
+            CoverageParams makeParams(const Dab& dab) {
+                CoverageParams params;
+                // Dabs narrower than a pixel keep a one pixel footprint and fade out by area instead
+                float radius = std::max(dab.radius, 0.5f);
+                float areaScale = dab.radius < 0.5f ? (dab.radius * dab.radius) / 0.25f : 1.0f;
+                float hardness = std::clamp(dab.hardness, 0.0f, 1.0f);
+                float alpha = dab.blend == DabBlend::Paint ? dab.color.a : 1.0f;
+
+                params.cx = dab.center.x;
+                params.cy = dab.center.y;
+                params.edge = radius + 0.5f;
+                params.inner = radius * hardness;
+                params.invFalloff = hardness < 1.0f ? 1.0f / (radius - params.inner) : 0.0f;
+                params.strength = std::clamp(dab.opacity * alpha, 0.0f, 1.0f) * areaScale * 255.0f;
+                params.square = dab.shape == DabShape::Square;
+                
+                const float roundness = std::clamp(dab.roundness, 0.01f, 1.0f);
+                params.oriented = roundness < 1.0f || (dab.angle != 0.0f && params.square);
+                params.cosAngle = std::cos(dab.angle);
+                params.sinAngle = std::sin(dab.angle);
+                params.invRoundness = 1.0f / roundness;
+                params.minorEdge = radius * roundness + 0.5f;
+                return params;
+            }
+
+            inline uint8_t coverageScalar(const CoverageParams& p, float dx, float dy) {
+                float distance, edge;
+                if (p.oriented) {
+                    const float u = dx * p.cosAngle + dy * p.sinAngle;
+                    const float v = dy * p.cosAngle - dx * p.sinAngle;
+                    if (p.square) {
+                        const float au = std::fabs(u), av = std::fabs(v);
+                        distance = std::max(au, av * p.invRoundness);
+                        edge = std::clamp(p.edge - au, 0.0f, 1.0f) * std::clamp(p.minorEdge - av, 0.0f, 1.0f);
+                    } else {
+                        // Distance to the ellipse, to first order: its level set over the gradient length
+                        const float stretched = v * p.invRoundness;
+                        distance = std::sqrt(u * u + stretched * stretched);
+                        const float gradient = distance > 0.0f
+                            ? std::sqrt(u * u + stretched * stretched * p.invRoundness * p.invRoundness) / distance : 1.0f;
+                        edge = std::clamp(0.5f - (distance - (p.edge - 0.5f)) / gradient, 0.0f, 1.0f);
+                    }
+                } else if (p.square) {
+                    float ax = std::fabs(dx), ay = std::fabs(dy);
+                    distance = std::max(ax, ay);
+                    edge = std::clamp(p.edge - ax, 0.0f, 1.0f) * std::clamp(p.edge - ay, 0.0f, 1.0f);
+                } else {
+                    distance = std::sqrt(dx * dx + dy * dy);
+                    edge = std::clamp(p.edge - distance, 0.0f, 1.0f);
+                }
+                float t = std::clamp((distance - p.inner) * p.invFalloff, 0.0f, 1.0f);
+                float falloff = 1.0f - t * t * (3.0f - 2.0f * t);
+                return static_cast<uint8_t>(edge * falloff * p.strength + 0.5f);
+            }
+
+            // (x + 127) / 255 for x in [0, 255 * 255]
+            inline uint32_t div255(uint32_t x) {
+                x += 128;
+                return (x + (x >> 8)) >> 8;
+            }
+
+            struct RowSpan {
+                int32_t begin, end;
+            };
+
+            // out = coverage * strength / 65536, rounded; strength in [0, 65536]
+            void scaleCoverageRow(const uint8_t* coverage, uint32_t count, uint32_t strength, uint8_t* out) {
+                if (strength >= 65536) {
+                    std::memcpy(out, coverage, count);
+                    return;
+                }
+                uint32_t i = 0;
+#if defined(AE_SIMD_SSE2)
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i scale = _mm_set1_epi16(static_cast<int16_t>(static_cast<uint16_t>(strength)));
+                // High half of the 32-bit product, plus the bit below it for rounding
+                auto scale8 = [&](__m128i c) {
+                    const __m128i high = _mm_mulhi_epu16(c, scale);
+                    const __m128i low = _mm_mullo_epi16(c, scale);
+                    return _mm_add_epi16(high, _mm_srli_epi16(low, 15));
+                };
+                for (; i + 16 <= count; i += 16) {
+                    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coverage + i));
+                    const __m128i low = scale8(_mm_unpacklo_epi8(c, zero));
+                    const __m128i high = scale8(_mm_unpackhi_epi8(c, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(low, high));
+                }
+#endif
+                for (; i < count; ++i) {
+                    out[i] = static_cast<uint8_t>((coverage[i] * strength + 32768) >> 16);
+                }
+            }
+
+#if defined(AE_SIMD_SSE2)
+            // Two RGBA8 pixels in 16-bit lanes, a coverage per channel. 255 * d + (s - d) * a wraps in
+            // 16 bits on the way but ends within 0-65025, and the high half of (x + 128) * 257 is div255(x).
+            AE_FORCE_INLINE __m128i blendPixels2(__m128i d, __m128i a, __m128i source) {
+                __m128i x = _mm_sub_epi16(_mm_slli_epi16(d, 8), d);
+                x = _mm_add_epi16(x, _mm_mullo_epi16(_mm_sub_epi16(source, d), a));
+                return _mm_mulhi_epu16(_mm_add_epi16(x, _mm_set1_epi16(128)), _mm_set1_epi16(257));
+            }
+
+            // Up to four pixels packed in `pixels`, their coverage bytes in the low lanes of `a8`
+            AE_FORCE_INLINE __m128i blendPixels4(__m128i pixels, __m128i a8, __m128i source) {
+                const __m128i zero = _mm_setzero_si128();
+                a8 = _mm_unpacklo_epi8(a8, a8);
+                a8 = _mm_unpacklo_epi16(a8, a8);
+                return _mm_packus_epi16(blendPixels2(_mm_unpacklo_epi8(pixels, zero), _mm_unpacklo_epi8(a8, zero), source),
+                                        blendPixels2(_mm_unpackhi_epi8(pixels, zero), _mm_unpackhi_epi8(a8, zero), source));
+            }
+
+            AE_FORCE_INLINE void blendPixels8(uint8_t* dst, const uint8_t* coverage, __m128i source) {
+                uint64_t packedCoverage;
+                std::memcpy(&packedCoverage, coverage, 8);
+                if (packedCoverage == 0) {
+                    return;
+                }
+                const __m128i a8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(coverage));
+                __m128i* out = reinterpret_cast<__m128i*>(dst);
+                _mm_storeu_si128(out, blendPixels4(_mm_loadu_si128(out), a8, source));
+                _mm_storeu_si128(out + 1, blendPixels4(_mm_loadu_si128(out + 1), _mm_srli_si128(a8, 4), source));
+            }
+
+            // The last `count` < 8 pixels of a row, four, two and one at a time
+            AE_FORCE_INLINE void blendPixelsTail(uint8_t* dst, const uint8_t* coverage, uint32_t count, __m128i source) {
+                if (count & 4) {
+                    uint32_t packedCoverage;
+                    std::memcpy(&packedCoverage, coverage, 4);
+                    __m128i* out = reinterpret_cast<__m128i*>(dst);
+                    _mm_storeu_si128(out, blendPixels4(_mm_loadu_si128(out), _mm_cvtsi32_si128(static_cast<int>(packedCoverage)), source));
+                    dst += 16;
+                    coverage += 4;
+                }
+                if (count & 2) {
+                    uint16_t packedCoverage;
+                    std::memcpy(&packedCoverage, coverage, 2);
+                    const __m128i pixels = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(dst));
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), blendPixels4(pixels, _mm_cvtsi32_si128(packedCoverage), source));
+                    dst += 8;
+                    coverage += 2;
+                }
+                if (count & 1) {
+                    int32_t pixel;
+                    std::memcpy(&pixel, dst, 4);
+                    pixel = _mm_cvtsi128_si32(blendPixels4(_mm_cvtsi32_si128(pixel), _mm_cvtsi32_si128(coverage[0]), source));
+                    std::memcpy(dst, &pixel, 4);
+                }
+            }
+#endif
+
+            // Linear formats lerp in float; RGBA16 keeps its 0-65535 range to skip rescaling
+            template <PixelFormat F>
+            void blendPixelsLinear(uint8_t* dst, const uint8_t* coverage, uint32_t count, const float color[4]) {
+                constexpr float scale = F == PixelFormat::RGBA16 ? 65535.0f : 1.0f;
+                constexpr float inv255 = 1.0f / 255.0f;
+                const float source[4] = {color[0] * scale, color[1] * scale, color[2] * scale, color[3] * scale};
+
+#if defined(AE_SIMD_SSE2)
+                const __m128 vsource = _mm_loadu_ps(source);
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i bias = _mm_set1_epi32(32768);
+                const __m128i flip = _mm_set1_epi16(static_cast<int16_t>(0x8000));
+                for (uint32_t i = 0; i < count; ++i) {
+                    if (coverage[i] == 0) {
+                        continue;
+                    }
+                    const __m128 t = _mm_set1_ps(static_cast<float>(coverage[i]) * inv255);
+                    if constexpr (F == PixelFormat::RGBA16) {
+                        uint8_t* pixel = dst + static_cast<size_t>(i) * 8;
+                        __m128 d = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pixel)), zero));
+                        d = _mm_add_ps(d, _mm_mul_ps(_mm_sub_ps(vsource, d), t));
+                        // The lerp stays within 0-65535, so a signed pack around 32768 is exact
+                        __m128i result = _mm_sub_epi32(_mm_cvtps_epi32(d), bias);
+                        result = _mm_xor_si128(_mm_packs_epi32(result, result), flip);
+                        _mm_storel_epi64(reinterpret_cast<__m128i*>(pixel), result);
+                    } else {
+                        float* pixel = reinterpret_cast<float*>(dst + static_cast<size_t>(i) * 16);
+                        __m128 d = _mm_loadu_ps(pixel);
+                        _mm_storeu_ps(pixel, _mm_add_ps(d, _mm_mul_ps(_mm_sub_ps(vsource, d), t)));
+                    }
+                }
+#else
+                for (uint32_t i = 0; i < count; ++i) {
+                    if (coverage[i] == 0) {
+                        continue;
+                    }
+                    const float t = static_cast<float>(coverage[i]) * inv255;
+                    if constexpr (F == PixelFormat::RGBA16) {
+                        uint16_t pixel[4];
+                        std::memcpy(pixel, dst + static_cast<size_t>(i) * 8, 8);
+                        for (int c = 0; c < 4; ++c) {
+                            const float d = static_cast<float>(pixel[c]);
+                            pixel[c] = static_cast<uint16_t>(std::clamp(d + (source[c] - d) * t, 0.0f, 65535.0f) + 0.5f);
+                        }
+                        std::memcpy(dst + static_cast<size_t>(i) * 8, pixel, 8);
+                    } else {
+                        float pixel[4];
+                        std::memcpy(pixel, dst + static_cast<size_t>(i) * 16, 16);
+                        for (int c = 0; c < 4; ++c) {
+                            pixel[c] += (source[c] - pixel[c]) * t;
+                        }
+                        std::memcpy(dst + static_cast<size_t>(i) * 16, pixel, 16);
+                    }
+                }
+#endif
+            }
+
+#if defined(AE_SIMD_AVX2_DISPATCH)
+            AE_FORCE_INLINE AE_TARGET_AVX2 __m256 clamp01Avx2(__m256 x) {
+                return _mm256_min_ps(_mm256_max_ps(x, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+            }
+
+            // Upright footprints, 8 pixels per step; the tail goes through a scratch block
+            AE_TARGET_AVX2 void coverageRowAvx2(const CoverageParams& p, float dx0, float dy, uint32_t count, uint8_t* coverage) {
+                const __m256 one = _mm256_set1_ps(1.0f);
+                const __m256 three = _mm256_set1_ps(3.0f);
+                const __m256 two = _mm256_set1_ps(2.0f);
+                const __m256 half = _mm256_set1_ps(0.5f);
+                const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+                const __m256 edgeRadius = _mm256_set1_ps(p.edge);
+                const __m256 inner = _mm256_set1_ps(p.inner);
+                const __m256 invFalloff = _mm256_set1_ps(p.invFalloff);
+                const __m256 strength = _mm256_set1_ps(p.strength);
+                const __m256 vdy = _mm256_set1_ps(dy);
+                const __m256 ady = _mm256_and_ps(vdy, absMask);
+                const __m256 dy2 = _mm256_mul_ps(vdy, vdy);
+                const __m256 edgeY = clamp01Avx2(_mm256_sub_ps(edgeRadius, ady));
+                const __m256 origin = _mm256_set1_ps(dx0);
+                const __m256 lanes = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+
+                for (uint32_t i = 0; i < count; i += 8) {
+                    // dx0 + index rounds once, like the SSE2 and scalar paths
+                    const __m256 vdx = _mm256_add_ps(origin, _mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), lanes));
+                    __m256 distance, edge;
+                    if (p.square) {
+                        __m256 adx = _mm256_and_ps(vdx, absMask);
+                        distance = _mm256_max_ps(adx, ady);
+                        edge = _mm256_mul_ps(clamp01Avx2(_mm256_sub_ps(edgeRadius, adx)), edgeY);
+                    } else {
+                        distance = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(vdx, vdx), dy2));
+                        edge = clamp01Avx2(_mm256_sub_ps(edgeRadius, distance));
+                    }
+                    __m256 t = clamp01Avx2(_mm256_mul_ps(_mm256_sub_ps(distance, inner), invFalloff));
+                    __m256 falloff = _mm256_sub_ps(one, _mm256_mul_ps(_mm256_mul_ps(t, t), _mm256_sub_ps(three, _mm256_mul_ps(two, t))));
+                    __m256 value = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(edge, falloff), strength), half);
+                    __m256i ints = _mm256_cvttps_epi32(value);
+                    __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(ints), _mm256_extracti128_si256(ints, 1));
+                    __m128i bytes = _mm_packus_epi16(words, words);
+                    if (i + 8 <= count) {
+                        _mm_storel_epi64(reinterpret_cast<__m128i*>(coverage + i), bytes);
+                    } else {
+                        uint8_t tail[8];
+                        _mm_storel_epi64(reinterpret_cast<__m128i*>(tail), bytes);
+                        std::memcpy(coverage + i, tail, count - i);
+                    }
+                }
+            }
+
+            // Four premultiplied pixels per 16-bit lane group, same arithmetic as the SSE2 path
+            AE_FORCE_INLINE AE_TARGET_AVX2 __m256i blendPixels4Avx2(__m256i d, __m256i a, __m256i source) {
+                __m256i x = _mm256_sub_epi16(_mm256_slli_epi16(d, 8), d);
+                x = _mm256_add_epi16(x, _mm256_mullo_epi16(_mm256_sub_epi16(source, d), a));
+                return _mm256_mulhi_epu16(_mm256_add_epi16(x, _mm256_set1_epi16(128)), _mm256_set1_epi16(257));
+            }
+
+            // 16 pixels per step, then the SSE2 steps for the rest of the row
+            AE_TARGET_AVX2 void blendRowAvx2(uint8_t* dst, const uint8_t* coverage, uint32_t count, const uint8_t color[4]) {
+                const __m256i source = _mm256_setr_epi16(color[0], color[1], color[2], color[3], color[0], color[1], color[2], color[3],
+                                                         color[0], color[1], color[2], color[3], color[0], color[1], color[2], color[3]);
+                const __m256i zero = _mm256_setzero_si256();
+                // Each coverage byte is repeated for the four channels of its pixel, per 128-bit lane
+                const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                                        4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7);
+
+                uint32_t i = 0;
+                for (; i + 16 <= count; i += 16) {
+                    const __m128i a16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coverage + i));
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi8(a16, _mm_setzero_si128())) == 0xFFFF) {
+                        continue;
+                    }
+                    // Pixels 0-3 | 4-7 and 8-11 | 12-15, each byte of coverage spread over a pixel
+                    const __m256i a0 = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(a16), spread);
+                    const __m256i a1 = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_srli_si128(a16, 8)), spread);
+                    __m256i* out = reinterpret_cast<__m256i*>(dst + i * 4);
+                    const __m256i p0 = _mm256_loadu_si256(out);
+                    const __m256i p1 = _mm256_loadu_si256(out + 1);
+                    // Unpacking within lanes keeps pixel order through the matching pack
+                    _mm256_storeu_si256(out, _mm256_packus_epi16(
+                        blendPixels4Avx2(_mm256_unpacklo_epi8(p0, zero), _mm256_unpacklo_epi8(a0, zero), source),
+                        blendPixels4Avx2(_mm256_unpackhi_epi8(p0, zero), _mm256_unpackhi_epi8(a0, zero), source)));
+                    _mm256_storeu_si256(out + 1, _mm256_packus_epi16(
+                        blendPixels4Avx2(_mm256_unpacklo_epi8(p1, zero), _mm256_unpacklo_epi8(a1, zero), source),
+                        blendPixels4Avx2(_mm256_unpackhi_epi8(p1, zero), _mm256_unpackhi_epi8(a1, zero), source)));
+                }
+
+                const __m128i narrow = _mm256_castsi256_si128(source);
+                if (i + 8 <= count) {
+                    blendPixels8(dst + i * 4, coverage + i, narrow);
+                    i += 8;
+                }
+                blendPixelsTail(dst + i * 4, coverage + i, count - i, narrow);
+            }
+#endif
+        }
+
+        namespace DabRasterizer {
+            void computeCoverageRow(const Dab& dab, int32_t x, int32_t y, uint32_t count, uint8_t* coverage) {
+                const CoverageParams p = makeParams(dab);
+                const float dy = static_cast<float>(y) + 0.5f - p.cy;
+                const float dx0 = static_cast<float>(x) + 0.5f - p.cx;
+                uint32_t i = 0;
+                if (p.oriented) {
+                    for (; i < count; ++i) {
+                        coverage[i] = coverageScalar(p, dx0 + static_cast<float>(i), dy);
+                    }
+                    return;
+                }
+
+#if defined(AE_SIMD_AVX2_DISPATCH)
+                if (Simd::hasAvx2()) {
+                    coverageRowAvx2(p, dx0, dy, count, coverage);
+                    return;
+                }
+#endif
+#if defined(AE_SIMD_SSE2)
+                {
+                    const __m128 zero = _mm_setzero_ps();
+                    const __m128 one = _mm_set1_ps(1.0f);
+                    const __m128 three = _mm_set1_ps(3.0f);
+                    const __m128 two = _mm_set1_ps(2.0f);
+                    const __m128 half = _mm_set1_ps(0.5f);
+                    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+                    const __m128 edgeRadius = _mm_set1_ps(p.edge);
+                    const __m128 inner = _mm_set1_ps(p.inner);
+                    const __m128 invFalloff = _mm_set1_ps(p.invFalloff);
+                    const __m128 strength = _mm_set1_ps(p.strength);
+                    const __m128 vdy = _mm_set1_ps(dy);
+                    const __m128 ady = _mm_and_ps(vdy, absMask);
+                    const __m128 dy2 = _mm_mul_ps(vdy, vdy);
+                    const __m128 edgeY = _mm_min_ps(_mm_max_ps(_mm_sub_ps(edgeRadius, ady), zero), one);
+                    const __m128 origin = _mm_set1_ps(dx0);
+                    const __m128 lanes = _mm_setr_ps(0, 1, 2, 3);
+
+                    // dx0 + index rounds once, like the scalar path
+                    auto coverage4 = [&](uint8_t* out) {
+                        const __m128 vdx = _mm_add_ps(origin, _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), lanes));
+                        __m128 distance, edge;
+                        if (p.square) {
+                            __m128 adx = _mm_and_ps(vdx, absMask);
+                            distance = _mm_max_ps(adx, ady);
+                            edge = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_sub_ps(edgeRadius, adx), zero), one), edgeY);
+                        } else {
+                            distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vdx, vdx), dy2));
+                            edge = _mm_min_ps(_mm_max_ps(_mm_sub_ps(edgeRadius, distance), zero), one);
+                        }
+                        __m128 t = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(distance, inner), invFalloff), zero), one);
+                        __m128 falloff = _mm_sub_ps(one, _mm_mul_ps(_mm_mul_ps(t, t), _mm_sub_ps(three, _mm_mul_ps(two, t))));
+                        __m128 value = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(edge, falloff), strength), half);
+                        __m128i ints = _mm_cvttps_epi32(value);
+                        __m128i words = _mm_packs_epi32(ints, ints);
+                        uint32_t packed = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(words, words)));
+                        std::memcpy(out, &packed, 4);
+                    };
+
+                    for (; i + 4 <= count; i += 4) {
+                        coverage4(coverage + i);
+                    }
+                    if (i < count) {
+                        uint8_t tail[4];
+                        coverage4(tail);
+                        std::memcpy(coverage + i, tail, count - i);
+                        i = count;
+                    }
+                }
+#endif
+
+                for (; i < count; ++i) {
+                    coverage[i] = coverageScalar(p, dx0 + static_cast<float>(i), dy);
+                }
+            }
+
+            void blendRow(uint8_t* dst, const uint8_t* coverage, uint32_t count, const uint8_t color[4]) {
+                uint32_t i = 0;
+
+#if defined(AE_SIMD_AVX2_DISPATCH)
+                if (Simd::hasAvx2()) {
+                    blendRowAvx2(dst, coverage, count, color);
+                    return;
+                }
+#endif
+#if defined(AE_SIMD_SSE2)
+                const __m128i source = _mm_setr_epi16(color[0], color[1], color[2], color[3], color[0], color[1], color[2], color[3]);
+                for (; i + 8 <= count; i += 8) {
+                    blendPixels8(dst + i * 4, coverage + i, source);
+                }
+                blendPixelsTail(dst + i * 4, coverage + i, count - i, source);
+                i = count;
+#endif
+
+                for (; i < count; ++i) {
+                    uint32_t a = coverage[i];
+                    if (a == 0) {
+                        continue;
+                    }
+                    uint8_t* pixel = dst + i * 4;
+                    for (int c = 0; c < 4; ++c) {
+                        pixel[c] = static_cast<uint8_t>(div255(color[c] * a + pixel[c] * (255 - a)));
+                    }
+                }
+            }
+
+            void blendRowLinear(PixelFormat format, uint8_t* dst, const uint8_t* coverage, uint32_t count, const float color[4]) {
+                switch (format) {
+                    case PixelFormat::RGBA16:
+                        blendPixelsLinear<PixelFormat::RGBA16>(dst, coverage, count, color);
+                        break;
+                    case PixelFormat::RGBA32F:
+                        blendPixelsLinear<PixelFormat::RGBA32F>(dst, coverage, count, color);
+                        break;
+                    case PixelFormat::RGBA8:
+                        break;
+                }
+            }
+
+            glm::vec2 getReach(const Dab& dab) {
+                const float radius = std::max(dab.radius, 0.5f);
+                const float roundness = std::clamp(dab.roundness, 0.01f, 1.0f);
+                if (roundness >= 1.0f && (dab.shape == DabShape::Round || dab.angle == 0.0f)) {
+                    return glm::vec2(radius + 0.5f);
+                }
+                const float minor = radius * roundness;
+                const float c = std::fabs(std::cos(dab.angle)), s = std::fabs(std::sin(dab.angle));
+                if (dab.shape == DabShape::Square) {
+                    return {radius * c + minor * s + 0.5f, radius * s + minor * c + 0.5f};
+                }
+                return {std::sqrt(radius * radius * c * c + minor * minor * s * s) + 0.5f,
+                        std::sqrt(radius * radius * s * s + minor * minor * c * c) + 0.5f};
+            }
+
+            TileRect getTileBounds(const TiledImage& image, const Dab& dab) {
+                TileRect bounds;
+                const glm::vec2 reach = getReach(dab);
+                const int32_t px0 = std::max(0, static_cast<int32_t>(std::floor(dab.center.x - reach.x)));
+                const int32_t py0 = std::max(0, static_cast<int32_t>(std::floor(dab.center.y - reach.y)));
+                const int32_t px1 = std::min(static_cast<int32_t>(image.getWidth()), static_cast<int32_t>(std::ceil(dab.center.x + reach.x)));
+                const int32_t py1 = std::min(static_cast<int32_t>(image.getHeight()), static_cast<int32_t>(std::ceil(dab.center.y + reach.y)));
+                if (px0 >= px1 || py0 >= py1) {
+                    return bounds;
+                }
+                bounds.x0 = static_cast<uint32_t>(px0) / TILE_SIZE;
+                bounds.y0 = static_cast<uint32_t>(py0) / TILE_SIZE;
+                bounds.x1 = (static_cast<uint32_t>(px1) + TILE_SIZE - 1) / TILE_SIZE;
+                bounds.y1 = (static_cast<uint32_t>(py1) + TILE_SIZE - 1) / TILE_SIZE;
+                return bounds;
+            }
+
+            TileRect stamp(TiledImage& image, const Dab& dab, const TiledMask* clip, DabMaskCache* masks) {
+                TileRect touched;
+                if (dab.opacity <= 0.0f || (dab.blend == DabBlend::Paint && dab.color.a <= 0.0f)) {
+                    return touched;
+                }
+
+                // Dab alpha is part of the coverage, so the color itself is opaque
+                const PixelFormat format = image.getFormat();
+                const uint32_t bpp = getBytesPerPixel(format);
+                uint8_t color[4] = {0, 0, 0, 0};
+                float linearColor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+                if (dab.blend == DabBlend::Paint) {
+                    for (int c = 0; c < 3; ++c) {
+                        const float value = std::clamp(dab.color[c], 0.0f, 1.0f);
+                        color[c] = static_cast<uint8_t>(value * 255.0f + 0.5f);
+                        linearColor[c] = ColorSpace::srgbToLinear(value);
+                    }
+                    color[3] = 255;
+                    linearColor[3] = 1.0f;
+                }
+
+                // Coverage for the whole dab, one span per row. Spans hug the footprint so
+                // the kernels never see the empty corners and rows are not split at tile seams.
+                thread_local std::vector<uint8_t> coverage;
+                thread_local std::vector<RowSpan> spans;
+                int32_t px0, py0, px1, py1;
+                if (masks) {
+                    // The cached mask holds unit coverage around the snapped center; opacity scales it here
+                    const Dab snapped = DabMaskCache::quantize(dab);
+                    const std::shared_ptr<const DabMask> mask = masks->getMask(snapped);
+                    const int32_t originX = static_cast<int32_t>(std::floor(snapped.center.x)) + mask->x0;
+                    const int32_t originY = static_cast<int32_t>(std::floor(snapped.center.y)) + mask->y0;
+                    px0 = std::max(0, originX);
+                    py0 = std::max(0, originY);
+                    px1 = std::min(static_cast<int32_t>(image.getWidth()), originX + static_cast<int32_t>(mask->width));
+                    py1 = std::min(static_cast<int32_t>(image.getHeight()), originY + static_cast<int32_t>(mask->height));
+                    if (px0 >= px1 || py0 >= py1) {
+                        return touched;
+                    }
+
+                    const float alpha = dab.blend == DabBlend::Paint ? dab.color.a : 1.0f;
+                    const uint32_t strength = static_cast<uint32_t>(std::clamp(dab.opacity * alpha, 0.0f, 1.0f) * 65536.0f + 0.5f);
+                    const uint32_t boundsWidth = static_cast<uint32_t>(px1 - px0);
+                    coverage.resize(static_cast<size_t>(boundsWidth) * static_cast<uint32_t>(py1 - py0));
+                    spans.resize(static_cast<size_t>(py1 - py0));
+                    for (int32_t y = py0; y < py1; ++y) {
+                        const DabMask::Span& row = mask->spans[y - originY];
+                        RowSpan& span = spans[y - py0];
+                        span.begin = std::max(px0, originX + static_cast<int32_t>(row.begin));
+                        span.end = std::min(px1, originX + static_cast<int32_t>(row.end));
+                        if (span.begin < span.end) {
+                            scaleCoverageRow(mask->coverage.data() + static_cast<size_t>(y - originY) * mask->width + (span.begin - originX),
+                                             static_cast<uint32_t>(span.end - span.begin), strength,
+                                             coverage.data() + static_cast<size_t>(y - py0) * boundsWidth + (span.begin - px0));
+                        }
+                    }
+                } else {
+                    // Pixel bounds of everything the anti-aliased edge can reach
+                    const glm::vec2 reach = getReach(dab);
+                    px0 = std::max(0, static_cast<int32_t>(std::floor(dab.center.x - reach.x)));
+                    py0 = std::max(0, static_cast<int32_t>(std::floor(dab.center.y - reach.y)));
+                    px1 = std::min(static_cast<int32_t>(image.getWidth()), static_cast<int32_t>(std::ceil(dab.center.x + reach.x)));
+                    py1 = std::min(static_cast<int32_t>(image.getHeight()), static_cast<int32_t>(std::ceil(dab.center.y + reach.y)));
+                    if (px0 >= px1 || py0 >= py1) {
+                        return touched;
+                    }
+
+                    // Only an upright round footprint narrows its rows; the rest span their box
+                    const bool circle = dab.shape == DabShape::Round && dab.roundness >= 1.0f;
+                    const uint32_t boundsWidth = static_cast<uint32_t>(px1 - px0);
+                    coverage.resize(static_cast<size_t>(boundsWidth) * static_cast<uint32_t>(py1 - py0));
+                    spans.resize(static_cast<size_t>(py1 - py0));
+                    for (int32_t y = py0; y < py1; ++y) {
+                        float dy = std::fabs(static_cast<float>(y) + 0.5f - dab.center.y);
+                        float halfWidth = !circle ? (dy < reach.y ? reach.x : 0.0f)
+                                                  : std::sqrt(std::max(reach.x * reach.x - dy * dy, 0.0f));
+                        RowSpan& span = spans[y - py0];
+                        span.begin = std::max(px0, static_cast<int32_t>(std::floor(dab.center.x - halfWidth)));
+                        span.end = std::min(px1, static_cast<int32_t>(std::ceil(dab.center.x + halfWidth)));
+                        if (span.begin < span.end) {
+                            computeCoverageRow(dab, span.begin, y, static_cast<uint32_t>(span.end - span.begin),
+                                               coverage.data() + static_cast<size_t>(y - py0) * boundsWidth + (span.begin - px0));
+                        }
+                    }
+                }
+                const uint32_t boundsWidth = static_cast<uint32_t>(px1 - px0);
+                for (uint32_t ty = static_cast<uint32_t>(py0) / TILE_SIZE; ty * TILE_SIZE < static_cast<uint32_t>(py1); ++ty) {
+                    for (uint32_t tx = static_cast<uint32_t>(px0) / TILE_SIZE; tx * TILE_SIZE < static_cast<uint32_t>(px1); ++tx) {
+                        // Erasing a transparent tile changes nothing
+                        if (dab.blend == DabBlend::Erase && !image.getTile(tx, ty)) {
+                            continue;
+                        }
+                        // Unselected tiles are left alone; partly selected ones scale the coverage
+                        const uint8_t* clipTile = nullptr;
+                        if (clip) {
+                            if (clip->isTileEmpty(tx, ty)) {
+                                continue;
+                            }
+                            if (!clip->isTileFull(tx, ty)) {
+                                clipTile = clip->getTile(tx, ty);
+                            }
+                        }
+
+                        const int32_t tileX = static_cast<int32_t>(tx * TILE_SIZE);
+                        const int32_t tileY = static_cast<int32_t>(ty * TILE_SIZE);
+                        const int32_t x0 = std::max(px0, tileX), x1 = std::min(px1, tileX + static_cast<int32_t>(TILE_SIZE));
+                        const int32_t y0 = std::max(py0, tileY), y1 = std::min(py1, tileY + static_cast<int32_t>(TILE_SIZE));
+
+                        // Skip tiles the footprint only grazes with its bounding box
+                        bool anySpan = false;
+                        for (int32_t y = y0; y < y1 && !anySpan; ++y) {
+                            const RowSpan& span = spans[y - py0];
+                            anySpan = std::max(span.begin, x0) < std::min(span.end, x1);
+                        }
+                        if (!anySpan) {
+                            continue;
+                        }
+
+                        uint8_t* pixels = image.getTileForWrite(tx, ty).getData();
+                        for (int32_t y = y0; y < y1; ++y) {
+                            const RowSpan& span = spans[y - py0];
+                            int32_t begin = std::max(span.begin, x0), end = std::min(span.end, x1);
+                            if (begin >= end) {
+                                continue;
+                            }
+                            uint8_t* dst = pixels + (static_cast<size_t>(y - tileY) * TILE_SIZE + (begin - tileX)) * bpp;
+                            uint8_t* rowCoverage = coverage.data() + static_cast<size_t>(y - py0) * boundsWidth + (begin - px0);
+                            if (clipTile) {
+                                MaskOps::multiplyRow(rowCoverage, clipTile + (y - tileY) * TILE_SIZE + (begin - tileX), static_cast<uint32_t>(end - begin));
+                            }
+                            if (format == PixelFormat::RGBA8) {
+                                blendRow(dst, rowCoverage, static_cast<uint32_t>(end - begin), color);
+                            } else {
+                                blendRowLinear(format, dst, rowCoverage, static_cast<uint32_t>(end - begin), linearColor);
+                            }
+                        }
+                        touched.merge({tx, ty, tx + 1, ty + 1});
+                    }
+                }
+                return touched;
+            }
+        }
+    }
+}
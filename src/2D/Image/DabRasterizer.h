@@ -0,0 +1,67 @@
+#pragma once
+
+#include "2D/Image/TiledImage.h"
+#include "2D/Image/TiledMask.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+
+namespace AstralEngine {
+    namespace D2 {
+        class DabMaskCache;
+        
+        enum class DabShape : uint8_t {
+            Round,
+            Square
+        };
+
+        enum class DabBlend : uint8_t {
+            Paint, // Source-over with the dab color
+            Erase  // Destination-out, removes coverage from the layer
+        };
+
+        // A single brush footprint, in image pixel coordinates
+        struct Dab {
+            glm::vec2 center = {0.0f, 0.0f};
+            float radius = 5.0f;
+            float hardness = 1.0f;  // 1 = solid up to the anti-aliased edge, 0 = falloff from the center
+            float roundness = 1.0f; // Minor to major axis ratio; the major axis is `radius`
+            float angle = 0.0f;     // Major axis direction in radians from +x, clockwise as y points down
+            float opacity = 1.0f;
+            glm::vec4 color = {0.0f, 0.0f, 0.0f, 1.0f}; // Straight alpha
+            DabShape shape = DabShape::Round;
+            DabBlend blend = DabBlend::Paint;
+        };
+
+        /**
+         * @brief Stamps brush dabs into tiled layer pixels
+         *
+         * Coverage is evaluated per pixel center with a one-pixel anti-aliased edge and a
+         * smoothstep falloff controlled by hardness. Coverage runs 8 pixels per step on AVX2
+         * or 4 on SSE2, the premultiplied blend 16 or 8, with AVX2 picked at runtime; scalar
+         * code is the fallback. RGBA16 and RGBA32F images are painted in linear light, a pixel
+         * per SSE2 step; the dab color is given in sRGB and converted once per dab. Squashed or
+         * rotated footprints are evaluated one pixel at a time, so strokes normally take
+         * their coverage from a DabMaskCache instead, which leaves a multiply per pixel.
+         */
+        namespace DabRasterizer {
+            // Stamps one dab and returns the tiles it modified; `clip` (same size as the image) scales coverage.
+            // With `masks` the footprint comes from the cache, as if stamping DabMaskCache::quantize(dab).
+            TileRect stamp(TiledImage& image, const Dab& dab, const TiledMask* clip = nullptr, DabMaskCache* masks = nullptr);
+
+            // Tiles a dab may modify, known before stamping (e.g. to snapshot them for undo)
+            TileRect getTileBounds(const TiledImage& image, const Dab& dab);
+            
+            // Half width and height of the box the anti-aliased footprint fits in
+            glm::vec2 getReach(const Dab& dab);
+
+            // Coverage (0-255) of `count` pixels of row `y`, starting at column `x`
+            void computeCoverageRow(const Dab& dab, int32_t x, int32_t y, uint32_t count, uint8_t* coverage);
+
+            // dst = color * coverage + dst * (1 - coverage), all channels; `color` is straight RGBA8
+            void blendRow(uint8_t* dst, const uint8_t* coverage, uint32_t count, const uint8_t color[4]);
+            
+            // Same for RGBA16 and RGBA32F pixels; `color` is premultiplied linear light in [0, 1]
+            void blendRowLinear(PixelFormat format, uint8_t* dst, const uint8_t* coverage, uint32_t count, const float color[4]);
+        }
+    }
+}
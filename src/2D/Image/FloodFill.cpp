@@ -0,0 +1,644 @@
+#include "2D/Image/FloodFill.h"
+#include "2D/Image/ColorSpace.h"
+#include "2D/Image/DabRasterizer.h"
+#include "2D/Image/Simd.h"
+#include "Core/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            constexpr uint32_t TILE_EDGE = TILE_SIZE - 1;
+
+            // Tiles per job when a wave or the mask is processed in parallel
+            constexpr size_t FILL_GRAIN = 4;
+
+            // Entry m has byte i set to 1 when bit i of m is: expands a movemask to per-pixel flags
+            struct ExpandTable {
+                uint64_t entries[256];
+
+                ExpandTable() {
+                    for (uint32_t mask = 0; mask < 256; ++mask) {
+                        uint64_t flags = 0;
+                        for (uint32_t bit = 0; bit < 8; ++bit) {
+                            if (mask & (1u << bit)) {
+                                flags |= uint64_t(1) << (bit * 8);
+                            }
+                        }
+                        entries[mask] = flags;
+                    }
+                }
+            };
+
+            const ExpandTable s_expand;
+
+#if defined(AE_SIMD_AVX2_DISPATCH)
+            // |p - seed| per byte via two saturating subtractions; a pixel matches when all four are <= tolerance.
+            // Returns the pixels done.
+            AE_TARGET_AVX2 uint32_t matchRow8Avx2(const uint8_t* row, uint32_t count, uint32_t seedPixel, uint8_t tolerance,
+                                                  uint8_t* matches) {
+                const __m256i vseed = _mm256_set1_epi32(static_cast<int>(seedPixel));
+                const __m256i vtolerance = _mm256_set1_epi8(static_cast<char>(tolerance));
+                const __m256i ones = _mm256_set1_epi32(-1);
+                uint32_t i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + static_cast<size_t>(i) * 4));
+                    const __m256i diff = _mm256_or_si256(_mm256_subs_epu8(p, vseed), _mm256_subs_epu8(vseed, p));
+                    const __m256i within = _mm256_cmpeq_epi8(_mm256_max_epu8(diff, vtolerance), vtolerance);
+                    const __m256i pixel = _mm256_cmpeq_epi32(within, ones);
+                    const uint64_t flags = s_expand.entries[_mm256_movemask_ps(_mm256_castsi256_ps(pixel))];
+                    std::memcpy(matches + i, &flags, 8);
+                }
+                return i;
+            }
+#endif
+
+            void matchRow8(const uint8_t* row, uint32_t count, const uint8_t* seed, uint8_t tolerance, uint8_t* matches) {
+                uint32_t i = 0;
+#if defined(AE_SIMD_SSE2)
+                uint32_t seedPixel;
+                std::memcpy(&seedPixel, seed, 4);
+#endif
+#if defined(AE_SIMD_AVX2_DISPATCH)
+                if (Simd::hasAvx2()) {
+                    i = matchRow8Avx2(row, count, seedPixel, tolerance, matches);
+                }
+#endif
+#if defined(AE_SIMD_SSE2)
+                {
+                    const __m128i vseed = _mm_set1_epi32(static_cast<int>(seedPixel));
+                    const __m128i vtolerance = _mm_set1_epi8(static_cast<char>(tolerance));
+                    const __m128i ones = _mm_set1_epi32(-1);
+                    for (; i + 4 <= count; i += 4) {
+                        const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + static_cast<size_t>(i) * 4));
+                        const __m128i diff = _mm_or_si128(_mm_subs_epu8(p, vseed), _mm_subs_epu8(vseed, p));
+                        const __m128i within = _mm_cmpeq_epi8(_mm_max_epu8(diff, vtolerance), vtolerance);
+                        const __m128i pixel = _mm_cmpeq_epi32(within, ones);
+                        const uint32_t flags = static_cast<uint32_t>(s_expand.entries[_mm_movemask_ps(_mm_castsi128_ps(pixel))]);
+                        std::memcpy(matches + i, &flags, 4);
+                    }
+                }
+#endif
+                for (; i < count; ++i) {
+                    const uint8_t* p = row + static_cast<size_t>(i) * 4;
+                    bool within = true;
+                    for (int c = 0; c < 4; ++c) {
+                        within &= std::abs(static_cast<int>(p[c]) - static_cast<int>(seed[c])) <= tolerance;
+                    }
+                    matches[i] = within ? 1 : 0;
+                }
+            }
+
+            void matchRow16(const uint8_t* row, uint32_t count, const uint8_t* seed, uint16_t tolerance, uint8_t* matches) {
+                const uint16_t* pixels = reinterpret_cast<const uint16_t*>(row);
+                uint16_t seedPixel[4];
+                std::memcpy(seedPixel, seed, 8);
+                uint32_t i = 0;
+#if defined(AE_SIMD_SSE2)
+                {
+                    // Two pixels per step; each pixel owns 8 bytes of the comparison mask.
+                    // diff <= tolerance as a saturating subtraction reaching zero, which needs no SSE4.1 max.
+                    uint64_t seedBits;
+                    std::memcpy(&seedBits, seedPixel, 8);
+                    const __m128i vseed = _mm_set1_epi64x(static_cast<long long>(seedBits));
+                    const __m128i vtolerance = _mm_set1_epi16(static_cast<short>(tolerance));
+                    const __m128i zero = _mm_setzero_si128();
+                    for (; i + 2 <= count; i += 2) {
+                        const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + static_cast<size_t>(i) * 4));
+                        const __m128i diff = _mm_or_si128(_mm_subs_epu16(p, vseed), _mm_subs_epu16(vseed, p));
+                        const __m128i within = _mm_cmpeq_epi16(_mm_subs_epu16(diff, vtolerance), zero);
+                        const int bits = _mm_movemask_epi8(within);
+                        matches[i] = (bits & 0xFF) == 0xFF ? 1 : 0;
+                        matches[i + 1] = (bits >> 8) == 0xFF ? 1 : 0;
+                    }
+                }
+#endif
+                for (; i < count; ++i) {
+                    const uint16_t* p = pixels + static_cast<size_t>(i) * 4;
+                    bool within = true;
+                    for (int c = 0; c < 4; ++c) {
+                        within &= std::abs(static_cast<int>(p[c]) - static_cast<int>(seedPixel[c])) <= tolerance;
+                    }
+                    matches[i] = within ? 1 : 0;
+                }
+            }
+
+            void matchRow32F(const uint8_t* row, uint32_t count, const uint8_t* seed, float tolerance, uint8_t* matches) {
+                const float* pixels = reinterpret_cast<const float*>(row);
+                float seedPixel[4];
+                std::memcpy(seedPixel, seed, 16);
+                uint32_t i = 0;
+#if defined(AE_SIMD_SSE2)
+                {
+                    const __m128 vseed = _mm_loadu_ps(seedPixel);
+                    const __m128 vtolerance = _mm_set1_ps(tolerance);
+                    const __m128 sign = _mm_set1_ps(-0.0f);
+                    for (; i < count; ++i) {
+                        const __m128 p = _mm_loadu_ps(pixels + static_cast<size_t>(i) * 4);
+                        const __m128 diff = _mm_andnot_ps(sign, _mm_sub_ps(p, vseed));
+                        matches[i] = _mm_movemask_ps(_mm_cmple_ps(diff, vtolerance)) == 0xF ? 1 : 0;
+                    }
+                }
+#endif
+                for (; i < count; ++i) {
+                    const float* p = pixels + static_cast<size_t>(i) * 4;
+                    bool within = true;
+                    for (int c = 0; c < 4; ++c) {
+                        within &= std::fabs(p[c] - seedPixel[c]) <= tolerance;
+                    }
+                    matches[i] = within ? 1 : 0;
+                }
+            }
+
+            // (x + 127) / 255 for x in [0, 255 * 255]
+            inline uint32_t div255(uint32_t x) {
+                x += 128;
+                return (x + (x >> 8)) >> 8;
+            }
+
+            enum class TileMatch : uint8_t {
+                Unknown, // Not reached yet
+                None,    // No pixel matches the seed
+                All,     // Every pixel matches; filled as a whole
+                Partial  // `matches` holds the per-pixel result
+            };
+
+            // Pixels handed to a neighbor tile, inclusive, in that tile's local coordinates
+            struct SeedRun {
+                uint8_t x0, y0, x1, y1;
+            };
+
+            struct Handover {
+                uint32_t tile;
+                SeedRun run;
+            };
+
+            struct FillTile {
+                TileMatch match = TileMatch::Unknown;
+                bool full = false;   // An All tile the fill reached
+                bool queued = false; // Part of the next wave
+                std::unique_ptr<uint8_t[]> matches;
+                std::unique_ptr<uint8_t[]> filled;
+                std::vector<SeedRun> seeds;
+                std::vector<Handover> handovers;
+            };
+
+            class FillState {
+            public:
+                FillState(const TiledImage& source, const uint8_t* seed, float tolerance)
+                    : m_source(source), m_tilesX(source.getTilesX()), m_tilesY(source.getTilesY()),
+                      m_tolerance(tolerance), m_tiles(source.getTileCount()) {
+                    std::memcpy(m_seed, seed, getBytesPerPixel(source.getFormat()));
+                }
+
+                void run(uint32_t x, uint32_t y) {
+                    const uint32_t start = (y / TILE_SIZE) * m_tilesX + x / TILE_SIZE;
+                    const uint8_t lx = static_cast<uint8_t>(x % TILE_SIZE);
+                    const uint8_t ly = static_cast<uint8_t>(y % TILE_SIZE);
+                    m_tiles[start].seeds.push_back({lx, ly, lx, ly});
+
+                    std::vector<uint32_t> wave = {start};
+                    std::vector<uint32_t> next;
+                    while (!wave.empty()) {
+                        Jobs::JobSystem::getInstance().parallelFor(wave.size(), [&](size_t i) {
+                            processTile(wave[i]);
+                        }, FILL_GRAIN);
+
+                        for (uint32_t index : wave) {
+                            m_tiles[index].queued = false;
+                        }
+                        next.clear();
+                        for (uint32_t index : wave) {
+                            for (const Handover& handover : m_tiles[index].handovers) {
+                                FillTile& target = m_tiles[handover.tile];
+                                if (target.full || target.match == TileMatch::None ||
+                                    (target.filled && !hasOpenPixel(target, handover.run))) {
+                                    continue;
+                                }
+                                target.seeds.push_back(handover.run);
+                                if (!target.queued) {
+                                    target.queued = true;
+                                    next.push_back(handover.tile);
+                                }
+                            }
+                            m_tiles[index].handovers.clear();
+                        }
+                        wave.swap(next);
+                    }
+                }
+
+                // Every matching pixel, wherever it is
+                void runGlobal() {
+                    Jobs::JobSystem::getInstance().parallelFor(m_tiles.size(), [&](size_t i) {
+                        FillTile& tile = m_tiles[i];
+                        classify(static_cast<uint32_t>(i));
+                        tile.full = tile.match == TileMatch::All;
+                        if (tile.match == TileMatch::Partial) {
+                            tile.filled = std::move(tile.matches);
+                        }
+                    }, FILL_GRAIN);
+                }
+
+                TiledMask buildMask(bool antiAlias) const {
+                    TiledMask mask(m_source.getWidth(), m_source.getHeight());
+
+                    // Anti-aliasing spills half a pixel into the tiles around the filled ones
+                    std::vector<uint8_t> candidate(m_tiles.size(), 0);
+                    for (uint32_t index = 0; index < m_tiles.size(); ++index) {
+                        const FillTile& tile = m_tiles[index];
+                        if (!tile.full && !tile.filled) {
+                            continue;
+                        }
+                        const int32_t tx = static_cast<int32_t>(index % m_tilesX);
+                        const int32_t ty = static_cast<int32_t>(index / m_tilesX);
+                        const int32_t reach = antiAlias ? 1 : 0;
+                        for (int32_t ny = std::max(ty - reach, 0); ny <= std::min(ty + reach, static_cast<int32_t>(m_tilesY) - 1); ++ny) {
+                            for (int32_t nx = std::max(tx - reach, 0); nx <= std::min(tx + reach, static_cast<int32_t>(m_tilesX) - 1); ++nx) {
+                                candidate[ny * m_tilesX + nx] = 1;
+                            }
+                        }
+                    }
+                    std::vector<uint32_t> tiles;
+                    for (uint32_t index = 0; index < candidate.size(); ++index) {
+                        if (candidate[index]) {
+                            tiles.push_back(index);
+                        }
+                    }
+
+                    Jobs::JobSystem::getInstance().parallelFor(tiles.size(), [&](size_t i) {
+                        buildMaskTile(mask, tiles[i], antiAlias);
+                    }, FILL_GRAIN);
+                    return mask;
+                }
+
+            private:
+                void classify(uint32_t index) {
+                    FillTile& fill = m_tiles[index];
+                    const uint32_t tx = index % m_tilesX;
+                    const uint32_t ty = index / m_tilesX;
+                    const uint32_t validWidth = std::min(TILE_SIZE, m_source.getWidth() - tx * TILE_SIZE);
+                    const uint32_t validHeight = std::min(TILE_SIZE, m_source.getHeight() - ty * TILE_SIZE);
+                    const bool whole = validWidth == TILE_SIZE && validHeight == TILE_SIZE;
+                    const PixelFormat format = m_source.getFormat();
+
+                    const Tile* tile = m_source.getTile(tx, ty);
+                    if (!tile || tile->isUniform()) {
+                        static const uint8_t transparent[16] = {};
+                        uint8_t match = 0;
+                        FloodFill::matchRow(format, tile ? tile->getUniformPixel() : transparent, 1, m_seed, m_tolerance, &match);
+                        if (!match) {
+                            fill.match = TileMatch::None;
+                        } else if (whole) {
+                            fill.match = TileMatch::All;
+                        } else {
+                            // Edge tiles never fill past the image
+                            fill.matches = std::make_unique<uint8_t[]>(TILE_PIXELS);
+                            for (uint32_t y = 0; y < validHeight; ++y) {
+                                std::memset(fill.matches.get() + y * TILE_SIZE, 1, validWidth);
+                            }
+                            fill.match = TileMatch::Partial;
+                        }
+                        return;
+                    }
+
+                    fill.matches = std::make_unique<uint8_t[]>(TILE_PIXELS);
+                    const size_t rowBytes = static_cast<size_t>(TILE_SIZE) * getBytesPerPixel(format);
+                    uint32_t count = 0;
+                    for (uint32_t y = 0; y < validHeight; ++y) {
+                        uint8_t* matches = fill.matches.get() + y * TILE_SIZE;
+                        FloodFill::matchRow(format, tile->getData() + y * rowBytes, validWidth, m_seed, m_tolerance, matches);
+                        for (uint32_t x = 0; x < validWidth; ++x) {
+                            count += matches[x];
+                        }
+                    }
+                    if (count == 0) {
+                        fill.matches.reset();
+                        fill.match = TileMatch::None;
+                    } else if (whole && count == TILE_PIXELS) {
+                        fill.matches.reset();
+                        fill.match = TileMatch::All;
+                    } else {
+                        fill.match = TileMatch::Partial;
+                    }
+                }
+
+                // Runs in parallel with other tiles of the wave; only touches its own FillTile
+                void processTile(uint32_t index) {
+                    FillTile& tile = m_tiles[index];
+                    if (tile.match == TileMatch::Unknown) {
+                        classify(index);
+                    }
+                    std::vector<SeedRun> seeds;
+                    seeds.swap(tile.seeds);
+
+                    if (tile.match == TileMatch::None) {
+                        return;
+                    }
+                    if (tile.match == TileMatch::All) {
+                        if (!tile.full) {
+                            tile.full = true;
+                            handOver(index, 0, TILE_EDGE, 0);
+                            handOver(index, 0, TILE_EDGE, TILE_EDGE);
+                            handOverColumn(index, 0, 0, TILE_EDGE);
+                            handOverColumn(index, TILE_EDGE, 0, TILE_EDGE);
+                        }
+                        return;
+                    }
+
+                    if (!tile.filled) {
+                        tile.filled = std::make_unique<uint8_t[]>(TILE_PIXELS);
+                    }
+                    const uint8_t* matches = tile.matches.get();
+                    uint8_t* filled = tile.filled.get();
+                    auto isOpen = [&](uint32_t pixel) { return matches[pixel] && !filled[pixel]; };
+
+                    std::vector<uint16_t> stack;
+                    for (const SeedRun& run : seeds) {
+                        for (uint32_t y = run.y0; y <= run.y1; ++y) {
+                            for (uint32_t x = run.x0; x <= run.x1; ++x) {
+                                stack.push_back(static_cast<uint16_t>(y * TILE_SIZE + x));
+                            }
+                        }
+                    }
+
+                    // Pushes the first pixel of every open run of row `row` within [x0, x1]
+                    auto pushRuns = [&](uint32_t row, uint32_t x0, uint32_t x1) {
+                        bool inRun = false;
+                        for (uint32_t x = x0; x <= x1; ++x) {
+                            const bool open = isOpen(row + x);
+                            if (open && !inRun) {
+                                stack.push_back(static_cast<uint16_t>(row + x));
+                            }
+                            inRun = open;
+                        }
+                    };
+
+                    while (!stack.empty()) {
+                        const uint32_t pixel = stack.back();
+                        stack.pop_back();
+                        if (!isOpen(pixel)) {
+                            continue;
+                        }
+                        const uint32_t y = pixel / TILE_SIZE;
+                        const uint32_t row = y * TILE_SIZE;
+                        uint32_t x0 = pixel % TILE_SIZE;
+                        uint32_t x1 = x0;
+                        while (x0 > 0 && isOpen(row + x0 - 1)) {
+                            --x0;
+                        }
+                        while (x1 < TILE_EDGE && isOpen(row + x1 + 1)) {
+                            ++x1;
+                        }
+                        std::memset(filled + row + x0, 1, x1 - x0 + 1);
+
+                        if (x0 == 0) {
+                            handOverColumn(index, 0, y, y);
+                        }
+                        if (x1 == TILE_EDGE) {
+                            handOverColumn(index, TILE_EDGE, y, y);
+                        }
+                        handOver(index, x0, x1, y);
+                        if (y > 0) {
+                            pushRuns(row - TILE_SIZE, x0, x1);
+                        }
+                        if (y < TILE_EDGE) {
+                            pushRuns(row + TILE_SIZE, x0, x1);
+                        }
+                    }
+                }
+
+                // Passes a filled span of the top or bottom row to the tile above or below
+                void handOver(uint32_t index, uint32_t x0, uint32_t x1, uint32_t y) {
+                    const uint32_t ty = index / m_tilesX;
+                    const SeedRun run = {static_cast<uint8_t>(x0), 0, static_cast<uint8_t>(x1), 0};
+                    if (y == 0 && ty > 0) {
+                        m_tiles[index].handovers.push_back({index - m_tilesX, {run.x0, TILE_EDGE, run.x1, TILE_EDGE}});
+                    }
+                    if (y == TILE_EDGE && ty + 1 < m_tilesY) {
+                        m_tiles[index].handovers.push_back({index + m_tilesX, run});
+                    }
+                }
+
+                // Passes filled rows [y0, y1] of the left or right column to the tile beside it
+                void handOverColumn(uint32_t index, uint32_t x, uint32_t y0, uint32_t y1) {
+                    const uint32_t tx = index % m_tilesX;
+                    const uint8_t top = static_cast<uint8_t>(y0);
+                    const uint8_t bottom = static_cast<uint8_t>(y1);
+                    if (x == 0 && tx > 0) {
+                        m_tiles[index].handovers.push_back({index - 1, {TILE_EDGE, top, TILE_EDGE, bottom}});
+                    }
+                    if (x == TILE_EDGE && tx + 1 < m_tilesX) {
+                        m_tiles[index].handovers.push_back({index + 1, {0, top, 0, bottom}});
+                    }
+                }
+
+                static bool hasOpenPixel(const FillTile& tile, const SeedRun& run) {
+                    for (uint32_t y = run.y0; y <= run.y1; ++y) {
+                        for (uint32_t x = run.x0; x <= run.x1; ++x) {
+                            const uint32_t pixel = y * TILE_SIZE + x;
+                            if (tile.matches[pixel] && !tile.filled[pixel]) {
+                                return true;
+                            }
+                        }
+                    }
+                    return false;
+                }
+
+                bool isFilled(int32_t x, int32_t y) const {
+                    if (x < 0 || y < 0 || x >= static_cast<int32_t>(m_source.getWidth()) || y >= static_cast<int32_t>(m_source.getHeight())) {
+                        return false;
+                    }
+                    const FillTile& tile = m_tiles[(y / TILE_SIZE) * m_tilesX + x / TILE_SIZE];
+                    if (tile.full) {
+                        return true;
+                    }
+                    return tile.filled && tile.filled[(y % TILE_SIZE) * TILE_SIZE + x % TILE_SIZE];
+                }
+
+                void buildMaskTile(TiledMask& mask, uint32_t index, bool antiAlias) const {
+                    const FillTile& tile = m_tiles[index];
+                    const uint32_t tx = index % m_tilesX;
+                    const uint32_t ty = index / m_tilesX;
+                    if (tile.full) {
+                        mask.setTileFull(tx, ty);
+                        return;
+                    }
+                    const uint32_t validWidth = std::min(TILE_SIZE, m_source.getWidth() - tx * TILE_SIZE);
+                    const uint32_t validHeight = std::min(TILE_SIZE, m_source.getHeight() - ty * TILE_SIZE);
+
+                    MaskTile coverage;
+                    coverage.fill(0);
+                    if (!antiAlias) {
+                        if (!tile.filled) {
+                            return;
+                        }
+                        for (uint32_t pixel = 0; pixel < TILE_PIXELS; ++pixel) {
+                            coverage[pixel] = tile.filled[pixel] ? 255 : 0;
+                        }
+                    } else {
+                        // Filled flags with a one pixel border taken from the neighbors
+                        constexpr uint32_t PADDED = TILE_SIZE + 2;
+                        uint8_t padded[PADDED * PADDED];
+                        const int32_t originX = static_cast<int32_t>(tx * TILE_SIZE) - 1;
+                        const int32_t originY = static_cast<int32_t>(ty * TILE_SIZE) - 1;
+                        for (uint32_t y = 0; y < PADDED; ++y) {
+                            const bool borderRow = y == 0 || y == PADDED - 1;
+                            for (uint32_t x = 0; x < PADDED; ++x) {
+                                if (!borderRow && x > 0 && x < PADDED - 1) {
+                                    padded[y * PADDED + x] = tile.filled ? tile.filled[(y - 1) * TILE_SIZE + x - 1] : 0;
+                                } else {
+                                    padded[y * PADDED + x] = isFilled(originX + static_cast<int32_t>(x), originY + static_cast<int32_t>(y)) ? 1 : 0;
+                                }
+                            }
+                        }
+
+                        // Unfilled pixels take the filled share of their 3x3 neighborhood
+                        for (uint32_t y = 0; y < validHeight; ++y) {
+                            const uint8_t* above = padded + y * PADDED;
+                            const uint8_t* center = above + PADDED;
+                            const uint8_t* below = center + PADDED;
+                            for (uint32_t x = 0; x < validWidth; ++x) {
+                                if (center[x + 1]) {
+                                    coverage[y * TILE_SIZE + x] = 255;
+                                    continue;
+                                }
+                                const uint32_t sum = above[x] + above[x + 1] + above[x + 2] +
+                                                     center[x] + center[x + 2] +
+                                                     below[x] + below[x + 1] + below[x + 2];
+                                coverage[y * TILE_SIZE + x] = static_cast<uint8_t>((sum * 255 + 4) / 9);
+                            }
+                        }
+                    }
+
+                    if (std::all_of(coverage.begin(), coverage.end(), [](uint8_t value) { return value == 0; })) {
+                        return;
+                    }
+                    std::memcpy(mask.getTileForWrite(tx, ty), coverage.data(), TILE_PIXELS);
+                    mask.compactTile(tx, ty);
+                }
+
+                const TiledImage& m_source;
+                const uint32_t m_tilesX;
+                const uint32_t m_tilesY;
+                uint8_t m_seed[16] = {};
+                float m_tolerance;
+                std::vector<FillTile> m_tiles;
+            };
+        }
+
+        namespace FloodFill {
+            void matchRow(PixelFormat format, const uint8_t* row, uint32_t count, const uint8_t* seed,
+                          float tolerance, uint8_t* matches) {
+                const float clamped = std::clamp(tolerance, 0.0f, 1.0f);
+                switch (format) {
+                    case PixelFormat::RGBA8:
+                        matchRow8(row, count, seed, static_cast<uint8_t>(clamped * 255.0f + 0.5f), matches);
+                        break;
+                    case PixelFormat::RGBA16:
+                        matchRow16(row, count, seed, static_cast<uint16_t>(clamped * 65535.0f + 0.5f), matches);
+                        break;
+                    case PixelFormat::RGBA32F:
+                        matchRow32F(row, count, seed, clamped, matches);
+                        break;
+                }
+            }
+
+            TiledMask computeMask(const TiledImage& source, uint32_t x, uint32_t y, const FillOptions& options) {
+                if (x >= source.getWidth() || y >= source.getHeight()) {
+                    return TiledMask(source.getWidth(), source.getHeight());
+                }
+
+                uint8_t seed[16] = {};
+                const uint32_t bpp = getBytesPerPixel(source.getFormat());
+                if (const Tile* tile = source.getTile(x / TILE_SIZE, y / TILE_SIZE)) {
+                    const size_t offset = (static_cast<size_t>(y % TILE_SIZE) * TILE_SIZE + x % TILE_SIZE) * bpp;
+                    std::memcpy(seed, tile->getData() + offset, bpp);
+                }
+
+                FillState state(source, seed, options.tolerance);
+                if (options.contiguous) {
+                    state.run(x, y);
+                } else {
+                    state.runGlobal();
+                }
+                return state.buildMask(options.antiAlias);
+            }
+
+            TileRect fillMask(TiledImage& image, const TiledMask& mask, const glm::vec4& color, float opacity) {
+                TileRect touched;
+                const float strength = std::clamp(opacity * color.a, 0.0f, 1.0f);
+                if (strength <= 0.0f) {
+                    return touched;
+                }
+
+                // Alpha is part of the coverage, so the color itself is opaque
+                const PixelFormat format = image.getFormat();
+                const uint32_t bpp = getBytesPerPixel(format);
+                uint8_t color8[4] = {0, 0, 0, 255};
+                float linearColor[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+                for (int c = 0; c < 3; ++c) {
+                    const float value = std::clamp(color[c], 0.0f, 1.0f);
+                    color8[c] = static_cast<uint8_t>(value * 255.0f + 0.5f);
+                    linearColor[c] = ColorSpace::srgbToLinear(value);
+                }
+                const uint32_t scale = static_cast<uint32_t>(strength * 255.0f + 0.5f);
+                auto blend = [&](uint8_t* dst, const uint8_t* coverage, uint32_t count) {
+                    if (format == PixelFormat::RGBA8) {
+                        DabRasterizer::blendRow(dst, coverage, count, color8);
+                    } else {
+                        DabRasterizer::blendRowLinear(format, dst, coverage, count, linearColor);
+                    }
+                };
+
+                const uint32_t tilesX = std::min(image.getTilesX(), mask.getTilesX());
+                const uint32_t tilesY = std::min(image.getTilesY(), mask.getTilesY());
+                std::vector<uint32_t> tiles;
+                for (uint32_t ty = 0; ty < tilesY; ++ty) {
+                    for (uint32_t tx = 0; tx < tilesX; ++tx) {
+                        if (!mask.isTileEmpty(tx, ty)) {
+                            tiles.push_back(ty * tilesX + tx);
+                            touched.merge({tx, ty, tx + 1, ty + 1});
+                        }
+                    }
+                }
+
+                Jobs::JobSystem::getInstance().parallelFor(tiles.size(), [&](size_t i) {
+                    const uint32_t tx = tiles[i] % tilesX;
+                    const uint32_t ty = tiles[i] / tilesX;
+                    const bool full = mask.isTileFull(tx, ty);
+
+                    // A full mask over a flat tile, or painting opaque, gives a flat tile: blend one pixel
+                    const Tile* existing = image.getTile(tx, ty);
+                    if (full && (!existing || existing->isUniform() || scale == 255)) {
+                        uint8_t pixel[16] = {};
+                        if (existing && existing->isUniform()) {
+                            std::memcpy(pixel, existing->getUniformPixel(), bpp);
+                        }
+                        const uint8_t coverage = static_cast<uint8_t>(scale);
+                        blend(pixel, &coverage, 1);
+                        image.fillTile(tx, ty, pixel);
+                        return;
+                    }
+
+                    const uint32_t validWidth = std::min(TILE_SIZE, image.getWidth() - tx * TILE_SIZE);
+                    const uint32_t validHeight = std::min(TILE_SIZE, image.getHeight() - ty * TILE_SIZE);
+                    const uint8_t* coverage = mask.getTile(tx, ty);
+                    Tile& tile = image.getTileForWrite(tx, ty);
+                    uint8_t rowCoverage[TILE_SIZE];
+                    for (uint32_t y = 0; y < validHeight; ++y) {
+                        const uint8_t* source = coverage + y * TILE_SIZE;
+                        for (uint32_t x = 0; x < validWidth; ++x) {
+                            rowCoverage[x] = static_cast<uint8_t>(div255(source[x] * scale));
+                        }
+                        blend(tile.getData() + static_cast<size_t>(y) * TILE_SIZE * bpp, rowCoverage, validWidth);
+                    }
+                }, FILL_GRAIN);
+                return touched;
+            }
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "2D/Image/TiledImage.h"
+#include "2D/Image/TiledMask.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+
+namespace AstralEngine {
+    namespace D2 {
+        struct FillOptions {
+            // Largest per-channel difference from the seed pixel that still fills, 0-1
+            float tolerance = 0.0f;
+            // Soften the region's edge by half a pixel so fills meet line art without a gap
+            bool antiAlias = true;
+            // Only the region connected to the seed; otherwise every matching pixel of the image
+            bool contiguous = true;
+        };
+
+        /**
+         * @brief Bucket fill over tiled pixels
+         *
+         * The region is grown with a span-based scanline fill inside each tile. Tiles are
+         * processed in waves on the job system: every tile reached by the previous wave
+         * fills from the pixels its neighbors handed over and passes its own border spans
+         * on, until no tile receives anything new. A tile is compared against the seed
+         * color the first time the fill reaches it, with AVX2/SSE kernels; missing and
+         * uniform tiles are decided from a single pixel and filled as a whole, so large
+         * flat areas cost a few operations per tile rather than per pixel.
+         *
+         * Without `contiguous` there is nothing to grow: every tile is compared in one
+         * parallel pass and its matches become the region as they are.
+         *
+         * Colors match when no premultiplied channel differs from the seed pixel by more
+         * than the tolerance, measured in the image's own encoding.
+         */
+        namespace FloodFill {
+            // Coverage of the 4-connected region around (x, y) that matches that pixel's color,
+            // or of all pixels matching it if the options are not contiguous
+            TiledMask computeMask(const TiledImage& source, uint32_t x, uint32_t y, const FillOptions& options);
+
+            /**
+             * Paints `color` (straight sRGB) source-over onto `image` through `mask` and returns
+             * the tiles it modified. Fully covered tiles over missing or uniform ones stay uniform.
+             */
+            TileRect fillMask(TiledImage& image, const TiledMask& mask, const glm::vec4& color, float opacity = 1.0f);
+
+            // matches[i] = 1 if pixel i is within `tolerance` of `seed` (one pixel of `format`), else 0
+            void matchRow(PixelFormat format, const uint8_t* row, uint32_t count, const uint8_t* seed,
+                          float tolerance, uint8_t* matches);
+        }
+    }
+}
@@ -0,0 +1,596 @@
+#include "2D/Image/MaskOps.h"
+#include "2D/Image/Simd.h"
+#include "Core/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            // Tiles per job for the per-tile passes
+            constexpr size_t MASK_GRAIN = 8;
+
+            // (x + 127) / 255 for x in [0, 255 * 255]
+            inline uint32_t div255(uint32_t x) {
+                x += 128;
+                return (x + (x >> 8)) >> 8;
+            }
+
+            struct MaxOp {
+#if defined(AE_SIMD_AVX2)
+                static AE_FORCE_INLINE __m256i apply(__m256i a, __m256i b) { return _mm256_max_epu8(a, b); }
+#endif
+#if defined(AE_SIMD_SSE2)
+                static AE_FORCE_INLINE __m128i apply(__m128i a, __m128i b) { return _mm_max_epu8(a, b); }
+#endif
+                static AE_FORCE_INLINE uint8_t apply(uint8_t a, uint8_t b) { return std::max(a, b); }
+            };
+
+            struct MinOp {
+#if defined(AE_SIMD_AVX2)
+                static AE_FORCE_INLINE __m256i apply(__m256i a, __m256i b) { return _mm256_min_epu8(a, b); }
+#endif
+#if defined(AE_SIMD_SSE2)
+                static AE_FORCE_INLINE __m128i apply(__m128i a, __m128i b) { return _mm_min_epu8(a, b); }
+#endif
+                static AE_FORCE_INLINE uint8_t apply(uint8_t a, uint8_t b) { return std::min(a, b); }
+            };
+
+            struct SubtractOp {
+#if defined(AE_SIMD_AVX2)
+                static AE_FORCE_INLINE __m256i apply(__m256i a, __m256i b) {
+                    return _mm256_min_epu8(a, _mm256_xor_si256(b, _mm256_set1_epi8(-1)));
+                }
+#endif
+#if defined(AE_SIMD_SSE2)
+                static AE_FORCE_INLINE __m128i apply(__m128i a, __m128i b) {
+                    return _mm_min_epu8(a, _mm_xor_si128(b, _mm_set1_epi8(-1)));
+                }
+#endif
+                static AE_FORCE_INLINE uint8_t apply(uint8_t a, uint8_t b) { return std::min<uint8_t>(a, 255 - b); }
+            };
+
+            struct MultiplyOp {
+#if defined(AE_SIMD_AVX2)
+                static AE_FORCE_INLINE __m256i apply(__m256i a, __m256i b) {
+                    const __m256i zero = _mm256_setzero_si256();
+                    const __m256i bias = _mm256_set1_epi16(128);
+                    __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero)), bias);
+                    __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero)), bias);
+                    lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+                    hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+                    return _mm256_packus_epi16(lo, hi);
+                }
+#endif
+#if defined(AE_SIMD_SSE2)
+                static AE_FORCE_INLINE __m128i apply(__m128i a, __m128i b) {
+                    const __m128i zero = _mm_setzero_si128();
+                    const __m128i bias = _mm_set1_epi16(128);
+                    __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)), bias);
+                    __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)), bias);
+                    lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+                    hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+                    return _mm_packus_epi16(lo, hi);
+                }
+#endif
+                static AE_FORCE_INLINE uint8_t apply(uint8_t a, uint8_t b) { return static_cast<uint8_t>(div255(uint32_t(a) * b)); }
+            };
+
+            /**
+             * dst[i] = Op(a[i], b[i]). `dst` may alias `a` as long as `b` reads at or ahead of
+             * it, which lets the window passes combine a buffer with a shifted view of itself.
+             */
+            template <typename Op>
+            void applyRows(uint8_t* dst, const uint8_t* a, const uint8_t* b, size_t count) {
+                size_t i = 0;
+#if defined(AE_SIMD_AVX2)
+                for (; i + 32 <= count; i += 32) {
+                    const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+                    const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), Op::apply(va, vb));
+                }
+#endif
+#if defined(AE_SIMD_SSE2)
+                for (; i + 16 <= count; i += 16) {
+                    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+                    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), Op::apply(va, vb));
+                }
+#endif
+                for (; i < count; ++i) {
+                    dst[i] = Op::apply(a[i], b[i]);
+                }
+            }
+
+            enum class RegionState : uint8_t {
+                Empty,
+                Full,
+                Mixed
+            };
+
+            // State of the pixels in [x0, x1) x [y0, y1); pixels past the mask read `outside`
+            RegionState getRegionState(const TiledMask& mask, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint8_t outside) {
+                const int32_t width = static_cast<int32_t>(mask.getWidth());
+                const int32_t height = static_cast<int32_t>(mask.getHeight());
+                bool empty = false, full = false;
+                if (x0 < 0 || y0 < 0 || x1 > width || y1 > height) {
+                    (outside == 0 ? empty : full) = true;
+                }
+                const int32_t tx0 = std::max(x0, 0) / static_cast<int32_t>(TILE_SIZE);
+                const int32_t ty0 = std::max(y0, 0) / static_cast<int32_t>(TILE_SIZE);
+                const int32_t tx1 = (std::min(x1, width) + static_cast<int32_t>(TILE_SIZE) - 1) / static_cast<int32_t>(TILE_SIZE);
+                const int32_t ty1 = (std::min(y1, height) + static_cast<int32_t>(TILE_SIZE) - 1) / static_cast<int32_t>(TILE_SIZE);
+                for (int32_t ty = ty0; ty < ty1; ++ty) {
+                    for (int32_t tx = tx0; tx < tx1; ++tx) {
+                        if (mask.isTileEmpty(tx, ty)) {
+                            empty = true;
+                        } else if (mask.isTileFull(tx, ty)) {
+                            full = true;
+                        } else {
+                            return RegionState::Mixed;
+                        }
+                        if (empty && full) {
+                            return RegionState::Mixed;
+                        }
+                    }
+                }
+                return full ? RegionState::Full : RegionState::Empty;
+            }
+
+            // Copies a size x size block at (x0, y0) into `buffer`; pixels past the mask read `outside`
+            void gather(const TiledMask& mask, int32_t x0, int32_t y0, uint32_t size, uint8_t outside, uint8_t* buffer) {
+                std::memset(buffer, outside, static_cast<size_t>(size) * size);
+                const int32_t cx0 = std::max(x0, 0);
+                const int32_t cy0 = std::max(y0, 0);
+                const int32_t cx1 = std::min(x0 + static_cast<int32_t>(size), static_cast<int32_t>(mask.getWidth()));
+                const int32_t cy1 = std::min(y0 + static_cast<int32_t>(size), static_cast<int32_t>(mask.getHeight()));
+                for (int32_t tileY = cy0 - cy0 % static_cast<int32_t>(TILE_SIZE); tileY < cy1; tileY += TILE_SIZE) {
+                    for (int32_t tileX = cx0 - cx0 % static_cast<int32_t>(TILE_SIZE); tileX < cx1; tileX += TILE_SIZE) {
+                        const uint8_t* tile = mask.getTile(tileX / TILE_SIZE, tileY / TILE_SIZE);
+                        const int32_t bx0 = std::max(cx0, tileX), bx1 = std::min(cx1, tileX + static_cast<int32_t>(TILE_SIZE));
+                        const int32_t by0 = std::max(cy0, tileY), by1 = std::min(cy1, tileY + static_cast<int32_t>(TILE_SIZE));
+                        for (int32_t y = by0; y < by1; ++y) {
+                            uint8_t* dst = buffer + static_cast<size_t>(y - y0) * size + (bx0 - x0);
+                            if (tile) {
+                                std::memcpy(dst, tile + (y - tileY) * TILE_SIZE + (bx0 - tileX), bx1 - bx0);
+                            } else {
+                                std::memset(dst, 0, bx1 - bx0);
+                            }
+                        }
+                    }
+                }
+            }
+
+            /**
+             * Replaces `buffer` with Op over a window of 2 * radius + 1 samples `stride` apart.
+             * Windows of 2^k samples are built in place by doubling, then two overlapping
+             * ones cover the full window. Results closer than `radius` to the buffer's ends
+             * are not meaningful; callers keep that much halo.
+             */
+            template <typename Op>
+            void windowPass(std::vector<uint8_t>& buffer, std::vector<uint8_t>& scratch, size_t stride, uint32_t radius) {
+                const size_t total = buffer.size();
+                const uint32_t window = 2 * radius + 1;
+                uint32_t span = 1;
+                while (span * 2 <= window) {
+                    applyRows<Op>(buffer.data(), buffer.data(), buffer.data() + span * stride, total - span * stride);
+                    span *= 2;
+                }
+                const size_t offset = radius * stride;
+                const size_t overlap = (window - span) * stride;
+                std::memcpy(scratch.data(), buffer.data(), offset);
+                applyRows<Op>(scratch.data() + offset, buffer.data(), buffer.data() + overlap, total - offset);
+                buffer.swap(scratch);
+            }
+
+            // Vertical box blur of 2 * radius + 1 rows over every column; rows past the buffer count as 0
+            void boxBlurColumns(const uint8_t* src, uint8_t* dst, uint32_t size, uint32_t radius, std::vector<uint32_t>& sums) {
+                sums.assign(size, 0);
+                for (uint32_t y = 0; y <= radius && y < size; ++y) {
+                    for (uint32_t x = 0; x < size; ++x) {
+                        sums[x] += src[static_cast<size_t>(y) * size + x];
+                    }
+                }
+                const float scale = 1.0f / static_cast<float>(2 * radius + 1);
+                for (uint32_t y = 0; y < size; ++y) {
+                    uint8_t* out = dst + static_cast<size_t>(y) * size;
+                    const uint8_t* add = y + radius + 1 < size ? src + static_cast<size_t>(y + radius + 1) * size : nullptr;
+                    const uint8_t* sub = y >= radius ? src + static_cast<size_t>(y - radius) * size : nullptr;
+                    uint32_t x = 0;
+#if defined(AE_SIMD_AVX2)
+                    const __m256 vscale = _mm256_set1_ps(scale);
+                    const __m256 half = _mm256_set1_ps(0.5f);
+                    for (; x + 8 <= size; x += 8) {
+                        __m256i sum = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sums.data() + x));
+                        const __m256 value = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(sum), vscale), half);
+                        const __m256i rounded = _mm256_cvttps_epi32(value);
+                        const __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(rounded), _mm256_extracti128_si256(rounded, 1));
+                        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(words, words));
+                        if (add) {
+                            sum = _mm256_add_epi32(sum, _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(add + x))));
+                        }
+                        if (sub) {
+                            sum = _mm256_sub_epi32(sum, _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(sub + x))));
+                        }
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(sums.data() + x), sum);
+                    }
+#endif
+                    for (; x < size; ++x) {
+                        out[x] = static_cast<uint8_t>(static_cast<float>(sums[x]) * scale + 0.5f);
+                        sums[x] += (add ? add[x] : 0) - (sub ? sub[x] : 0);
+                    }
+                }
+            }
+
+            // Square transpose in 8x8 blocks
+            void transpose(const uint8_t* src, uint8_t* dst, uint32_t size) {
+                constexpr uint32_t BLOCK = 8;
+                for (uint32_t by = 0; by < size; by += BLOCK) {
+                    for (uint32_t bx = 0; bx < size; bx += BLOCK) {
+                        const uint32_t ey = std::min(by + BLOCK, size), ex = std::min(bx + BLOCK, size);
+                        for (uint32_t y = by; y < ey; ++y) {
+                            for (uint32_t x = bx; x < ex; ++x) {
+                                dst[static_cast<size_t>(x) * size + y] = src[static_cast<size_t>(y) * size + x];
+                            }
+                        }
+                    }
+                }
+            }
+
+            /**
+             * Runs `filter` over every tile whose neighborhood within `halo` pixels is mixed.
+             * `filter(buffer, scratch, size, tile)` gets the tile plus halo in `buffer` and
+             * writes the tile's new coverage. With `spreads`, empty tiles near covered ones
+             * are candidates too (the filter can move coverage into them).
+             */
+            template <typename Filter>
+            TiledMask filterTiles(const TiledMask& mask, uint32_t halo, uint8_t outside, bool spreads, Filter&& filter) {
+                TiledMask result(mask.getWidth(), mask.getHeight());
+                const uint32_t tilesX = mask.getTilesX();
+                const uint32_t tilesY = mask.getTilesY();
+                const uint32_t reach = spreads ? (halo + TILE_SIZE - 1) / TILE_SIZE : 0;
+
+                std::vector<uint8_t> candidate(mask.getTileCount(), 0);
+                for (uint32_t ty = 0; ty < tilesY; ++ty) {
+                    for (uint32_t tx = 0; tx < tilesX; ++tx) {
+                        if (mask.isTileEmpty(tx, ty)) {
+                            continue;
+                        }
+                        const uint32_t y1 = std::min(ty + reach + 1, tilesY), x1 = std::min(tx + reach + 1, tilesX);
+                        for (uint32_t ny = ty > reach ? ty - reach : 0; ny < y1; ++ny) {
+                            for (uint32_t nx = tx > reach ? tx - reach : 0; nx < x1; ++nx) {
+                                candidate[ny * tilesX + nx] = 1;
+                            }
+                        }
+                    }
+                }
+                std::vector<uint32_t> tiles;
+                for (uint32_t index = 0; index < candidate.size(); ++index) {
+                    if (candidate[index]) {
+                        tiles.push_back(index);
+                    }
+                }
+
+                const uint32_t size = TILE_SIZE + 2 * halo;
+                Jobs::JobSystem::getInstance().parallelFor(tiles.size(), [&](size_t i) {
+                    const uint32_t tx = tiles[i] % tilesX;
+                    const uint32_t ty = tiles[i] / tilesX;
+                    const int32_t x0 = static_cast<int32_t>(tx * TILE_SIZE) - static_cast<int32_t>(halo);
+                    const int32_t y0 = static_cast<int32_t>(ty * TILE_SIZE) - static_cast<int32_t>(halo);
+                    switch (getRegionState(mask, x0, y0, x0 + static_cast<int32_t>(size), y0 + static_cast<int32_t>(size), outside)) {
+                        case RegionState::Empty:
+                            return;
+                        case RegionState::Full:
+                            result.setTileFull(tx, ty);
+                            return;
+                        case RegionState::Mixed:
+                            break;
+                    }
+
+                    std::vector<uint8_t> buffer(static_cast<size_t>(size) * size);
+                    std::vector<uint8_t> scratch(buffer.size());
+                    gather(mask, x0, y0, size, outside, buffer.data());
+                    MaskTile coverage;
+                    filter(buffer, scratch, size, coverage.data());
+                    if (std::all_of(coverage.begin(), coverage.end(), [](uint8_t value) { return value == 0; })) {
+                        return;
+                    }
+                    std::memcpy(result.getTileForWrite(tx, ty), coverage.data(), TILE_PIXELS);
+                    result.compactTile(tx, ty);
+                }, MASK_GRAIN);
+                return result;
+            }
+
+            // Copies the TILE_SIZE square at (halo, halo) out of a filtered buffer
+            void extractTile(const std::vector<uint8_t>& buffer, uint32_t size, uint32_t halo, uint8_t* tile) {
+                for (uint32_t y = 0; y < TILE_SIZE; ++y) {
+                    std::memcpy(tile + y * TILE_SIZE, buffer.data() + static_cast<size_t>(y + halo) * size + halo, TILE_SIZE);
+                }
+            }
+
+            template <typename Op>
+            TiledMask morphology(const TiledMask& mask, uint32_t radius, uint8_t outside, bool spreads) {
+                return filterTiles(mask, radius, outside, spreads, [radius](std::vector<uint8_t>& buffer, std::vector<uint8_t>& scratch, uint32_t size, uint8_t* tile) {
+                    windowPass<Op>(buffer, scratch, 1, radius);
+                    windowPass<Op>(buffer, scratch, size, radius);
+                    extractTile(buffer, size, radius, tile);
+                });
+            }
+
+            enum class TileState : uint8_t {
+                Empty,
+                Full,
+                Partial
+            };
+        }
+
+        namespace MaskOps {
+            void combineRow(MaskCombine mode, uint8_t* target, const uint8_t* source, uint32_t count) {
+                switch (mode) {
+                    case MaskCombine::Replace:
+                        std::memcpy(target, source, count);
+                        break;
+                    case MaskCombine::Union:
+                        applyRows<MaxOp>(target, target, source, count);
+                        break;
+                    case MaskCombine::Subtract:
+                        applyRows<SubtractOp>(target, target, source, count);
+                        break;
+                    case MaskCombine::Intersect:
+                        applyRows<MinOp>(target, target, source, count);
+                        break;
+                }
+            }
+
+            void multiplyRow(uint8_t* coverage, const uint8_t* mask, uint32_t count) {
+                applyRows<MultiplyOp>(coverage, coverage, mask, count);
+            }
+
+            void combine(TiledMask& target, const TiledMask& source, MaskCombine mode) {
+                if (target.getTilesX() != source.getTilesX() || target.getTilesY() != source.getTilesY()) {
+                    return;
+                }
+                const uint32_t tilesX = target.getTilesX();
+                Jobs::JobSystem::getInstance().parallelFor(target.getTileCount(), [&](size_t index) {
+                    const uint32_t tx = static_cast<uint32_t>(index) % tilesX;
+                    const uint32_t ty = static_cast<uint32_t>(index) / tilesX;
+                    const bool sourceEmpty = source.isTileEmpty(tx, ty), sourceFull = source.isTileFull(tx, ty);
+                    const bool targetEmpty = target.isTileEmpty(tx, ty), targetFull = target.isTileFull(tx, ty);
+
+                    // Decide from the tile states where possible; only edge tiles meet byte by byte
+                    switch (mode) {
+                        case MaskCombine::Replace:
+                            target.shareTile(source, tx, ty);
+                            return;
+                        case MaskCombine::Union:
+                            if (sourceEmpty || targetFull) {
+                                return;
+                            }
+                            if (sourceFull || targetEmpty) {
+                                target.shareTile(source, tx, ty);
+                                return;
+                            }
+                            break;
+                        case MaskCombine::Subtract:
+                            if (sourceEmpty || targetEmpty) {
+                                return;
+                            }
+                            if (sourceFull) {
+                                target.clearTile(tx, ty);
+                                return;
+                            }
+                            break;
+                        case MaskCombine::Intersect:
+                            if (sourceFull || targetEmpty) {
+                                return;
+                            }
+                            if (sourceEmpty || targetFull) {
+                                target.shareTile(source, tx, ty);
+                                return;
+                            }
+                            break;
+                    }
+                    combineRow(mode, target.getTileForWrite(tx, ty), source.getTile(tx, ty), TILE_PIXELS);
+                    target.compactTile(tx, ty);
+                }, MASK_GRAIN);
+            }
+
+            void invert(TiledMask& mask) {
+                const uint32_t tilesX = mask.getTilesX();
+                Jobs::JobSystem::getInstance().parallelFor(mask.getTileCount(), [&](size_t index) {
+                    const uint32_t tx = static_cast<uint32_t>(index) % tilesX;
+                    const uint32_t ty = static_cast<uint32_t>(index) / tilesX;
+                    if (mask.isTileEmpty(tx, ty)) {
+                        mask.setTileFull(tx, ty);
+                    } else if (mask.isTileFull(tx, ty)) {
+                        mask.clearTile(tx, ty);
+                    } else {
+                        // 255 - x == min(255, 255 - x)
+                        static const MaskTile s_full = [] { MaskTile tile; tile.fill(255); return tile; }();
+                        uint8_t* coverage = mask.getTileForWrite(tx, ty);
+                        applyRows<SubtractOp>(coverage, s_full.data(), coverage, TILE_PIXELS);
+                    }
+                }, MASK_GRAIN);
+            }
+
+            void fillRect(TiledMask& mask, int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+                x0 = std::max(x0, 0);
+                y0 = std::max(y0, 0);
+                x1 = std::min(x1, static_cast<int32_t>(mask.getWidth()));
+                y1 = std::min(y1, static_cast<int32_t>(mask.getHeight()));
+                if (x0 >= x1 || y0 >= y1) {
+                    return;
+                }
+                const int32_t tileSize = static_cast<int32_t>(TILE_SIZE);
+                for (int32_t tileY = y0 - y0 % tileSize; tileY < y1; tileY += tileSize) {
+                    for (int32_t tileX = x0 - x0 % tileSize; tileX < x1; tileX += tileSize) {
+                        const uint32_t tx = static_cast<uint32_t>(tileX / tileSize), ty = static_cast<uint32_t>(tileY / tileSize);
+                        const int32_t bx0 = std::max(x0, tileX), bx1 = std::min(x1, tileX + tileSize);
+                        const int32_t by0 = std::max(y0, tileY), by1 = std::min(y1, tileY + tileSize);
+                        if (mask.isTileFull(tx, ty)) {
+                            continue;
+                        }
+                        // Tiles cut by the image edge count as covered once every pixel inside is
+                        const bool coversTile = bx0 == tileX && by0 == tileY &&
+                                                (bx1 == tileX + tileSize || bx1 == static_cast<int32_t>(mask.getWidth())) &&
+                                                (by1 == tileY + tileSize || by1 == static_cast<int32_t>(mask.getHeight()));
+                        if (coversTile) {
+                            mask.setTileFull(tx, ty);
+                            continue;
+                        }
+                        uint8_t* coverage = mask.getTileForWrite(tx, ty);
+                        for (int32_t y = by0; y < by1; ++y) {
+                            std::memset(coverage + (y - tileY) * tileSize + (bx0 - tileX), 255, bx1 - bx0);
+                        }
+                        mask.compactTile(tx, ty);
+                    }
+                }
+            }
+
+            TiledMask grow(const TiledMask& mask, uint32_t radius) {
+                if (radius == 0) {
+                    return mask;
+                }
+                return morphology<MaxOp>(mask, radius, 0, true);
+            }
+
+            TiledMask shrink(const TiledMask& mask, uint32_t radius) {
+                if (radius == 0) {
+                    return mask;
+                }
+                return morphology<MinOp>(mask, radius, 255, false);
+            }
+
+            TiledMask feather(const TiledMask& mask, float radius) {
+                // Three box passes of width 2b + 1 have the variance of a Gaussian with sigma = radius
+                const float sigma = std::max(radius, 0.0f);
+                const uint32_t box = static_cast<uint32_t>(std::lround((std::sqrt(4.0f * sigma * sigma + 1.0f) - 1.0f) * 0.5f));
+                if (box == 0) {
+                    return mask;
+                }
+                const uint32_t halo = 3 * box;
+                return filterTiles(mask, halo, 0, true, [box, halo](std::vector<uint8_t>& buffer, std::vector<uint8_t>& scratch, uint32_t size, uint8_t* tile) {
+                    std::vector<uint32_t> sums;
+                    for (int pass = 0; pass < 3; ++pass) {
+                        boxBlurColumns(buffer.data(), scratch.data(), size, box, sums);
+                        buffer.swap(scratch);
+                    }
+                    // Rows become columns, so the same kernel blurs horizontally
+                    transpose(buffer.data(), scratch.data(), size);
+                    buffer.swap(scratch);
+                    for (int pass = 0; pass < 3; ++pass) {
+                        boxBlurColumns(buffer.data(), scratch.data(), size, box, sums);
+                        buffer.swap(scratch);
+                    }
+                    for (uint32_t y = 0; y < TILE_SIZE; ++y) {
+                        for (uint32_t x = 0; x < TILE_SIZE; ++x) {
+                            tile[y * TILE_SIZE + x] = buffer[static_cast<size_t>(x + halo) * size + y + halo];
+                        }
+                    }
+                });
+            }
+
+            std::vector<MaskSegment> traceOutline(const TiledMask& mask) {
+                const uint32_t tilesX = mask.getTilesX();
+                const uint32_t tilesY = mask.getTilesY();
+                auto stateOf = [&](int64_t tx, int64_t ty) {
+                    if (tx < 0 || ty < 0 || tx >= tilesX || ty >= tilesY) {
+                        return TileState::Empty;
+                    }
+                    if (mask.isTileEmpty(static_cast<uint32_t>(tx), static_cast<uint32_t>(ty))) {
+                        return TileState::Empty;
+                    }
+                    return mask.isTileFull(static_cast<uint32_t>(tx), static_cast<uint32_t>(ty)) ? TileState::Full : TileState::Partial;
+                };
+
+                // The outline only passes through partial tiles and tiles next to a different state
+                std::vector<uint32_t> tiles;
+                for (uint32_t ty = 0; ty < tilesY; ++ty) {
+                    for (uint32_t tx = 0; tx < tilesX; ++tx) {
+                        const TileState state = stateOf(tx, ty);
+                        if (state == TileState::Partial ||
+                            stateOf(int64_t(tx) - 1, ty) != state || stateOf(int64_t(tx) + 1, ty) != state ||
+                            stateOf(tx, int64_t(ty) - 1) != state || stateOf(tx, int64_t(ty) + 1) != state) {
+                            tiles.push_back(ty * tilesX + tx);
+                        }
+                    }
+                }
+
+                // Each tile traces the edges on the right and bottom of its pixels, plus the canvas's left and top edges
+                std::vector<std::vector<MaskSegment>> tileSegments(tiles.size());
+                Jobs::JobSystem::getInstance().parallelFor(tiles.size(), [&](size_t i) {
+                    const uint32_t tx = tiles[i] % tilesX;
+                    const uint32_t ty = tiles[i] / tilesX;
+                    const int32_t originX = static_cast<int32_t>(tx * TILE_SIZE);
+                    const int32_t originY = static_cast<int32_t>(ty * TILE_SIZE);
+                    const uint32_t validWidth = std::min(TILE_SIZE, mask.getWidth() - tx * TILE_SIZE);
+                    const uint32_t validHeight = std::min(TILE_SIZE, mask.getHeight() - ty * TILE_SIZE);
+
+                    constexpr uint32_t SIZE = TILE_SIZE + 1;
+                    uint8_t coverage[SIZE * SIZE];
+                    gather(mask, originX, originY, SIZE, 0, coverage);
+                    auto inside = [&](uint32_t x, uint32_t y) { return coverage[y * SIZE + x] >= 128; };
+
+                    std::vector<MaskSegment>& segments = tileSegments[i];
+                    for (uint32_t y = 0; y < validHeight; ++y) {
+                        const int32_t edgeY = originY + static_cast<int32_t>(y) + 1;
+                        bool open = false;
+                        for (uint32_t x = 0; x <= validWidth; ++x) {
+                            const bool edge = x < validWidth && inside(x, y) != inside(x, y + 1);
+                            if (edge && !open) {
+                                segments.push_back({originX + static_cast<int32_t>(x), edgeY, 0, edgeY});
+                            } else if (!edge && open) {
+                                segments.back().x1 = originX + static_cast<int32_t>(x);
+                            }
+                            open = edge;
+                        }
+                    }
+                    for (uint32_t x = 0; x < validWidth; ++x) {
+                        const int32_t edgeX = originX + static_cast<int32_t>(x) + 1;
+                        bool open = false;
+                        for (uint32_t y = 0; y <= validHeight; ++y) {
+                            const bool edge = y < validHeight && inside(x, y) != inside(x + 1, y);
+                            if (edge && !open) {
+                                segments.push_back({edgeX, originY + static_cast<int32_t>(y), edgeX, 0});
+                            } else if (!edge && open) {
+                                segments.back().y1 = originY + static_cast<int32_t>(y);
+                            }
+                            open = edge;
+                        }
+                    }
+                    if (ty == 0) {
+                        bool open = false;
+                        for (uint32_t x = 0; x <= validWidth; ++x) {
+                            const bool edge = x < validWidth && inside(x, 0);
+                            if (edge && !open) {
+                                segments.push_back({originX + static_cast<int32_t>(x), 0, 0, 0});
+                            } else if (!edge && open) {
+                                segments.back().x1 = originX + static_cast<int32_t>(x);
+                            }
+                            open = edge;
+                        }
+                    }
+                    if (tx == 0) {
+                        bool open = false;
+                        for (uint32_t y = 0; y <= validHeight; ++y) {
+                            const bool edge = y < validHeight && inside(0, y);
+                            if (edge && !open) {
+                                segments.push_back({0, originY + static_cast<int32_t>(y), 0, 0});
+                            } else if (!edge && open) {
+                                segments.back().y1 = originY + static_cast<int32_t>(y);
+                            }
+                            open = edge;
+                        }
+                    }
+                }, MASK_GRAIN);
+
+                std::vector<MaskSegment> outline;
+                for (const auto& segments : tileSegments) {
+                    outline.insert(outline.end(), segments.begin(), segments.end());
+                }
+                return outline;
+            }
+        }
+    }
+}
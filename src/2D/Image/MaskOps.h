@@ -0,0 +1,57 @@
+#pragma once
+
+#include "2D/Image/TiledMask.h"
+#include <cstdint>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        // How a new mask is merged into an existing one
+        enum class MaskCombine : uint8_t {
+            Replace,
+            Union,     // max(a, b)
+            Subtract,  // min(a, 255 - b)
+            Intersect  // min(a, b)
+        };
+
+        // Outline edge between a covered and an uncovered pixel, in pixel-corner coordinates
+        struct MaskSegment {
+            int32_t x0, y0, x1, y1;
+        };
+
+        /**
+         * @brief Tile operations on coverage masks
+         *
+         * Every operation first looks at the empty/full state of the tiles involved, so
+         * only tiles along a mask's edge are touched byte by byte; those run 32 pixels per
+         * step on AVX2 and 16 on SSE2. Tiles are processed in parallel on the job system.
+         *
+         * Neighborhood filters (grow, shrink, feather) read a halo around each tile from the
+         * neighboring tiles. A tile whose whole neighborhood is empty or full is decided
+         * without filtering. Grow and shrink use a square window built from log2(window)
+         * max/min passes; feather approximates a Gaussian with three box blurs per axis.
+         */
+        namespace MaskOps {
+            // Merges `source` into `target`; both masks must have the same size
+            void combine(TiledMask& target, const TiledMask& source, MaskCombine mode);
+            void invert(TiledMask& mask);
+
+            // Covers the pixel rectangle [x0, x1) x [y0, y1), clipped to the mask
+            void fillRect(TiledMask& mask, int32_t x0, int32_t y0, int32_t x1, int32_t y1);
+
+            // Morphological dilation/erosion by `radius` pixels; shrinking treats the canvas edge as covered
+            TiledMask grow(const TiledMask& mask, uint32_t radius);
+            TiledMask shrink(const TiledMask& mask, uint32_t radius);
+            // Blurs coverage with a Gaussian of standard deviation `radius`
+            TiledMask feather(const TiledMask& mask, float radius);
+
+            // Edges where coverage crosses 50%, traced only in tiles that contain one
+            std::vector<MaskSegment> traceOutline(const TiledMask& mask);
+
+            // Row kernels
+            void combineRow(MaskCombine mode, uint8_t* target, const uint8_t* source, uint32_t count);
+            // coverage = coverage * mask / 255, rounded
+            void multiplyRow(uint8_t* coverage, const uint8_t* mask, uint32_t count);
+        }
+    }
+}
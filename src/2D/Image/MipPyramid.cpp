@@ -0,0 +1,291 @@
+#include "2D/Image/MipPyramid.h"
+#include "2D/Image/Simd.h"
+#include "Core/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            // Tiles per job; reducing a tile is a few microseconds
+            constexpr size_t REDUCE_GRAIN = 8;
+            constexpr uint32_t HALF_TILE = TILE_SIZE / 2;
+
+            // Rounded average of four pixels, one channel at a time
+            inline void reducePixel(PixelFormat format, const uint8_t* a, const uint8_t* b,
+                                    const uint8_t* c, const uint8_t* d, uint8_t* dst) {
+                switch (format) {
+                    case PixelFormat::RGBA8:
+                        for (int i = 0; i < 4; ++i) {
+                            dst[i] = static_cast<uint8_t>((a[i] + b[i] + c[i] + d[i] + 2) >> 2);
+                        }
+                        break;
+                    case PixelFormat::RGBA16: {
+                        uint16_t pa[4], pb[4], pc[4], pd[4], out[4];
+                        std::memcpy(pa, a, 8);
+                        std::memcpy(pb, b, 8);
+                        std::memcpy(pc, c, 8);
+                        std::memcpy(pd, d, 8);
+                        for (int i = 0; i < 4; ++i) {
+                            out[i] = static_cast<uint16_t>((uint32_t(pa[i]) + pb[i] + pc[i] + pd[i] + 2) >> 2);
+                        }
+                        std::memcpy(dst, out, 8);
+                        break;
+                    }
+                    case PixelFormat::RGBA32F: {
+                        float pa[4], pb[4], pc[4], pd[4], out[4];
+                        std::memcpy(pa, a, 16);
+                        std::memcpy(pb, b, 16);
+                        std::memcpy(pc, c, 16);
+                        std::memcpy(pd, d, 16);
+                        for (int i = 0; i < 4; ++i) {
+                            out[i] = (pa[i] + pb[i] + pc[i] + pd[i]) * 0.25f;
+                        }
+                        std::memcpy(dst, out, 16);
+                        break;
+                    }
+                }
+            }
+
+#if defined(AE_SIMD_SSE2)
+            // Reduces 8 source pixels of two rows to 4 RGBA8 pixels
+            AE_FORCE_INLINE __m128i reduce4(const uint8_t* row0, const uint8_t* row1) {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i bias = _mm_set1_epi16(2);
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 16));
+                __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1));
+                __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 16));
+
+                // Vertical sums, two pixels per register as 16-bit channels
+                __m128i s01 = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(c, zero));
+                __m128i s23 = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(c, zero));
+                __m128i s45 = _mm_add_epi16(_mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(d, zero));
+                __m128i s67 = _mm_add_epi16(_mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(d, zero));
+
+                // Horizontal pair sums land in the low half of each register
+                s01 = _mm_add_epi16(s01, _mm_srli_si128(s01, 8));
+                s23 = _mm_add_epi16(s23, _mm_srli_si128(s23, 8));
+                s45 = _mm_add_epi16(s45, _mm_srli_si128(s45, 8));
+                s67 = _mm_add_epi16(s67, _mm_srli_si128(s67, 8));
+
+                __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s01, s23), bias), 2);
+                __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s45, s67), bias), 2);
+                return _mm_packus_epi16(lo, hi);
+            }
+#endif
+
+#if defined(AE_SIMD_AVX2)
+            // Reduces 16 source pixels of two rows to 8 RGBA8 pixels
+            AE_FORCE_INLINE __m256i reduce8(const uint8_t* row0, const uint8_t* row1) {
+                const __m256i zero = _mm256_setzero_si256();
+                const __m256i bias = _mm256_set1_epi16(2);
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + 32));
+                __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1));
+                __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + 32));
+
+                // Per 128-bit lane this is reduce4(); lanes hold pixels 0-3 and 4-7 of each load
+                __m256i sA = _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(c, zero));
+                __m256i sB = _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(c, zero));
+                __m256i sC = _mm256_add_epi16(_mm256_unpacklo_epi8(b, zero), _mm256_unpacklo_epi8(d, zero));
+                __m256i sD = _mm256_add_epi16(_mm256_unpackhi_epi8(b, zero), _mm256_unpackhi_epi8(d, zero));
+
+                sA = _mm256_add_epi16(sA, _mm256_srli_si256(sA, 8));
+                sB = _mm256_add_epi16(sB, _mm256_srli_si256(sB, 8));
+                sC = _mm256_add_epi16(sC, _mm256_srli_si256(sC, 8));
+                sD = _mm256_add_epi16(sD, _mm256_srli_si256(sD, 8));
+
+                __m256i lo = _mm256_srli_epi16(_mm256_add_epi16(_mm256_unpacklo_epi64(sA, sB), bias), 2);
+                __m256i hi = _mm256_srli_epi16(_mm256_add_epi16(_mm256_unpacklo_epi64(sC, sD), bias), 2);
+
+                // Packing works per lane and leaves the pixel pairs as 0-1, 4-5, 2-3, 6-7
+                return _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+            }
+#endif
+        }
+
+        namespace MipKernels {
+            void reduceRow(PixelFormat format, const uint8_t* row0, const uint8_t* row1, uint8_t* dst, uint32_t count) {
+                uint32_t i = 0;
+                if (format == PixelFormat::RGBA8) {
+#if defined(AE_SIMD_AVX2)
+                    for (; i + 8 <= count; i += 8) {
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), reduce8(row0 + i * 8, row1 + i * 8));
+                    }
+#endif
+#if defined(AE_SIMD_SSE2)
+                    for (; i + 4 <= count; i += 4) {
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), reduce4(row0 + i * 8, row1 + i * 8));
+                    }
+#endif
+                }
+
+                const uint32_t bpp = getBytesPerPixel(format);
+                for (; i < count; ++i) {
+                    const size_t s = static_cast<size_t>(i) * 2 * bpp;
+                    reducePixel(format, row0 + s, row0 + s + bpp, row1 + s, row1 + s + bpp, dst + static_cast<size_t>(i) * bpp);
+                }
+            }
+        }
+
+        void MipPyramid::resize(uint32_t width, uint32_t height, PixelFormat format) {
+            m_levels.clear();
+            m_dirty.clear();
+            m_sourceTilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+            if (width == 0 || height == 0) {
+                m_sourceTilesX = 0;
+                return;
+            }
+
+            // Stop once a level fits in one tile
+            while (width > TILE_SIZE || height > TILE_SIZE) {
+                width = std::max(1u, (width + 1) / 2);
+                height = std::max(1u, (height + 1) / 2);
+                m_levels.push_back(std::make_unique<TiledImage>(width, height, format));
+                m_dirty.emplace_back();
+                m_dirty.back().resize(m_levels.back()->getTilesX(), m_levels.back()->getTilesY());
+            }
+            invalidateAll();
+        }
+
+        void MipPyramid::invalidate(const std::vector<uint32_t>& sourceTiles) {
+            if (m_dirty.empty()) {
+                return;
+            }
+            for (uint32_t index : sourceTiles) {
+                const uint32_t tx = index % m_sourceTilesX;
+                const uint32_t ty = index / m_sourceTilesX;
+                m_dirty[0].add(tx / 2, ty / 2);
+            }
+        }
+
+        void MipPyramid::invalidateAll() {
+            for (DirtyTileSet& dirty : m_dirty) {
+                dirty.addAll();
+            }
+        }
+
+        const std::vector<uint32_t>& MipPyramid::update(const TiledImage& source, uint32_t level) {
+            m_updated.clear();
+            level = std::min<uint32_t>(level, static_cast<uint32_t>(m_levels.size()));
+
+            for (uint32_t n = 1; n <= level; ++n) {
+                const TiledImage& below = n == 1 ? source : *m_levels[n - 2];
+                TiledImage& target = *m_levels[n - 1];
+                DirtyTileSet& dirty = m_dirty[n - 1];
+                if (dirty.isEmpty()) {
+                    continue;
+                }
+
+                const std::vector<uint32_t>& indices = dirty.getIndices();
+                const uint32_t tilesX = target.getTilesX();
+                Jobs::JobSystem::getInstance().parallelFor(indices.size(), [&](size_t i) {
+                    reduceTile(below, target, indices[i] % tilesX, indices[i] / tilesX);
+                }, REDUCE_GRAIN);
+
+                // The level above goes stale where this one changed
+                if (n < m_levels.size()) {
+                    for (uint32_t index : indices) {
+                        m_dirty[n].add((index % tilesX) / 2, (index / tilesX) / 2);
+                    }
+                }
+                if (n == level) {
+                    m_updated = indices;
+                }
+                dirty.clear();
+            }
+            return m_updated;
+        }
+
+        const TiledImage* MipPyramid::getLevel(uint32_t level) const {
+            return level >= 1 && level <= m_levels.size() ? m_levels[level - 1].get() : nullptr;
+        }
+
+        uint32_t MipPyramid::getLevelForScale(float scale) const {
+            if (m_levels.empty() || !(scale < 1.0f)) {
+                return 0;
+            }
+            // Level n has 2^-n of the resolution; keep at least one texel per screen pixel
+            const float level = std::floor(-std::log2(std::max(scale, 1e-6f)));
+            return std::min(static_cast<uint32_t>(level), static_cast<uint32_t>(m_levels.size()));
+        }
+
+        void MipPyramid::reduceTile(const TiledImage& source, TiledImage& target, uint32_t tx, uint32_t ty) const {
+            const PixelFormat format = target.getFormat();
+            const uint32_t bpp = getBytesPerPixel(format);
+
+            // Quadrants past the source edge fall outside the target image too
+            const Tile* quadrants[4] = {};
+            bool inRange[4] = {};
+            bool empty = true;
+            bool uniform = true;
+            const Tile* uniformTile = nullptr;
+            for (uint32_t q = 0; q < 4; ++q) {
+                const uint32_t sx = tx * 2 + (q & 1);
+                const uint32_t sy = ty * 2 + (q >> 1);
+                inRange[q] = sx < source.getTilesX() && sy < source.getTilesY();
+                if (!inRange[q]) {
+                    continue;
+                }
+                const Tile* tile = source.getTile(sx, sy);
+                quadrants[q] = tile;
+                empty = empty && !tile;
+                if (!tile || !tile->isUniform()) {
+                    uniform = false;
+                } else if (!uniformTile) {
+                    uniformTile = tile;
+                } else if (std::memcmp(tile->getUniformPixel(), uniformTile->getUniformPixel(), bpp) != 0) {
+                    uniform = false;
+                }
+            }
+
+            // Averaging one color gives that color back, so these stay sparse
+            if (empty) {
+                target.clearTile(tx, ty);
+                return;
+            }
+            if (uniform && uniformTile) {
+                target.fillTile(tx, ty, uniformTile->getUniformPixel());
+                return;
+            }
+
+            Tile& tile = target.getTileForWrite(tx, ty);
+            const size_t rowBytes = static_cast<size_t>(TILE_SIZE) * bpp;
+            for (uint32_t q = 0; q < 4; ++q) {
+                if (!inRange[q]) {
+                    continue;
+                }
+                const uint32_t sx = tx * 2 + (q & 1);
+                const uint32_t sy = ty * 2 + (q >> 1);
+                uint8_t* dst = tile.getData() + (q >> 1) * HALF_TILE * rowBytes + (q & 1) * HALF_TILE * bpp;
+
+                if (!quadrants[q]) {
+                    for (uint32_t y = 0; y < HALF_TILE; ++y) {
+                        std::memset(dst + y * rowBytes, 0, HALF_TILE * bpp);
+                    }
+                    continue;
+                }
+
+                // Source pixels that exist in this tile; the rest is padding past the image edge
+                const uint32_t validCols = std::min(TILE_SIZE, source.getWidth() - sx * TILE_SIZE);
+                const uint32_t validRows = std::min(TILE_SIZE, source.getHeight() - sy * TILE_SIZE);
+                const uint32_t cols = (validCols + 1) / 2;
+                const uint32_t rows = (validRows + 1) / 2;
+                const uint8_t* src = quadrants[q]->getData();
+                for (uint32_t y = 0; y < rows; ++y) {
+                    const uint8_t* row0 = src + static_cast<size_t>(y) * 2 * rowBytes;
+                    const uint8_t* row1 = y * 2 + 1 < validRows ? row0 + rowBytes : row0;
+                    uint8_t* out = dst + y * rowBytes;
+                    MipKernels::reduceRow(format, row0, row1, out, cols);
+                    if (validCols & 1) {
+                        const uint8_t* p0 = row0 + static_cast<size_t>(validCols - 1) * bpp;
+                        const uint8_t* p1 = row1 + static_cast<size_t>(validCols - 1) * bpp;
+                        reducePixel(format, p0, p0, p1, p1, out + static_cast<size_t>(cols - 1) * bpp);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "2D/Image/TiledImage.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        /**
+         * @brief Half-resolution reductions of a tiled image, down to a single tile
+         *
+         * Level 0 is the source image, which the pyramid does not own; level n is the source
+         * reduced 2^n times with a 2x2 box filter. Each level tile is built from the four
+         * tiles below it, so a changed source tile only rebuilds one tile per level.
+         *
+         * Levels are brought up to date lazily: invalidate() only records which source tiles
+         * changed, and update() rebuilds the levels up to the one that is asked for. Viewing
+         * at full resolution therefore costs nothing, and zooming out only reduces tiles that
+         * changed since that level was last looked at. Tiles are reduced in parallel on the
+         * job system; RGBA8 rows use AVX2/SSE2.
+         *
+         * At odd level sizes the last column and row average the pixels that exist instead
+         * of mixing in the padding past the image edge.
+         */
+        class MipPyramid {
+        public:
+            // Rebuilds the levels for a source of this size; every tile starts out stale
+            void resize(uint32_t width, uint32_t height, PixelFormat format = PixelFormat::RGBA8);
+
+            // Records source (level 0) tiles that changed, as row-major tile indices
+            void invalidate(const std::vector<uint32_t>& sourceTiles);
+            void invalidateAll();
+
+            /**
+             * Brings levels 1..`level` up to date from `source` and returns the row-major
+             * indices of the `level` tiles rebuilt by this call. Returns nothing for level 0.
+             */
+            const std::vector<uint32_t>& update(const TiledImage& source, uint32_t level);
+
+            // Level count including the source; 0 before resize()
+            uint32_t getLevelCount() const { return m_sourceTilesX > 0 ? static_cast<uint32_t>(m_levels.size()) + 1 : 0; }
+            // Reduced level (1..getLevelCount() - 1), valid as of the last update() reaching it
+            const TiledImage* getLevel(uint32_t level) const;
+
+            // Coarsest level whose resolution still covers a view drawn at `scale` (1 = 100%)
+            uint32_t getLevelForScale(float scale) const;
+
+        private:
+            void reduceTile(const TiledImage& source, TiledImage& target, uint32_t tx, uint32_t ty) const;
+
+            uint32_t m_sourceTilesX = 0;
+            std::vector<std::unique_ptr<TiledImage>> m_levels; // m_levels[i] is level i + 1
+            std::vector<DirtyTileSet> m_dirty;                 // Stale tiles of each reduced level
+            std::vector<uint32_t> m_updated;
+        };
+
+        namespace MipKernels {
+            // dst[i] = rounded average of src pixels 2i and 2i+1 of rows `row0` and `row1`
+            void reduceRow(PixelFormat format, const uint8_t* row0, const uint8_t* row1, uint8_t* dst, uint32_t count);
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#include "2D/Image/PackBits.h"
+#include "2D/Image/Simd.h"
+#include <algorithm>
+#include <cstring>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace PackBits {
+            namespace {
+                // Length of the run of identical bytes starting at src[0], capped at maxLength
+                size_t runLength(const uint8_t* src, size_t maxLength) {
+                    size_t length = 1;
+#if defined(AE_SIMD_SSE2)
+                    const __m128i value = _mm_set1_epi8(static_cast<char>(src[0]));
+                    while (length + 16 <= maxLength) {
+                        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + length));
+                        uint32_t equal = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, value)));
+                        if (equal != 0xFFFF) {
+                            return length + Simd::countTrailingZeros(~equal);
+                        }
+                        length += 16;
+                    }
+#endif
+                    while (length < maxLength && src[length] == src[0]) {
+                        ++length;
+                    }
+                    return length;
+                }
+                
+                // First position in [begin, end) where three identical bytes start,
+                // or end if there is none. src must be readable up to size.
+                size_t findRunStart(const uint8_t* src, size_t begin, size_t end, size_t size) {
+                    size_t i = begin;
+#if defined(AE_SIMD_SSE2)
+                    while (i + 16 <= end && i + 18 <= size) {
+                        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 1));
+                        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 2));
+                        __m128i triple = _mm_and_si128(_mm_cmpeq_epi8(a, b), _mm_cmpeq_epi8(b, c));
+                        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(triple));
+                        if (mask != 0) {
+                            return i + Simd::countTrailingZeros(mask);
+                        }
+                        i += 16;
+                    }
+#endif
+                    for (; i < end; ++i) {
+                        if (i + 2 < size && src[i] == src[i + 1] && src[i] == src[i + 2]) {
+                            return i;
+                        }
+                    }
+                    return end;
+                }
+            }
+            
+            size_t encode(const uint8_t* src, size_t size, std::vector<uint8_t>& out) {
+                const size_t start = out.size();
+                size_t i = 0;
+                
+                while (i < size) {
+                    size_t run = runLength(src + i, std::min<size_t>(128, size - i));
+                    if (run >= 3) {
+                        out.push_back(static_cast<uint8_t>(1 - static_cast<int>(run)));
+                        out.push_back(src[i]);
+                        i += run;
+                        continue;
+                    }
+                    
+                    // Gather literals until a run worth encoding begins
+                    size_t literalEnd = findRunStart(src, i + 1, std::min(size, i + 128), size);
+                    size_t literalCount = literalEnd - i;
+                    out.push_back(static_cast<uint8_t>(literalCount - 1));
+                    out.insert(out.end(), src + i, src + literalEnd);
+                    i = literalEnd;
+                }
+                
+                return out.size() - start;
+            }
+            
+            bool decode(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize, size_t& consumed) {
+                size_t in = 0;
+                size_t outPos = 0;
+                
+                while (outPos < dstSize) {
+                    if (in >= srcSize) {
+                        return false;
+                    }
+                    int8_t header = static_cast<int8_t>(src[in++]);
+                    if (header >= 0) {
+                        size_t count = static_cast<size_t>(header) + 1;
+                        if (in + count > srcSize || outPos + count > dstSize) {
+                            return false;
+                        }
+                        std::memcpy(dst + outPos, src + in, count);
+                        in += count;
+                        outPos += count;
+                    } else if (header != -128) {
+                        size_t count = static_cast<size_t>(1 - header);
+                        if (in >= srcSize || outPos + count > dstSize) {
+                            return false;
+                        }
+                        std::memset(dst + outPos, src[in++], count);
+                        outPos += count;
+                    }
+                }
+                
+                consumed = in;
+                return true;
+            }
+        }
+    }
+}
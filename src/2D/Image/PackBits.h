@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        /**
+         * @brief PackBits run-length codec (the Macintosh/TIFF/PSD variant)
+         *
+         * A header byte n in [0, 127] is followed by n + 1 literal bytes; n in [-127, -1]
+         * repeats the following byte 1 - n times; -128 is a no-op.
+         */
+        namespace PackBits {
+            // Appends the encoding of src to out and returns the number of bytes appended
+            size_t encode(const uint8_t* src, size_t size, std::vector<uint8_t>& out);
+            
+            // Decodes exactly dstSize bytes. Returns false on truncated or overlong input;
+            // on success `consumed` holds the number of source bytes read.
+            bool decode(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize, size_t& consumed);
+        }
+    }
+}
@@ -0,0 +1,721 @@
+#include "2D/Image/Resample.h"
+#include "2D/Image/MipPyramid.h"
+#include "2D/Image/Simd.h"
+#include "Core/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            // Zero border around a copied source area; wider than any kernel reaches, so a
+            // sample clamped into the border still reads transparent
+            constexpr int REGION_MARGIN = 4;
+            // Largest source area copied for one block before it is split further
+            constexpr size_t REGION_MAX_PIXELS = size_t(1) << 20;
+            constexpr uint32_t MIN_BLOCK = 8;
+            // Source pixels per destination pixel past a whole number before another sample is taken
+            constexpr float SUPERSAMPLE_SLACK = 0.25f;
+            // Below this a homogeneous w counts as behind the viewer
+            constexpr float MIN_W = 1e-6f;
+
+            // Row-major 3x3 mapping (x, y, 1) to homogeneous (u, v, w)
+            struct Projection {
+                float m[3][3];
+
+                bool map(float x, float y, float& u, float& v) const {
+                    const float w = m[2][0] * x + m[2][1] * y + m[2][2];
+                    if (!(w > MIN_W)) {
+                        return false;
+                    }
+                    u = (m[0][0] * x + m[0][1] * y + m[0][2]) / w;
+                    v = (m[1][0] * x + m[1][1] * y + m[1][2]) / w;
+                    return true;
+                }
+            };
+
+            Projection makeProjection(const glm::mat3& matrix) {
+                Projection p;
+                for (int row = 0; row < 3; ++row) {
+                    for (int column = 0; column < 3; ++column) {
+                        p.m[row][column] = matrix[column][row];
+                    }
+                }
+                return p;
+            }
+
+            // Copied source area; region pixel (0, 0) is source pixel (x0, y0)
+            struct Region {
+                int x0 = 0, y0 = 0;
+                int width = 0, height = 0;
+                int border = 0; // Outer ring left transparent whatever the source holds there
+            };
+
+            struct Setup {
+                Projection inverse; // Destination pixel coordinates to source (level) pixel coordinates
+                const TiledImage* source = nullptr;
+                ResampleFilter filter = ResampleFilter::Bilinear;
+                uint32_t samplesX = 1, samplesY = 1;
+            };
+
+            thread_local std::vector<uint32_t> t_region8;
+            thread_local std::vector<float> t_regionFloat;
+
+            // Convex polygon; a quad cut by five lines has at most 9 corners, the rest is room for rounding
+            struct Polygon {
+                static constexpr int CAPACITY = 16;
+                double x[CAPACITY], y[CAPACITY];
+                int count = 0;
+
+                void add(double px, double py) {
+                    if (count < CAPACITY) {
+                        x[count] = px;
+                        y[count] = py;
+                        ++count;
+                    }
+                }
+            };
+
+            // The part of `polygon` where the affine `side(x, y)` is not negative
+            template <typename Side>
+            Polygon clipPolygon(const Polygon& polygon, Side side) {
+                Polygon result;
+                for (int i = 0; i < polygon.count; ++i) {
+                    const int j = i + 1 < polygon.count ? i + 1 : 0;
+                    const double a = side(polygon.x[i], polygon.y[i]);
+                    const double b = side(polygon.x[j], polygon.y[j]);
+                    if (a >= 0.0) {
+                        result.add(polygon.x[i], polygon.y[i]);
+                    }
+                    if ((a >= 0.0) != (b >= 0.0)) {
+                        const double t = a / (a - b);
+                        result.add(polygon.x[i] + (polygon.x[j] - polygon.x[i]) * t, polygon.y[i] + (polygon.y[j] - polygon.y[i]) * t);
+                    }
+                }
+                return result;
+            }
+
+            /**
+             * Source area of a block that partly maps from behind the projection. Its samples
+             * in front of it can land arbitrarily far out, so the region is the part of the
+             * block's image within reach of the source, plus a transparent border that far
+             * samples clamp into.
+             */
+            Region findHorizonRegion(const Setup& setup, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) {
+                const Projection& p = setup.inverse;
+                Polygon block;
+                block.add(x0, y0);
+                block.add(x1, y0);
+                block.add(x1, y1);
+                block.add(x0, y1);
+                block = clipPolygon(block, [&p](double x, double y) {
+                    return p.m[2][0] * x + p.m[2][1] * y + p.m[2][2] - MIN_W;
+                });
+
+                // The projection keeps the cut polygon convex, so mapping its corners maps it
+                Polygon image;
+                for (int i = 0; i < block.count; ++i) {
+                    const double x = block.x[i], y = block.y[i];
+                    const double w = std::max(p.m[2][0] * x + p.m[2][1] * y + p.m[2][2], static_cast<double>(MIN_W));
+                    image.add((p.m[0][0] * x + p.m[0][1] * y + p.m[0][2]) / w, (p.m[1][0] * x + p.m[1][1] * y + p.m[1][2]) / w);
+                }
+                const double low = -REGION_MARGIN;
+                const double highU = static_cast<double>(setup.source->getWidth()) + REGION_MARGIN;
+                const double highV = static_cast<double>(setup.source->getHeight()) + REGION_MARGIN;
+                image = clipPolygon(image, [low](double u, double) { return u - low; });
+                image = clipPolygon(image, [highU](double u, double) { return highU - u; });
+                image = clipPolygon(image, [low](double, double v) { return v - low; });
+                image = clipPolygon(image, [highV](double, double v) { return highV - v; });
+
+                Region region;
+                if (image.count == 0) {
+                    return region; // Everything the block sees is transparent
+                }
+                double minU = image.x[0], maxU = image.x[0], minV = image.y[0], maxV = image.y[0];
+                for (int i = 1; i < image.count; ++i) {
+                    minU = std::min(minU, image.x[i]); maxU = std::max(maxU, image.x[i]);
+                    minV = std::min(minV, image.y[i]); maxV = std::max(maxV, image.y[i]);
+                }
+                // Samples outside the image clip are at least REGION_MARGIN from the source, so
+                // they read transparent; the kernels clamp them into the border, which is too
+                region.border = REGION_MARGIN;
+                region.x0 = static_cast<int>(std::floor(minU)) - REGION_MARGIN * 2;
+                region.y0 = static_cast<int>(std::floor(minV)) - REGION_MARGIN * 2;
+                region.width = static_cast<int>(std::ceil(maxU)) + REGION_MARGIN * 2 - region.x0;
+                region.height = static_cast<int>(std::ceil(maxV)) + REGION_MARGIN * 2 - region.y0;
+                return region;
+            }
+
+            // Source area the destination block [x0, x1) x [y0, y1) samples from
+            Region findRegion(const Setup& setup, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) {
+                const int limitX = static_cast<int>(setup.source->getWidth()) + REGION_MARGIN;
+                const int limitY = static_cast<int>(setup.source->getHeight()) + REGION_MARGIN;
+                float minU = 0.0f, minV = 0.0f, maxU = 0.0f, maxV = 0.0f;
+                for (int corner = 0; corner < 4; ++corner) {
+                    float u, v;
+                    if (!setup.inverse.map(static_cast<float>(corner & 1 ? x1 : x0), static_cast<float>(corner & 2 ? y1 : y0), u, v)) {
+                        return findHorizonRegion(setup, x0, y0, x1, y1);
+                    }
+                    if (corner == 0) {
+                        minU = maxU = u;
+                        minV = maxV = v;
+                    }
+                    minU = std::min(minU, u); maxU = std::max(maxU, u);
+                    minV = std::min(minV, v); maxV = std::max(maxV, v);
+                }
+
+                // Kept within the source plus its zero border, so far-off corners cannot overflow
+                const float lowU = std::min(std::max(std::floor(minU) - REGION_MARGIN, static_cast<float>(-REGION_MARGIN)), static_cast<float>(limitX));
+                const float lowV = std::min(std::max(std::floor(minV) - REGION_MARGIN, static_cast<float>(-REGION_MARGIN)), static_cast<float>(limitY));
+                const float highU = std::max(std::min(std::ceil(maxU) + REGION_MARGIN, static_cast<float>(limitX)), lowU);
+                const float highV = std::max(std::min(std::ceil(maxV) + REGION_MARGIN, static_cast<float>(limitY)), lowV);
+                Region region;
+                region.x0 = static_cast<int>(lowU);
+                region.y0 = static_cast<int>(lowV);
+                region.width = static_cast<int>(highU) - region.x0;
+                region.height = static_cast<int>(highV) - region.y0;
+                return region;
+            }
+
+            // Whether any source tile under the region holds pixels
+            bool regionHasPixels(const TiledImage& source, const Region& region) {
+                const int x0 = std::max(region.x0 + region.border, 0), y0 = std::max(region.y0 + region.border, 0);
+                const int x1 = std::min(region.x0 + region.width - region.border, static_cast<int>(source.getWidth()));
+                const int y1 = std::min(region.y0 + region.height - region.border, static_cast<int>(source.getHeight()));
+                if (x0 >= x1 || y0 >= y1) {
+                    return false;
+                }
+                for (uint32_t ty = y0 / TILE_SIZE; ty <= static_cast<uint32_t>(y1 - 1) / TILE_SIZE; ++ty) {
+                    for (uint32_t tx = x0 / TILE_SIZE; tx <= static_cast<uint32_t>(x1 - 1) / TILE_SIZE; ++tx) {
+                        if (source.getTile(tx, ty)) {
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            }
+
+            /**
+             * Copies the region into `dst`, `Channels` values of T per pixel, zero outside the
+             * source and in the region's border. `convert` turns `count` source pixels into
+             * region pixels.
+             */
+            template <typename T, int Channels, typename Convert>
+            void copyRegion(const TiledImage& source, const Region& region, std::vector<T>& dst, Convert convert) {
+                const uint32_t bpp = getBytesPerPixel(source.getFormat());
+                const int width = static_cast<int>(source.getWidth());
+                const int height = static_cast<int>(source.getHeight());
+                dst.assign(static_cast<size_t>(region.width) * region.height * Channels, T(0));
+                const int x0 = std::max(region.x0 + region.border, 0);
+                const int x1 = std::min(region.x0 + region.width - region.border, width);
+                for (int ry = region.border; ry < region.height - region.border; ++ry) {
+                    const int sy = region.y0 + ry;
+                    if (sy < 0 || sy >= height) {
+                        continue;
+                    }
+                    T* row = dst.data() + static_cast<size_t>(ry) * region.width * Channels;
+                    for (int sx = x0; sx < x1;) {
+                        const int span = std::min(x1, (sx / static_cast<int>(TILE_SIZE) + 1) * static_cast<int>(TILE_SIZE)) - sx;
+                        const Tile* tile = source.getTile(sx / TILE_SIZE, sy / TILE_SIZE);
+                        T* out = row + static_cast<size_t>(sx - region.x0) * Channels;
+                        if (tile && tile->isUniform()) {
+                            T pixel[Channels];
+                            convert(tile->getUniformPixel(), pixel, 1);
+                            for (int i = 0; i < span; ++i) {
+                                std::memcpy(out + i * Channels, pixel, sizeof(pixel));
+                            }
+                        } else if (tile) {
+                            const uint8_t* src = tile->getData() + ((sy % TILE_SIZE) * TILE_SIZE + sx % TILE_SIZE) * bpp;
+                            convert(src, out, span);
+                        }
+                        sx += span;
+                    }
+                }
+            }
+
+            // Catmull-Rom weights for the four taps around a sample at fraction t
+            AE_FORCE_INLINE void cubicWeights(float t, float* w) {
+                w[0] = ((-0.5f * t + 1.0f) * t - 0.5f) * t;
+                w[1] = (1.5f * t - 2.5f) * t * t + 1.0f;
+                w[2] = ((-1.5f * t + 2.0f) * t + 0.5f) * t;
+                w[3] = (0.5f * t - 0.5f) * t * t;
+            }
+
+            AE_FORCE_INLINE int clampIndex(float value, int limit) {
+                return std::min(std::max(static_cast<int>(value), 0), limit);
+            }
+
+            /**
+             * Filters one destination pixel into `out` (4 floats in the region's scale).
+             * `fetch(index, px)` reads region pixel `index` as 4 floats.
+             */
+            template <typename Fetch>
+            void samplePixel(const Setup& setup, const Region& region, float x, float y, Fetch fetch, float* out) {
+                out[0] = out[1] = out[2] = out[3] = 0.0f;
+                const float offsetU = 0.5f + static_cast<float>(region.x0);
+                const float offsetV = 0.5f + static_cast<float>(region.y0);
+                float px[4];
+                for (uint32_t sj = 0; sj < setup.samplesY; ++sj) {
+                    for (uint32_t si = 0; si < setup.samplesX; ++si) {
+                        float u, v;
+                        if (!setup.inverse.map(x + (si + 0.5f) / setup.samplesX, y + (sj + 0.5f) / setup.samplesY, u, v)) {
+                            continue;
+                        }
+                        // Region index space: pixel centers at integers
+                        u -= offsetU;
+                        v -= offsetV;
+                        switch (setup.filter) {
+                            case ResampleFilter::Nearest: {
+                                const int ix = clampIndex(std::floor(u + 0.5f), region.width - 1);
+                                const int iy = clampIndex(std::floor(v + 0.5f), region.height - 1);
+                                fetch(static_cast<size_t>(iy) * region.width + ix, px);
+                                for (int c = 0; c < 4; ++c) {
+                                    out[c] += px[c];
+                                }
+                                break;
+                            }
+                            case ResampleFilter::Bilinear: {
+                                const float fu = std::floor(u), fv = std::floor(v);
+                                const float tx = u - fu, ty = v - fv;
+                                const int ix = clampIndex(fu, region.width - 2);
+                                const int iy = clampIndex(fv, region.height - 2);
+                                const size_t base = static_cast<size_t>(iy) * region.width + ix;
+                                const float weights[4] = {(1 - tx) * (1 - ty), tx * (1 - ty), (1 - tx) * ty, tx * ty};
+                                const size_t offsets[4] = {0, 1, static_cast<size_t>(region.width), static_cast<size_t>(region.width) + 1};
+                                for (int k = 0; k < 4; ++k) {
+                                    fetch(base + offsets[k], px);
+                                    for (int c = 0; c < 4; ++c) {
+                                        out[c] += px[c] * weights[k];
+                                    }
+                                }
+                                break;
+                            }
+                            case ResampleFilter::Bicubic: {
+                                const float fu = std::floor(u), fv = std::floor(v);
+                                float wx[4], wy[4];
+                                cubicWeights(u - fu, wx);
+                                cubicWeights(v - fv, wy);
+                                const int ix = clampIndex(fu - 1.0f, region.width - 4);
+                                const int iy = clampIndex(fv - 1.0f, region.height - 4);
+                                for (int j = 0; j < 4; ++j) {
+                                    const size_t base = static_cast<size_t>(iy + j) * region.width + ix;
+                                    for (int i = 0; i < 4; ++i) {
+                                        fetch(base + i, px);
+                                        const float weight = wx[i] * wy[j];
+                                        for (int c = 0; c < 4; ++c) {
+                                            out[c] += px[c] * weight;
+                                        }
+                                    }
+                                }
+                                break;
+                            }
+                        }
+                    }
+                }
+                const float scale = 1.0f / static_cast<float>(setup.samplesX * setup.samplesY);
+                for (int c = 0; c < 4; ++c) {
+                    out[c] *= scale;
+                }
+            }
+
+            AE_FORCE_INLINE uint32_t packPixel8(const float* value) {
+                const float alpha = std::min(std::max(value[3], 0.0f), 255.0f);
+                uint32_t packed = static_cast<uint32_t>(std::lrint(alpha)) << 24;
+                for (int c = 0; c < 3; ++c) {
+                    packed |= static_cast<uint32_t>(std::lrint(std::min(std::max(value[c], 0.0f), alpha))) << (c * 8);
+                }
+                return packed;
+            }
+
+            AE_FORCE_INLINE void unpackPixel8(uint32_t pixel, float* out) {
+                for (int c = 0; c < 4; ++c) {
+                    out[c] = static_cast<float>((pixel >> (c * 8)) & 0xff);
+                }
+            }
+
+#if defined(AE_SIMD_AVX2_DISPATCH)
+            // Channel c of 8 packed RGBA8 pixels as floats
+            AE_FORCE_INLINE AE_TARGET_AVX2 __m256 channel8(__m256i pixels, int c) {
+                return _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(pixels, c * 8), _mm256_set1_epi32(0xff)));
+            }
+
+            AE_FORCE_INLINE AE_TARGET_AVX2 void accumulate8(__m256* acc, __m256i pixels, __m256 weight) {
+                for (int c = 0; c < 4; ++c) {
+                    acc[c] = _mm256_fmadd_ps(channel8(pixels, c), weight, acc[c]);
+                }
+            }
+
+            AE_FORCE_INLINE AE_TARGET_AVX2 void cubicWeights8(__m256 t, __m256* w) {
+                const __m256 half = _mm256_set1_ps(0.5f);
+                const __m256 one = _mm256_set1_ps(1.0f);
+                const __m256 t2 = _mm256_mul_ps(t, t);
+                w[0] = _mm256_mul_ps(_mm256_fmsub_ps(_mm256_fnmadd_ps(half, t, one), t, half), t);
+                w[1] = _mm256_fmadd_ps(_mm256_fmsub_ps(_mm256_set1_ps(1.5f), t, _mm256_set1_ps(2.5f)), t2, one);
+                w[2] = _mm256_mul_ps(_mm256_fmadd_ps(_mm256_fnmadd_ps(_mm256_set1_ps(1.5f), t, _mm256_set1_ps(2.0f)), t, half), t);
+                w[3] = _mm256_mul_ps(_mm256_fmsub_ps(half, t, half), t2);
+            }
+
+            AE_FORCE_INLINE AE_TARGET_AVX2 __m256i clampIndex8(__m256 value, int limit) {
+                return _mm256_min_epi32(_mm256_max_epi32(_mm256_cvttps_epi32(value), _mm256_setzero_si256()), _mm256_set1_epi32(limit));
+            }
+
+            /**
+             * Eight RGBA8 destination pixels starting at (x, y). Lanes mapping from behind a
+             * perspective get weight 0, like the scalar path skipping them.
+             */
+            AE_TARGET_AVX2 void samplePixels8(const Setup& setup, const Region& region, const uint32_t* pixels, float x, float y, uint32_t* out) {
+                const Projection& p = setup.inverse;
+                const int* base = reinterpret_cast<const int*>(pixels);
+                const __m256 lanes = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+                const __m256 offsetU = _mm256_set1_ps(0.5f + static_cast<float>(region.x0));
+                const __m256 offsetV = _mm256_set1_ps(0.5f + static_cast<float>(region.y0));
+                const __m256i stride = _mm256_set1_epi32(region.width);
+                const __m256 one = _mm256_set1_ps(1.0f);
+                __m256 acc[4] = {_mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps()};
+
+                for (uint32_t sj = 0; sj < setup.samplesY; ++sj) {
+                    const float sy = y + (sj + 0.5f) / setup.samplesY;
+                    for (uint32_t si = 0; si < setup.samplesX; ++si) {
+                        const __m256 sx = _mm256_add_ps(lanes, _mm256_set1_ps(x + (si + 0.5f) / setup.samplesX));
+                        const __m256 w = _mm256_fmadd_ps(_mm256_set1_ps(p.m[2][0]), sx, _mm256_set1_ps(p.m[2][1] * sy + p.m[2][2]));
+                        const __m256 visible = _mm256_cmp_ps(w, _mm256_set1_ps(MIN_W), _CMP_GT_OQ);
+                        const __m256 inverseW = _mm256_div_ps(one, _mm256_blendv_ps(one, w, visible));
+                        __m256 u = _mm256_mul_ps(_mm256_fmadd_ps(_mm256_set1_ps(p.m[0][0]), sx, _mm256_set1_ps(p.m[0][1] * sy + p.m[0][2])), inverseW);
+                        __m256 v = _mm256_mul_ps(_mm256_fmadd_ps(_mm256_set1_ps(p.m[1][0]), sx, _mm256_set1_ps(p.m[1][1] * sy + p.m[1][2])), inverseW);
+                        u = _mm256_sub_ps(u, offsetU);
+                        v = _mm256_sub_ps(v, offsetV);
+                        const __m256 keep = _mm256_and_ps(visible, one);
+
+                        switch (setup.filter) {
+                            case ResampleFilter::Nearest: {
+                                const __m256i ix = clampIndex8(_mm256_floor_ps(_mm256_add_ps(u, _mm256_set1_ps(0.5f))), region.width - 1);
+                                const __m256i iy = clampIndex8(_mm256_floor_ps(_mm256_add_ps(v, _mm256_set1_ps(0.5f))), region.height - 1);
+                                const __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(iy, stride), ix);
+                                accumulate8(acc, _mm256_i32gather_epi32(base, index, 4), keep);
+                                break;
+                            }
+                            case ResampleFilter::Bilinear: {
+                                const __m256 fu = _mm256_floor_ps(u), fv = _mm256_floor_ps(v);
+                                const __m256 tx = _mm256_sub_ps(u, fu), ty = _mm256_sub_ps(v, fv);
+                                const __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(clampIndex8(fv, region.height - 2), stride),
+                                                                       clampIndex8(fu, region.width - 2));
+                                const __m256 top = _mm256_mul_ps(_mm256_sub_ps(one, ty), keep);
+                                const __m256 bottom = _mm256_mul_ps(ty, keep);
+                                const __m256 left = _mm256_sub_ps(one, tx);
+                                const __m256i next = _mm256_add_epi32(index, stride);
+                                accumulate8(acc, _mm256_i32gather_epi32(base, index, 4), _mm256_mul_ps(left, top));
+                                accumulate8(acc, _mm256_i32gather_epi32(base + 1, index, 4), _mm256_mul_ps(tx, top));
+                                accumulate8(acc, _mm256_i32gather_epi32(base, next, 4), _mm256_mul_ps(left, bottom));
+                                accumulate8(acc, _mm256_i32gather_epi32(base + 1, next, 4), _mm256_mul_ps(tx, bottom));
+                                break;
+                            }
+                            case ResampleFilter::Bicubic: {
+                                const __m256 fu = _mm256_floor_ps(u), fv = _mm256_floor_ps(v);
+                                __m256 wx[4], wy[4];
+                                cubicWeights8(_mm256_sub_ps(u, fu), wx);
+                                cubicWeights8(_mm256_sub_ps(v, fv), wy);
+                                __m256i index = _mm256_add_epi32(
+                                    _mm256_mullo_epi32(clampIndex8(_mm256_sub_ps(fv, one), region.height - 4), stride),
+                                    clampIndex8(_mm256_sub_ps(fu, one), region.width - 4));
+                                for (int j = 0; j < 4; ++j, index = _mm256_add_epi32(index, stride)) {
+                                    __m256 row[4] = {_mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps()};
+                                    for (int i = 0; i < 4; ++i) {
+                                        accumulate8(row, _mm256_i32gather_epi32(base + i, index, 4), wx[i]);
+                                    }
+                                    const __m256 weight = _mm256_mul_ps(wy[j], keep);
+                                    for (int c = 0; c < 4; ++c) {
+                                        acc[c] = _mm256_fmadd_ps(row[c], weight, acc[c]);
+                                    }
+                                }
+                                break;
+                            }
+                        }
+                    }
+                }
+
+                // Average, clamp to [0, alpha] and pack
+                const __m256 scale = _mm256_set1_ps(1.0f / static_cast<float>(setup.samplesX * setup.samplesY));
+                const __m256 alpha = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(acc[3], scale), _mm256_setzero_ps()), _mm256_set1_ps(255.0f));
+                __m256i packed = _mm256_slli_epi32(_mm256_cvtps_epi32(alpha), 24);
+                for (int c = 0; c < 3; ++c) {
+                    const __m256 value = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(acc[c], scale), _mm256_setzero_ps()), alpha);
+                    packed = _mm256_or_si256(packed, _mm256_slli_epi32(_mm256_cvtps_epi32(value), c * 8));
+                }
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), packed);
+            }
+#endif
+
+            // Resamples destination pixels [x0, x1) x [y0, y1) of tile (tx, ty)
+            void resampleBlock(const Setup& setup, TiledImage& target, uint32_t tx, uint32_t ty,
+                               uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) {
+                const Region region = findRegion(setup, x0, y0, x1, y1);
+                const size_t regionPixels = static_cast<size_t>(region.width) * region.height;
+                if (regionPixels > REGION_MAX_PIXELS && x1 - x0 > MIN_BLOCK) {
+                    // Strong perspective; smaller blocks see smaller source areas
+                    const uint32_t mx = (x0 + x1) / 2, my = (y0 + y1) / 2;
+                    resampleBlock(setup, target, tx, ty, x0, y0, mx, my);
+                    resampleBlock(setup, target, tx, ty, mx, y0, x1, my);
+                    resampleBlock(setup, target, tx, ty, x0, my, mx, y1);
+                    resampleBlock(setup, target, tx, ty, mx, my, x1, y1);
+                    return;
+                }
+                if (!regionHasPixels(*setup.source, region)) {
+                    return;
+                }
+
+                const PixelFormat format = target.getFormat();
+                const uint32_t bpp = getBytesPerPixel(format);
+                const uint32_t right = std::min(x1, target.getWidth());
+                const uint32_t bottom = std::min(y1, target.getHeight());
+                if (right <= x0 || bottom <= y0) {
+                    return;
+                }
+                uint8_t* tile = target.getTileForWrite(tx, ty).getData();
+                const uint32_t originX = tx * TILE_SIZE, originY = ty * TILE_SIZE;
+                float value[4];
+
+                if (format == PixelFormat::RGBA8) {
+                    copyRegion<uint32_t, 1>(*setup.source, region, t_region8, [](const uint8_t* src, uint32_t* dst, int count) {
+                        std::memcpy(dst, src, static_cast<size_t>(count) * 4);
+                    });
+                    const uint32_t* pixels = t_region8.data();
+                    auto fetch = [pixels](size_t index, float* px) { unpackPixel8(pixels[index], px); };
+#if defined(AE_SIMD_AVX2_DISPATCH)
+                    const bool avx2 = Simd::hasAvx2();
+#endif
+                    for (uint32_t y = y0; y < bottom; ++y) {
+                        uint32_t* row = reinterpret_cast<uint32_t*>(tile + (y - originY) * TILE_SIZE * 4) - originX;
+                        uint32_t x = x0;
+#if defined(AE_SIMD_AVX2_DISPATCH)
+                        if (avx2) {
+                            for (; x + 8 <= right; x += 8) {
+                                samplePixels8(setup, region, pixels, static_cast<float>(x), static_cast<float>(y), row + x);
+                            }
+                        }
+#endif
+                        for (; x < right; ++x) {
+                            samplePixel(setup, region, static_cast<float>(x), static_cast<float>(y), fetch, value);
+                            row[x] = packPixel8(value);
+                        }
+                    }
+                    return;
+                }
+
+                const bool wide = format == PixelFormat::RGBA16;
+                copyRegion<float, 4>(*setup.source, region, t_regionFloat, [wide](const uint8_t* src, float* dst, int count) {
+                    if (wide) {
+                        for (int i = 0; i < count * 4; ++i) {
+                            uint16_t channel;
+                            std::memcpy(&channel, src + i * 2, 2);
+                            dst[i] = static_cast<float>(channel) * (1.0f / 65535.0f);
+                        }
+                    } else {
+                        std::memcpy(dst, src, static_cast<size_t>(count) * 16);
+                    }
+                });
+                const float* pixels = t_regionFloat.data();
+                auto fetch = [pixels](size_t index, float* px) { std::memcpy(px, pixels + index * 4, 16); };
+                for (uint32_t y = y0; y < bottom; ++y) {
+                    uint8_t* row = tile + (y - originY) * TILE_SIZE * bpp;
+                    for (uint32_t x = x0; x < right; ++x) {
+                        samplePixel(setup, region, static_cast<float>(x), static_cast<float>(y), fetch, value);
+                        const float alpha = std::min(std::max(value[3], 0.0f), 1.0f);
+                        uint8_t* out = row + (x - originX) * bpp;
+                        if (wide) {
+                            uint16_t channels[4];
+                            for (int c = 0; c < 4; ++c) {
+                                const float v = c < 3 ? std::min(std::max(value[c], 0.0f), alpha) : alpha;
+                                channels[c] = static_cast<uint16_t>(std::lrint(v * 65535.0f));
+                            }
+                            std::memcpy(out, channels, 8);
+                        } else {
+                            // Linear float may exceed 1; only the negative lobes are cut
+                            for (int c = 0; c < 3; ++c) {
+                                value[c] = std::max(value[c], 0.0f);
+                            }
+                            value[3] = alpha;
+                            std::memcpy(out, value, 16);
+                        }
+                    }
+                }
+            }
+
+            // Fills target tile (tx, ty) from the level-`level` proxy tile covering it
+            template <size_t BPP>
+            void upsampleTile(const uint8_t* proxy, uint32_t level, uint32_t tx, uint32_t ty, uint8_t* target) {
+                const uint32_t originX = tx * TILE_SIZE, originY = ty * TILE_SIZE;
+                for (uint32_t y = 0; y < TILE_SIZE; ++y) {
+                    const uint8_t* src = proxy + (((originY + y) >> level) & (TILE_SIZE - 1)) * TILE_SIZE * BPP;
+                    uint8_t* dst = target + y * TILE_SIZE * BPP;
+                    for (uint32_t x = 0; x < TILE_SIZE; ++x) {
+                        std::memcpy(dst + x * BPP, src + (((originX + x) >> level) & (TILE_SIZE - 1)) * BPP, BPP);
+                    }
+                }
+            }
+        }
+
+        namespace Resample {
+            TileRect getTransformedTiles(uint32_t sourceWidth, uint32_t sourceHeight, const glm::mat3& transform,
+                                         uint32_t width, uint32_t height) {
+                TileRect tiles;
+                if (width == 0 || height == 0 || sourceWidth == 0 || sourceHeight == 0) {
+                    return tiles;
+                }
+                const Projection forward = makeProjection(transform);
+                float minX = 0.0f, minY = 0.0f, maxX = 0.0f, maxY = 0.0f;
+                for (int corner = 0; corner < 4; ++corner) {
+                    float x, y;
+                    if (!forward.map(corner & 1 ? static_cast<float>(sourceWidth) : 0.0f,
+                                     corner & 2 ? static_cast<float>(sourceHeight) : 0.0f, x, y)) {
+                        // The source crosses the horizon and can cover anything
+                        tiles.x1 = (width + TILE_SIZE - 1) / TILE_SIZE;
+                        tiles.y1 = (height + TILE_SIZE - 1) / TILE_SIZE;
+                        return tiles;
+                    }
+                    if (corner == 0) {
+                        minX = maxX = x;
+                        minY = maxY = y;
+                    }
+                    minX = std::min(minX, x); maxX = std::max(maxX, x);
+                    minY = std::min(minY, y); maxY = std::max(maxY, y);
+                }
+                // A pixel past the edge still catches the filter's reach
+                const float x0 = std::max(std::floor(minX) - 2.0f, 0.0f);
+                const float y0 = std::max(std::floor(minY) - 2.0f, 0.0f);
+                const float x1 = std::min(std::ceil(maxX) + 2.0f, static_cast<float>(width));
+                const float y1 = std::min(std::ceil(maxY) + 2.0f, static_cast<float>(height));
+                if (x0 >= x1 || y0 >= y1) {
+                    return tiles;
+                }
+                tiles.x0 = static_cast<uint32_t>(x0) / TILE_SIZE;
+                tiles.y0 = static_cast<uint32_t>(y0) / TILE_SIZE;
+                tiles.x1 = (static_cast<uint32_t>(x1) + TILE_SIZE - 1) / TILE_SIZE;
+                tiles.y1 = (static_cast<uint32_t>(y1) + TILE_SIZE - 1) / TILE_SIZE;
+                return tiles;
+            }
+
+            void transformInto(const TiledImage& source, const glm::mat3& transform, TiledImage& target,
+                               const TileRect& tiles, ResampleFilter filter, const std::atomic<bool>* cancel) {
+                TileRect rect = tiles;
+                rect.x1 = std::min(rect.x1, target.getTilesX());
+                rect.y1 = std::min(rect.y1, target.getTilesY());
+                if (rect.isEmpty()) {
+                    return;
+                }
+                TileRect reach = getTransformedTiles(source.getWidth(), source.getHeight(), transform,
+                                                     target.getWidth(), target.getHeight());
+                reach.x0 = std::max(reach.x0, rect.x0); reach.x1 = std::min(reach.x1, rect.x1);
+                reach.y0 = std::max(reach.y0, rect.y0); reach.y1 = std::min(reach.y1, rect.y1);
+
+                Setup setup;
+                setup.inverse = makeProjection(glm::inverse(transform));
+                setup.source = &source;
+                setup.filter = filter;
+
+                // Source pixels per destination pixel along each destination axis, at the center
+                MipPyramid pyramid;
+                if (!reach.isEmpty()) {
+                    const float cx = (reach.x0 + reach.x1) * 0.5f * TILE_SIZE;
+                    const float cy = (reach.y0 + reach.y1) * 0.5f * TILE_SIZE;
+                    float u0, v0, ux, vx, uy, vy;
+                    float stepX = 1.0f, stepY = 1.0f;
+                    if (setup.inverse.map(cx, cy, u0, v0) && setup.inverse.map(cx + 1.0f, cy, ux, vx) && setup.inverse.map(cx, cy + 1.0f, uy, vy)) {
+                        stepX = std::sqrt((ux - u0) * (ux - u0) + (vx - v0) * (vx - v0));
+                        stepY = std::sqrt((uy - u0) * (uy - u0) + (vy - v0) * (vy - v0));
+                    }
+
+                    // Halve the source with its mip levels while both axes still shrink 2x, then supersample the rest
+                    if (filter != ResampleFilter::Nearest) {
+                        uint32_t level = 0;
+                        while (std::min(stepX, stepY) >= static_cast<float>(2u << level)) {
+                            ++level;
+                        }
+                        if (level > 0) {
+                            pyramid.resize(source.getWidth(), source.getHeight(), source.getFormat());
+                            level = std::min(level, pyramid.getLevelCount() - 1);
+                        }
+                        if (level > 0) {
+                            pyramid.update(source, level);
+                            setup.source = pyramid.getLevel(level);
+                            const float reduce = 1.0f / static_cast<float>(1u << level);
+                            for (int column = 0; column < 3; ++column) {
+                                setup.inverse.m[0][column] *= reduce;
+                                setup.inverse.m[1][column] *= reduce;
+                            }
+                            stepX *= reduce;
+                            stepY *= reduce;
+                        }
+                        // Mild reductions alias too little to be worth several samples
+                        setup.samplesX = std::min(std::max(static_cast<uint32_t>(std::ceil(stepX - SUPERSAMPLE_SLACK)), 1u), MAX_SUPERSAMPLES);
+                        setup.samplesY = std::min(std::max(static_cast<uint32_t>(std::ceil(stepY - SUPERSAMPLE_SLACK)), 1u), MAX_SUPERSAMPLES);
+                    }
+                }
+
+                const uint32_t columns = rect.x1 - rect.x0;
+                const size_t count = static_cast<size_t>(columns) * (rect.y1 - rect.y0);
+                Jobs::JobSystem::getInstance().parallelFor(count, [&](size_t index) {
+                    if (cancel && cancel->load(std::memory_order_relaxed)) {
+                        return;
+                    }
+                    const uint32_t tx = rect.x0 + static_cast<uint32_t>(index % columns);
+                    const uint32_t ty = rect.y0 + static_cast<uint32_t>(index / columns);
+                    // Blocks only write where the source lands, so whatever the tile held goes first
+                    target.clearTile(tx, ty);
+                    if (tx < reach.x0 || tx >= reach.x1 || ty < reach.y0 || ty >= reach.y1) {
+                        return;
+                    }
+                    resampleBlock(setup, target, tx, ty, tx * TILE_SIZE, ty * TILE_SIZE, (tx + 1) * TILE_SIZE, (ty + 1) * TILE_SIZE);
+                    if (target.getTile(tx, ty)) {
+                        target.compactTile(tx, ty);
+                    }
+                });
+            }
+
+            std::shared_ptr<TiledImage> transformImage(const TiledImage& source, const glm::mat3& transform,
+                                                       uint32_t width, uint32_t height, ResampleFilter filter,
+                                                       const std::atomic<bool>* cancel) {
+                auto result = std::make_shared<TiledImage>(width, height, source.getFormat());
+                const TileRect tiles = getTransformedTiles(source.getWidth(), source.getHeight(), transform, width, height);
+                transformInto(source, transform, *result, tiles, filter, cancel);
+                if (cancel && cancel->load()) {
+                    return nullptr;
+                }
+                return result;
+            }
+
+            void upsampleLevel(const TiledImage& proxy, uint32_t level, TiledImage& target, const TileRect& tiles) {
+                TileRect rect = tiles;
+                rect.x1 = std::min(rect.x1, target.getTilesX());
+                rect.y1 = std::min(rect.y1, target.getTilesY());
+                if (rect.isEmpty()) {
+                    return;
+                }
+                const uint32_t columns = rect.x1 - rect.x0;
+                const size_t count = static_cast<size_t>(columns) * (rect.y1 - rect.y0);
+                Jobs::JobSystem::getInstance().parallelFor(count, [&](size_t index) {
+                    const uint32_t tx = rect.x0 + static_cast<uint32_t>(index % columns);
+                    const uint32_t ty = rect.y0 + static_cast<uint32_t>(index / columns);
+                    const Tile* tile = proxy.getTile(tx >> level, ty >> level);
+                    if (!tile) {
+                        target.clearTile(tx, ty);
+                        return;
+                    }
+                    if (tile->isUniform()) {
+                        target.fillTile(tx, ty, tile->getUniformPixel());
+                        return;
+                    }
+                    uint8_t* pixels = target.getTileForWrite(tx, ty).getData();
+                    switch (getBytesPerPixel(target.getFormat())) {
+                        case 4:  upsampleTile<4>(tile->getData(), level, tx, ty, pixels); break;
+                        case 8:  upsampleTile<8>(tile->getData(), level, tx, ty, pixels); break;
+                        default: upsampleTile<16>(tile->getData(), level, tx, ty, pixels); break;
+                    }
+                    // The proxy tile's other pixels may be the only ones set
+                    target.compactTile(tx, ty);
+                }, 4);
+            }
+        }
+    }
+}
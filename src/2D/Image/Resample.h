@@ -0,0 +1,57 @@
+#pragma once
+
+#include "2D/Image/TiledImage.h"
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace AstralEngine {
+    namespace D2 {
+        enum class ResampleFilter {
+            Nearest,
+            Bilinear,
+            Bicubic // Catmull-Rom
+        };
+
+        /**
+         * @brief Resampling of tiled pixels through a 2D transform
+         *
+         * The transform maps source pixel coordinates to destination ones, with pixel (x, y)
+         * covering [x, x + 1) x [y, y + 1) and the third row allowing a perspective divide.
+         * Every destination pixel center is mapped back into the source and filtered there;
+         * outside the source is transparent, so edges come out antialiased.
+         *
+         * Work is split over destination tiles on the job system, and only tiles the
+         * transformed source bounds reach are visited; the rest stay missing. For each tile
+         * the source area it maps to is copied into a flat buffer once, so the kernels
+         * sample without tile lookups: on CPUs with AVX2, RGBA8 is filtered 8 pixels at a
+         * time with gathers, otherwise (and in other formats) one pixel at a time in floats.
+         * Blocks crossing a perspective horizon copy only the source they can reach.
+         *
+         * Downscales by 2x or more sample a mip level of the source, and the remaining
+         * minification is supersampled with up to MAX_SUPERSAMPLES samples per axis, so
+         * heavy reductions do not alias.
+         */
+        namespace Resample {
+            constexpr uint32_t MAX_SUPERSAMPLES = 4;
+
+            // Destination tiles the transformed `sourceWidth` x `sourceHeight` rectangle can reach
+            TileRect getTransformedTiles(uint32_t sourceWidth, uint32_t sourceHeight, const glm::mat3& transform,
+                                         uint32_t width, uint32_t height);
+
+            // Rewrites just `tiles` of `target` with `source` resampled into it; tiles the source misses are cleared
+            void transformInto(const TiledImage& source, const glm::mat3& transform, TiledImage& target,
+                               const TileRect& tiles, ResampleFilter filter, const std::atomic<bool>* cancel = nullptr);
+
+            // `source` resampled into a new `width` x `height` image; nullptr if `cancel` was raised
+            std::shared_ptr<TiledImage> transformImage(const TiledImage& source, const glm::mat3& transform,
+                                                       uint32_t width, uint32_t height, ResampleFilter filter,
+                                                       const std::atomic<bool>* cancel = nullptr);
+
+            // Rewrites `tiles` of `target` with level `level` of it enlarged nearest-neighbour,
+            // each proxy pixel becoming a 2^level square; for quick previews from a proxy
+            void upsampleLevel(const TiledImage& proxy, uint32_t level, TiledImage& target, const TileRect& tiles);
+        }
+    }
+}
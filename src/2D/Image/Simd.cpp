@@ -0,0 +1,45 @@
+#include "2D/Image/Simd.h"
+#include <atomic>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace Simd {
+            namespace {
+                std::atomic<bool> s_avx2Enabled{true};
+
+                bool detectAvx2() {
+#if !defined(AE_SIMD_AVX2_DISPATCH)
+                    return false;
+#elif defined(_MSC_VER)
+                    int info[4];
+                    __cpuid(info, 0);
+                    if (info[0] < 7) {
+                        return false;
+                    }
+                    __cpuid(info, 1);
+                    const bool fma = (info[2] & (1 << 12)) != 0;
+                    const bool osxsave = (info[2] & (1 << 27)) != 0;
+                    if (!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+                        return false; // The OS does not save YMM registers
+                    }
+                    __cpuidex(info, 7, 0);
+                    return (info[1] & (1 << 5)) != 0;
+#else
+                    // libgcc also checks that the OS saves YMM registers
+                    __builtin_cpu_init();
+                    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+                }
+            }
+
+            bool hasAvx2() {
+                static const bool supported = detectAvx2();
+                return supported && s_avx2Enabled.load(std::memory_order_relaxed);
+            }
+
+            void setAvx2Enabled(bool enabled) {
+                s_avx2Enabled.store(enabled, std::memory_order_relaxed);
+            }
+        }
+    }
+}
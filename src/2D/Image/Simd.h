@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+// Instruction sets available to pixel kernels, resolved at compile time.
+// AVX2 is enabled through the ASTRAL_ENABLE_AVX2 CMake option; SSE2 is the x86-64 baseline.
+// Hot kernels also carry an AVX2 variant marked AE_TARGET_AVX2, or built in a source file of its
+// own with AVX2 enabled where templates make that impractical, picked when Simd::hasAvx2().
+#if defined(__AVX2__)
+    #define AE_SIMD_AVX2 1
+#endif
+
+#if defined(__SSE4_1__) || defined(AE_SIMD_AVX2)
+    #define AE_SIMD_SSE41 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define AE_SIMD_SSE2 1
+#endif
+
+#if defined(AE_SIMD_SSE2)
+    #include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+// Functions built for AVX2 and FMA whatever the compiler flags, for runtime dispatch. They may
+// only call intrinsics and functions marked the same way (or plain scalar code), never lambdas.
+#if defined(AE_SIMD_SSE2) && (defined(__GNUC__) || defined(__clang__))
+    #define AE_SIMD_AVX2_DISPATCH 1
+    #define AE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#elif defined(AE_SIMD_SSE2) && defined(_MSC_VER)
+    #define AE_SIMD_AVX2_DISPATCH 1
+    #define AE_TARGET_AVX2
+#endif
+
+// Kernel building blocks must inline even in translation units with many template instances
+#if defined(_MSC_VER)
+    #define AE_FORCE_INLINE __forceinline
+#else
+    #define AE_FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace Simd {
+            // Whether AE_TARGET_AVX2 kernels may run: the CPU and OS support AVX2 and FMA, and they were not disabled
+            bool hasAvx2();
+
+            // Lets tests and benchmarks run the baseline kernels on AVX2 machines
+            void setAvx2Enabled(bool enabled);
+
+            // Index of the lowest set bit; mask must be non-zero
+            inline uint32_t countTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER)
+                unsigned long index;
+                _BitScanForward(&index, mask);
+                return static_cast<uint32_t>(index);
+#else
+                return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+            }
+        }
+    }
+}
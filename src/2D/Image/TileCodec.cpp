@@ -0,0 +1,88 @@
+#include "2D/Image/TileCodec.h"
+#include "2D/Image/PackBits.h"
+#include <array>
+#include <cstring>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace TileCodec {
+            TileCompression encode(const Tile& tile, std::vector<uint8_t>& out) {
+                return encode(tile.getFormat(), tile.getData(), out);
+            }
+            
+            bool decode(TileCompression compression, const uint8_t* data, size_t size, Tile& tile) {
+                return decode(compression, data, size, tile.getFormat(), tile.getData());
+            }
+            
+            TileCompression encode(PixelFormat format, const uint8_t* pixels, std::vector<uint8_t>& out) {
+                const uint32_t bpp = getBytesPerPixel(format);
+                const size_t byteSize = static_cast<size_t>(TILE_PIXELS) * bpp;
+                
+                out.clear();
+                out.reserve(byteSize / 4);
+                
+                std::array<uint8_t, TILE_PIXELS> plane;
+                for (uint32_t p = 0; p < bpp; ++p) {
+                    for (uint32_t y = 0; y < TILE_SIZE; ++y) {
+                        const uint8_t* row = pixels + static_cast<size_t>(y) * TILE_SIZE * bpp + p;
+                        uint8_t* planeRow = plane.data() + y * TILE_SIZE;
+                        uint8_t previous = 0;
+                        for (uint32_t x = 0; x < TILE_SIZE; ++x) {
+                            uint8_t value = row[x * bpp];
+                            planeRow[x] = static_cast<uint8_t>(value - previous);
+                            previous = value;
+                        }
+                    }
+                    PackBits::encode(plane.data(), plane.size(), out);
+                    
+                    // Incompressible content; give up early and store raw
+                    if (out.size() >= byteSize) {
+                        break;
+                    }
+                }
+                
+                if (out.size() >= byteSize) {
+                    out.assign(pixels, pixels + byteSize);
+                    return TileCompression::Raw;
+                }
+                return TileCompression::PlanarRLE;
+            }
+            
+            bool decode(TileCompression compression, const uint8_t* data, size_t size, PixelFormat format, uint8_t* pixels) {
+                if (compression == TileCompression::Raw) {
+                    if (size != static_cast<size_t>(TILE_PIXELS) * getBytesPerPixel(format)) {
+                        return false;
+                    }
+                    std::memcpy(pixels, data, size);
+                    return true;
+                }
+                
+                if (compression != TileCompression::PlanarRLE) {
+                    return false;
+                }
+                
+                const uint32_t bpp = getBytesPerPixel(format);
+                std::array<uint8_t, TILE_PIXELS> plane;
+                size_t offset = 0;
+                for (uint32_t p = 0; p < bpp; ++p) {
+                    size_t consumed = 0;
+                    if (!PackBits::decode(data + offset, size - offset, plane.data(), plane.size(), consumed)) {
+                        return false;
+                    }
+                    offset += consumed;
+                    
+                    for (uint32_t y = 0; y < TILE_SIZE; ++y) {
+                        uint8_t* row = pixels + static_cast<size_t>(y) * TILE_SIZE * bpp + p;
+                        const uint8_t* planeRow = plane.data() + y * TILE_SIZE;
+                        uint8_t value = 0;
+                        for (uint32_t x = 0; x < TILE_SIZE; ++x) {
+                            value = static_cast<uint8_t>(value + planeRow[x]);
+                            row[x * bpp] = value;
+                        }
+                    }
+                }
+                return offset == size;
+            }
+        }
+    }
+}
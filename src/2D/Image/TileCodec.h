@@ -0,0 +1,34 @@
+#pragma once
+
+#include "2D/Image/TiledImage.h"
+#include <cstdint>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        // How an encoded tile payload is stored
+        enum class TileCompression : uint8_t {
+            Raw = 0,       // Pixels as-is
+            PlanarRLE = 1  // Byte planes, horizontal delta per row, PackBits
+        };
+        
+        /**
+         * @brief Lossless, allocation-light tile codec
+         *
+         * Splitting pixels into byte planes and delta-coding rows turns flat and smoothly
+         * varying paint into long runs, which PackBits then collapses. It is not as tight as
+         * a general-purpose compressor but runs at memory speed and needs no dependency.
+         */
+        namespace TileCodec {
+            // Replaces `out` with the encoded tile and returns the compression that was used
+            TileCompression encode(const Tile& tile, std::vector<uint8_t>& out);
+            
+            // Decodes into `tile`, whose format must match the encoded data
+            bool decode(TileCompression compression, const uint8_t* data, size_t size, Tile& tile);
+            
+            // The same on a bare TILE_PIXELS buffer of `format` pixels, for storage that holds no Tile
+            TileCompression encode(PixelFormat format, const uint8_t* pixels, std::vector<uint8_t>& out);
+            bool decode(TileCompression compression, const uint8_t* data, size_t size, PixelFormat format, uint8_t* pixels);
+        }
+    }
+}
@@ -0,0 +1,469 @@
+#include "2D/Image/TileStore.h"
+#include "2D/Image/TileCodec.h"
+#include "Core/EngineConfig.h"
+#include "Core/JobSystem.h"
+#include "Core/Logger.h"
+#include "Core/MemoryManager.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            // Paging out stops this far below the budget, so the next frames do not page out again
+            constexpr size_t TRIM_HEADROOM_DIVISOR = 8;
+        }
+
+        TileStore& TileStore::getInstance() {
+            // Never destroyed: interned tiles and other statics unregister after main() returns
+            static TileStore* instance = new TileStore();
+            return *instance;
+        }
+
+        TileStore::TileStore() {
+            const EngineConfig& config = EngineConfig::getInstance();
+            m_budget.store(static_cast<size_t>(std::max(config.tileMemoryBudgetMB, 0)) << 20, std::memory_order_relaxed);
+            m_compression.store(config.compressTileSwap, std::memory_order_relaxed);
+        }
+
+        void TileStore::setMemoryBudget(size_t bytes) {
+            m_budget.store(bytes, std::memory_order_relaxed);
+            AE_DEBUG("Tile bellek bütçesi: {} MB", bytes >> 20);
+        }
+
+        void TileStore::setSwapPath(const std::string& path) {
+            std::lock_guard<std::mutex> lock(m_swapMutex);
+            if (!m_chunks.empty()) {
+                AE_WARN("Tile takas dosyası zaten açık: {}", m_swapPath);
+                return;
+            }
+            m_swapPath = path;
+            m_swapFailed = false;
+        }
+
+        TileStore::Shard& TileStore::getShard(const Tile& tile) {
+            return m_shards[(reinterpret_cast<uintptr_t>(&tile) / alignof(Tile)) % SHARD_COUNT];
+        }
+
+        void TileStore::add(Tile& tile) {
+            Shard& shard = getShard(tile);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            tile.m_next = shard.head;
+            if (shard.head) {
+                shard.head->m_previous = &tile;
+            }
+            shard.head = &tile;
+            ++shard.count;
+            m_residentBytes.fetch_add(tile.getByteSize(), std::memory_order_relaxed);
+        }
+
+        void TileStore::remove(Tile& tile) {
+            {
+                Shard& shard = getShard(tile);
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                if (tile.m_previous) {
+                    tile.m_previous->m_next = tile.m_next;
+                } else {
+                    shard.head = tile.m_next;
+                }
+                if (tile.m_next) {
+                    tile.m_next->m_previous = tile.m_previous;
+                }
+                --shard.count;
+                if (tile.m_resident.load(std::memory_order_relaxed)) {
+                    m_residentBytes.fetch_sub(tile.getByteSize(), std::memory_order_relaxed);
+                } else {
+                    m_pagedOutCount.fetch_sub(1, std::memory_order_relaxed);
+                }
+            }
+            if (tile.m_swapSize != 0) {
+                releaseSlot(tile);
+            }
+        }
+
+        void TileStore::pageIn(const Tile& tile) {
+            Shard& shard = getShard(tile);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            // Another thread may have brought it back while this one waited
+            if (tile.m_resident.load(std::memory_order_relaxed)) {
+                return;
+            }
+
+            const uint8_t* slot = nullptr;
+            {
+                // Chunks stay mapped at the same address until shutdown, so only the lookup needs the lock
+                std::lock_guard<std::mutex> swapLock(m_swapMutex);
+                const size_t chunk = static_cast<size_t>(tile.m_swapOffset / SWAP_CHUNK_SIZE);
+                if (chunk < m_chunks.size()) {
+                    slot = m_chunks[chunk].data + tile.m_swapOffset % SWAP_CHUNK_SIZE;
+                }
+            }
+            tile.m_data.resize(tile.getByteSize());
+            if (!slot || !TileCodec::decode(static_cast<TileCompression>(tile.m_swapCompression), slot, tile.m_swapSize,
+                                            tile.m_format, tile.m_data.data())) {
+                AE_ERROR("Takas dosyasından tile okunamadı (konum {})", tile.m_swapOffset);
+                std::fill(tile.m_data.begin(), tile.m_data.end(), uint8_t(0));
+            }
+
+            m_residentBytes.fetch_add(tile.getByteSize(), std::memory_order_relaxed);
+            m_pagedOutCount.fetch_sub(1, std::memory_order_relaxed);
+            m_pageIns.fetch_add(1, std::memory_order_relaxed);
+            tile.m_resident.store(true, std::memory_order_release);
+        }
+
+        void TileStore::releaseSlot(Tile& tile) {
+            std::lock_guard<std::mutex> lock(m_swapMutex);
+            freeSlot(tile.m_swapOffset, tile.m_swapSize);
+            tile.m_swapSize = 0;
+        }
+
+        bool TileStore::isMainThread(const char* caller) {
+            const std::thread::id current = std::this_thread::get_id();
+            std::thread::id expected{};
+            if (m_mainThread.compare_exchange_strong(expected, current, std::memory_order_relaxed) || expected == current) {
+                return true;
+            }
+            // Paging out here could free pixels the main thread is reading
+            AE_ERROR("TileStore::{} ana thread dışından çağrıldı, yok sayılıyor", caller);
+            return false;
+        }
+
+        void TileStore::update() {
+            if (!isMainThread("update")) {
+                return;
+            }
+
+            // Tiles used from here on count as used in the new frame
+            Tile::s_frame.fetch_add(1, std::memory_order_relaxed);
+
+            m_prefetches.erase(std::remove_if(m_prefetches.begin(), m_prefetches.end(), [](const std::future<void>& job) {
+                return job.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+            }), m_prefetches.end());
+
+            const size_t budget = m_budget.load(std::memory_order_relaxed);
+            if (budget > 0 && m_residentBytes.load(std::memory_order_relaxed) > budget) {
+                Jobs::JobSystem::getInstance().runWhileIdle([this]() { trim(); });
+            }
+
+            const Stats stats = getStats();
+            Memory::PagingStats paging;
+            paging.residentBytes = stats.residentBytes;
+            paging.budgetBytes = stats.budgetBytes;
+            paging.swappedBytes = stats.swappedBytes;
+            paging.swapFileBytes = stats.swapFileBytes;
+            paging.pageIns = stats.pageIns;
+            paging.pageOuts = stats.pageOuts;
+            Memory::MemoryManager::getInstance().setPagingStats(paging);
+        }
+
+        void TileStore::trim() {
+            const uint32_t frame = Tile::s_frame.load(std::memory_order_relaxed);
+            const size_t budget = m_budget.load(std::memory_order_relaxed);
+            const size_t target = budget - budget / TRIM_HEADROOM_DIVISOR;
+
+            // Nothing runs concurrently, but tiles may still be created or destroyed on this thread
+            std::vector<std::pair<uint32_t, Tile*>> candidates;
+            for (Shard& shard : m_shards) {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                for (Tile* tile = shard.head; tile; tile = tile->m_next) {
+                    // Tiles of the last frame are the working set; interned uniform tiles are shared by design
+                    const uint32_t lastUse = tile->m_lastUse.load(std::memory_order_relaxed);
+                    if (tile->m_resident.load(std::memory_order_relaxed) && !tile->m_uniform &&
+                        static_cast<int32_t>(frame - lastUse) > 1) {
+                        candidates.emplace_back(frame - lastUse, tile);
+                    }
+                }
+            }
+            std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+            size_t pagedOut = 0;
+            for (const auto& candidate : candidates) {
+                if (m_residentBytes.load(std::memory_order_relaxed) <= target) {
+                    break;
+                }
+                if (!pageOut(*candidate.second)) {
+                    break;
+                }
+                ++pagedOut;
+            }
+
+#ifndef _WIN32
+            // The written pages now only need to live in the page cache, where the kernel can write them back
+            if (pagedOut > 0) {
+                std::lock_guard<std::mutex> lock(m_swapMutex);
+                for (const SwapChunk& chunk : m_chunks) {
+                    madvise(chunk.data, SWAP_CHUNK_SIZE, MADV_DONTNEED);
+                }
+            }
+#endif
+            if (pagedOut > 0) {
+                AE_DEBUG("{} tile takas dosyasına yazıldı, bellekte {} MB", pagedOut,
+                         m_residentBytes.load(std::memory_order_relaxed) >> 20);
+            }
+        }
+
+        bool TileStore::pageOut(Tile& tile) {
+            if (tile.m_swapSize == 0) {
+                TileCompression compression = TileCompression::Raw;
+                if (m_compression.load(std::memory_order_relaxed)) {
+                    compression = TileCodec::encode(tile.m_format, tile.m_data.data(), m_encodeBuffer);
+                } else {
+                    m_encodeBuffer.assign(tile.m_data.begin(), tile.m_data.end());
+                }
+
+                std::lock_guard<std::mutex> lock(m_swapMutex);
+                uint64_t offset = 0;
+                if (!allocateSlot(m_encodeBuffer.size(), offset)) {
+                    return false;
+                }
+                std::memcpy(m_chunks[offset / SWAP_CHUNK_SIZE].data + offset % SWAP_CHUNK_SIZE,
+                            m_encodeBuffer.data(), m_encodeBuffer.size());
+                tile.m_swapOffset = offset;
+                tile.m_swapSize = static_cast<uint32_t>(m_encodeBuffer.size());
+                tile.m_swapCompression = static_cast<uint8_t>(compression);
+            }
+
+            std::vector<uint8_t>().swap(tile.m_data);
+            tile.m_resident.store(false, std::memory_order_release);
+            m_residentBytes.fetch_sub(tile.getByteSize(), std::memory_order_relaxed);
+            m_pagedOutCount.fetch_add(1, std::memory_order_relaxed);
+            m_pageOuts.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        bool TileStore::allocateSlot(size_t size, uint64_t& offset) {
+            size = (size + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT;
+
+            // Best fit among freed ranges; the rest of a larger one stays free
+            auto fit = m_freeBySize.lower_bound({size, 0});
+            if (fit != m_freeBySize.end()) {
+                offset = fit->second;
+                const uint64_t remainder = fit->first - size;
+                eraseFreeRange(m_freeRanges.find(offset));
+                if (remainder > 0) {
+                    insertFreeRange(offset + size, remainder);
+                }
+                m_swappedBytes += size;
+                return true;
+            }
+
+            // Slots never straddle chunks; the unused end of a chunk becomes a free range
+            uint64_t start = m_swapEnd;
+            if (start % SWAP_CHUNK_SIZE + size > SWAP_CHUNK_SIZE) {
+                start = (start / SWAP_CHUNK_SIZE + 1) * SWAP_CHUNK_SIZE;
+            }
+            if (start + size > static_cast<uint64_t>(m_chunks.size()) * SWAP_CHUNK_SIZE && !addChunk()) {
+                return false;
+            }
+            if (start > m_swapEnd) {
+                insertFreeRange(m_swapEnd, start - m_swapEnd);
+            }
+            offset = start;
+            m_swapEnd = start + size;
+            m_swappedBytes += size;
+            return true;
+        }
+
+        void TileStore::freeSlot(uint64_t offset, size_t size) {
+            size = (size + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT;
+            m_swappedBytes -= size;
+            uint64_t end = offset + size;
+
+            // Merge with the free neighbours on both sides, but not across a chunk boundary
+            auto next = m_freeRanges.lower_bound(offset);
+            if (next != m_freeRanges.end() && next->first == end && end % SWAP_CHUNK_SIZE != 0) {
+                end += next->second;
+                auto after = std::next(next);
+                eraseFreeRange(next);
+                next = after;
+            }
+            if (next != m_freeRanges.begin()) {
+                auto prev = std::prev(next);
+                if (prev->first + prev->second == offset && offset % SWAP_CHUNK_SIZE != 0) {
+                    offset = prev->first;
+                    eraseFreeRange(prev);
+                }
+            }
+            if (end != m_swapEnd) {
+                insertFreeRange(offset, end - offset);
+                return;
+            }
+
+            // A free tail is given back, along with the unused ends of the chunks it uncovers
+            m_swapEnd = offset;
+            while (!m_freeRanges.empty()) {
+                auto last = std::prev(m_freeRanges.end());
+                if (last->first + last->second != m_swapEnd) {
+                    break;
+                }
+                m_swapEnd = last->first;
+                eraseFreeRange(last);
+            }
+        }
+
+        void TileStore::insertFreeRange(uint64_t offset, uint64_t size) {
+            m_freeRanges.emplace(offset, size);
+            m_freeBySize.emplace(size, offset);
+        }
+
+        void TileStore::eraseFreeRange(std::map<uint64_t, uint64_t>::iterator it) {
+            m_freeBySize.erase({it->second, it->first});
+            m_freeRanges.erase(it);
+        }
+
+        bool TileStore::addChunk() {
+            if (m_swapPath.empty() || m_swapFailed) {
+                return false;
+            }
+            const uint64_t offset = static_cast<uint64_t>(m_chunks.size()) * SWAP_CHUNK_SIZE;
+            const uint64_t fileSize = offset + SWAP_CHUNK_SIZE;
+            SwapChunk chunk;
+
+#ifdef _WIN32
+            if (!m_fileHandle) {
+                // Deleted by the system once the last handle closes
+                HANDLE file = CreateFileA(m_swapPath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                                          FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+                if (file == INVALID_HANDLE_VALUE) {
+                    AE_ERROR("Tile takas dosyası açılamadı: {}", m_swapPath);
+                    m_swapFailed = true;
+                    return false;
+                }
+                m_fileHandle = file;
+            }
+            // A mapping larger than the file extends it
+            HANDLE mapping = CreateFileMappingA(static_cast<HANDLE>(m_fileHandle), nullptr, PAGE_READWRITE,
+                                                static_cast<DWORD>(fileSize >> 32), static_cast<DWORD>(fileSize), nullptr);
+            void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_WRITE, static_cast<DWORD>(offset >> 32),
+                                                 static_cast<DWORD>(offset), SWAP_CHUNK_SIZE) : nullptr;
+            if (!view) {
+                if (mapping) {
+                    CloseHandle(mapping);
+                }
+                AE_ERROR("Tile takas dosyası büyütülemedi: {}", m_swapPath);
+                m_swapFailed = true;
+                return false;
+            }
+            chunk.mappingHandle = mapping;
+            chunk.data = static_cast<uint8_t*>(view);
+#else
+            if (m_file < 0) {
+                m_file = ::open(m_swapPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+                if (m_file < 0) {
+                    AE_ERROR("Tile takas dosyası açılamadı: {}", m_swapPath);
+                    m_swapFailed = true;
+                    return false;
+                }
+                // The open descriptor keeps the data; nothing is left behind if the process dies
+                ::unlink(m_swapPath.c_str());
+            }
+            void* view = MAP_FAILED;
+            if (ftruncate(m_file, static_cast<off_t>(fileSize)) == 0) {
+                view = mmap(nullptr, SWAP_CHUNK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, static_cast<off_t>(offset));
+            }
+            if (view == MAP_FAILED) {
+                AE_ERROR("Tile takas dosyası büyütülemedi: {}", m_swapPath);
+                m_swapFailed = true;
+                return false;
+            }
+            chunk.data = static_cast<uint8_t*>(view);
+#endif
+            m_chunks.push_back(chunk);
+            AE_DEBUG("Tile takas dosyası {} MB oldu", (fileSize >> 20));
+            return true;
+        }
+
+        void TileStore::prefetch(const TiledImage& image, const TileRect& tiles) {
+            if (!isMainThread("prefetch")) {
+                return;
+            }
+            // Shared, so tiles dropped by the image meanwhile are still safe to page in
+            std::vector<std::shared_ptr<const Tile>> pagedOut;
+            const uint32_t x1 = std::min(tiles.x1, image.getTilesX());
+            const uint32_t y1 = std::min(tiles.y1, image.getTilesY());
+            for (uint32_t ty = tiles.y0; ty < y1; ++ty) {
+                for (uint32_t tx = tiles.x0; tx < x1; ++tx) {
+                    const Tile* tile = image.getTile(tx, ty);
+                    if (tile && !tile->isResident()) {
+                        pagedOut.push_back(image.shareTile(tx, ty));
+                    }
+                }
+            }
+            if (pagedOut.empty()) {
+                return;
+            }
+            m_prefetches.push_back(Jobs::JobSystem::getInstance().submit([pagedOut = std::move(pagedOut)]() {
+                for (const auto& tile : pagedOut) {
+                    tile->getData();
+                }
+            }));
+        }
+
+        TileStore::Stats TileStore::getStats() const {
+            Stats stats;
+            stats.residentBytes = m_residentBytes.load(std::memory_order_relaxed);
+            stats.budgetBytes = m_budget.load(std::memory_order_relaxed);
+            stats.pagedOutCount = m_pagedOutCount.load(std::memory_order_relaxed);
+            stats.pageIns = m_pageIns.load(std::memory_order_relaxed);
+            stats.pageOuts = m_pageOuts.load(std::memory_order_relaxed);
+            for (const Shard& shard : m_shards) {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                stats.tileCount += shard.count;
+            }
+            std::lock_guard<std::mutex> lock(m_swapMutex);
+            stats.swappedBytes = m_swappedBytes;
+            stats.swapFileBytes = m_chunks.size() * SWAP_CHUNK_SIZE;
+            return stats;
+        }
+
+        void TileStore::shutdown() {
+            for (auto& job : m_prefetches) {
+                job.wait();
+            }
+            m_prefetches.clear();
+
+            std::lock_guard<std::mutex> lock(m_swapMutex);
+            closeSwap();
+        }
+
+        void TileStore::closeSwap() {
+            for (SwapChunk& chunk : m_chunks) {
+#ifdef _WIN32
+                UnmapViewOfFile(chunk.data);
+                CloseHandle(static_cast<HANDLE>(chunk.mappingHandle));
+#else
+                munmap(chunk.data, SWAP_CHUNK_SIZE);
+#endif
+            }
+            m_chunks.clear();
+#ifdef _WIN32
+            if (m_fileHandle) {
+                CloseHandle(static_cast<HANDLE>(m_fileHandle));
+                m_fileHandle = nullptr;
+            }
+#else
+            if (m_file >= 0) {
+                ::close(m_file);
+                m_file = -1;
+            }
+#endif
+            m_swapEnd = 0;
+            m_swappedBytes = 0;
+            m_freeRanges.clear();
+            m_freeBySize.clear();
+        }
+    }
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "2D/Image/TiledImage.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        /**
+         * @brief Out-of-core storage for tile pixels
+         *
+         * Every Tile registers here. Once the pixels of all tiles outgrow the memory budget,
+         * update() pages out tiles that were not used in the last frame, least recently
+         * used first, until usage is back under the budget with some headroom. Paged-out
+         * pixels go to a swap file mapped in SWAP_CHUNK_SIZE chunks, TileCodec-compressed
+         * unless compression is turned off, and come back on the tile's next getData().
+         * A tile keeps its swap slot until it is written or destroyed, so paging out a tile
+         * that was only read again costs nothing.
+         *
+         * Paging out frees pixels that a getData() pointer may still point into, so it
+         * only happens in update() on the main thread, between frames, and only while the
+         * job system is idle; update() skips a frame rather than wait. A getData() pointer
+         * therefore stays valid for the rest of the frame on the main thread and for the
+         * lifetime of the job that took it. update() and prefetch() refuse to run on any
+         * thread but the first one to call update(). Paging in is safe from any thread.
+         * prefetch() pages tiles in on the job system ahead of use, e.g. around the brush
+         * or the visible part of the canvas.
+         *
+         * The budget and compression start out from EngineConfig; a budget of 0 never
+         * pages out. The swap file is deleted as soon as it is created, so it never
+         * outlives the process.
+         */
+        class TileStore {
+        public:
+            static constexpr size_t SWAP_CHUNK_SIZE = size_t(64) << 20;
+
+            struct Stats {
+                size_t residentBytes = 0; // Pixels of tiles in memory
+                size_t budgetBytes = 0;
+                size_t swappedBytes = 0;  // Swap slots in use, including clean copies of resident tiles
+                size_t swapFileBytes = 0;
+                size_t tileCount = 0;
+                size_t pagedOutCount = 0;
+                uint64_t pageIns = 0;
+                uint64_t pageOuts = 0;
+            };
+
+            static TileStore& getInstance();
+
+            TileStore(const TileStore&) = delete;
+            TileStore& operator=(const TileStore&) = delete;
+
+            // Bytes of tile pixels kept in memory; 0 never pages out
+            void setMemoryBudget(size_t bytes);
+            size_t getMemoryBudget() const { return m_budget.load(std::memory_order_relaxed); }
+            // Swap file to create on the first page-out; ignored once it exists
+            void setSwapPath(const std::string& path);
+            void setCompression(bool enabled) { m_compression.store(enabled, std::memory_order_relaxed); }
+            bool isCompressionEnabled() const { return m_compression.load(std::memory_order_relaxed); }
+
+            // Call once per frame from the main thread, outside any job; ends the frame tile use is
+            // stamped with and pages out over the budget. Also publishes the stats to MemoryManager.
+            void update();
+
+            // Pages `tiles` of `image` back in on the job system; main thread only
+            void prefetch(const TiledImage& image, const TileRect& tiles);
+
+            Stats getStats() const;
+
+            // Waits for prefetches and closes the swap file; tiles paged out by then are lost
+            void shutdown();
+
+        private:
+            friend class Tile;
+
+            static constexpr size_t SHARD_COUNT = 16;
+            static constexpr size_t SLOT_ALIGNMENT = 256;
+
+            // Tiles are linked into one of several lists so construction on many threads does not contend
+            struct Shard {
+                mutable std::mutex mutex; // Also serializes paging in this shard's tiles
+                Tile* head = nullptr;
+                size_t count = 0;
+            };
+
+            struct SwapChunk {
+                uint8_t* data = nullptr;
+#ifdef _WIN32
+                void* mappingHandle = nullptr;
+#endif
+            };
+
+            TileStore();
+            ~TileStore() = default;
+
+            // Claims the main thread on the first call; false elsewhere
+            bool isMainThread(const char* caller);
+
+            Shard& getShard(const Tile& tile);
+            void add(Tile& tile);
+            void remove(Tile& tile);
+            void pageIn(const Tile& tile);
+            // Frees the tile's swap slot; its pixels are about to change
+            void releaseSlot(Tile& tile);
+
+            // Only while the job system is idle
+            void trim();
+            bool pageOut(Tile& tile);
+            // Called with m_swapMutex held
+            bool allocateSlot(size_t size, uint64_t& offset);
+            bool addChunk();
+            void freeSlot(uint64_t offset, size_t size);
+            void insertFreeRange(uint64_t offset, uint64_t size);
+            void eraseFreeRange(std::map<uint64_t, uint64_t>::iterator it);
+            void closeSwap();
+
+            std::array<Shard, SHARD_COUNT> m_shards;
+            std::atomic<size_t> m_budget{0};
+            std::atomic<size_t> m_residentBytes{0};
+            std::atomic<size_t> m_pagedOutCount{0};
+            std::atomic<uint64_t> m_pageIns{0};
+            std::atomic<uint64_t> m_pageOuts{0};
+            std::atomic<bool> m_compression{true};
+            std::atomic<std::thread::id> m_mainThread{};
+
+            mutable std::mutex m_swapMutex;
+            std::string m_swapPath;
+            bool m_swapFailed = false;
+#ifdef _WIN32
+            void* m_fileHandle = nullptr;
+#else
+            int m_file = -1;
+#endif
+            std::vector<SwapChunk> m_chunks;
+            uint64_t m_swapEnd = 0;
+            size_t m_swappedBytes = 0;
+            std::map<uint64_t, uint64_t> m_freeRanges; // Offset -> size of unused ranges below m_swapEnd
+            std::set<std::pair<uint64_t, uint64_t>> m_freeBySize; // (size, offset) of the same ranges, for best fit
+            std::vector<uint8_t> m_encodeBuffer;
+
+            std::vector<std::future<void>> m_prefetches;
+        };
+    }
+}
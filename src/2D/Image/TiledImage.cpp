@@ -0,0 +1,274 @@
+#include "2D/Image/TiledImage.h"
+#include "2D/Image/TileStore.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            // Interned uniform tiles are kept alive here; past the cap new colors get private tiles
+            constexpr size_t MAX_INTERNED_UNIFORM_TILES = 256;
+            
+            std::mutex s_uniformMutex;
+            std::unordered_map<std::string, std::shared_ptr<Tile>> s_uniformTiles;
+            
+            bool isTransparent(PixelFormat format, const void* pixel) {
+                static const uint8_t zero[16] = {};
+                return std::memcmp(pixel, zero, getBytesPerPixel(format)) == 0;
+            }
+        }
+        
+        void TileRect::merge(const TileRect& other) {
+            if (other.isEmpty()) {
+                return;
+            }
+            if (isEmpty()) {
+                *this = other;
+                return;
+            }
+            x0 = std::min(x0, other.x0);
+            y0 = std::min(y0, other.y0);
+            x1 = std::max(x1, other.x1);
+            y1 = std::max(y1, other.y1);
+        }
+        
+        void DirtyTileSet::resize(uint32_t tilesX, uint32_t tilesY) {
+            m_tilesX = tilesX;
+            m_tilesY = tilesY;
+            m_flags.assign(static_cast<size_t>(tilesX) * tilesY, 0);
+            m_indices.clear();
+            m_bounds = TileRect();
+        }
+        
+        void DirtyTileSet::add(uint32_t tx, uint32_t ty) {
+            assert(tx < m_tilesX && ty < m_tilesY);
+            uint32_t index = ty * m_tilesX + tx;
+            if (!m_flags[index]) {
+                m_flags[index] = 1;
+                m_indices.push_back(index);
+                m_bounds.merge({tx, ty, tx + 1, ty + 1});
+            }
+        }
+        
+        void DirtyTileSet::add(const TileRect& tiles) {
+            const uint32_t x1 = std::min(tiles.x1, m_tilesX);
+            const uint32_t y1 = std::min(tiles.y1, m_tilesY);
+            for (uint32_t ty = tiles.y0; ty < y1; ++ty) {
+                for (uint32_t tx = tiles.x0; tx < x1; ++tx) {
+                    add(tx, ty);
+                }
+            }
+        }
+        
+        void DirtyTileSet::addAll() {
+            add({0, 0, m_tilesX, m_tilesY});
+        }
+        
+        void DirtyTileSet::merge(const DirtyTileSet& other) {
+            if (other.m_tilesX != m_tilesX || other.m_tilesY != m_tilesY) {
+                // Different grids cannot be mapped tile by tile; be conservative
+                addAll();
+                return;
+            }
+            for (uint32_t index : other.m_indices) {
+                add(index % m_tilesX, index / m_tilesX);
+            }
+        }
+        
+        void DirtyTileSet::clear() {
+            for (uint32_t index : m_indices) {
+                m_flags[index] = 0;
+            }
+            m_indices.clear();
+            m_bounds = TileRect();
+        }
+        
+        std::atomic<uint32_t> Tile::s_frame{0};
+        
+        Tile::Tile(PixelFormat format)
+            : m_format(format), m_revision(nextRevision()),
+              m_data(static_cast<size_t>(TILE_PIXELS) * getBytesPerPixel(format), 0),
+              m_lastUse(s_frame.load(std::memory_order_relaxed)) {
+            TileStore::getInstance().add(*this);
+        }
+        
+        Tile::Tile(const Tile& other)
+            : m_format(other.m_format), m_revision(other.m_revision), m_uniform(other.m_uniform),
+              m_lastUse(s_frame.load(std::memory_order_relaxed)) {
+            const uint8_t* pixels = other.getData();
+            m_data.assign(pixels, pixels + other.getByteSize());
+            TileStore::getInstance().add(*this);
+        }
+        
+        Tile::~Tile() {
+            TileStore::getInstance().remove(*this);
+        }
+        
+        void Tile::touch() {
+            // The swap copy goes stale with the write that follows
+            use();
+            if (m_swapSize != 0) {
+                TileStore::getInstance().releaseSlot(*this);
+            }
+            m_revision = nextRevision();
+            m_uniform = false;
+        }
+        
+        void Tile::pageIn() const {
+            TileStore::getInstance().pageIn(*this);
+        }
+        
+        bool Tile::detectUniform() const {
+            const size_t pixelSize = getBytesPerPixel(m_format);
+            const uint8_t* first = getData();
+            // Compare against the already-verified prefix, doubling it each step
+            size_t verified = pixelSize;
+            while (verified < m_data.size()) {
+                size_t chunk = std::min(verified, m_data.size() - verified);
+                if (std::memcmp(first, first + verified, chunk) != 0) {
+                    return false;
+                }
+                verified += chunk;
+            }
+            return true;
+        }
+        
+        std::shared_ptr<Tile> Tile::makeUniform(PixelFormat format, const void* pixel) {
+            const size_t pixelSize = getBytesPerPixel(format);
+            std::string key(1, static_cast<char>(format));
+            key.append(static_cast<const char*>(pixel), pixelSize);
+            
+            std::lock_guard<std::mutex> lock(s_uniformMutex);
+            auto it = s_uniformTiles.find(key);
+            if (it != s_uniformTiles.end()) {
+                return it->second;
+            }
+            
+            auto tile = std::make_shared<Tile>(format);
+            for (size_t offset = 0; offset < tile->m_data.size(); offset += pixelSize) {
+                std::memcpy(tile->m_data.data() + offset, pixel, pixelSize);
+            }
+            tile->m_uniform = true;
+            if (s_uniformTiles.size() < MAX_INTERNED_UNIFORM_TILES) {
+                s_uniformTiles.emplace(std::move(key), tile);
+            }
+            return tile;
+        }
+        
+        uint64_t Tile::nextRevision() {
+            static std::atomic<uint64_t> s_revision{1};
+            return s_revision.fetch_add(1, std::memory_order_relaxed);
+        }
+        
+        TiledImage::TiledImage(uint32_t width, uint32_t height, PixelFormat format)
+            : m_width(width), m_height(height), m_format(format),
+              m_tilesX((width + TILE_SIZE - 1) / TILE_SIZE),
+              m_tilesY((height + TILE_SIZE - 1) / TILE_SIZE) {
+            m_tiles.resize(static_cast<size_t>(m_tilesX) * m_tilesY);
+        }
+        
+        const Tile* TiledImage::getTile(uint32_t tx, uint32_t ty) const {
+            assert(tx < m_tilesX && ty < m_tilesY);
+            return m_tiles[tileIndex(tx, ty)].get();
+        }
+        
+        std::shared_ptr<const Tile> TiledImage::shareTile(uint32_t tx, uint32_t ty) const {
+            assert(tx < m_tilesX && ty < m_tilesY);
+            return m_tiles[tileIndex(tx, ty)];
+        }
+        
+        Tile& TiledImage::getTileForWrite(uint32_t tx, uint32_t ty) {
+            assert(tx < m_tilesX && ty < m_tilesY);
+            auto& tile = m_tiles[tileIndex(tx, ty)];
+            if (!tile) {
+                tile = std::make_shared<Tile>(m_format);
+            } else {
+                // Interned uniform tiles are always shared with the cache, so they land here too
+                if (tile.use_count() > 1 || tile->isUniform()) {
+                    tile = std::make_shared<Tile>(*tile);
+                }
+                tile->touch();
+            }
+            return *tile;
+        }
+        
+        void TiledImage::setTile(uint32_t tx, uint32_t ty, std::shared_ptr<Tile> tile) {
+            assert(tx < m_tilesX && ty < m_tilesY);
+            assert(!tile || tile->getFormat() == m_format);
+            m_tiles[tileIndex(tx, ty)] = std::move(tile);
+        }
+        
+        void TiledImage::swapTile(uint32_t tx, uint32_t ty, std::shared_ptr<const Tile>& tile) {
+            assert(tx < m_tilesX && ty < m_tilesY);
+            assert(!tile || tile->getFormat() == m_format);
+            std::shared_ptr<Tile> incoming = std::const_pointer_cast<Tile>(tile);
+            tile = std::move(m_tiles[tileIndex(tx, ty)]);
+            m_tiles[tileIndex(tx, ty)] = std::move(incoming);
+        }
+        
+        void TiledImage::clearTile(uint32_t tx, uint32_t ty) {
+            setTile(tx, ty, nullptr);
+        }
+        
+        void TiledImage::clear() {
+            for (auto& tile : m_tiles) {
+                tile.reset();
+            }
+        }
+        
+        void TiledImage::fillTile(uint32_t tx, uint32_t ty, const void* pixel) {
+            setTile(tx, ty, isTransparent(m_format, pixel) ? nullptr : Tile::makeUniform(m_format, pixel));
+        }
+        
+        void TiledImage::fill(const void* pixel) {
+            std::shared_ptr<Tile> tile = isTransparent(m_format, pixel) ? nullptr : Tile::makeUniform(m_format, pixel);
+            for (auto& slot : m_tiles) {
+                slot = tile;
+            }
+        }
+        
+        bool TiledImage::compactTile(uint32_t tx, uint32_t ty) {
+            assert(tx < m_tilesX && ty < m_tilesY);
+            auto& tile = m_tiles[tileIndex(tx, ty)];
+            if (!tile || tile->isUniform() || !tile->detectUniform()) {
+                return false;
+            }
+            const uint8_t* pixel = tile->getUniformPixel();
+            tile = isTransparent(m_format, pixel) ? nullptr : Tile::makeUniform(m_format, pixel);
+            return true;
+        }
+        
+        void TiledImage::compact() {
+            for (uint32_t ty = 0; ty < m_tilesY; ++ty) {
+                for (uint32_t tx = 0; tx < m_tilesX; ++tx) {
+                    compactTile(tx, ty);
+                }
+            }
+        }
+        
+        size_t TiledImage::getAllocatedTileCount() const {
+            size_t count = 0;
+            for (const auto& tile : m_tiles) {
+                if (tile) {
+                    ++count;
+                }
+            }
+            return count;
+        }
+        
+        size_t TiledImage::getExclusiveMemoryUsage() const {
+            size_t bytes = 0;
+            for (const auto& tile : m_tiles) {
+                if (tile && !tile->isUniform() && tile.use_count() == 1) {
+                    bytes += tile->getByteSize();
+                }
+            }
+            return bytes;
+        }
+    }
+}
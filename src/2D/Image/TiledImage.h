@@ -0,0 +1,228 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        // Pixel storage formats for layer data. Pixels are always RGBA, premultiplied.
+        enum class PixelFormat : uint8_t {
+            RGBA8,
+            RGBA16,
+            RGBA32F
+        };
+        
+        constexpr uint32_t getBytesPerPixel(PixelFormat format) {
+            switch (format) {
+                case PixelFormat::RGBA8:   return 4;
+                case PixelFormat::RGBA16:  return 8;
+                case PixelFormat::RGBA32F: return 16;
+            }
+            return 4;
+        }
+        
+        // Edge length of a tile in pixels
+        constexpr uint32_t TILE_SIZE = 64;
+        constexpr uint32_t TILE_PIXELS = TILE_SIZE * TILE_SIZE;
+        
+        // Half-open range of tile coordinates
+        struct TileRect {
+            uint32_t x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+            
+            bool isEmpty() const { return x0 >= x1 || y0 >= y1; }
+            void merge(const TileRect& other);
+        };
+        
+        /**
+         * @brief Set of tiles whose pixels changed since a consumer last looked
+         *
+         * Keeps a flag per tile plus the list of set tiles, so adding, iterating and
+         * clearing cost O(dirty tiles) rather than O(canvas).
+         */
+        class DirtyTileSet {
+        public:
+            // Resizing drops the current contents
+            void resize(uint32_t tilesX, uint32_t tilesY);
+            uint32_t getTilesX() const { return m_tilesX; }
+            uint32_t getTilesY() const { return m_tilesY; }
+            
+            void add(uint32_t tx, uint32_t ty);
+            void add(const TileRect& tiles);
+            void addAll();
+            void merge(const DirtyTileSet& other);
+            void clear();
+            
+            bool contains(uint32_t tx, uint32_t ty) const { return m_flags[ty * m_tilesX + tx] != 0; }
+            bool isEmpty() const { return m_indices.empty(); }
+            size_t getCount() const { return m_indices.size(); }
+            const TileRect& getBounds() const { return m_bounds; }
+            
+            // Row-major tile indices (ty * tilesX + tx) in insertion order
+            const std::vector<uint32_t>& getIndices() const { return m_indices; }
+            
+        private:
+            uint32_t m_tilesX = 0;
+            uint32_t m_tilesY = 0;
+            std::vector<uint8_t> m_flags;
+            std::vector<uint32_t> m_indices;
+            TileRect m_bounds;
+        };
+        
+        /**
+         * @brief Fixed-size block of layer pixels
+         *
+         * Every write access gives the tile a new, globally unique revision. Savers and
+         * caches compare revisions to tell whether the pixels changed since they last looked.
+         *
+         * Tiles are shared between images (duplicated layers, undo snapshots) and copied
+         * on write by TiledImage, so a tile reachable from more than one place is never
+         * modified in place.
+         *
+         * Every tile is known to the TileStore, which may page the pixels of tiles that
+         * went unused out to its swap file. getData() pages them back in transparently.
+         */
+        class Tile {
+        public:
+            explicit Tile(PixelFormat format);
+            // Copies the pixels and keeps the revision; the copy diverges on its first write
+            Tile(const Tile& other);
+            Tile& operator=(const Tile&) = delete;
+            ~Tile();
+            
+            PixelFormat getFormat() const { return m_format; }
+            size_t getByteSize() const { return static_cast<size_t>(TILE_PIXELS) * getBytesPerPixel(m_format); }
+            uint64_t getRevision() const { return m_revision; }
+            
+            // Valid for the rest of the frame, or of the job that called it; see TileStore
+            const uint8_t* getData() const { use(); return m_data.data(); }
+            uint8_t* getData() { use(); return m_data.data(); }
+            
+            // Uniform tiles hold a single color in every pixel; their data is still fully expanded
+            bool isUniform() const { return m_uniform; }
+            const uint8_t* getUniformPixel() const { return getData(); }
+            
+            // False while the pixels are paged out
+            bool isResident() const { return m_resident.load(std::memory_order_acquire); }
+            
+            // Assigns a new revision and drops the uniform flag; called before the pixels change
+            void touch();
+            
+            // Returns true if every pixel equals the first one
+            bool detectUniform() const;
+            
+            static uint64_t nextRevision();
+            
+            /**
+             * Returns a shared, immutable tile filled with `pixel` (getBytesPerPixel(format) bytes).
+             * Uniform tiles are interned per color, so any number of them cost one allocation.
+             */
+            static std::shared_ptr<Tile> makeUniform(PixelFormat format, const void* pixel);
+            
+        private:
+            friend class TileStore;
+            
+            // Brings paged-out pixels back and stamps the tile as used this frame
+            void use() const {
+                if (!m_resident.load(std::memory_order_acquire)) {
+                    pageIn();
+                }
+                const uint32_t frame = s_frame.load(std::memory_order_relaxed);
+                if (m_lastUse.load(std::memory_order_relaxed) != frame) {
+                    m_lastUse.store(frame, std::memory_order_relaxed);
+                }
+            }
+            void pageIn() const;
+            
+            PixelFormat m_format;
+            uint64_t m_revision;
+            bool m_uniform = false;
+            mutable std::vector<uint8_t> m_data; // Empty while paged out
+            
+            // Paging state, owned by the TileStore
+            static std::atomic<uint32_t> s_frame;
+            mutable std::atomic<bool> m_resident{true};
+            mutable std::atomic<uint32_t> m_lastUse{0};
+            uint64_t m_swapOffset = 0; // Slot in the swap file; kept while the pixels stay unchanged
+            uint32_t m_swapSize = 0;   // 0 if the tile has no slot
+            uint8_t m_swapCompression = 0;
+            Tile* m_previous = nullptr;
+            Tile* m_next = nullptr;
+        };
+        
+        /**
+         * @brief CPU-side layer pixels split into TILE_SIZE x TILE_SIZE tiles
+         *
+         * Storage is sparse: a missing tile is fully transparent and uniform tiles point to
+         * one interned tile per color. Tiles are reference counted and copied on write, so
+         * copying a TiledImage only copies tile pointers.
+         */
+        class TiledImage {
+        public:
+            TiledImage(uint32_t width, uint32_t height, PixelFormat format = PixelFormat::RGBA8);
+            
+            // Shares every tile with `other`; O(tile count)
+            TiledImage(const TiledImage& other) = default;
+            TiledImage& operator=(const TiledImage& other) = default;
+            
+            uint32_t getWidth() const { return m_width; }
+            uint32_t getHeight() const { return m_height; }
+            PixelFormat getFormat() const { return m_format; }
+            uint32_t getTilesX() const { return m_tilesX; }
+            uint32_t getTilesY() const { return m_tilesY; }
+            uint32_t getTileCount() const { return m_tilesX * m_tilesY; }
+            
+            // Tile access; returns nullptr for tiles that were never written
+            const Tile* getTile(uint32_t tx, uint32_t ty) const;
+            
+            // Shared handle to a tile, for snapshots that want to keep it alive
+            std::shared_ptr<const Tile> shareTile(uint32_t tx, uint32_t ty) const;
+            
+            /**
+             * Returns the tile for modification and bumps its revision. Missing tiles are
+             * allocated transparent, shared or uniform tiles are copied first.
+             */
+            Tile& getTileForWrite(uint32_t tx, uint32_t ty);
+            
+            // Replaces a tile wholesale (loaders, snapshots); nullptr clears it
+            void setTile(uint32_t tx, uint32_t ty, std::shared_ptr<Tile> tile);
+            
+            /**
+             * Exchanges the stored tile with `tile` (nullptr = missing). Undo swaps pre- and
+             * post-images this way; the tile that comes in is treated like any shared tile
+             * and only modified in place once nothing else holds it.
+             */
+            void swapTile(uint32_t tx, uint32_t ty, std::shared_ptr<const Tile>& tile);
+            void clearTile(uint32_t tx, uint32_t ty);
+            void clear();
+            
+            // Sets a tile or the whole image to a single color without allocating pixels
+            void fillTile(uint32_t tx, uint32_t ty, const void* pixel);
+            void fill(const void* pixel);
+            
+            /**
+             * Replaces a tile that turned out transparent or uniform (e.g. after a stroke or
+             * an erase) with the sparse representation. Returns true if the tile was released.
+             */
+            bool compactTile(uint32_t tx, uint32_t ty);
+            void compact();
+            
+            // Number of tiles that are present (allocated, shared or uniform)
+            size_t getAllocatedTileCount() const;
+            // Bytes held by tiles this image owns exclusively; shared and uniform tiles are free
+            size_t getExclusiveMemoryUsage() const;
+            
+        private:
+            uint32_t tileIndex(uint32_t tx, uint32_t ty) const { return ty * m_tilesX + tx; }
+            
+            uint32_t m_width;
+            uint32_t m_height;
+            PixelFormat m_format;
+            uint32_t m_tilesX;
+            uint32_t m_tilesY;
+            std::vector<std::shared_ptr<Tile>> m_tiles;
+        };
+    }
+}
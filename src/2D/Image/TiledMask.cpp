@@ -0,0 +1,110 @@
+#include "2D/Image/TiledMask.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace AstralEngine {
+    namespace D2 {
+        TiledMask::TiledMask(uint32_t width, uint32_t height)
+            : m_width(width), m_height(height),
+              m_tilesX((width + TILE_SIZE - 1) / TILE_SIZE),
+              m_tilesY((height + TILE_SIZE - 1) / TILE_SIZE),
+              m_tiles(static_cast<size_t>(m_tilesX) * m_tilesY) {
+        }
+
+        const std::shared_ptr<MaskTile>& TiledMask::getFullTile() {
+            static const std::shared_ptr<MaskTile> s_full = [] {
+                auto tile = std::make_shared<MaskTile>();
+                tile->fill(255);
+                return tile;
+            }();
+            return s_full;
+        }
+
+        const uint8_t* TiledMask::getTile(uint32_t tx, uint32_t ty) const {
+            assert(tx < m_tilesX && ty < m_tilesY);
+            const auto& tile = m_tiles[tileIndex(tx, ty)];
+            return tile ? tile->data() : nullptr;
+        }
+
+        uint8_t* TiledMask::getTileForWrite(uint32_t tx, uint32_t ty) {
+            assert(tx < m_tilesX && ty < m_tilesY);
+            auto& tile = m_tiles[tileIndex(tx, ty)];
+            if (!tile) {
+                tile = std::make_shared<MaskTile>();
+                tile->fill(0);
+            } else if (tile.use_count() > 1 || tile == getFullTile()) {
+                tile = std::make_shared<MaskTile>(*tile);
+            }
+            return tile->data();
+        }
+
+        void TiledMask::setTileFull(uint32_t tx, uint32_t ty) {
+            assert(tx < m_tilesX && ty < m_tilesY);
+            m_tiles[tileIndex(tx, ty)] = getFullTile();
+        }
+
+        void TiledMask::shareTile(const TiledMask& source, uint32_t tx, uint32_t ty) {
+            assert(tx < m_tilesX && ty < m_tilesY && source.m_tilesX == m_tilesX && source.m_tilesY == m_tilesY);
+            m_tiles[tileIndex(tx, ty)] = source.m_tiles[tileIndex(tx, ty)];
+        }
+
+        void TiledMask::clearTile(uint32_t tx, uint32_t ty) {
+            assert(tx < m_tilesX && ty < m_tilesY);
+            m_tiles[tileIndex(tx, ty)].reset();
+        }
+
+        void TiledMask::clear() {
+            std::fill(m_tiles.begin(), m_tiles.end(), nullptr);
+        }
+
+        void TiledMask::fill() {
+            std::fill(m_tiles.begin(), m_tiles.end(), getFullTile());
+        }
+
+        bool TiledMask::compactTile(uint32_t tx, uint32_t ty) {
+            assert(tx < m_tilesX && ty < m_tilesY);
+            auto& tile = m_tiles[tileIndex(tx, ty)];
+            if (!tile || tile == getFullTile()) {
+                return false;
+            }
+            const uint8_t first = (*tile)[0];
+            if (first != 0 && first != 255) {
+                return false;
+            }
+            if (std::any_of(tile->begin(), tile->end(), [first](uint8_t value) { return value != first; })) {
+                return false;
+            }
+            if (first == 0) {
+                tile.reset();
+            } else {
+                tile = getFullTile();
+            }
+            return true;
+        }
+
+        uint8_t TiledMask::getCoverage(uint32_t x, uint32_t y) const {
+            if (x >= m_width || y >= m_height) {
+                return 0;
+            }
+            const uint8_t* tile = getTile(x / TILE_SIZE, y / TILE_SIZE);
+            return tile ? tile[(y % TILE_SIZE) * TILE_SIZE + x % TILE_SIZE] : 0;
+        }
+
+        bool TiledMask::isEmpty() const {
+            return std::none_of(m_tiles.begin(), m_tiles.end(), [](const std::shared_ptr<MaskTile>& tile) { return tile != nullptr; });
+        }
+
+        TileRect TiledMask::getTileBounds() const {
+            TileRect bounds;
+            for (uint32_t ty = 0; ty < m_tilesY; ++ty) {
+                for (uint32_t tx = 0; tx < m_tilesX; ++tx) {
+                    if (m_tiles[tileIndex(tx, ty)]) {
+                        bounds.merge({tx, ty, tx + 1, ty + 1});
+                    }
+                }
+            }
+            return bounds;
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "2D/Image/TiledImage.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        // 8-bit coverage of one TILE_SIZE x TILE_SIZE block, row-major
+        using MaskTile = std::array<uint8_t, TILE_PIXELS>;
+
+        /**
+         * @brief Sparse 8-bit coverage over the document's tile grid
+         *
+         * Selections and fill regions are mostly empty or fully covered, so a missing tile
+         * means coverage 0 and fully covered tiles all point to one shared tile. Only tiles
+         * along an edge hold their own bytes. Tiles are copied on write like TiledImage
+         * tiles, so copying a mask only copies pointers.
+         *
+         * Coverage past the image edge in the last column and row of tiles is not
+         * meaningful; consumers clip to the image size.
+         */
+        class TiledMask {
+        public:
+            TiledMask(uint32_t width = 0, uint32_t height = 0);
+
+            TiledMask(const TiledMask& other) = default;
+            TiledMask& operator=(const TiledMask& other) = default;
+            TiledMask(TiledMask&& other) = default;
+            TiledMask& operator=(TiledMask&& other) = default;
+
+            uint32_t getWidth() const { return m_width; }
+            uint32_t getHeight() const { return m_height; }
+            uint32_t getTilesX() const { return m_tilesX; }
+            uint32_t getTilesY() const { return m_tilesY; }
+            uint32_t getTileCount() const { return m_tilesX * m_tilesY; }
+
+            // Coverage bytes of a tile; nullptr for empty tiles
+            const uint8_t* getTile(uint32_t tx, uint32_t ty) const;
+            bool isTileEmpty(uint32_t tx, uint32_t ty) const { return !m_tiles[tileIndex(tx, ty)]; }
+            bool isTileFull(uint32_t tx, uint32_t ty) const { return m_tiles[tileIndex(tx, ty)] == getFullTile(); }
+
+            // Coverage for modification; empty tiles are allocated zeroed, full or shared ones copied
+            uint8_t* getTileForWrite(uint32_t tx, uint32_t ty);
+
+            void setTileFull(uint32_t tx, uint32_t ty);
+            // Points a tile at `source`'s tile of the same coordinates; both masks must share a grid
+            void shareTile(const TiledMask& source, uint32_t tx, uint32_t ty);
+            void clearTile(uint32_t tx, uint32_t ty);
+            void clear();
+            void fill();
+
+            // Turns a written tile that ended up all 0 or all 255 back into the sparse form
+            bool compactTile(uint32_t tx, uint32_t ty);
+
+            // Coverage of a single pixel; 0 outside the mask
+            uint8_t getCoverage(uint32_t x, uint32_t y) const;
+
+            bool isEmpty() const;
+            // Tiles holding any coverage
+            TileRect getTileBounds() const;
+
+        private:
+            uint32_t tileIndex(uint32_t tx, uint32_t ty) const { return ty * m_tilesX + tx; }
+            static const std::shared_ptr<MaskTile>& getFullTile();
+
+            uint32_t m_width;
+            uint32_t m_height;
+            uint32_t m_tilesX;
+            uint32_t m_tilesY;
+            std::vector<std::shared_ptr<MaskTile>> m_tiles;
+        };
+    }
+}
@@ -1,8 +1,16 @@
 #include "2D/Layers/Layer.h"
+#include "2D/Layers/UndoHistory.h"
+#include "2D/Canvas/CanvasCompositor.h"
+#include "2D/Filters/Filter.h"
+#include "2D/Image/ColorSpace.h"
+#include "2D/Image/FloodFill.h"
+#include "2D/Selection/Selection.h"
+#include "Core/JobSystem.h"
 #include "Core/Logger.h"
 #include "Renderer/RRenderer.h"
 #include "Renderer/Texture.h"
 #include <algorithm>
+#include <chrono>
 #include <glm/gtc/matrix_transform.hpp>
 
 namespace AstralEngine {
@@ -17,11 +25,322 @@ namespace AstralEngine {
             return translation * rotationMat * scaleMat;
         }
         
+        void Layer::markDirty(const TileRect& tiles) {
+            if (!pixels || tiles.isEmpty()) {
+                return;
+            }
+            // Replacing `pixels` already recomposites the whole layer; only the grid needs updating
+            if (dirtyTiles.getTilesX() != pixels->getTilesX() || dirtyTiles.getTilesY() != pixels->getTilesY()) {
+                dirtyTiles.resize(pixels->getTilesX(), pixels->getTilesY());
+            }
+            dirtyTiles.add(tiles);
+            ++version;
+        }
+        
+        void Layer::markAllDirty() {
+            if (!pixels) {
+                return;
+            }
+            if (dirtyTiles.getTilesX() != pixels->getTilesX() || dirtyTiles.getTilesY() != pixels->getTilesY()) {
+                dirtyTiles.resize(pixels->getTilesX(), pixels->getTilesY());
+            }
+            dirtyTiles.addAll();
+            ++version;
+        }
+        
         LayerSystem::LayerSystem(ECS::Scene& scene) : m_scene(scene) {
             AE_INFO("LayerSystem başlatıldı");
         }
         
+        LayerSystem::~LayerSystem() {
+            // A commit job still reads the original pixels; no job may outlive the system
+            if (m_transform && m_transform->job) {
+                m_transform->job->cancel.store(true);
+                m_transform->jobDone.wait();
+            }
+        }
+        
+        void LayerSystem::setDocumentSize(uint32_t width, uint32_t height, PixelFormat format) {
+            m_documentWidth = width;
+            m_documentHeight = height;
+            m_documentFormat = format;
+        }
+        
+        void LayerSystem::convertDocument(PixelFormat format) {
+            beginHistory("Convert Document");
+            for (ECS::EntityID layerId : m_layerStack) {
+                if (!m_scene.hasComponent<Layer>(layerId)) {
+                    continue;
+                }
+                // The old pixels stay with the history, so undo restores them as they were
+                auto& layer = m_scene.getComponent<Layer>(layerId);
+                if (layer.pixels && layer.pixels->getFormat() != format) {
+                    layer.pixels = ColorSpace::convertImage(*layer.pixels, format);
+                }
+            }
+            m_documentFormat = format;
+            endHistory();
+            
+            AE_DEBUG("Doküman piksel formatı dönüştürüldü: {}", static_cast<int>(format));
+        }
+        
+        void LayerSystem::replaceLayerPixels(ECS::EntityID layerId, std::shared_ptr<TiledImage> pixels, const std::string& name) {
+            if (!m_scene.hasComponent<Layer>(layerId)) {
+                AE_WARN("Layer bulunamadı: {}", layerId);
+                return;
+            }
+            beginHistory(name);
+            // Like convertDocument, the history keeps the previous pixels as they were
+            auto& layer = m_scene.getComponent<Layer>(layerId);
+            layer.pixels = std::move(pixels);
+            layer.markAllDirty();
+            endHistory();
+        }
+        
+        void LayerSystem::transformLayer(ECS::EntityID layerId, const glm::mat3& transform, ResampleFilter filter) {
+            if (!m_scene.hasComponent<Layer>(layerId)) {
+                AE_WARN("Layer bulunamadı: {}", layerId);
+                return;
+            }
+            auto& layer = m_scene.getComponent<Layer>(layerId);
+            if (!layer.pixels) {
+                AE_WARN("Layer piksel verisi yok: {}", layerId);
+                return;
+            }
+            
+            // Resampled before the operation opens, so the history records the stack untouched
+            auto resampled = Resample::transformImage(*layer.pixels, transform, layer.pixels->getWidth(),
+                                                      layer.pixels->getHeight(), filter);
+            beginHistory("Transform");
+            layer.pixels = std::move(resampled);
+            layer.markAllDirty();
+            endHistory();
+        }
+        
+        void LayerSystem::applyLayerTransform(ECS::EntityID layerId, ResampleFilter filter) {
+            if (!m_scene.hasComponent<Layer>(layerId)) {
+                AE_WARN("Layer bulunamadı: {}", layerId);
+                return;
+            }
+            auto& layer = m_scene.getComponent<Layer>(layerId);
+            if (layer.position == glm::vec2(0.0f) && layer.scale == glm::vec2(1.0f) && layer.rotation == 0.0f) {
+                return;
+            }
+            
+            // One entry for the resample and the reset, so undo brings both back
+            if (m_history) {
+                m_history->beginOperation("Transform");
+            }
+            transformLayer(layerId, layer.getTransformMatrix(), filter);
+            layer.position = {0.0f, 0.0f};
+            layer.scale = {1.0f, 1.0f};
+            layer.rotation = 0.0f;
+            if (m_history) {
+                m_history->endOperation();
+            }
+        }
+        
+        bool LayerSystem::beginTransform(ECS::EntityID layerId, uint32_t displayLevel) {
+            cancelTransform();
+            if (!m_scene.hasComponent<Layer>(layerId)) {
+                AE_WARN("Layer bulunamadı: {}", layerId);
+                return false;
+            }
+            auto& layer = m_scene.getComponent<Layer>(layerId);
+            if (!layer.pixels) {
+                AE_WARN("Layer piksel verisi yok: {}", layerId);
+                return false;
+            }
+            
+            auto state = std::make_unique<TransformState>();
+            state->layerId = layerId;
+            state->original = layer.pixels;
+            // Shares the original's tiles until a preview rewrites them
+            state->preview = std::make_shared<TiledImage>(*layer.pixels);
+            const TiledImage& original = *state->original;
+            for (uint32_t ty = 0; ty < original.getTilesY(); ++ty) {
+                for (uint32_t tx = 0; tx < original.getTilesX(); ++tx) {
+                    if (original.getTile(tx, ty)) {
+                        state->shown.merge({tx, ty, tx + 1, ty + 1});
+                    }
+                }
+            }
+            
+            // Smallest reduction within the preview budget; zoomed out, the canvas shows no finer level anyway
+            const uint64_t pixels = static_cast<uint64_t>(original.getWidth()) * original.getHeight();
+            uint32_t level = 0;
+            while ((pixels >> (level * 2)) > TRANSFORM_PREVIEW_MAX_PIXELS) {
+                ++level;
+            }
+            level = std::max(level, displayLevel);
+            if (level > 0) {
+                state->proxies.resize(original.getWidth(), original.getHeight(), original.getFormat());
+                level = std::min(level, state->proxies.getLevelCount() - 1);
+            }
+            if (level > 0) {
+                state->proxies.update(original, level);
+                const TiledImage* proxy = state->proxies.getLevel(level);
+                state->proxyPreview = std::make_unique<TiledImage>(proxy->getWidth(), proxy->getHeight(), proxy->getFormat());
+                state->proxyLevel = level;
+            }
+            
+            layer.pixels = state->preview;
+            layer.markAllDirty();
+            m_transform = std::move(state);
+            AE_DEBUG("Dönüşüm başladı: Layer {}, proxy seviyesi {}", layerId, level);
+            return true;
+        }
+        
+        void LayerSystem::previewTransform(const glm::mat3& transform) {
+            if (!m_transform || m_transform->job) {
+                return;
+            }
+            TransformState& state = *m_transform;
+            if (!m_scene.hasComponent<Layer>(state.layerId)) {
+                return;
+            }
+            auto& layer = m_scene.getComponent<Layer>(state.layerId);
+            if (layer.pixels != state.preview) {
+                return;
+            }
+            state.transform = transform;
+            
+            // Tiles the new preview covers plus those the last one left behind
+            const uint32_t width = state.original->getWidth(), height = state.original->getHeight();
+            const TileRect reach = Resample::getTransformedTiles(width, height, transform, width, height);
+            TileRect tiles = reach;
+            tiles.merge(state.shown);
+            if (tiles.isEmpty()) {
+                return;
+            }
+            
+            if (state.proxyLevel == 0) {
+                Resample::transformInto(*state.original, transform, *state.preview, tiles, ResampleFilter::Bilinear);
+            } else {
+                // The same transform between proxy pixels, which are 2^level level-0 pixels wide
+                const uint32_t level = state.proxyLevel;
+                const float factor = static_cast<float>(1u << level);
+                const glm::mat3 proxyTransform = glm::scale(glm::mat3(1.0f), glm::vec2(1.0f / factor)) * transform *
+                                                 glm::scale(glm::mat3(1.0f), glm::vec2(factor));
+                const uint32_t round = (1u << level) - 1;
+                const TileRect proxyTiles{tiles.x0 >> level, tiles.y0 >> level, (tiles.x1 + round) >> level, (tiles.y1 + round) >> level};
+                Resample::transformInto(*state.proxies.getLevel(level), proxyTransform, *state.proxyPreview, proxyTiles,
+                                        ResampleFilter::Bilinear);
+                Resample::upsampleLevel(*state.proxyPreview, level, *state.preview, tiles);
+            }
+            state.shown = reach;
+            layer.markDirty(tiles);
+        }
+        
+        void LayerSystem::commitTransform(ResampleFilter filter) {
+            if (!m_transform || m_transform->job) {
+                return;
+            }
+            TransformState& state = *m_transform;
+            if (state.transform == glm::mat3(1.0f)) {
+                endTransform();
+                return;
+            }
+            
+            // The preview stays up while the full-resolution pixels are resampled in the background
+            auto job = std::make_shared<TransformJob>();
+            std::shared_ptr<const TiledImage> original = state.original;
+            const glm::mat3 transform = state.transform;
+            state.jobDone = Jobs::JobSystem::getInstance().submit([job, original, transform, filter] {
+                job->result = Resample::transformImage(*original, transform, original->getWidth(), original->getHeight(),
+                                                       filter, &job->cancel);
+            });
+            state.job = std::move(job);
+            state.proxies = MipPyramid();
+            state.proxyPreview.reset();
+        }
+        
+        bool LayerSystem::updateTransform() {
+            if (!m_transform || !m_transform->job ||
+                m_transform->jobDone.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return false;
+            }
+            const ECS::EntityID layerId = m_transform->layerId;
+            auto result = std::move(m_transform->job->result);
+            // The history records the stack as it was, so the original goes back in first
+            endTransform();
+            if (!result || !m_scene.hasComponent<Layer>(layerId)) {
+                return false;
+            }
+            replaceLayerPixels(layerId, std::move(result), "Transform");
+            AE_DEBUG("Dönüşüm uygulandı: Layer {}", layerId);
+            return true;
+        }
+        
+        void LayerSystem::cancelTransform() {
+            if (!m_transform) {
+                return;
+            }
+            if (m_transform->job) {
+                m_transform->jobDone.wait();
+                updateTransform();
+                return;
+            }
+            endTransform();
+        }
+        
+        void LayerSystem::endTransform() {
+            TransformState& state = *m_transform;
+            if (m_scene.hasComponent<Layer>(state.layerId)) {
+                auto& layer = m_scene.getComponent<Layer>(state.layerId);
+                if (layer.pixels == state.preview) {
+                    layer.pixels = state.original;
+                    layer.markAllDirty();
+                }
+            }
+            m_transform.reset();
+        }
+        
+        const TiledImage* LayerSystem::getLayerPixels(ECS::EntityID layerId) const {
+            if (!m_scene.hasComponent<Layer>(layerId)) {
+                return nullptr;
+            }
+            return m_scene.getComponent<Layer>(layerId).pixels.get();
+        }
+        
+        void LayerSystem::fillLayer(ECS::EntityID layerId, const TiledMask& mask, const glm::vec4& color, float opacity) {
+            if (!m_scene.hasComponent<Layer>(layerId)) {
+                AE_WARN("Layer bulunamadı: {}", layerId);
+                return;
+            }
+            auto& layer = m_scene.getComponent<Layer>(layerId);
+            if (!layer.pixels) {
+                AE_WARN("Layer piksel verisi yok: {}", layerId);
+                return;
+            }
+            
+            // Copying a mask only shares its tiles, so clipping costs the edge tiles
+            const TiledMask* region = &mask;
+            TiledMask clipped;
+            const TiledMask* clip = m_selection ? m_selection->getClipMask() : nullptr;
+            if (clip && clip->getWidth() == mask.getWidth() && clip->getHeight() == mask.getHeight()) {
+                clipped = mask;
+                MaskOps::combine(clipped, *clip, MaskCombine::Intersect);
+                region = &clipped;
+            }
+            
+            // Tiles the fill leaves unchanged are pruned from the entry when it closes
+            if (m_history) {
+                m_history->beginOperation("Fill");
+                m_history->recordTiles(layerId, region->getTileBounds());
+            }
+            TileRect touched = FloodFill::fillMask(*layer.pixels, *region, color, opacity);
+            layer.markDirty(touched);
+            if (m_history) {
+                m_history->endOperation();
+            }
+            
+            AE_DEBUG("Layer dolduruldu: {} ({} karo)", layerId, (touched.x1 - touched.x0) * (touched.y1 - touched.y0));
+        }
+        
         ECS::EntityID LayerSystem::addLayer(const std::string& name) {
+            beginHistory("Add Layer");
+            
             // Create a new entity for the layer
             ECS::EntityID layerId = m_scene.createEntity(name);
             
@@ -29,8 +348,14 @@ namespace AstralEngine {
             auto& layer = m_scene.addComponent<Layer>(layerId);
             layer.name = name;
             
+            // Pixel storage is sparse, so an empty layer costs one pointer per tile
+            if (m_documentWidth > 0 && m_documentHeight > 0) {
+                layer.pixels = std::make_shared<TiledImage>(m_documentWidth, m_documentHeight, m_documentFormat);
+            }
+            
             // Add to the layer stack at the top (end of vector)
             m_layerStack.push_back(layerId);
+            endHistory();
             
             AE_DEBUG("Layer eklendi: {} (ID: {})", name, layerId);
             return layerId;
@@ -43,6 +368,8 @@ namespace AstralEngine {
                 return;
             }
             
+            beginHistory("Delete Layer");
+            
             // Remove from layer stack
             auto it = std::find(m_layerStack.begin(), m_layerStack.end(), layerId);
             if (it != m_layerStack.end()) {
@@ -57,6 +384,7 @@ namespace AstralEngine {
             
             // Destroy the entity
             m_scene.destroyEntity(layerId);
+            endHistory();
             
             AE_DEBUG("Layer silindi: {}", layerId);
         }
@@ -87,29 +415,35 @@ namespace AstralEngine {
                 return;
             }
             
+            beginHistory("Move Layer");
+            
             // Remove from current position
             m_layerStack.erase(it);
             
             // Insert at new position
             m_layerStack.insert(m_layerStack.begin() + newPosition, layerId);
+            endHistory();
             
             AE_DEBUG("Layer taşındı: {} from {} to {}", layerId, currentIndex, newPosition);
         }
         
-        void LayerSystem::duplicateLayer(ECS::EntityID layerId) {
+        ECS::EntityID LayerSystem::duplicateLayer(ECS::EntityID layerId) {
             // Check if the layer exists
             if (!m_scene.hasComponent<Layer>(layerId)) {
                 AE_WARN("Layer bulunamadı: {}", layerId);
-                return;
+                return ECS::INVALID_ENTITY;
             }
             
-            // Get the original layer
-            const auto& originalLayer = m_scene.getComponent<Layer>(layerId);
+            // The add and the property copy undo as one step
+            beginHistory("Duplicate Layer");
             
             // Create a new layer with a modified name
-            std::string newName = originalLayer.name + " Copy";
+            std::string newName = m_scene.getComponent<Layer>(layerId).name + " Copy";
             ECS::EntityID newLayerId = addLayer(newName);
             
+            // Adding a component may move storage, so look the original up again
+            const auto& originalLayer = m_scene.getComponent<Layer>(layerId);
+            
             // Copy properties
             auto& newLayer = m_scene.getComponent<Layer>(newLayerId);
             newLayer.opacity = originalLayer.opacity;
@@ -119,11 +453,67 @@ namespace AstralEngine {
             newLayer.scale = originalLayer.scale;
             newLayer.rotation = originalLayer.rotation;
             
-            // TODO: Copy content (texture) when implemented
-            // For now, we'll just copy the reference
-            newLayer.content = originalLayer.content;
+            // Tiles are shared copy-on-write, so this copies tile pointers only
+            newLayer.pixels = originalLayer.pixels ? std::make_shared<TiledImage>(*originalLayer.pixels) : nullptr;
+            
+            // The GPU copy is left to be uploaded for the duplicate; sharing it would show one layer's edits on both
+            newLayer.content.reset();
+            endHistory();
             
             AE_DEBUG("Layer kopyalandı: {} -> {}", layerId, newLayerId);
+            return newLayerId;
+        }
+        
+        void LayerSystem::copyLayer(ECS::EntityID layerId) {
+            if (!m_scene.hasComponent<Layer>(layerId)) {
+                AE_WARN("Layer bulunamadı: {}", layerId);
+                return;
+            }
+            const auto& layer = m_scene.getComponent<Layer>(layerId);
+            if (!layer.pixels) {
+                AE_WARN("Layer piksel verisi yok: {}", layerId);
+                return;
+            }
+            
+            auto copy = std::make_shared<TiledImage>(*layer.pixels);
+            const TiledMask* clip = m_selection ? m_selection->getClipMask() : nullptr;
+            if (clip && clip->getWidth() == copy->getWidth() && clip->getHeight() == copy->getHeight()) {
+                // Clipped against nothing: fully selected tiles stay shared, unselected ones go missing
+                const TiledImage empty(copy->getWidth(), copy->getHeight(), copy->getFormat());
+                FilterKernels::clipToMask(*copy, empty, *clip);
+            }
+            m_clipboard = std::move(copy);
+            
+            AE_DEBUG("Layer panoya kopyalandı: {} ({} karo)", layerId, m_clipboard->getAllocatedTileCount());
+        }
+        
+        ECS::EntityID LayerSystem::pasteLayer() {
+            if (!m_clipboard) {
+                return ECS::INVALID_ENTITY;
+            }
+            // Documents converted since the copy get the clipboard in their own format
+            std::shared_ptr<TiledImage> pixels = m_clipboard->getFormat() == m_documentFormat
+                ? std::make_shared<TiledImage>(*m_clipboard)
+                : ColorSpace::convertImage(*m_clipboard, m_documentFormat);
+            const ECS::EntityID activeId = getActiveLayer();
+            
+            beginHistory("Paste");
+            ECS::EntityID layerId = addLayer("Pasted Layer");
+            m_scene.getComponent<Layer>(layerId).pixels = std::move(pixels);
+            
+            // addLayer() put it on top; paste lands right above the layer being edited
+            auto active = std::find(m_layerStack.begin(), m_layerStack.end(), activeId);
+            if (active != m_layerStack.end()) {
+                m_layerStack.pop_back();
+                m_layerStack.insert(std::find(m_layerStack.begin(), m_layerStack.end(), activeId) + 1, layerId);
+            }
+            endHistory();
+            
+            // The pasted layer becomes the one tools edit
+            m_selectedLayers.assign(1, layerId);
+            
+            AE_DEBUG("Panodan yapıştırıldı: {}", layerId);
+            return layerId;
         }
         
         void LayerSystem::mergeLayers(ECS::EntityID layer1, ECS::EntityID layer2) {
@@ -132,22 +522,144 @@ namespace AstralEngine {
                 AE_WARN("Bir veya daha fazla layer bulunamadı: {}, {}", layer1, layer2);
                 return;
             }
+            auto it1 = std::find(m_layerStack.begin(), m_layerStack.end(), layer1);
+            auto it2 = std::find(m_layerStack.begin(), m_layerStack.end(), layer2);
+            if (it1 == m_layerStack.end() || it2 == m_layerStack.end() || it1 == it2) {
+                AE_WARN("Birleştirilecek layer'lar stack'te değil: {}, {}", layer1, layer2);
+                return;
+            }
+            const ECS::EntityID lowerId = it1 < it2 ? layer1 : layer2;
+            const ECS::EntityID upperId = it1 < it2 ? layer2 : layer1;
+            
+            auto& lower = m_scene.getComponent<Layer>(lowerId);
+            auto& upper = m_scene.getComponent<Layer>(upperId);
+            // The history records these very images for undo, so thinning them out would lose the
+            // pixels and free nothing; only untracked sources give up their tiles
+            std::vector<TiledImage*> release;
+            for (Layer* layer : {&lower, &upper}) {
+                if (!m_history && layer->pixels && layer->pixels.use_count() == 1) {
+                    release.push_back(layer->pixels.get());
+                }
+            }
+            
+            // The lower layer's opacity and blend mode stay on it, so its pixels go in as they are
+            Layer base;
+            base.pixels = lower.pixels;
+            std::shared_ptr<TiledImage> merged = mergePixels({&base, &upper}, release);
+            base.pixels.reset();
             
-            // For now, we'll just remove the second layer
-            // In a full implementation, we would actually merge the contents
-            removeLayer(layer2);
+            beginHistory("Merge Layers");
+            if (merged) {
+                lower.pixels = std::move(merged);
+                lower.markAllDirty();
+            }
+            removeLayer(upperId);
+            endHistory();
             
-            AE_DEBUG("Layer'lar birleştirildi: {} ve {}", layer1, layer2);
+            AE_DEBUG("Layer'lar birleştirildi: {} ve {}", lowerId, upperId);
         }
         
         void LayerSystem::flattenLayers() {
-            // For now, we'll just clear all layers except the first one
-            // In a full implementation, we would actually merge all layers
-            while (m_layerStack.size() > 1) {
-                removeLayer(m_layerStack.back());
+            if (m_layerStack.empty()) {
+                return;
+            }
+            
+            std::vector<Layer*> layers;
+            std::vector<TiledImage*> release;
+            for (ECS::EntityID layerId : m_layerStack) {
+                if (!m_scene.hasComponent<Layer>(layerId)) {
+                    continue;
+                }
+                Layer& layer = m_scene.getComponent<Layer>(layerId);
+                layers.push_back(&layer);
+                if (!m_history && layer.pixels && layer.pixels.use_count() == 1) {
+                    release.push_back(layer.pixels.get());
+                }
             }
+            // Every layer is blended in the same pass, so a deep stack is not merged pairwise
+            std::shared_ptr<TiledImage> flattened = mergePixels(layers, release);
             
-            AE_DEBUG("Tüm layer'lar düzleştirildi");
+            beginHistory("Flatten Image");
+            
+            // The bottom layer takes the result with its opacity and blend mode baked in
+            const ECS::EntityID bottomId = m_layerStack.front();
+            if (m_scene.hasComponent<Layer>(bottomId)) {
+                auto& bottom = m_scene.getComponent<Layer>(bottomId);
+                if (flattened) {
+                    bottom.pixels = std::move(flattened);
+                }
+                bottom.opacity = 1.0f;
+                bottom.visible = true;
+                bottom.blendMode = BlendMode::Normal;
+                bottom.markAllDirty();
+            }
+            
+            // Removed directly rather than through removeLayer(), which would record the stack once per layer
+            for (size_t i = 1; i < m_layerStack.size(); ++i) {
+                if (m_scene.hasComponent<Layer>(m_layerStack[i])) {
+                    m_scene.destroyEntity(m_layerStack[i]);
+                }
+            }
+            m_layerStack.resize(1);
+            m_selectedLayers.erase(std::remove_if(m_selectedLayers.begin(), m_selectedLayers.end(),
+                                                  [bottomId](ECS::EntityID id) { return id != bottomId; }),
+                                   m_selectedLayers.end());
+            endHistory();
+            
+            AE_DEBUG("Tüm layer'lar düzleştirildi ({} layer)", layers.size());
+        }
+        
+        std::shared_ptr<TiledImage> LayerSystem::mergePixels(const std::vector<Layer*>& layers,
+                                                             const std::vector<TiledImage*>& release) const {
+            // The result matches the document, like the canvas the layers are composited on
+            uint32_t width = m_documentWidth;
+            uint32_t height = m_documentHeight;
+            PixelFormat format = m_documentFormat;
+            if (width == 0 || height == 0) {
+                auto sized = std::find_if(layers.begin(), layers.end(), [](const Layer* layer) { return layer->pixels != nullptr; });
+                if (sized == layers.end()) {
+                    return nullptr;
+                }
+                width = (*sized)->pixels->getWidth();
+                height = (*sized)->pixels->getHeight();
+                format = (*sized)->pixels->getFormat();
+            }
+            
+            auto merged = std::make_shared<TiledImage>(width, height, format);
+            const uint32_t tilesX = merged->getTilesX();
+            Jobs::JobSystem::getInstance().parallelFor(merged->getTileCount(), [&](size_t i) {
+                const uint32_t tx = static_cast<uint32_t>(i % tilesX);
+                const uint32_t ty = static_cast<uint32_t>(i / tilesX);
+                
+                // A tile only one layer covers as it is is shared rather than copied
+                const Tile* single = nullptr;
+                size_t contributing = 0;
+                for (const Layer* layer : layers) {
+                    if (const Tile* tile = CanvasCompositor::getSourceTile(layer, format, tx, ty)) {
+                        ++contributing;
+                        single = layer->blendMode == BlendMode::Normal && layer->opacity >= 1.0f ? tile : nullptr;
+                    }
+                }
+                if (contributing == 1 && single) {
+                    for (const Layer* layer : layers) {
+                        if (CanvasCompositor::getSourceTile(layer, format, tx, ty) == single) {
+                            std::shared_ptr<const Tile> shared = layer->pixels->shareTile(tx, ty);
+                            merged->swapTile(tx, ty, shared);
+                            break;
+                        }
+                    }
+                } else if (contributing > 0 && CanvasCompositor::compositeRange(layers, 0, layers.size(), tx, ty, *merged)) {
+                    merged->compactTile(tx, ty);
+                }
+                
+                // Each job owns its tile index in every image, so sources can be thinned out concurrently
+                for (TiledImage* source : release) {
+                    if (tx < source->getTilesX() && ty < source->getTilesY()) {
+                        source->clearTile(tx, ty);
+                    }
+                }
+            }, 4);
+            return merged;
         }
         
         void LayerSystem::selectLayer(ECS::EntityID layerId) {
@@ -178,6 +690,43 @@ namespace AstralEngine {
             AE_DEBUG("Tüm layer seçimleri kaldırıldı");
         }
         
+        ECS::EntityID LayerSystem::getActiveLayer() const {
+            if (!m_selectedLayers.empty()) {
+                return m_selectedLayers.back();
+            }
+            return m_layerStack.empty() ? ECS::INVALID_ENTITY : m_layerStack.back();
+        }
+        
+        void LayerSystem::setLayerStack(std::vector<ECS::EntityID> layerStack) {
+            m_layerStack = std::move(layerStack);
+            
+            // Undoing a conversion brings back layers in the earlier format
+            for (ECS::EntityID id : m_layerStack) {
+                if (m_scene.hasComponent<Layer>(id) && m_scene.getComponent<Layer>(id).pixels) {
+                    m_documentFormat = m_scene.getComponent<Layer>(id).pixels->getFormat();
+                    break;
+                }
+            }
+            
+            auto removed = [this](ECS::EntityID id) {
+                return std::find(m_layerStack.begin(), m_layerStack.end(), id) == m_layerStack.end();
+            };
+            m_selectedLayers.erase(std::remove_if(m_selectedLayers.begin(), m_selectedLayers.end(), removed), m_selectedLayers.end());
+        }
+        
+        void LayerSystem::beginHistory(const std::string& name) {
+            if (m_history) {
+                m_history->beginOperation(name);
+                m_history->recordStack();
+            }
+        }
+        
+        void LayerSystem::endHistory() {
+            if (m_history) {
+                m_history->endOperation();
+            }
+        }
+        
         void LayerSystem::renderLayer(ECS::EntityID layerId) {
             // Check if the layer exists
             if (!m_scene.hasComponent<Layer>(layerId)) {
@@ -2,31 +2,21 @@
 
 #include "ECS/Components.h"
 #include "Renderer/Texture.h"
+#include "2D/Image/TiledImage.h"
+#include "2D/Image/BlendKernels.h"
+#include "2D/Image/MipPyramid.h"
+#include "2D/Image/Resample.h"
+#include <atomic>
+#include <future>
 #include <string>
 #include <memory>
 #include <vector>
 
 namespace AstralEngine {
     namespace D2 {
-        // Blend modes for layers
-        enum class BlendMode {
-            Normal,
-            Multiply,
-            Screen,
-            Overlay,
-            Darken,
-            Lighten,
-            ColorDodge,
-            ColorBurn,
-            HardLight,
-            SoftLight,
-            Difference,
-            Exclusion,
-            Hue,
-            Saturation,
-            Color,
-            Luminosity
-        };
+        class UndoHistory;
+        class TiledMask;
+        class SelectionSystem;
         
         /**
          * @brief Layer component for 2D graphics editing
@@ -38,6 +28,15 @@ namespace AstralEngine {
             // Layer content
             std::shared_ptr<Texture> content;
             
+            // CPU-side pixels edited by tools; `content` is the GPU copy for display
+            std::shared_ptr<TiledImage> pixels;
+            
+            // Tiles of `pixels` changed since the canvas last composited this layer
+            DirtyTileSet dirtyTiles;
+            
+            // Bumped by markDirty()/markAllDirty(), for consumers that poll for edits without clearing `dirtyTiles`
+            uint64_t version = 0;
+            
             // Layer properties
             std::string name = "Layer";
             float opacity = 1.0f;
@@ -61,6 +60,10 @@ namespace AstralEngine {
             // Helper methods
             bool isVisible() const { return visible && opacity > 0.0f; }
             glm::mat3 getTransformMatrix() const;
+            
+            // Tools call these after writing to `pixels` so only those tiles are recomposited
+            void markDirty(const TileRect& tiles);
+            void markAllDirty();
         };
         
         /**
@@ -70,17 +73,46 @@ namespace AstralEngine {
          */
         class LayerSystem {
         public:
+            // Proxy size interactive transform previews aim for
+            static constexpr uint64_t TRANSFORM_PREVIEW_MAX_PIXELS = 1u << 20;
+            
             LayerSystem(ECS::Scene& scene);
-            ~LayerSystem() = default;
+            ~LayerSystem();
+            
+            // Document size used for new layers' pixel storage; 0x0 creates layers without pixels
+            void setDocumentSize(uint32_t width, uint32_t height, PixelFormat format = PixelFormat::RGBA8);
+            uint32_t getDocumentWidth() const { return m_documentWidth; }
+            uint32_t getDocumentHeight() const { return m_documentHeight; }
+            PixelFormat getDocumentFormat() const { return m_documentFormat; }
+            
+            // Converts every layer's pixels to `format`, re-encoding between sRGB and linear light
+            void convertDocument(PixelFormat format);
             
             // Layer operations
             ECS::EntityID addLayer(const std::string& name);
             void removeLayer(ECS::EntityID layerId);
             void moveLayer(ECS::EntityID layerId, int newPosition);
-            void duplicateLayer(ECS::EntityID layerId);
+            // The copy shares every tile with the original until one of them writes it
+            ECS::EntityID duplicateLayer(ECS::EntityID layerId);
+            
+            // Clipboard. Copies share tiles copy-on-write like duplicates, so copying and
+            // pasting even an 8K layer costs a pointer per tile; only edge tiles of the
+            // selection are copied, and other tiles only once either side is edited.
+            // Puts a layer's pixels, clipped to the selection, on the clipboard
+            void copyLayer(ECS::EntityID layerId);
+            // Adds the clipboard as a new layer above the active one, as one undoable "Paste"
+            ECS::EntityID pasteLayer();
+            bool hasClipboard() const { return m_clipboard != nullptr; }
             
-            // Layer stack operations
+            // Layer stack operations. Both blend every tile of the participating layers
+            // straight into the result in one tile-parallel pass, as the canvas composites
+            // them; hidden layers are dropped. With a history (as in the editor) the sources
+            // stay whole for undo, so memory peaks at the sources plus the result. Only
+            // without one do sources whose pixels nothing else holds give up each tile once
+            // it is merged.
+            // Blends the upper of the two layers into the lower one, which keeps its opacity and blend mode
             void mergeLayers(ECS::EntityID layer1, ECS::EntityID layer2);
+            // Flattens the whole stack into its bottom layer
             void flattenLayers();
             
             // Layer selection
@@ -89,16 +121,96 @@ namespace AstralEngine {
             void clearSelection();
             const std::vector<ECS::EntityID>& getSelectedLayers() const { return m_selectedLayers; }
             
+            // Layer that tools paint into: the last selected one, else the top of the stack
+            ECS::EntityID getActiveLayer() const;
+            
             // Layer stack access
             const std::vector<ECS::EntityID>& getLayerStack() const { return m_layerStack; }
             
+            // Pixels of a layer for tools that sample them; nullptr if it has none
+            const TiledImage* getLayerPixels(ECS::EntityID layerId) const;
+            
+            // Paints `color` (straight sRGB) through `mask`, clipped to the selection, as one undoable "Fill"
+            void fillLayer(ECS::EntityID layerId, const TiledMask& mask, const glm::vec4& color, float opacity = 1.0f);
+            
+            // Resamples a layer's pixels through `transform` (layer pixels to document pixels) as one undoable "Transform"
+            void transformLayer(ECS::EntityID layerId, const glm::mat3& transform, ResampleFilter filter = ResampleFilter::Bicubic);
+            // Bakes the layer's position, scale and rotation into its pixels and resets them
+            void applyLayerTransform(ECS::EntityID layerId, ResampleFilter filter = ResampleFilter::Bicubic);
+            
+            // Interactive transform: while a handle is dragged the layer shows previewTransform()
+            // resampled from a cached proxy of its pixels, at most TRANSFORM_PREVIEW_MAX_PIXELS
+            // and no finer than canvas level `displayLevel`, so a preview costs the tiles it
+            // touches at proxy resolution. commitTransform() resamples the full-resolution
+            // pixels in the background; updateTransform() applies the result as one undoable
+            // "Transform" once it is ready. Edits to the layer while a transform is open are lost.
+            bool beginTransform(ECS::EntityID layerId, uint32_t displayLevel = 0);
+            void previewTransform(const glm::mat3& transform);
+            void commitTransform(ResampleFilter filter = ResampleFilter::Bicubic);
+            // Call once per frame; returns true when a committed transform was applied
+            bool updateTransform();
+            // Drops an open preview; a commit already under way is waited for and applied instead
+            void cancelTransform();
+            bool isTransforming() const { return m_transform != nullptr; }
+            bool isCommittingTransform() const { return m_transform && m_transform->job; }
+            
+            // Swaps in whole new pixels for a layer, e.g. a filter result, as one undoable operation `name`
+            void replaceLayerPixels(ECS::EntityID layerId, std::shared_ptr<TiledImage> pixels, const std::string& name);
+            
+            // Replaces the stack order wholesale (undo/redo); selection keeps only layers still in it
+            void setLayerStack(std::vector<ECS::EntityID> layerStack);
+            
+            // History that stack operations record into; nullptr disables recording
+            void setHistory(UndoHistory* history) { m_history = history; }
+            UndoHistory* getHistory() const { return m_history; }
+            
+            // Selection that fills and pixel operations clip to; nullptr edits whole layers
+            void setSelection(const SelectionSystem* selection) { m_selection = selection; }
+            const SelectionSystem* getSelection() const { return m_selection; }
+            
             // Rendering
             void renderLayer(ECS::EntityID layerId);
             
         private:
+            // Shared with the commit job; its future stays in TransformState, as the job's state owns the closure
+            struct TransformJob {
+                std::atomic<bool> cancel{false};
+                std::shared_ptr<TiledImage> result;
+            };
+            
+            struct TransformState {
+                ECS::EntityID layerId = ECS::INVALID_ENTITY;
+                std::shared_ptr<TiledImage> original;
+                std::shared_ptr<TiledImage> preview; // Shown in place of `original` until the transform ends
+                TileRect shown;                      // Tiles of `preview` that may hold pixels
+                
+                MipPyramid proxies;
+                uint32_t proxyLevel = 0;
+                std::unique_ptr<TiledImage> proxyPreview; // Preview at proxy resolution, enlarged into `preview`
+                
+                glm::mat3 transform = glm::mat3(1.0f);
+                std::shared_ptr<TransformJob> job;
+                std::future<void> jobDone;
+            };
+            
+            void beginHistory(const std::string& name);
+            void endHistory();
+            // `layers` (bottom to top) flattened into a new image; tiles of the images in `release` are dropped once merged
+            std::shared_ptr<TiledImage> mergePixels(const std::vector<Layer*>& layers, const std::vector<TiledImage*>& release) const;
+            // Puts the original pixels back on the layer and closes the transform
+            void endTransform();
+            
             ECS::Scene& m_scene;
             std::vector<ECS::EntityID> m_layerStack;
             std::vector<ECS::EntityID> m_selectedLayers;
+            UndoHistory* m_history = nullptr;
+            const SelectionSystem* m_selection = nullptr;
+            std::unique_ptr<TransformState> m_transform;
+            std::shared_ptr<const TiledImage> m_clipboard;
+            
+            uint32_t m_documentWidth = 0;
+            uint32_t m_documentHeight = 0;
+            PixelFormat m_documentFormat = PixelFormat::RGBA8;
         };
     }
 }
\ No newline at end of file
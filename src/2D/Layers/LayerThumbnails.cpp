@@ -0,0 +1,367 @@
+#include "2D/Layers/LayerThumbnails.h"
+#include "2D/Image/ColorSpace.h"
+#include "2D/Image/MipPyramid.h"
+#include "Core/JobSystem.h"
+#include "Core/Logger.h"
+#include "Renderer/Texture.h"
+#include <algorithm>
+#include <cstring>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            // Slices per worker, so uneven tiles still spread evenly
+            constexpr uint32_t SLICES_PER_WORKER = 4;
+            // Checkerboard shown through transparent pixels
+            constexpr uint32_t CHECKER_SIZE = 8;
+            constexpr uint32_t CHECKER_LIGHT = 255;
+            constexpr uint32_t CHECKER_DARK = 204;
+            constexpr uint64_t NO_REVISION = UINT64_MAX;
+
+            inline void fillRow(uint8_t* dst, const uint8_t* pixel, uint32_t count) {
+                for (uint32_t x = 0; x < count; ++x) {
+                    std::memcpy(dst + x * 4, pixel, 4);
+                }
+            }
+        }
+
+        LayerThumbnails::LayerThumbnails(ECS::Scene& scene)
+            : m_scene(scene), m_renderer(nullptr) {
+            AE_INFO("LayerThumbnails başlatıldı (Renderer olmadan)");
+        }
+
+        LayerThumbnails::LayerThumbnails(ECS::Scene& scene, Renderer& renderer)
+            : m_scene(scene), m_renderer(&renderer) {
+            AE_INFO("LayerThumbnails başlatıldı");
+        }
+
+        LayerThumbnails::~LayerThumbnails() {
+            // Jobs write into reductions shared with them, but no job may outlive the images it reads
+            for (auto& [layerId, entry] : m_entries) {
+                waitFor(entry);
+            }
+            for (Entry& entry : m_retired) {
+                waitFor(entry);
+            }
+        }
+
+        void LayerThumbnails::waitFor(Entry& entry) {
+            if (entry.job.valid()) {
+                entry.reduction->cancel.store(true);
+                entry.job.wait();
+            }
+        }
+
+        const LayerThumbnails::Thumbnail* LayerThumbnails::getThumbnail(ECS::EntityID layerId) const {
+            auto it = m_entries.find(layerId);
+            return it != m_entries.end() && it->second.ready ? &it->second.thumbnail : nullptr;
+        }
+
+        const uint8_t* LayerThumbnails::getPixels(ECS::EntityID layerId) const {
+            auto it = m_entries.find(layerId);
+            return it != m_entries.end() && it->second.ready ? it->second.pixels.data() : nullptr;
+        }
+
+        std::shared_ptr<Texture> LayerThumbnails::getAtlas(uint32_t atlas) const {
+            return atlas < m_atlases.size() ? m_atlases[atlas] : nullptr;
+        }
+
+        uint32_t LayerThumbnails::allocateCell() {
+            if (!m_freeCells.empty()) {
+                const uint32_t cell = m_freeCells.back();
+                m_freeCells.pop_back();
+                return cell;
+            }
+            const uint32_t cell = m_cellCount++;
+            if (m_renderer && cell / CELLS_PER_ATLAS >= m_atlases.size()) {
+                // Every cell is uploaded whole before it is shown, so the atlas starts uninitialized
+                m_atlases.push_back(std::make_shared<Texture>(m_renderer->getDevice(), ATLAS_SIZE, ATLAS_SIZE,
+                                                              VK_FORMAT_R8G8B8A8_UNORM, nullptr, false));
+                AE_DEBUG("Küçük resim atlası oluşturuldu: {}", m_atlases.size());
+            }
+            return cell;
+        }
+
+        void LayerThumbnails::update(const std::vector<ECS::EntityID>& layers) {
+            // Retired cells are free once nothing writes their reduction any more
+            for (size_t i = 0; i < m_retired.size();) {
+                Entry& entry = m_retired[i];
+                if (entry.job.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                    ++i;
+                    continue;
+                }
+                entry.job.get();
+                --m_running;
+                m_freeCells.push_back(entry.cell);
+                m_retired[i] = std::move(m_retired.back());
+                m_retired.pop_back();
+            }
+
+            // Layers no longer shown, e.g. deleted or merged away
+            for (auto it = m_entries.begin(); it != m_entries.end();) {
+                if (std::find(layers.begin(), layers.end(), it->first) != layers.end() &&
+                    m_scene.hasComponent<Layer>(it->first)) {
+                    ++it;
+                    continue;
+                }
+                if (it->second.job.valid()) {
+                    it->second.reduction->cancel.store(true);
+                    m_retired.push_back(std::move(it->second));
+                } else {
+                    m_freeCells.push_back(it->second.cell);
+                }
+                it = m_entries.erase(it);
+            }
+
+            for (auto& [layerId, entry] : m_entries) {
+                if (entry.job.valid() && entry.job.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                    entry.job.get();
+                    --m_running;
+                    finish(entry);
+                }
+            }
+            upload();
+
+            // Start refreshes of edited layers, within the throttle
+            auto& jobs = Jobs::JobSystem::getInstance();
+            const uint32_t maxRunning = std::max(1u, jobs.getWorkerCount());
+            const auto now = std::chrono::steady_clock::now();
+            for (ECS::EntityID layerId : layers) {
+                if (m_running >= maxRunning) {
+                    break;
+                }
+                if (!m_scene.hasComponent<Layer>(layerId)) {
+                    continue;
+                }
+                const Layer& layer = m_scene.getComponent<Layer>(layerId);
+                if (!layer.pixels) {
+                    continue;
+                }
+                auto [it, added] = m_entries.try_emplace(layerId);
+                Entry& entry = it->second;
+                if (added) {
+                    entry.cell = allocateCell();
+                    entry.reduction = std::make_shared<Reduction>();
+                }
+                if (entry.job.valid() || (entry.started && now - entry.lastStart < REFRESH_INTERVAL)) {
+                    continue;
+                }
+                if (entry.started && entry.version == layer.version && entry.source.lock() == layer.pixels) {
+                    continue;
+                }
+
+                entry.started = true;
+                entry.lastStart = now;
+                entry.version = layer.version;
+                entry.source = layer.pixels;
+                entry.reduction->cancel.store(false);
+
+                std::shared_ptr<const TiledImage> snapshot = std::make_shared<TiledImage>(*layer.pixels);
+                std::shared_ptr<Reduction> reduction = entry.reduction;
+                entry.job = jobs.submit([reduction, snapshot] {
+                    refresh(*reduction, *snapshot);
+                });
+                ++m_running;
+            }
+        }
+
+        void LayerThumbnails::finish(Entry& entry) {
+            const Reduction& reduction = *entry.reduction;
+            if (reduction.cancel.load() || reduction.cell.empty()) {
+                return;
+            }
+            entry.pixels = reduction.cell;
+            entry.ready = true;
+
+            const uint32_t local = entry.cell % CELLS_PER_ATLAS;
+            const float x = static_cast<float>((local % CELLS_PER_ROW) * THUMBNAIL_SIZE);
+            const float y = static_cast<float>((local / CELLS_PER_ROW) * THUMBNAIL_SIZE);
+            entry.thumbnail.atlas = entry.cell / CELLS_PER_ATLAS;
+            entry.thumbnail.width = reduction.thumbnailWidth;
+            entry.thumbnail.height = reduction.thumbnailHeight;
+            entry.thumbnail.uv0 = glm::vec2(x, y) / static_cast<float>(ATLAS_SIZE);
+            entry.thumbnail.uv1 = glm::vec2(x + reduction.thumbnailWidth, y + reduction.thumbnailHeight) / static_cast<float>(ATLAS_SIZE);
+            m_pendingUploads.push_back(&entry);
+        }
+
+        void LayerThumbnails::upload() {
+            if (m_atlases.empty()) {
+                m_pendingUploads.clear();
+                return;
+            }
+            std::sort(m_pendingUploads.begin(), m_pendingUploads.end(),
+                      [](const Entry* a, const Entry* b) { return a->cell < b->cell; });
+
+            const size_t cellBytes = static_cast<size_t>(THUMBNAIL_SIZE) * THUMBNAIL_SIZE * 4;
+            for (size_t begin = 0; begin < m_pendingUploads.size();) {
+                // One staging upload per atlas, cells packed back to back
+                const uint32_t atlas = m_pendingUploads[begin]->cell / CELLS_PER_ATLAS;
+                m_regions.clear();
+                m_uploadBuffer.clear();
+                size_t end = begin;
+                for (; end < m_pendingUploads.size() && m_pendingUploads[end]->cell / CELLS_PER_ATLAS == atlas; ++end) {
+                    const Entry& entry = *m_pendingUploads[end];
+                    const uint32_t local = entry.cell % CELLS_PER_ATLAS;
+                    TextureRegion region;
+                    region.x = (local % CELLS_PER_ROW) * THUMBNAIL_SIZE;
+                    region.y = (local / CELLS_PER_ROW) * THUMBNAIL_SIZE;
+                    region.width = THUMBNAIL_SIZE;
+                    region.height = THUMBNAIL_SIZE;
+                    m_regions.push_back(region);
+                    m_uploadBuffer.insert(m_uploadBuffer.end(), entry.pixels.begin(), entry.pixels.begin() + cellBytes);
+                }
+                m_atlases[atlas]->updateRegions(m_regions, m_uploadBuffer.data());
+                begin = end;
+            }
+            m_pendingUploads.clear();
+        }
+
+        void LayerThumbnails::refresh(Reduction& reduction, const TiledImage& image) {
+            const uint32_t width = image.getWidth();
+            const uint32_t height = image.getHeight();
+            if (width == 0 || height == 0) {
+                return;
+            }
+            if (reduction.width != width || reduction.height != height || reduction.format != image.getFormat()) {
+                // Coarsest power-of-two reduction still at least THUMBNAIL_SIZE on the long side,
+                // and no coarser than a tile per pixel
+                const uint32_t longSide = std::max(width, height);
+                uint32_t factor = 1;
+                while (factor < TILE_SIZE && (longSide + factor * 2 - 1) / (factor * 2) >= THUMBNAIL_SIZE) {
+                    factor *= 2;
+                }
+                reduction.width = width;
+                reduction.height = height;
+                reduction.format = image.getFormat();
+                reduction.factor = factor;
+                reduction.reducedWidth = (width + factor - 1) / factor;
+                reduction.reducedHeight = (height + factor - 1) / factor;
+                reduction.reduced.assign(static_cast<size_t>(reduction.reducedWidth) * reduction.reducedHeight * 4, 0);
+                reduction.revisions.assign(image.getTileCount(), NO_REVISION);
+            }
+
+            // Only tiles written since the last refresh; shared copy-on-write tiles keep their revision
+            std::vector<uint32_t> changed;
+            const uint32_t tilesX = image.getTilesX();
+            for (uint32_t index = 0; index < image.getTileCount(); ++index) {
+                const Tile* tile = image.getTile(index % tilesX, index / tilesX);
+                if ((tile ? tile->getRevision() : 0) != reduction.revisions[index]) {
+                    changed.push_back(index);
+                }
+            }
+
+            if (!changed.empty()) {
+                auto& jobs = Jobs::JobSystem::getInstance();
+                const uint32_t count = static_cast<uint32_t>(changed.size());
+                const uint32_t sliceCount = std::min(count, (jobs.getWorkerCount() + 1) * SLICES_PER_WORKER);
+                // Tiles reduce into disjoint blocks, so slices never write the same pixels
+                jobs.parallelFor(sliceCount, [&](size_t slice) {
+                    std::vector<uint8_t> scratch;
+                    const uint32_t begin = static_cast<uint32_t>(static_cast<uint64_t>(count) * slice / sliceCount);
+                    const uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(count) * (slice + 1) / sliceCount);
+                    for (uint32_t i = begin; i < end; ++i) {
+                        if (reduction.cancel.load(std::memory_order_relaxed)) {
+                            return;
+                        }
+                        reduceTile(reduction, image, changed[i] % tilesX, changed[i] / tilesX, scratch);
+                    }
+                });
+            }
+            if (!reduction.cancel.load()) {
+                renderCell(reduction);
+            }
+        }
+
+        void LayerThumbnails::reduceTile(Reduction& reduction, const TiledImage& image, uint32_t tx, uint32_t ty,
+                                         std::vector<uint8_t>& scratch) {
+            const PixelFormat format = reduction.format;
+            const uint32_t bytesPerPixel = getBytesPerPixel(format);
+            const uint32_t block = TILE_SIZE / reduction.factor;
+            const uint32_t x0 = tx * block;
+            const uint32_t y0 = ty * block;
+            const uint32_t width = std::min(block, reduction.reducedWidth - x0);
+            const uint32_t height = std::min(block, reduction.reducedHeight - y0);
+            const size_t stride = static_cast<size_t>(reduction.reducedWidth) * 4;
+            uint8_t* dst = reduction.reduced.data() + y0 * stride + static_cast<size_t>(x0) * 4;
+
+            const Tile* tile = image.getTile(tx, ty);
+            if (!tile || tile->isUniform()) {
+                uint8_t pixel[4] = {0, 0, 0, 0};
+                if (tile) {
+                    ColorSpace::convertRow(format, PixelFormat::RGBA8, tile->getUniformPixel(), pixel, 1);
+                }
+                for (uint32_t y = 0; y < height; ++y) {
+                    fillRow(dst + y * stride, pixel, width);
+                }
+            } else {
+                // Halve the tile in its own format until it is one block, then encode that
+                const uint8_t* src = tile->getData();
+                uint32_t size = TILE_SIZE;
+                if (reduction.factor > 1) {
+                    const size_t half = static_cast<size_t>(TILE_PIXELS / 4) * bytesPerPixel;
+                    scratch.resize(half + half / 4);
+                    uint8_t* buffers[2] = {scratch.data(), scratch.data() + half};
+                    for (uint32_t pass = 0; size > block; ++pass) {
+                        uint8_t* target = buffers[pass & 1];
+                        const size_t rowBytes = static_cast<size_t>(size) * bytesPerPixel;
+                        for (uint32_t y = 0; y < size / 2; ++y) {
+                            MipKernels::reduceRow(format, src + 2 * y * rowBytes, src + (2 * y + 1) * rowBytes,
+                                                  target + y * rowBytes / 2, size / 2);
+                        }
+                        src = target;
+                        size /= 2;
+                    }
+                }
+                for (uint32_t y = 0; y < height; ++y) {
+                    ColorSpace::convertRow(format, PixelFormat::RGBA8, src + static_cast<size_t>(y) * size * bytesPerPixel,
+                                           dst + y * stride, width);
+                }
+            }
+            reduction.revisions[ty * image.getTilesX() + tx] = tile ? tile->getRevision() : 0;
+        }
+
+        void LayerThumbnails::renderCell(Reduction& reduction) {
+            // Aspect fit into the cell, then box-filtered from the reduced pixels
+            const uint32_t longSide = std::max(reduction.width, reduction.height);
+            const uint32_t thumbnailWidth = std::max(1u, static_cast<uint32_t>(
+                (static_cast<uint64_t>(reduction.width) * THUMBNAIL_SIZE + longSide / 2) / longSide));
+            const uint32_t thumbnailHeight = std::max(1u, static_cast<uint32_t>(
+                (static_cast<uint64_t>(reduction.height) * THUMBNAIL_SIZE + longSide / 2) / longSide));
+            const uint32_t reducedWidth = reduction.reducedWidth;
+            const uint32_t reducedHeight = reduction.reducedHeight;
+            const size_t stride = static_cast<size_t>(reducedWidth) * 4;
+
+            // The part of the cell outside the thumbnail stays transparent
+            reduction.cell.assign(static_cast<size_t>(THUMBNAIL_SIZE) * THUMBNAIL_SIZE * 4, 0);
+            for (uint32_t y = 0; y < thumbnailHeight; ++y) {
+                const uint32_t sy0 = y * reducedHeight / thumbnailHeight;
+                const uint32_t sy1 = std::max(sy0 + 1, (y + 1) * reducedHeight / thumbnailHeight);
+                uint8_t* dst = reduction.cell.data() + static_cast<size_t>(y) * THUMBNAIL_SIZE * 4;
+                for (uint32_t x = 0; x < thumbnailWidth; ++x) {
+                    const uint32_t sx0 = x * reducedWidth / thumbnailWidth;
+                    const uint32_t sx1 = std::max(sx0 + 1, (x + 1) * reducedWidth / thumbnailWidth);
+                    uint32_t sum[4] = {0, 0, 0, 0};
+                    for (uint32_t sy = sy0; sy < sy1; ++sy) {
+                        const uint8_t* row = reduction.reduced.data() + sy * stride;
+                        for (uint32_t sx = sx0; sx < sx1; ++sx) {
+                            for (uint32_t c = 0; c < 4; ++c) {
+                                sum[c] += row[sx * 4 + c];
+                            }
+                        }
+                    }
+                    const uint32_t count = (sy1 - sy0) * (sx1 - sx0);
+                    const uint32_t alpha = (sum[3] + count / 2) / count;
+                    const uint32_t checker = ((x / CHECKER_SIZE + y / CHECKER_SIZE) & 1) ? CHECKER_DARK : CHECKER_LIGHT;
+                    // Premultiplied, so the checkerboard only adds what alpha leaves uncovered
+                    const uint32_t background = (checker * (255 - alpha) + 127) / 255;
+                    for (uint32_t c = 0; c < 3; ++c) {
+                        dst[x * 4 + c] = static_cast<uint8_t>(std::min((sum[c] + count / 2) / count + background, 255u));
+                    }
+                    dst[x * 4 + 3] = 255;
+                }
+            }
+            reduction.thumbnailWidth = thumbnailWidth;
+            reduction.thumbnailHeight = thumbnailHeight;
+        }
+    }
+}
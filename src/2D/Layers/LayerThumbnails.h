@@ -0,0 +1,119 @@
+#pragma once
+
+#include "ECS/Components.h"
+#include "Renderer/RRenderer.h"
+#include "2D/Layers/Layer.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        /**
+         * @brief Layer thumbnails for the layers panel, built in the background
+         *
+         * Each layer keeps a reduced copy of its pixels, a mip level of at least
+         * THUMBNAIL_SIZE pixels on the long side, built by reducing every tile with the mip
+         * kernels. A refresh only reduces the tiles whose revision changed since the last
+         * one, then scales the reduced copy down to the thumbnail and lays it over a
+         * checkerboard, so thumbnails are opaque. All of it runs on the job system, on a
+         * copy-on-write snapshot of the layer.
+         *
+         * A layer is refreshed once it was marked dirty or given new pixels, at most once
+         * per REFRESH_INTERVAL, with no more than one refresh per worker in flight.
+         * Thumbnails share ATLAS_SIZE atlas textures, one cell each, and every frame's
+         * finished thumbnails go up in one upload per atlas.
+         */
+        class LayerThumbnails {
+        public:
+            static constexpr uint32_t THUMBNAIL_SIZE = 64;
+            static constexpr uint32_t ATLAS_SIZE = 1024;
+            static constexpr uint32_t CELLS_PER_ROW = ATLAS_SIZE / THUMBNAIL_SIZE;
+            static constexpr uint32_t CELLS_PER_ATLAS = CELLS_PER_ROW * CELLS_PER_ROW;
+            static constexpr std::chrono::milliseconds REFRESH_INTERVAL{250};
+
+            // Where a thumbnail is in the atlases; the image keeps the layer's aspect ratio
+            struct Thumbnail {
+                uint32_t atlas = 0;
+                glm::vec2 uv0 = {0.0f, 0.0f};
+                glm::vec2 uv1 = {0.0f, 0.0f};
+                uint32_t width = 0, height = 0;
+            };
+
+            // Without a renderer thumbnails are only built on the CPU
+            explicit LayerThumbnails(ECS::Scene& scene);
+            LayerThumbnails(ECS::Scene& scene, Renderer& renderer);
+            ~LayerThumbnails();
+
+            LayerThumbnails(const LayerThumbnails&) = delete;
+            LayerThumbnails& operator=(const LayerThumbnails&) = delete;
+
+            // Call once per frame with the layers shown; starts refreshes and uploads finished ones
+            void update(const std::vector<ECS::EntityID>& layers);
+
+            // nullptr until the layer's first thumbnail is ready
+            const Thumbnail* getThumbnail(ECS::EntityID layerId) const;
+            // THUMBNAIL_SIZE x THUMBNAIL_SIZE RGBA8 cell, image in the top-left corner; nullptr until ready
+            const uint8_t* getPixels(ECS::EntityID layerId) const;
+
+            uint32_t getAtlasCount() const { return static_cast<uint32_t>(m_atlases.size()); }
+            std::shared_ptr<Texture> getAtlas(uint32_t atlas) const;
+
+        private:
+            // Owned by the refresh job while one runs
+            struct Reduction {
+                std::atomic<bool> cancel{false};
+                uint32_t width = 0, height = 0; // Of the source
+                PixelFormat format = PixelFormat::RGBA8;
+                uint32_t factor = 1;            // Source pixels per reduced pixel along each axis
+                uint32_t reducedWidth = 0, reducedHeight = 0;
+                std::vector<uint8_t> reduced;   // Premultiplied RGBA8
+                std::vector<uint64_t> revisions; // Tile revision each reduced block was built from; UINT64_MAX if none
+                std::vector<uint8_t> cell;       // Finished thumbnail
+                uint32_t thumbnailWidth = 0, thumbnailHeight = 0;
+            };
+
+            struct Entry {
+                uint32_t cell = 0;                  // Global cell index across atlases
+                bool ready = false;
+                Thumbnail thumbnail;
+                std::vector<uint8_t> pixels;        // Last finished cell
+                uint64_t version = 0;               // Layer::version at the last refresh started
+                std::weak_ptr<const TiledImage> source; // Pixels at the last refresh; only compared
+                bool started = false;
+                std::chrono::steady_clock::time_point lastStart;
+                std::shared_ptr<Reduction> reduction;
+                std::future<void> job;
+            };
+
+            static void refresh(Reduction& reduction, const TiledImage& image);
+            static void reduceTile(Reduction& reduction, const TiledImage& image, uint32_t tx, uint32_t ty,
+                                   std::vector<uint8_t>& scratch);
+            static void renderCell(Reduction& reduction);
+
+            uint32_t allocateCell();
+            void finish(Entry& entry);
+            void upload();
+            static void waitFor(Entry& entry);
+
+            ECS::Scene& m_scene;
+            Renderer* m_renderer;
+
+            std::unordered_map<ECS::EntityID, Entry> m_entries;
+            std::vector<Entry> m_retired; // Removed layers whose refresh is still running
+            std::vector<uint32_t> m_freeCells;
+            uint32_t m_cellCount = 0;
+            uint32_t m_running = 0;
+
+            std::vector<std::shared_ptr<Texture>> m_atlases;
+            // Thumbnails finished this frame, uploaded together per atlas
+            std::vector<const Entry*> m_pendingUploads;
+            std::vector<TextureRegion> m_regions;
+            std::vector<uint8_t> m_uploadBuffer;
+        };
+    }
+}
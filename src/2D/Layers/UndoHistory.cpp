@@ -0,0 +1,578 @@
+#include "2D/Layers/UndoHistory.h"
+#include "Core/JobSystem.h"
+#include "Core/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            // The most recent entries stay uncompressed so undoing them needs no decoding
+            constexpr size_t RAW_ENTRIES = 8;
+
+            const std::string EMPTY_NAME;
+        }
+
+        UndoHistory::UndoHistory(ECS::Scene& scene, LayerSystem& layerSystem)
+            : m_scene(scene), m_layerSystem(layerSystem) {
+        }
+
+        UndoHistory::~UndoHistory() {
+            waitForJobs();
+            if (m_spillFile.is_open()) {
+                m_spillFile.close();
+                std::remove(m_spillPath.c_str());
+            }
+        }
+
+        void UndoHistory::setMemoryBudget(size_t bytes) {
+            m_memoryBudget = bytes;
+            enforceBudget();
+        }
+
+        void UndoHistory::setSpillPath(const std::string& path) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_spillFile.is_open()) {
+                // Spilled tiles live in the old file; keep using it until the history is cleared
+                AE_WARN("Undo geçmişi zaten bir takas dosyası kullanıyor: {}", m_spillPath);
+                return;
+            }
+            m_spillPath = path;
+        }
+
+        void UndoHistory::beginOperation(const std::string& name) {
+            if (m_applying) {
+                return;
+            }
+            if (m_depth++ == 0) {
+                m_current = std::make_shared<Entry>();
+                m_current->name = name;
+                m_recordedTiles.clear();
+            }
+        }
+
+        void UndoHistory::endOperation() {
+            if (m_applying) {
+                return;
+            }
+            if (m_depth == 0) {
+                AE_WARN("Başlatılmamış bir undo işlemi sonlandırılmaya çalışıldı");
+                return;
+            }
+            if (--m_depth > 0) {
+                return;
+            }
+
+            std::shared_ptr<Entry> entry = std::move(m_current);
+            m_recordedTiles.clear();
+
+            // Tiles that were recorded but never written hold nothing to undo
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto unchanged = [this](const TileSnapshot& snapshot) {
+                    ECS::EntityID id = resolve(snapshot.layerId);
+                    if (!m_scene.hasComponent<Layer>(id)) {
+                        return false;
+                    }
+                    const auto& layer = m_scene.getComponent<Layer>(id);
+                    if (!layer.pixels || snapshot.tx >= layer.pixels->getTilesX() || snapshot.ty >= layer.pixels->getTilesY()) {
+                        return false;
+                    }
+                    if (layer.pixels->shareTile(snapshot.tx, snapshot.ty) != snapshot.tile) {
+                        return false;
+                    }
+                    m_memoryUsage -= getSnapshotMemory(snapshot);
+                    return true;
+                };
+                entry->tiles.erase(std::remove_if(entry->tiles.begin(), entry->tiles.end(), unchanged), entry->tiles.end());
+            }
+            if (entry->tiles.empty() && !entry->hasStack) {
+                return;
+            }
+            if (entry->hasStack) {
+                entry->stackAfter = captureStack();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (auto& undone : m_redoStack) {
+                    releaseEntry(*undone);
+                }
+            }
+            m_redoStack.clear();
+            m_undoStack.push_back(std::move(entry));
+
+            AE_DEBUG("Undo işlemi kaydedildi: {} ({} tile)", m_undoStack.back()->name, m_undoStack.back()->tiles.size());
+
+            scheduleCompression();
+            enforceBudget();
+        }
+
+        void UndoHistory::recordTile(ECS::EntityID layerId, uint32_t tx, uint32_t ty) {
+            if (!isRecording() || !m_scene.hasComponent<Layer>(layerId)) {
+                return;
+            }
+            const auto& layer = m_scene.getComponent<Layer>(layerId);
+            if (!layer.pixels || tx >= layer.pixels->getTilesX() || ty >= layer.pixels->getTilesY()) {
+                return;
+            }
+            const uint64_t key = (static_cast<uint64_t>(layerId) << 32) | (ty * layer.pixels->getTilesX() + tx);
+            if (!m_recordedTiles.insert(key).second) {
+                return;
+            }
+
+            // Holding a reference is enough: the layer copies the tile on its next write
+            TileSnapshot snapshot;
+            snapshot.layerId = layerId;
+            snapshot.tx = tx;
+            snapshot.ty = ty;
+            snapshot.format = layer.pixels->getFormat();
+            snapshot.tile = layer.pixels->shareTile(tx, ty);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_memoryUsage += getSnapshotMemory(snapshot);
+            m_current->tiles.push_back(std::move(snapshot));
+        }
+
+        void UndoHistory::recordTiles(ECS::EntityID layerId, const TileRect& tiles) {
+            if (!isRecording()) {
+                return;
+            }
+            for (uint32_t ty = tiles.y0; ty < tiles.y1; ++ty) {
+                for (uint32_t tx = tiles.x0; tx < tiles.x1; ++tx) {
+                    recordTile(layerId, tx, ty);
+                }
+            }
+        }
+
+        void UndoHistory::recordStack() {
+            if (!isRecording() || m_current->hasStack) {
+                return;
+            }
+            m_current->hasStack = true;
+            m_current->stackBefore = captureStack();
+        }
+
+        void UndoHistory::undo() {
+            if (m_depth > 0) {
+                AE_WARN("Kayıt sürerken geri alma yapılamaz");
+                return;
+            }
+            if (m_undoStack.empty()) {
+                return;
+            }
+            std::shared_ptr<Entry> entry = std::move(m_undoStack.back());
+            m_undoStack.pop_back();
+
+            // Pixels first, while every layer the entry touched still exists
+            m_applying = true;
+            swapTiles(*entry);
+            if (entry->hasStack) {
+                applyStack(entry->stackBefore);
+            }
+            m_applying = false;
+
+            AE_DEBUG("Geri alındı: {}", entry->name);
+            m_redoStack.push_back(std::move(entry));
+        }
+
+        void UndoHistory::redo() {
+            if (m_depth > 0) {
+                AE_WARN("Kayıt sürerken yineleme yapılamaz");
+                return;
+            }
+            if (m_redoStack.empty()) {
+                return;
+            }
+            std::shared_ptr<Entry> entry = std::move(m_redoStack.back());
+            m_redoStack.pop_back();
+
+            // The stack first, so layers the pixels belong to exist again
+            m_applying = true;
+            if (entry->hasStack) {
+                applyStack(entry->stackAfter);
+            }
+            swapTiles(*entry);
+            m_applying = false;
+
+            AE_DEBUG("Yinelendi: {}", entry->name);
+            m_undoStack.push_back(std::move(entry));
+
+            // Redone entries hold raw tiles again; the ones pushed past RAW_ENTRIES are compressed anew
+            scheduleCompression();
+            enforceBudget();
+        }
+
+        void UndoHistory::clear() {
+            waitForJobs();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto& entry : m_undoStack) {
+                releaseEntry(*entry);
+            }
+            for (auto& entry : m_redoStack) {
+                releaseEntry(*entry);
+            }
+            m_undoStack.clear();
+            m_redoStack.clear();
+            m_remap.clear();
+            if (m_spillFile.is_open()) {
+                m_spillFile.close();
+                std::remove(m_spillPath.c_str());
+            }
+            m_spillSize = 0;
+            m_spillFree.clear();
+        }
+
+        const std::string& UndoHistory::getUndoName() const {
+            return m_undoStack.empty() ? EMPTY_NAME : m_undoStack.back()->name;
+        }
+
+        const std::string& UndoHistory::getRedoName() const {
+            return m_redoStack.empty() ? EMPTY_NAME : m_redoStack.back()->name;
+        }
+
+        size_t UndoHistory::getMemoryUsage() const {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_memoryUsage;
+        }
+
+        std::vector<UndoHistory::LayerRecord> UndoHistory::captureStack() const {
+            std::vector<LayerRecord> stack;
+            for (ECS::EntityID id : m_layerSystem.getLayerStack()) {
+                if (!m_scene.hasComponent<Layer>(id)) {
+                    continue;
+                }
+                const auto& layer = m_scene.getComponent<Layer>(id);
+                LayerRecord record;
+                record.id = id;
+                record.name = layer.name;
+                record.opacity = layer.opacity;
+                record.visible = layer.visible;
+                record.blendMode = layer.blendMode;
+                record.position = layer.position;
+                record.scale = layer.scale;
+                record.rotation = layer.rotation;
+                record.pixels = layer.pixels;
+                stack.push_back(std::move(record));
+            }
+            return stack;
+        }
+
+        void UndoHistory::applyStack(const std::vector<LayerRecord>& stack) {
+            std::vector<ECS::EntityID> order;
+            order.reserve(stack.size());
+            for (const LayerRecord& record : stack) {
+                ECS::EntityID id = resolve(record.id);
+                if (!m_scene.hasComponent<Layer>(id)) {
+                    // The layer was removed since; bring it back under a new entity
+                    ECS::EntityID restored = m_scene.createEntity(record.name);
+                    m_scene.addComponent<Layer>(restored);
+                    m_remap[id] = restored;
+                    id = restored;
+                }
+                auto& layer = m_scene.getComponent<Layer>(id);
+                layer.name = record.name;
+                layer.opacity = record.opacity;
+                layer.visible = record.visible;
+                layer.blendMode = record.blendMode;
+                layer.position = record.position;
+                layer.scale = record.scale;
+                layer.rotation = record.rotation;
+                layer.pixels = record.pixels;
+                order.push_back(id);
+            }
+
+            // Layers missing from the restored stack go away; their records keep the pixels
+            std::vector<ECS::EntityID> current = m_layerSystem.getLayerStack();
+            for (ECS::EntityID id : current) {
+                if (std::find(order.begin(), order.end(), id) == order.end()) {
+                    m_scene.destroyEntity(id);
+                }
+            }
+            m_layerSystem.setLayerStack(std::move(order));
+        }
+
+        void UndoHistory::swapTiles(Entry& entry) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (TileSnapshot& snapshot : entry.tiles) {
+                ECS::EntityID id = resolve(snapshot.layerId);
+                if (!m_scene.hasComponent<Layer>(id)) {
+                    AE_WARN("Undo: layer bulunamadı: {}", id);
+                    continue;
+                }
+                auto& layer = m_scene.getComponent<Layer>(id);
+                if (!layer.pixels || layer.pixels->getFormat() != snapshot.format ||
+                    snapshot.tx >= layer.pixels->getTilesX() || snapshot.ty >= layer.pixels->getTilesY()) {
+                    continue;
+                }
+
+                std::shared_ptr<const Tile> tile = loadTile(snapshot);
+                if (!tile && snapshot.storage != TileStorage::Raw) {
+                    continue; // Unreadable; leave the layer as it is rather than clearing the tile
+                }
+                layer.pixels->swapTile(snapshot.tx, snapshot.ty, tile);
+
+                // The snapshot now holds the image to go back to
+                if (snapshot.storage == TileStorage::Spilled) {
+                    freeSpill(snapshot.spillOffset, snapshot.spillSize);
+                }
+                m_memoryUsage -= getSnapshotMemory(snapshot);
+                snapshot.storage = TileStorage::Raw;
+                snapshot.tile = std::move(tile);
+                snapshot.encoded = std::vector<uint8_t>();
+                m_memoryUsage += getSnapshotMemory(snapshot);
+
+                layer.markDirty({snapshot.tx, snapshot.ty, snapshot.tx + 1, snapshot.ty + 1});
+            }
+            entry.compressed = false;
+            ++entry.swaps;
+        }
+
+        std::shared_ptr<const Tile> UndoHistory::loadTile(TileSnapshot& snapshot) {
+            if (snapshot.storage == TileStorage::Raw) {
+                return snapshot.tile;
+            }
+
+            std::vector<uint8_t> spilled;
+            const std::vector<uint8_t>* encoded = &snapshot.encoded;
+            if (snapshot.storage == TileStorage::Spilled) {
+                spilled.resize(snapshot.spillSize);
+                m_spillFile.clear();
+                m_spillFile.seekg(static_cast<std::streamoff>(snapshot.spillOffset));
+                m_spillFile.read(reinterpret_cast<char*>(spilled.data()), static_cast<std::streamsize>(spilled.size()));
+                if (!m_spillFile) {
+                    AE_ERROR("Undo takas dosyası okunamadı: {}", m_spillPath);
+                    return nullptr;
+                }
+                encoded = &spilled;
+            }
+
+            auto tile = std::make_shared<Tile>(snapshot.format);
+            if (!TileCodec::decode(snapshot.compression, encoded->data(), encoded->size(), *tile)) {
+                AE_ERROR("Undo tile verisi çözülemedi");
+                return nullptr;
+            }
+            return tile;
+        }
+
+        ECS::EntityID UndoHistory::resolve(ECS::EntityID id) const {
+            for (auto it = m_remap.find(id); it != m_remap.end(); it = m_remap.find(id)) {
+                id = it->second;
+            }
+            return id;
+        }
+
+        size_t UndoHistory::getSnapshotMemory(const TileSnapshot& snapshot) {
+            switch (snapshot.storage) {
+                case TileStorage::Raw:
+                    // Interned uniform tiles are shared by everything and cost nothing extra
+                    return snapshot.tile && !snapshot.tile->isUniform() ? snapshot.tile->getByteSize() : 0;
+                case TileStorage::Compressed:
+                    return snapshot.encoded.size();
+                case TileStorage::Spilled:
+                    return 0;
+            }
+            return 0;
+        }
+
+        void UndoHistory::scheduleCompression() {
+            m_jobs.erase(std::remove_if(m_jobs.begin(), m_jobs.end(), [](const std::future<void>& job) {
+                return job.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+            }), m_jobs.end());
+
+            if (m_undoStack.size() <= RAW_ENTRIES) {
+                return;
+            }
+            const size_t end = m_undoStack.size() - RAW_ENTRIES;
+            for (size_t i = 0; i < end; ++i) {
+                std::shared_ptr<Entry> entry = m_undoStack[i];
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (entry->compressed || entry->compressing || entry->tiles.empty()) {
+                        continue;
+                    }
+                    entry->compressing = true;
+                }
+                m_jobs.push_back(Jobs::JobSystem::getInstance().submit([this, entry]() {
+                    compressEntry(entry);
+                }));
+            }
+        }
+
+        void UndoHistory::compressEntry(const std::shared_ptr<Entry>& entry) {
+            struct Work {
+                size_t index;
+                std::shared_ptr<const Tile> tile;
+                TileCompression compression;
+                std::vector<uint8_t> encoded;
+            };
+            std::vector<Work> work;
+            uint32_t swaps = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                swaps = entry->swaps;
+                for (size_t i = 0; i < entry->tiles.size(); ++i) {
+                    const TileSnapshot& snapshot = entry->tiles[i];
+                    if (snapshot.storage == TileStorage::Raw && snapshot.tile && !snapshot.tile->isUniform()) {
+                        work.push_back({i, snapshot.tile, TileCompression::Raw, {}});
+                    }
+                }
+            }
+
+            // Encoding runs without the lock; undo may swap tiles meanwhile
+            for (Work& item : work) {
+                item.compression = TileCodec::encode(*item.tile, item.encoded);
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (Work& item : work) {
+                if (item.index >= entry->tiles.size()) {
+                    break; // The entry was released
+                }
+                TileSnapshot& snapshot = entry->tiles[item.index];
+                if (snapshot.storage != TileStorage::Raw || snapshot.tile != item.tile) {
+                    continue;
+                }
+                m_memoryUsage -= getSnapshotMemory(snapshot);
+                snapshot.storage = TileStorage::Compressed;
+                snapshot.compression = item.compression;
+                snapshot.encoded = std::move(item.encoded);
+                snapshot.tile.reset();
+                m_memoryUsage += getSnapshotMemory(snapshot);
+            }
+            entry->compressing = false;
+            // Tiles swapped in by undo/redo meanwhile are raw again and need another pass
+            entry->compressed = entry->swaps == swaps;
+        }
+
+        void UndoHistory::enforceBudget() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_memoryUsage <= m_memoryBudget) {
+                return;
+            }
+
+            // Oldest compressed tiles go to disk first
+            if (!m_spillPath.empty()) {
+                for (auto& entry : m_undoStack) {
+                    for (TileSnapshot& snapshot : entry->tiles) {
+                        if (m_memoryUsage <= m_memoryBudget) {
+                            return;
+                        }
+                        if (snapshot.storage == TileStorage::Compressed && !spillSnapshot(snapshot)) {
+                            break;
+                        }
+                    }
+                }
+            }
+
+            // Then the oldest entries are forgotten; the latest one always stays undoable
+            size_t dropped = 0;
+            while (m_memoryUsage > m_memoryBudget && m_undoStack.size() - dropped > 1) {
+                releaseEntry(*m_undoStack[dropped]);
+                ++dropped;
+            }
+            if (dropped > 0) {
+                m_undoStack.erase(m_undoStack.begin(), m_undoStack.begin() + static_cast<ptrdiff_t>(dropped));
+                AE_DEBUG("Undo bellek bütçesi aşıldı, {} işlem silindi", dropped);
+            }
+        }
+
+        bool UndoHistory::spillSnapshot(TileSnapshot& snapshot) {
+            if (!m_spillFile.is_open()) {
+                m_spillFile.open(m_spillPath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+                if (!m_spillFile.is_open()) {
+                    AE_ERROR("Undo takas dosyası açılamadı: {}", m_spillPath);
+                    m_spillPath.clear();
+                    return false;
+                }
+                m_spillSize = 0;
+            }
+
+            const uint32_t size = static_cast<uint32_t>(snapshot.encoded.size());
+            const uint64_t offset = allocateSpill(size);
+            m_spillFile.clear();
+            m_spillFile.seekp(static_cast<std::streamoff>(offset));
+            m_spillFile.write(reinterpret_cast<const char*>(snapshot.encoded.data()), static_cast<std::streamsize>(size));
+            if (!m_spillFile) {
+                AE_ERROR("Undo takas dosyasına yazılamadı: {}", m_spillPath);
+                freeSpill(offset, size);
+                return false;
+            }
+
+            m_memoryUsage -= getSnapshotMemory(snapshot);
+            snapshot.storage = TileStorage::Spilled;
+            snapshot.spillOffset = offset;
+            snapshot.spillSize = size;
+            snapshot.encoded = std::vector<uint8_t>();
+            return true;
+        }
+
+        uint64_t UndoHistory::allocateSpill(uint32_t size) {
+            // First fit, from the front, so the file's tail tends to free up and shrink
+            for (auto it = m_spillFree.begin(); it != m_spillFree.end(); ++it) {
+                if (it->second < size) {
+                    continue;
+                }
+                const uint64_t offset = it->first;
+                const uint64_t remaining = it->second - size;
+                m_spillFree.erase(it);
+                if (remaining > 0) {
+                    m_spillFree.emplace(offset + size, remaining);
+                }
+                return offset;
+            }
+            const uint64_t offset = m_spillSize;
+            m_spillSize += size;
+            return offset;
+        }
+
+        void UndoHistory::freeSpill(uint64_t offset, uint32_t size) {
+            if (size == 0) {
+                return;
+            }
+            uint64_t end = offset + size;
+
+            // Merge with the free neighbours on both sides
+            auto next = m_spillFree.lower_bound(offset);
+            if (next != m_spillFree.end() && next->first == end) {
+                end += next->second;
+                next = m_spillFree.erase(next);
+            }
+            if (next != m_spillFree.begin()) {
+                auto prev = std::prev(next);
+                if (prev->first + prev->second == offset) {
+                    offset = prev->first;
+                    m_spillFree.erase(prev);
+                }
+            }
+
+            // A free tail is simply given back; the next spill writes over it
+            if (end == m_spillSize) {
+                m_spillSize = offset;
+                return;
+            }
+            m_spillFree.emplace(offset, end - offset);
+        }
+
+        void UndoHistory::releaseEntry(Entry& entry) {
+            for (const TileSnapshot& snapshot : entry.tiles) {
+                if (snapshot.storage == TileStorage::Spilled) {
+                    freeSpill(snapshot.spillOffset, snapshot.spillSize);
+                }
+                m_memoryUsage -= getSnapshotMemory(snapshot);
+            }
+            entry.tiles.clear();
+            entry.stackBefore.clear();
+            entry.stackAfter.clear();
+        }
+
+        void UndoHistory::waitForJobs() {
+            for (auto& job : m_jobs) {
+                job.wait();
+            }
+            m_jobs.clear();
+        }
+    }
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "2D/Layers/Layer.h"
+#include "2D/Image/TileCodec.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        /**
+         * @brief Undo/redo for layer pixels and the layer stack
+         *
+         * An operation records the pre-image of every tile before its first write. Capturing
+         * a tile only takes a reference; copy-on-write in TiledImage leaves the old pixels to
+         * the history when the layer writes. Undo swaps pre- and post-images back, so it costs
+         * O(modified tiles). Operations that change the stack or layer properties also store
+         * the stack's metadata before and after; layer pixels there are shared, not copied.
+         *
+         * Entries beyond the most recent few are compressed with TileCodec on the job system.
+         * When the history exceeds its memory budget, the oldest compressed tiles are spilled
+         * to disk if a spill file is configured, and whole entries are dropped after that.
+         * Ranges of the spill file freed by undo or dropped entries are reused by later spills.
+         */
+        class UndoHistory {
+        public:
+            UndoHistory(ECS::Scene& scene, LayerSystem& layerSystem);
+            ~UndoHistory();
+
+            UndoHistory(const UndoHistory&) = delete;
+            UndoHistory& operator=(const UndoHistory&) = delete;
+
+            // Bytes of tile data held in memory before old entries are spilled or dropped
+            void setMemoryBudget(size_t bytes);
+            size_t getMemoryBudget() const { return m_memoryBudget; }
+            // File receiving spilled tiles; empty disables spilling
+            void setSpillPath(const std::string& path);
+
+            /**
+             * Brackets one undoable operation. Nested calls join the outermost operation, so
+             * composite operations (e.g. duplicate = add + copy) undo as one step. Operations
+             * that record nothing leave no entry.
+             */
+            void beginOperation(const std::string& name);
+            void endOperation();
+            bool isRecording() const { return m_depth > 0 && !m_applying; }
+
+            // Call before the first write to these tiles within the current operation
+            void recordTile(ECS::EntityID layerId, uint32_t tx, uint32_t ty);
+            void recordTiles(ECS::EntityID layerId, const TileRect& tiles);
+            // Call before changing the layer stack or any layer's properties
+            void recordStack();
+
+            bool canUndo() const { return !m_undoStack.empty(); }
+            bool canRedo() const { return !m_redoStack.empty(); }
+            void undo();
+            void redo();
+            void clear();
+
+            // Name of the operation undo()/redo() would apply; empty if there is none
+            const std::string& getUndoName() const;
+            const std::string& getRedoName() const;
+
+            // Tile bytes currently held in memory, raw or compressed
+            size_t getMemoryUsage() const;
+
+        private:
+            enum class TileStorage : uint8_t {
+                Raw,        // `tile` holds the pixels (nullptr = the tile was missing)
+                Compressed, // `encoded` holds TileCodec output
+                Spilled     // Encoded bytes live in the spill file
+            };
+
+            struct TileSnapshot {
+                ECS::EntityID layerId = ECS::INVALID_ENTITY;
+                uint32_t tx = 0, ty = 0;
+                TileStorage storage = TileStorage::Raw;
+                std::shared_ptr<const Tile> tile;
+                PixelFormat format = PixelFormat::RGBA8;
+                TileCompression compression = TileCompression::Raw;
+                std::vector<uint8_t> encoded;
+                uint64_t spillOffset = 0;
+                uint32_t spillSize = 0;
+            };
+
+            // Layer metadata; pixels are shared with the layer while it exists
+            struct LayerRecord {
+                ECS::EntityID id = ECS::INVALID_ENTITY;
+                std::string name;
+                float opacity = 1.0f;
+                bool visible = true;
+                BlendMode blendMode = BlendMode::Normal;
+                glm::vec2 position = {0, 0};
+                glm::vec2 scale = {1, 1};
+                float rotation = 0.0f;
+                std::shared_ptr<TiledImage> pixels;
+            };
+
+            struct Entry {
+                std::string name;
+                std::vector<TileSnapshot> tiles;
+                bool hasStack = false;
+                std::vector<LayerRecord> stackBefore;
+                std::vector<LayerRecord> stackAfter;
+                bool compressing = false;
+                bool compressed = false;
+                uint32_t swaps = 0; // Bumped by swapTiles; a compression started before it is stale
+            };
+
+            std::vector<LayerRecord> captureStack() const;
+            void applyStack(const std::vector<LayerRecord>& stack);
+            // Swaps every recorded tile with the layer's current one
+            void swapTiles(Entry& entry);
+            // Turns a snapshot back into a tile; called with m_mutex held
+            std::shared_ptr<const Tile> loadTile(TileSnapshot& snapshot);
+
+            ECS::EntityID resolve(ECS::EntityID id) const;
+            static size_t getSnapshotMemory(const TileSnapshot& snapshot);
+
+            void scheduleCompression();
+            void compressEntry(const std::shared_ptr<Entry>& entry);
+            void enforceBudget();
+            bool spillSnapshot(TileSnapshot& snapshot);
+            // Spill file ranges; called with m_mutex held
+            uint64_t allocateSpill(uint32_t size);
+            void freeSpill(uint64_t offset, uint32_t size);
+            void releaseEntry(Entry& entry);
+            void waitForJobs();
+
+            ECS::Scene& m_scene;
+            LayerSystem& m_layerSystem;
+
+            std::vector<std::shared_ptr<Entry>> m_undoStack; // Oldest first
+            std::vector<std::shared_ptr<Entry>> m_redoStack; // Most recently undone last
+
+            // Operation being recorded
+            std::shared_ptr<Entry> m_current;
+            std::unordered_set<uint64_t> m_recordedTiles;
+            uint32_t m_depth = 0;
+            bool m_applying = false;
+
+            // Entities recreated by undo/redo get new IDs; entries keep the old ones
+            std::unordered_map<ECS::EntityID, ECS::EntityID> m_remap;
+
+            size_t m_memoryBudget = 512ull * 1024 * 1024;
+            size_t m_memoryUsage = 0;
+
+            std::string m_spillPath;
+            std::fstream m_spillFile;
+            uint64_t m_spillSize = 0;
+            std::map<uint64_t, uint64_t> m_spillFree; // Offset -> size of unused ranges below m_spillSize
+
+            // Guards tile snapshots and m_memoryUsage against the compression jobs
+            mutable std::mutex m_mutex;
+            std::vector<std::future<void>> m_jobs;
+        };
+    }
+}
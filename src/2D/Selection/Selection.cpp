@@ -0,0 +1,82 @@
+#include "2D/Selection/Selection.h"
+#include "Core/Logger.h"
+
+namespace AstralEngine {
+    namespace D2 {
+        void SelectionSystem::setDocumentSize(uint32_t width, uint32_t height) {
+            m_mask = TiledMask(width, height);
+            changed();
+        }
+
+        void SelectionSystem::selectAll() {
+            m_mask.fill();
+            changed();
+        }
+
+        void SelectionSystem::deselect() {
+            m_mask.clear();
+            changed();
+        }
+
+        void SelectionSystem::invert() {
+            // Inverting "nothing selected" selects everything, as the whole canvas was editable before
+            MaskOps::invert(m_mask);
+            changed();
+        }
+
+        void SelectionSystem::selectRect(int32_t x0, int32_t y0, int32_t x1, int32_t y1, MaskCombine mode) {
+            TiledMask rect(m_mask.getWidth(), m_mask.getHeight());
+            MaskOps::fillRect(rect, x0, y0, x1, y1);
+            selectMask(rect, mode);
+        }
+
+        void SelectionSystem::selectMask(const TiledMask& mask, MaskCombine mode) {
+            if (mask.getWidth() != m_mask.getWidth() || mask.getHeight() != m_mask.getHeight()) {
+                AE_WARN("Seçim maskesi doküman boyutuyla uyuşmuyor: {}x{}", mask.getWidth(), mask.getHeight());
+                return;
+            }
+            if (mode == MaskCombine::Replace) {
+                m_mask = mask;
+            } else {
+                MaskOps::combine(m_mask, mask, mode);
+            }
+            changed();
+        }
+
+        void SelectionSystem::feather(float radius) {
+            if (m_active) {
+                m_mask = MaskOps::feather(m_mask, radius);
+                changed();
+            }
+        }
+
+        void SelectionSystem::grow(uint32_t radius) {
+            if (m_active) {
+                m_mask = MaskOps::grow(m_mask, radius);
+                changed();
+            }
+        }
+
+        void SelectionSystem::shrink(uint32_t radius) {
+            if (m_active) {
+                m_mask = MaskOps::shrink(m_mask, radius);
+                changed();
+            }
+        }
+
+        const std::vector<MaskSegment>& SelectionSystem::getOutline() {
+            if (m_outlineDirty) {
+                m_outline = m_active ? MaskOps::traceOutline(m_mask) : std::vector<MaskSegment>();
+                m_outlineDirty = false;
+            }
+            return m_outline;
+        }
+
+        void SelectionSystem::changed() {
+            // A selection that lost all its pixels is no selection, not an uneditable canvas
+            m_active = !m_mask.isEmpty();
+            m_outlineDirty = true;
+            AE_DEBUG("Seçim güncellendi ({})", m_active ? "aktif" : "yok");
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "2D/Image/MaskOps.h"
+#include "2D/Image/TiledMask.h"
+#include <cstdint>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        /**
+         * @brief The document's pixel selection
+         *
+         * The selection is a TiledMask over the document, so rectangles and fills only
+         * store their edge tiles and the rest is empty/full flags. Painting tools and
+         * fills clip to getClipMask(); with nothing selected it returns nullptr and every
+         * pixel is editable.
+         *
+         * The marching-ants outline is traced from the boundary tiles on first request
+         * after a change and kept until the next one.
+         */
+        class SelectionSystem {
+        public:
+            // Drops the selection and sizes the mask for a document
+            void setDocumentSize(uint32_t width, uint32_t height);
+
+            bool hasSelection() const { return m_active; }
+            const TiledMask& getMask() const { return m_mask; }
+            const TiledMask* getClipMask() const { return m_active ? &m_mask : nullptr; }
+
+            void selectAll();
+            void deselect();
+            void invert();
+
+            // Pixel rectangle [x0, x1) x [y0, y1), merged into the current selection by `mode`
+            void selectRect(int32_t x0, int32_t y0, int32_t x1, int32_t y1, MaskCombine mode = MaskCombine::Replace);
+            // Arbitrary coverage (fill or magic wand regions); must match the document size
+            void selectMask(const TiledMask& mask, MaskCombine mode = MaskCombine::Replace);
+
+            void feather(float radius);
+            void grow(uint32_t radius);
+            void shrink(uint32_t radius);
+
+            // Marching-ants segments in document pixel coordinates
+            const std::vector<MaskSegment>& getOutline();
+
+        private:
+            void changed();
+
+            TiledMask m_mask;
+            bool m_active = false;
+            std::vector<MaskSegment> m_outline;
+            bool m_outlineDirty = false;
+        };
+    }
+}
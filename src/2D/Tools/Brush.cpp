@@ -3,6 +3,9 @@
 #include "Renderer/RRenderer.h"
 #include "Renderer/Texture.h"
 #include "2D/Layers/Layer.h"
+#include "2D/Layers/UndoHistory.h"
+#include "2D/Selection/Selection.h"
+#include "2D/Image/TileStore.h"
 #include <algorithm>
 #include <cmath>
 
@@ -12,20 +15,36 @@ namespace AstralEngine {
             AE_INFO("BrushSystem başlatıldı");
         }
         
-        void BrushSystem::beginStroke(const glm::vec2& startPoint) {
+        void BrushSystem::beginStroke(const glm::vec2& startPoint, ECS::EntityID layerId, DabBlend blend) {
             if (m_isDrawing) {
                 AE_WARN("Zaten bir fırça darbesi devam ediyor");
                 return;
             }
             
             m_currentStroke.points.clear();
-            m_currentStroke.points.push_back(startPoint);
+            m_currentStroke.samples.clear();
             m_currentStroke.pressure = 1.0f;
             m_currentStroke.tiltX = 0.0f;
             m_currentStroke.tiltY = 0.0f;
             m_currentStroke.timestamp = 0.0f; // TODO: Use actual timestamp
             
+            StrokeSample sample = currentSample(startPoint);
+            m_currentStroke.points.push_back(startPoint);
+            m_currentStroke.samples.push_back(sample);
+            
             m_isDrawing = true;
+            m_targetLayer = layerId;
+            m_strokeBlend = blend;
+            m_strokeTiles = TileRect();
+            
+            if (m_targetLayer != ECS::INVALID_ENTITY) {
+                if (m_history) {
+                    m_history->beginOperation(blend == DabBlend::Erase ? "Erase" : "Brush Stroke");
+                }
+                m_pendingDabs.clear();
+                m_interpolator.begin(sample, getDabSpacing(), m_currentBrush.stabilizer, m_pendingDabs);
+                m_strokeTiles.merge(stampDabs(m_targetLayer, m_pendingDabs, m_strokeBlend));
+            }
             
             AE_DEBUG("Fırça darbesi başlatıldı: ({}, {})", startPoint.x, startPoint.y);
         }
@@ -36,9 +55,15 @@ namespace AstralEngine {
                 return;
             }
             
+            StrokeSample sample = currentSample(point);
             m_currentStroke.points.push_back(point);
+            m_currentStroke.samples.push_back(sample);
             
-            AE_DEBUG("Fırça darbesine nokta eklendi: ({}, {})", point.x, point.y);
+            if (m_targetLayer != ECS::INVALID_ENTITY) {
+                m_pendingDabs.clear();
+                m_interpolator.addSample(sample, m_pendingDabs);
+                m_strokeTiles.merge(stampDabs(m_targetLayer, m_pendingDabs, m_strokeBlend));
+            }
         }
         
         void BrushSystem::endStroke() {
@@ -47,6 +72,19 @@ namespace AstralEngine {
                 return;
             }
             
+            if (m_targetLayer != ECS::INVALID_ENTITY) {
+                m_pendingDabs.clear();
+                m_interpolator.end(m_pendingDabs);
+                m_strokeTiles.merge(stampDabs(m_targetLayer, m_pendingDabs, m_strokeBlend));
+                if (m_strokeBlend == DabBlend::Erase) {
+                    releaseErasedTiles(m_targetLayer, m_strokeTiles);
+                }
+                if (m_history) {
+                    m_history->endOperation();
+                }
+                m_targetLayer = ECS::INVALID_ENTITY;
+            }
+            
             m_isDrawing = false;
             
             AE_DEBUG("Fırça darbesi sonlandırıldı, {} nokta", m_currentStroke.points.size());
@@ -59,13 +97,11 @@ namespace AstralEngine {
                 return;
             }
             
-            // For now, we'll just log the operation
-            // In a full implementation, we would actually paint on the layer's texture
             AE_DEBUG("Fırça darbesi uygulanıyor: {} nokta, layer {}", 
                      stroke.points.size(), layerId);
             
             // Rasterize the stroke
-            rasterizeStroke(layerId, stroke);
+            rasterizeStroke(layerId, stroke, DabBlend::Paint);
         }
         
         void BrushSystem::eraseStroke(ECS::EntityID layerId, const BrushStroke& stroke) {
@@ -75,16 +111,11 @@ namespace AstralEngine {
                 return;
             }
             
-            // Get the layer
-            auto& layer = m_scene.getComponent<Layer>(layerId);
-            
-            // For now, we'll just log the operation
-            // In a full implementation, we would actually erase from the layer's texture
             AE_DEBUG("Silgi darbesi uygulanıyor: {} nokta, layer {}", 
                      stroke.points.size(), layerId);
             
             // Rasterize the stroke for erasing
-            rasterizeStroke(layerId, stroke);
+            rasterizeStroke(layerId, stroke, DabBlend::Erase);
         }
         
         void BrushSystem::applyPressure(float pressure) {
@@ -98,25 +129,143 @@ namespace AstralEngine {
             AE_DEBUG("Eğim uygulandı: ({}, {})", tilt.x, tilt.y);
         }
         
-        void BrushSystem::rasterizeStroke(ECS::EntityID layerId, const BrushStroke& stroke) {
-            // Check if the layer exists
+        Dab BrushSystem::makeDab(float pressure, DabBlend blend) const {
+            Dab dab;
+            dab.radius = m_currentBrush.getRadius() * std::clamp(pressure, 0.0f, 1.0f);
+            dab.hardness = m_currentBrush.hardness;
+            dab.roundness = m_currentBrush.roundness;
+            dab.angle = m_currentBrush.angle * 3.14159265358979f / 180.0f;
+            dab.opacity = m_currentBrush.opacity;
+            dab.color = m_currentBrush.color;
+            dab.blend = blend;
+            
+            switch (m_currentBrush.type) {
+                case BrushType::Square:
+                    dab.shape = DabShape::Square;
+                    break;
+                case BrushType::SoftRound:
+                    dab.hardness = 0.0f;
+                    break;
+                case BrushType::HardRound:
+                    dab.hardness = 1.0f;
+                    break;
+                case BrushType::Round:
+                case BrushType::Texture: // No brush textures yet, stamp the round footprint
+                    break;
+            }
+            return dab;
+        }
+        
+        StrokeSample BrushSystem::currentSample(const glm::vec2& position) const {
+            StrokeSample sample;
+            sample.position = position;
+            sample.pressure = m_currentStroke.pressure;
+            sample.tilt = {m_currentStroke.tiltX, m_currentStroke.tiltY};
+            return sample;
+        }
+        
+        float BrushSystem::getDabSpacing() const {
+            return std::max(m_currentBrush.spacing * m_currentBrush.size, 1.0f);
+        }
+        
+        TileRect BrushSystem::stampDabs(ECS::EntityID layerId, const std::vector<StrokeSample>& dabs, DabBlend blend) {
+            TileRect touched;
+            if (dabs.empty()) {
+                return touched;
+            }
             if (!m_scene.hasComponent<Layer>(layerId)) {
                 AE_WARN("Layer bulunamadı: {}", layerId);
-                return;
+                return touched;
+            }
+            auto& layer = m_scene.getComponent<Layer>(layerId);
+            if (!layer.pixels) {
+                AE_WARN("Layer piksel verisi yok: {}", layerId);
+                return touched;
+            }
+            
+            const TiledMask* clip = m_selection ? m_selection->getClipMask() : nullptr;
+            if (clip && (clip->getWidth() != layer.pixels->getWidth() || clip->getHeight() != layer.pixels->getHeight())) {
+                clip = nullptr;
             }
             
-            // Get the layer
+            // Tilt is interpolated per dab but the round/square footprints do not use it yet.
+            // Dabs are snapped to the mask cache's grid first, so the undo bounds match what is stamped.
+            for (const StrokeSample& sample : dabs) {
+                Dab dab = makeDab(sample.pressure, blend);
+                dab.center = sample.position;
+                dab = DabMaskCache::quantize(dab);
+                if (m_history) {
+                    m_history->recordTiles(layerId, DabRasterizer::getTileBounds(*layer.pixels, dab));
+                }
+                touched.merge(DabRasterizer::stamp(*layer.pixels, dab, clip, &m_maskCache));
+            }
+            layer.markDirty(touched);
+            
+            // Page in the tiles around the brush and where the stroke is heading before it gets there
+            Dab ahead = makeDab(1.0f, blend);
+            ahead.radius += static_cast<float>(TILE_SIZE) * 2.0f;
+            ahead.center = dabs.back().position;
+            TileRect upcoming = DabRasterizer::getTileBounds(*layer.pixels, ahead);
+            ahead.center = dabs.back().position * 2.0f - dabs.front().position;
+            upcoming.merge(DabRasterizer::getTileBounds(*layer.pixels, ahead));
+            TileStore::getInstance().prefetch(*layer.pixels, upcoming);
+            return touched;
+        }
+        
+        void BrushSystem::releaseErasedTiles(ECS::EntityID layerId, const TileRect& tiles) {
+            if (tiles.isEmpty() || !m_scene.hasComponent<Layer>(layerId)) {
+                return;
+            }
             auto& layer = m_scene.getComponent<Layer>(layerId);
+            if (!layer.pixels) {
+                return;
+            }
+            // Erased tiles may be empty now; give their memory back
+            for (uint32_t ty = tiles.y0; ty < tiles.y1; ++ty) {
+                for (uint32_t tx = tiles.x0; tx < tiles.x1; ++tx) {
+                    layer.pixels->compactTile(tx, ty);
+                }
+            }
+        }
+        
+        void BrushSystem::rasterizeStroke(ECS::EntityID layerId, const BrushStroke& stroke, DabBlend blend) {
+            if (stroke.points.empty()) {
+                return;
+            }
             
-            // For now, we'll just log the operation
-            // In a full implementation, we would:
-            // 1. Create a brush mask based on the stroke points
-            // 2. Apply the brush dynamics (pressure, tilt)
-            // 3. Blend the brush with the layer's texture
-            // 4. Update the layer's texture
+            // Replays the recorded input through the same interpolation as live strokes
+            auto sampleAt = [&](size_t i) {
+                if (stroke.samples.size() == stroke.points.size()) {
+                    return stroke.samples[i];
+                }
+                StrokeSample sample;
+                sample.position = stroke.points[i];
+                sample.pressure = stroke.pressure;
+                sample.tilt = {stroke.tiltX, stroke.tiltY};
+                return sample;
+            };
             
-            AE_DEBUG("Fırça darbesi rasterize ediliyor: {} nokta, layer {}", 
-                     stroke.points.size(), layerId);
+            StrokeInterpolator interpolator;
+            std::vector<StrokeSample> dabs;
+            interpolator.begin(sampleAt(0), getDabSpacing(), m_currentBrush.stabilizer, dabs);
+            for (size_t i = 1; i < stroke.points.size(); ++i) {
+                interpolator.addSample(sampleAt(i), dabs);
+            }
+            interpolator.end(dabs);
+            
+            if (m_history) {
+                m_history->beginOperation(blend == DabBlend::Erase ? "Erase" : "Brush Stroke");
+            }
+            TileRect touched = stampDabs(layerId, dabs, blend);
+            if (blend == DabBlend::Erase) {
+                releaseErasedTiles(layerId, touched);
+            }
+            if (m_history) {
+                m_history->endOperation();
+            }
+            
+            AE_DEBUG("Fırça darbesi rasterize edildi: {} nokta, {} dab, layer {}", 
+                     stroke.points.size(), dabs.size(), layerId);
         }
         
         glm::vec4 BrushSystem::sampleBrushTexture(const glm::vec2& uv) {
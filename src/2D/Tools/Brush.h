@@ -3,7 +3,9 @@
 #include "ECS/Components.h"
 #include "2D/Layers/Layer.h"
 #include "2D/Tools/Tool.h" // Include the base class definition
-#include "2D/Layers/Layer.h"
+#include "2D/Image/DabMaskCache.h"
+#include "2D/Image/DabRasterizer.h"
+#include "2D/Tools/StrokeInterpolator.h"
 #include <glm/glm.hpp>
 #include <vector>
 #include <memory>
@@ -23,6 +25,8 @@ namespace AstralEngine {
         struct BrushTool : public ECS::IComponent {
             float size = 10.0f;
             float hardness = 1.0f;
+            float roundness = 1.0f; // Minor to major axis ratio of the tip
+            float angle = 0.0f;     // Tip rotation in degrees
             float opacity = 1.0f;
             glm::vec4 color = {0.0f, 0.0f, 0.0f, 1.0f};
             BrushType type = BrushType::Round;
@@ -30,6 +34,9 @@ namespace AstralEngine {
             // Spacing for stroke rendering
             float spacing = 0.25f;
             
+            // Input smoothing, 0 = raw pointer positions, towards 1 = heavier smoothing
+            float stabilizer = 0.0f;
+            
             // Texture for texture brushes
             // std::shared_ptr<Texture> brushTexture;
             
@@ -43,6 +50,8 @@ namespace AstralEngine {
         // Brush stroke structure
         struct BrushStroke {
             std::vector<glm::vec2> points;
+            // Per-point input with dynamics; `points` mirrors the positions
+            std::vector<StrokeSample> samples;
             float pressure = 1.0f;
             float tiltX = 0.0f;
             float tiltY = 0.0f;
@@ -55,8 +64,10 @@ namespace AstralEngine {
             BrushSystem(ECS::Scene& scene);
             ~BrushSystem() = default;
             
-            // Brush operations
-            void beginStroke(const glm::vec2& startPoint);
+            // Brush operations. With a target layer the stroke is painted while it is drawn,
+            // each new point only stamping the dabs of the newly completed segment.
+            void beginStroke(const glm::vec2& startPoint, ECS::EntityID layerId = ECS::INVALID_ENTITY,
+                             DabBlend blend = DabBlend::Paint);
             void addPointToStroke(const glm::vec2& point);
             void endStroke();
             
@@ -71,19 +82,42 @@ namespace AstralEngine {
             // Rendering
             void renderBrushPreview(const glm::vec2& position);
             
+            // History each stroke is recorded into as one operation; nullptr disables recording
+            void setHistory(UndoHistory* history) { m_history = history; }
+            // Strokes only reach selected pixels; nullptr paints everywhere
+            void setSelection(const SelectionSystem* selection) { m_selection = selection; }
+            
             // Get current brush
             BrushTool& getCurrentBrush() { return m_currentBrush; }
             const BrushTool& getCurrentBrush() const { return m_currentBrush; }
             const BrushStroke& getCurrentStroke() const { return m_currentStroke; }
             
+            // Dab footprints reused across strokes
+            DabMaskCache& getMaskCache() { return m_maskCache; }
+            
         private:
             ECS::Scene& m_scene;
             BrushTool m_currentBrush;
             BrushStroke m_currentStroke;
             bool m_isDrawing = false;
+            UndoHistory* m_history = nullptr;
+            const SelectionSystem* m_selection = nullptr;
+            
+            // Live stroke state
+            StrokeInterpolator m_interpolator;
+            std::vector<StrokeSample> m_pendingDabs;
+            ECS::EntityID m_targetLayer = ECS::INVALID_ENTITY;
+            DabBlend m_strokeBlend = DabBlend::Paint;
+            TileRect m_strokeTiles;
+            DabMaskCache m_maskCache;
             
             // Internal methods
-            void rasterizeStroke(ECS::EntityID layerId, const BrushStroke& stroke);
+            void rasterizeStroke(ECS::EntityID layerId, const BrushStroke& stroke, DabBlend blend);
+            TileRect stampDabs(ECS::EntityID layerId, const std::vector<StrokeSample>& dabs, DabBlend blend);
+            void releaseErasedTiles(ECS::EntityID layerId, const TileRect& tiles);
+            StrokeSample currentSample(const glm::vec2& position) const;
+            float getDabSpacing() const;
+            Dab makeDab(float pressure, DabBlend blend) const;
             glm::vec4 sampleBrushTexture(const glm::vec2& uv);
         };
 
@@ -0,0 +1,135 @@
+#include "2D/Tools/StrokeInterpolator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace AstralEngine {
+    namespace D2 {
+        namespace {
+            // Samples closer than this to the previous control point only update its dynamics
+            constexpr float MIN_CONTROL_DISTANCE = 0.5f;
+            // Segments are flattened into pieces of about this length before spacing dabs
+            constexpr float FLATTEN_STEP = 2.0f;
+            constexpr int MAX_FLATTEN_PIECES = 64;
+
+            StrokeSample lerpSample(const StrokeSample& a, const StrokeSample& b, float t) {
+                StrokeSample result;
+                result.position = a.position + (b.position - a.position) * t;
+                result.pressure = a.pressure + (b.pressure - a.pressure) * t;
+                result.tilt = a.tilt + (b.tilt - a.tilt) * t;
+                return result;
+            }
+
+            float knotInterval(const glm::vec2& a, const glm::vec2& b) {
+                // Centripetal parameterization: sqrt of the chord length
+                return std::max(std::sqrt(glm::length(b - a)), 1e-3f);
+            }
+        }
+
+        void StrokeInterpolator::begin(const StrokeSample& sample, float spacing, float stabilizer, std::vector<StrokeSample>& dabs) {
+            m_spacing = std::max(spacing, 0.5f);
+            m_stabilizer = std::clamp(stabilizer, 0.0f, 0.99f);
+            m_smoothed = sample;
+            m_lastRaw = sample;
+            m_travelled = 0.0f;
+            m_active = true;
+
+            // The start point doubles as the phantom point before the first segment
+            m_controls[0] = sample;
+            m_controls[1] = sample;
+            m_controlCount = 2;
+
+            dabs.push_back(sample);
+        }
+
+        void StrokeInterpolator::addSample(const StrokeSample& sample, std::vector<StrokeSample>& dabs) {
+            if (!m_active) {
+                return;
+            }
+            m_lastRaw = sample;
+            m_smoothed = lerpSample(m_smoothed, sample, 1.0f - m_stabilizer);
+
+            StrokeSample& last = m_controls[m_controlCount - 1];
+            if (glm::length(m_smoothed.position - last.position) < MIN_CONTROL_DISTANCE) {
+                last.pressure = m_smoothed.pressure;
+                last.tilt = m_smoothed.tilt;
+                return;
+            }
+            pushControlPoint(m_smoothed, dabs);
+        }
+
+        void StrokeInterpolator::end(std::vector<StrokeSample>& dabs) {
+            if (!m_active) {
+                return;
+            }
+            m_active = false;
+
+            // The stabilizer lags behind the pointer; finish where the user actually stopped
+            if (glm::length(m_lastRaw.position - m_controls[m_controlCount - 1].position) >= MIN_CONTROL_DISTANCE) {
+                pushControlPoint(m_lastRaw, dabs);
+            }
+            if (m_controlCount >= 3) {
+                pushControlPoint(m_controls[m_controlCount - 1], dabs);
+            }
+        }
+
+        void StrokeInterpolator::pushControlPoint(const StrokeSample& sample, std::vector<StrokeSample>& dabs) {
+            if (m_controlCount < m_controls.size()) {
+                m_controls[m_controlCount++] = sample;
+            } else {
+                std::rotate(m_controls.begin(), m_controls.begin() + 1, m_controls.end());
+                m_controls.back() = sample;
+            }
+            if (m_controlCount == m_controls.size()) {
+                emitSegment(m_controls[0], m_controls[1], m_controls[2], m_controls[3], dabs);
+            }
+        }
+
+        void StrokeInterpolator::emitSegment(const StrokeSample& p0, const StrokeSample& p1, const StrokeSample& p2,
+                                             const StrokeSample& p3, std::vector<StrokeSample>& dabs) {
+            // Phantom end points repeat a real one; reflect them so the knots stay well-conditioned
+            glm::vec2 q0 = p0.position, q1 = p1.position, q2 = p2.position, q3 = p3.position;
+            if (glm::length(q1 - q0) < MIN_CONTROL_DISTANCE) {
+                q0 = q1 + (q1 - q2);
+            }
+            if (glm::length(q3 - q2) < MIN_CONTROL_DISTANCE) {
+                q3 = q2 + (q2 - q1);
+            }
+
+            const float t0 = 0.0f;
+            const float t1 = t0 + knotInterval(q0, q1);
+            const float t2 = t1 + knotInterval(q1, q2);
+            const float t3 = t2 + knotInterval(q2, q3);
+
+            // Barry-Goldman pyramid evaluation of the segment between q1 and q2
+            auto evaluate = [&](float u) {
+                float t = t1 + (t2 - t1) * u;
+                glm::vec2 a1 = q0 * ((t1 - t) / (t1 - t0)) + q1 * ((t - t0) / (t1 - t0));
+                glm::vec2 a2 = q1 * ((t2 - t) / (t2 - t1)) + q2 * ((t - t1) / (t2 - t1));
+                glm::vec2 a3 = q2 * ((t3 - t) / (t3 - t2)) + q3 * ((t - t2) / (t3 - t2));
+                glm::vec2 b1 = a1 * ((t2 - t) / (t2 - t0)) + a2 * ((t - t0) / (t2 - t0));
+                glm::vec2 b2 = a2 * ((t3 - t) / (t3 - t1)) + a3 * ((t - t1) / (t3 - t1));
+                return b1 * ((t2 - t) / (t2 - t1)) + b2 * ((t - t1) / (t2 - t1));
+            };
+
+            // Flatten the segment and walk it at a constant arc-length spacing
+            const float chord = glm::length(q2 - q1);
+            const int pieces = std::clamp(static_cast<int>(std::ceil(chord / FLATTEN_STEP)), 1, MAX_FLATTEN_PIECES);
+            glm::vec2 previous = q1;
+            for (int k = 1; k <= pieces; ++k) {
+                const glm::vec2 current = k == pieces ? q2 : evaluate(static_cast<float>(k) / pieces);
+                const float length = glm::length(current - previous);
+                if (length > 0.0f) {
+                    float next = m_spacing - m_travelled;
+                    for (; next <= length; next += m_spacing) {
+                        float f = next / length;
+                        StrokeSample dab = lerpSample(p1, p2, (static_cast<float>(k - 1) + f) / pieces);
+                        dab.position = previous + (current - previous) * f;
+                        dabs.push_back(dab);
+                    }
+                    m_travelled = length - (next - m_spacing);
+                }
+                previous = current;
+            }
+        }
+    }
+}
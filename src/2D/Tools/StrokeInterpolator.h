@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <array>
+#include <vector>
+
+namespace AstralEngine {
+    namespace D2 {
+        // One input event of a stroke, or one interpolated dab position
+        struct StrokeSample {
+            glm::vec2 position = {0.0f, 0.0f};
+            float pressure = 1.0f;
+            glm::vec2 tilt = {0.0f, 0.0f};
+        };
+
+        /**
+         * @brief Turns raw pointer samples into evenly spaced dab positions
+         *
+         * Samples are smoothed by an exponential stabilizer and joined with a centripetal
+         * Catmull-Rom spline. A spline segment is final once the sample after it arrives,
+         * so every call only walks the newest segment and emits dabs at a fixed arc-length
+         * spacing, carrying the remainder into the next segment. Pressure and tilt are
+         * interpolated along each segment. The cost per event is independent of the stroke
+         * length.
+         */
+        class StrokeInterpolator {
+        public:
+            // `spacing` is the distance between dabs in pixels; `stabilizer` in [0, 1), 0 = raw input
+            void begin(const StrokeSample& sample, float spacing, float stabilizer, std::vector<StrokeSample>& dabs);
+            void addSample(const StrokeSample& sample, std::vector<StrokeSample>& dabs);
+            // Catches up with the last raw sample and emits the remaining segments
+            void end(std::vector<StrokeSample>& dabs);
+
+            bool isActive() const { return m_active; }
+
+        private:
+            void pushControlPoint(const StrokeSample& sample, std::vector<StrokeSample>& dabs);
+            void emitSegment(const StrokeSample& p0, const StrokeSample& p1, const StrokeSample& p2,
+                             const StrokeSample& p3, std::vector<StrokeSample>& dabs);
+
+            // Last four spline control points, oldest first
+            std::array<StrokeSample, 4> m_controls;
+            size_t m_controlCount = 0;
+
+            StrokeSample m_smoothed;
+            StrokeSample m_lastRaw;
+            float m_spacing = 1.0f;
+            float m_stabilizer = 0.0f;
+            float m_travelled = 0.0f; // Arc length since the last dab
+            bool m_active = false;
+        };
+    }
+}
@@ -2,6 +2,7 @@
 #include "Core/Logger.h"
 #include "Renderer/RRenderer.h"
 #include <algorithm>
+#include <cmath>
 
 namespace AstralEngine {
     namespace D2 {
@@ -14,8 +15,25 @@ namespace AstralEngine {
         }
         
         void SelectionTool::onMouseUp(const glm::vec2& position, ECS::EntityID canvasId) {
+            if (!m_selecting) {
+                return;
+            }
             m_selecting = false;
             m_endPos = position;
+            
+            const glm::vec2 minPos = glm::min(m_startPos, m_endPos);
+            const glm::vec2 maxPos = glm::max(m_startPos, m_endPos);
+            const int32_t x0 = static_cast<int32_t>(std::floor(minPos.x));
+            const int32_t y0 = static_cast<int32_t>(std::floor(minPos.y));
+            const int32_t x1 = static_cast<int32_t>(std::ceil(maxPos.x));
+            const int32_t y1 = static_cast<int32_t>(std::ceil(maxPos.y));
+            if (x1 - x0 <= 1 && y1 - y0 <= 1) {
+                if (m_mode == MaskCombine::Replace) {
+                    m_selectionSystem.deselect();
+                }
+            } else {
+                m_selectionSystem.selectRect(x0, y0, x1, y1, m_mode);
+            }
             AE_DEBUG("Selection tool mouse up at ({}, {})", position.x, position.y);
         }
         
@@ -34,6 +52,31 @@ namespace AstralEngine {
             }
         }
         
+        // MagicWandTool implementation
+        void MagicWandTool::onMouseDown(const glm::vec2& position, ECS::EntityID canvasId) {
+            const TiledImage* sample = m_sampleMerged ? m_canvasSystem.getComposite(canvasId) : nullptr;
+            if (!sample) {
+                sample = m_layerSystem.getLayerPixels(m_layerSystem.getActiveLayer());
+            }
+            if (!sample || position.x < 0.0f || position.y < 0.0f) {
+                return;
+            }
+            
+            // The mask comes back in tiles, with whole matching tiles shared, ready for the selection
+            const uint32_t x = static_cast<uint32_t>(position.x);
+            const uint32_t y = static_cast<uint32_t>(position.y);
+            TiledMask mask = FloodFill::computeMask(*sample, x, y, m_options);
+            if (mask.isEmpty()) {
+                // Clicking off the image drops a replaced selection, as the marquee does
+                if (m_mode == MaskCombine::Replace) {
+                    m_selectionSystem.deselect();
+                }
+                return;
+            }
+            m_selectionSystem.selectMask(mask, m_mode);
+            AE_DEBUG("Sihirli değnek seçimi: ({}, {}), tolerans {}", x, y, m_options.tolerance);
+        }
+        
         // BrushTool2D implementation
         void BrushTool2D::activate() {
             Tool::activate();
@@ -51,7 +94,7 @@ namespace AstralEngine {
         
         void BrushTool2D::onMouseDown(const glm::vec2& position, ECS::EntityID canvasId) {
             m_drawing = true;
-            m_brushSystem.beginStroke(position);
+            m_brushSystem.beginStroke(position, m_layerSystem.getActiveLayer(), DabBlend::Paint);
         }
         
         void BrushTool2D::onMouseUp(const glm::vec2& position, ECS::EntityID canvasId) {
@@ -90,18 +133,13 @@ namespace AstralEngine {
         
         void EraserTool::onMouseDown(const glm::vec2& position, ECS::EntityID canvasId) {
             m_erasing = true;
-            m_brushSystem.beginStroke(position);
+            m_brushSystem.beginStroke(position, m_layerSystem.getActiveLayer(), DabBlend::Erase);
             AE_DEBUG("Eraser tool mouse down at ({}, {})", position.x, position.y);
         }
         
         void EraserTool::onMouseUp(const glm::vec2& position, ECS::EntityID canvasId) {
             if (m_erasing) {
                 m_brushSystem.addPointToStroke(position);
-                const auto& stroke = m_brushSystem.getCurrentStroke();
-                auto layers = m_layerSystem.getLayerStack();
-                if (!layers.empty()) {
-                    m_brushSystem.eraseStroke(layers[0], stroke);
-                }
                 m_brushSystem.endStroke();
                 m_erasing = false;
                 AE_DEBUG("Eraser tool mouse up at ({}, {})", position.x, position.y);
@@ -120,6 +158,32 @@ namespace AstralEngine {
             AE_DEBUG("Eraser tool rendering");
         }
         
+        // FillTool implementation
+        void FillTool::onMouseDown(const glm::vec2& position, ECS::EntityID canvasId) {
+            const ECS::EntityID layerId = m_layerSystem.getActiveLayer();
+            const TiledImage* target = m_layerSystem.getLayerPixels(layerId);
+            if (!target || position.x < 0.0f || position.y < 0.0f) {
+                return;
+            }
+            
+            // The composite is only there once the canvas has been rendered
+            const TiledImage* sample = m_sampleMerged ? m_canvasSystem.getComposite(canvasId) : nullptr;
+            if (!sample) {
+                sample = target;
+            }
+            
+            const uint32_t x = static_cast<uint32_t>(position.x);
+            const uint32_t y = static_cast<uint32_t>(position.y);
+            TiledMask mask = FloodFill::computeMask(*sample, x, y, m_options);
+            if (mask.isEmpty()) {
+                return;
+            }
+            
+            const BrushTool& brush = m_brushSystem.getCurrentBrush();
+            m_layerSystem.fillLayer(layerId, mask, brush.color, brush.opacity);
+            AE_DEBUG("Fill tool mouse down at ({}, {})", position.x, position.y);
+        }
+        
         // ToolManager implementation
         ToolManager::ToolManager(ECS::Scene& scene, CanvasSystem& canvasSystem, BrushSystem& brushSystem)
             : m_scene(scene), m_canvasSystem(canvasSystem), m_brushSystem(brushSystem) {
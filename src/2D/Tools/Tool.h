@@ -5,6 +5,8 @@
 #include "2D/Canvas/Canvas.h"
 #include "2D/Layers/Layer.h"
 #include "2D/Tools/Brush.h"
+#include "2D/Image/FloodFill.h"
+#include "2D/Selection/Selection.h"
 #include <glm/glm.hpp>
 #include <string>
 #include <memory>
@@ -40,22 +42,55 @@ namespace AstralEngine {
             bool m_active = false;
         };
         
-        // Selection tool
+        // Rectangular marquee; a click without dragging drops the selection
         class SelectionTool : public Tool {
         public:
-            SelectionTool() : Tool("Selection") {}
+            SelectionTool(SelectionSystem& selectionSystem) : Tool("Selection"), m_selectionSystem(selectionSystem) {}
             
             void onMouseDown(const glm::vec2& position, ECS::EntityID canvasId) override;
             void onMouseUp(const glm::vec2& position, ECS::EntityID canvasId) override;
             void onMouseMove(const glm::vec2& position, ECS::EntityID canvasId) override;
             void render() override;
             
+            // How the next rectangle merges with the current selection
+            void setMode(MaskCombine mode) { m_mode = mode; }
+            MaskCombine getMode() const { return m_mode; }
+            
         private:
+            SelectionSystem& m_selectionSystem;
+            MaskCombine m_mode = MaskCombine::Replace;
             bool m_selecting = false;
             glm::vec2 m_startPos;
             glm::vec2 m_endPos;
         };
         
+        // Selects the region around the click that matches its color, merged into the selection by the mode
+        class MagicWandTool : public Tool {
+        public:
+            MagicWandTool(SelectionSystem& selectionSystem, LayerSystem& layerSystem, CanvasSystem& canvasSystem)
+                : Tool("Magic Wand"), m_selectionSystem(selectionSystem), m_layerSystem(layerSystem), m_canvasSystem(canvasSystem) {
+                m_options.tolerance = 32.0f / 255.0f;
+            }
+            
+            void onMouseDown(const glm::vec2& position, ECS::EntityID canvasId) override;
+            
+            // Tolerance, anti-aliasing and contiguous or global matching
+            FillOptions& getOptions() { return m_options; }
+            // Match colors against the canvas composite instead of the active layer alone
+            void setSampleMerged(bool sampleMerged) { m_sampleMerged = sampleMerged; }
+            bool isSampleMerged() const { return m_sampleMerged; }
+            void setMode(MaskCombine mode) { m_mode = mode; }
+            MaskCombine getMode() const { return m_mode; }
+            
+        private:
+            SelectionSystem& m_selectionSystem;
+            LayerSystem& m_layerSystem;
+            CanvasSystem& m_canvasSystem;
+            FillOptions m_options;
+            bool m_sampleMerged = false;
+            MaskCombine m_mode = MaskCombine::Replace;
+        };
+        
         // Eraser tool
         class EraserTool : public Tool {
         public:
@@ -74,6 +109,27 @@ namespace AstralEngine {
             bool m_erasing = false;
         };
         
+        // Bucket fill tool: fills the region around the click with the brush color
+        class FillTool : public Tool {
+        public:
+            FillTool(BrushSystem& brushSystem, LayerSystem& layerSystem, CanvasSystem& canvasSystem)
+                : Tool("Fill"), m_brushSystem(brushSystem), m_layerSystem(layerSystem), m_canvasSystem(canvasSystem) {}
+            
+            void onMouseDown(const glm::vec2& position, ECS::EntityID canvasId) override;
+            
+            FillOptions& getOptions() { return m_options; }
+            // Match colors against the canvas composite instead of the active layer alone
+            void setSampleMerged(bool sampleMerged) { m_sampleMerged = sampleMerged; }
+            bool isSampleMerged() const { return m_sampleMerged; }
+            
+        private:
+            BrushSystem& m_brushSystem;
+            LayerSystem& m_layerSystem;
+            CanvasSystem& m_canvasSystem;
+            FillOptions m_options;
+            bool m_sampleMerged = false;
+        };
+        
         // Tool manager
         class ToolManager {
         public:
@@ -0,0 +1,585 @@
+#include "Asset/AstralDocument.h"
+#include "Core/Logger.h"
+#include "Core/JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
+
+namespace AstralEngine {
+    namespace Asset {
+        namespace {
+            constexpr char FILE_MAGIC[8] = {'A', 'S', 'T', 'R', 'A', 'L', 'D', 'C'};
+            constexpr uint32_t FILE_VERSION = 1;
+            constexpr uint64_t HEADER_SIZE = 32;
+            constexpr uint64_t CHUNK_HEADER_SIZE = 16;
+            // Largest document side accepted on load, the same as for PSB
+            constexpr uint32_t MAX_DIMENSION = 300000;
+            // Bytes of a layer's entry in the document index with an empty name
+            constexpr size_t MIN_LAYER_ENTRY_SIZE = 54;
+            
+            constexpr uint32_t makeTag(char a, char b, char c, char d) {
+                return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+                       (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+            }
+            constexpr uint32_t TAG_TILE = makeTag('T', 'I', 'L', 'E');
+            constexpr uint32_t TAG_LAYER_INDEX = makeTag('L', 'I', 'D', 'X');
+            constexpr uint32_t TAG_DOCUMENT_INDEX = makeTag('D', 'I', 'D', 'X');
+            
+            // Tiles are encoded and written in batches to bound the memory held by encoded data
+            constexpr size_t TILE_BATCH_SIZE = 1024;
+            
+            // Compact once dead chunks exceed live data and this many bytes
+            constexpr uint64_t COMPACTION_THRESHOLD = 64ull * 1024 * 1024;
+            
+            // Little-endian serialization into a growable buffer
+            class ByteWriter {
+            public:
+                explicit ByteWriter(std::vector<uint8_t>& out) : m_out(out) {}
+                
+                template<typename T>
+                void write(T value) {
+                    size_t pos = m_out.size();
+                    m_out.resize(pos + sizeof(T));
+                    std::memcpy(m_out.data() + pos, &value, sizeof(T));
+                }
+                
+                void writeString(const std::string& value) {
+                    write<uint32_t>(static_cast<uint32_t>(value.size()));
+                    m_out.insert(m_out.end(), value.begin(), value.end());
+                }
+                
+            private:
+                std::vector<uint8_t>& m_out;
+            };
+            
+            class ByteReader {
+            public:
+                ByteReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+                
+                template<typename T>
+                T read() {
+                    T value{};
+                    if (m_pos + sizeof(T) > m_size) {
+                        m_ok = false;
+                        return value;
+                    }
+                    std::memcpy(&value, m_data + m_pos, sizeof(T));
+                    m_pos += sizeof(T);
+                    return value;
+                }
+                
+                std::string readString() {
+                    uint32_t length = read<uint32_t>();
+                    if (!m_ok || m_pos + length > m_size) {
+                        m_ok = false;
+                        return {};
+                    }
+                    std::string value(reinterpret_cast<const char*>(m_data + m_pos), length);
+                    m_pos += length;
+                    return value;
+                }
+                
+                bool ok() const { return m_ok; }
+                
+            private:
+                const uint8_t* m_data;
+                size_t m_size;
+                size_t m_pos = 0;
+                bool m_ok = true;
+            };
+            
+            void appendChunkHeader(std::vector<uint8_t>& out, uint32_t tag, uint64_t payloadSize) {
+                ByteWriter writer(out);
+                writer.write<uint32_t>(tag);
+                writer.write<uint32_t>(0);
+                writer.write<uint64_t>(payloadSize);
+            }
+            
+            std::vector<uint8_t> buildHeader(uint64_t indexOffset, uint64_t indexSize) {
+                std::vector<uint8_t> header(FILE_MAGIC, FILE_MAGIC + sizeof(FILE_MAGIC));
+                ByteWriter writer(header);
+                writer.write<uint32_t>(FILE_VERSION);
+                writer.write<uint32_t>(0);
+                writer.write<uint64_t>(indexOffset);
+                writer.write<uint64_t>(indexSize);
+                return header;
+            }
+            
+            // Whether [offset, offset + size) lies within a file of `fileSize` bytes
+            bool withinFile(uint64_t offset, uint64_t size, uint64_t fileSize) {
+                return offset <= fileSize && size <= fileSize - offset;
+            }
+            
+            bool readChunk(std::ifstream& file, uint64_t fileSize, uint64_t payloadOffset, uint32_t expectedTag,
+                           std::vector<uint8_t>& payload) {
+                if (payloadOffset < HEADER_SIZE + CHUNK_HEADER_SIZE || payloadOffset > fileSize) {
+                    return false;
+                }
+                uint8_t header[CHUNK_HEADER_SIZE];
+                file.seekg(static_cast<std::streamoff>(payloadOffset - CHUNK_HEADER_SIZE));
+                if (!file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+                    return false;
+                }
+                ByteReader reader(header, sizeof(header));
+                uint32_t tag = reader.read<uint32_t>();
+                reader.read<uint32_t>();
+                uint64_t size = reader.read<uint64_t>();
+                // The size is checked before anything is allocated for it
+                if (tag != expectedTag || !withinFile(payloadOffset, size, fileSize)) {
+                    return false;
+                }
+                payload.resize(static_cast<size_t>(size));
+                return static_cast<bool>(file.read(reinterpret_cast<char*>(payload.data()), static_cast<std::streamsize>(size)));
+            }
+            
+            struct PendingTile {
+                const D2::Tile* tile;
+                std::vector<uint8_t> encoded;
+                D2::TileCompression compression = D2::TileCompression::Raw;
+            };
+            
+            /**
+             * Appends everything the project references but `previous` does not already hold
+             * on disk, followed by a fresh document index. `next` receives the resulting state.
+             */
+            bool appendSnapshot(std::ostream& file, uint64_t offset, const Project& project,
+                                const AstralSaveState* previous, AstralSaveState& next) {
+                next.tiles.clear();
+                next.layerIndices.clear();
+                next.liveBytes = HEADER_SIZE;
+                
+                // 1. Collect tiles whose revision is not on disk yet
+                std::vector<const D2::Tile*> dirtyTiles;
+                std::unordered_set<uint64_t> queued;
+                for (const auto& layer : project.layers) {
+                    if (!layer.pixels) {
+                        continue;
+                    }
+                    const D2::TiledImage& image = *layer.pixels;
+                    for (uint32_t ty = 0; ty < image.getTilesY(); ++ty) {
+                        for (uint32_t tx = 0; tx < image.getTilesX(); ++tx) {
+                            const D2::Tile* tile = image.getTile(tx, ty);
+                            if (!tile) {
+                                continue;
+                            }
+                            uint64_t revision = tile->getRevision();
+                            if (previous) {
+                                auto it = previous->tiles.find(revision);
+                                if (it != previous->tiles.end()) {
+                                    next.tiles.emplace(revision, it->second);
+                                    continue;
+                                }
+                            }
+                            if (queued.insert(revision).second) {
+                                dirtyTiles.push_back(tile);
+                            }
+                        }
+                    }
+                }
+                
+                // 2. Encode dirty tiles in parallel, write them sequentially
+                std::vector<PendingTile> batch;
+                std::vector<uint8_t> buffer;
+                for (size_t first = 0; first < dirtyTiles.size(); first += TILE_BATCH_SIZE) {
+                    size_t count = std::min(TILE_BATCH_SIZE, dirtyTiles.size() - first);
+                    batch.resize(count);
+                    Jobs::JobSystem::getInstance().parallelFor(count, [&](size_t i) {
+                        batch[i].tile = dirtyTiles[first + i];
+                        batch[i].compression = D2::TileCodec::encode(*batch[i].tile, batch[i].encoded);
+                    });
+                    
+                    buffer.clear();
+                    for (const auto& pending : batch) {
+                        appendChunkHeader(buffer, TAG_TILE, pending.encoded.size());
+                        AstralSaveState::TileLocation location;
+                        location.offset = offset + buffer.size();
+                        location.size = static_cast<uint32_t>(pending.encoded.size());
+                        location.compression = pending.compression;
+                        next.tiles.emplace(pending.tile->getRevision(), location);
+                        buffer.insert(buffer.end(), pending.encoded.begin(), pending.encoded.end());
+                    }
+                    if (!file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()))) {
+                        return false;
+                    }
+                    offset += buffer.size();
+                }
+                
+                for (const auto& [revision, location] : next.tiles) {
+                    next.liveBytes += CHUNK_HEADER_SIZE + location.size;
+                }
+                
+                // 3. Layer indices; unchanged layers keep pointing at their previous LIDX
+                std::vector<uint8_t> payload;
+                buffer.clear();
+                for (const auto& layer : project.layers) {
+                    if (!layer.pixels || next.layerIndices.count(layer.pixels.get())) {
+                        continue;
+                    }
+                    const D2::TiledImage& image = *layer.pixels;
+                    
+                    AstralSaveState::LayerIndexLocation location;
+                    location.revisions.resize(image.getTileCount(), 0);
+                    for (uint32_t ty = 0; ty < image.getTilesY(); ++ty) {
+                        for (uint32_t tx = 0; tx < image.getTilesX(); ++tx) {
+                            if (const D2::Tile* tile = image.getTile(tx, ty)) {
+                                location.revisions[ty * image.getTilesX() + tx] = tile->getRevision();
+                            }
+                        }
+                    }
+                    
+                    if (previous) {
+                        auto it = previous->layerIndices.find(&image);
+                        if (it != previous->layerIndices.end() && it->second.revisions == location.revisions) {
+                            next.liveBytes += CHUNK_HEADER_SIZE + it->second.size;
+                            next.layerIndices.emplace(&image, it->second);
+                            continue;
+                        }
+                    }
+                    
+                    payload.clear();
+                    ByteWriter writer(payload);
+                    uint32_t tileCount = 0;
+                    writer.write<uint32_t>(0); // Patched below
+                    for (uint32_t i = 0; i < location.revisions.size(); ++i) {
+                        if (location.revisions[i] == 0) {
+                            continue;
+                        }
+                        const auto& tileLocation = next.tiles.at(location.revisions[i]);
+                        writer.write<uint32_t>(i % image.getTilesX());
+                        writer.write<uint32_t>(i / image.getTilesX());
+                        writer.write<uint8_t>(static_cast<uint8_t>(tileLocation.compression));
+                        writer.write<uint8_t>(0);
+                        writer.write<uint16_t>(0);
+                        writer.write<uint32_t>(tileLocation.size);
+                        writer.write<uint64_t>(tileLocation.offset);
+                        ++tileCount;
+                    }
+                    std::memcpy(payload.data(), &tileCount, sizeof(tileCount));
+                    
+                    appendChunkHeader(buffer, TAG_LAYER_INDEX, payload.size());
+                    location.offset = offset + buffer.size();
+                    location.size = payload.size();
+                    buffer.insert(buffer.end(), payload.begin(), payload.end());
+                    next.liveBytes += CHUNK_HEADER_SIZE + location.size;
+                    next.layerIndices.emplace(&image, std::move(location));
+                }
+                
+                // 4. Document index
+                payload.clear();
+                ByteWriter writer(payload);
+                writer.writeString(project.name);
+                writer.write<uint32_t>(project.width);
+                writer.write<uint32_t>(project.height);
+                writer.write<uint8_t>(static_cast<uint8_t>(project.format));
+                writer.write<uint32_t>(static_cast<uint32_t>(project.layers.size()));
+                for (const auto& layer : project.layers) {
+                    writer.writeString(layer.name);
+                    writer.write<float>(layer.opacity);
+                    writer.write<uint8_t>(layer.visible ? 1 : 0);
+                    writer.write<uint8_t>(static_cast<uint8_t>(layer.blendMode));
+                    writer.write<float>(layer.position.x);
+                    writer.write<float>(layer.position.y);
+                    writer.write<float>(layer.scale.x);
+                    writer.write<float>(layer.scale.y);
+                    writer.write<float>(layer.rotation);
+                    if (layer.pixels) {
+                        const auto& location = next.layerIndices.at(layer.pixels.get());
+                        writer.write<uint32_t>(layer.pixels->getWidth());
+                        writer.write<uint32_t>(layer.pixels->getHeight());
+                        writer.write<uint64_t>(location.offset);
+                        writer.write<uint64_t>(location.size);
+                    } else {
+                        writer.write<uint32_t>(0);
+                        writer.write<uint32_t>(0);
+                        writer.write<uint64_t>(0);
+                        writer.write<uint64_t>(0);
+                    }
+                }
+                
+                appendChunkHeader(buffer, TAG_DOCUMENT_INDEX, payload.size());
+                uint64_t indexOffset = offset + buffer.size();
+                buffer.insert(buffer.end(), payload.begin(), payload.end());
+                if (!file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()))) {
+                    return false;
+                }
+                offset += buffer.size();
+                next.liveBytes += CHUNK_HEADER_SIZE + payload.size();
+                next.endOffset = offset;
+                
+                // 5. Flip the header to the new index only after everything else is on disk
+                file.flush();
+                std::vector<uint8_t> header = buildHeader(indexOffset, payload.size());
+                file.seekp(0);
+                file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+                file.flush();
+                return static_cast<bool>(file);
+            }
+        }
+        
+        std::shared_ptr<Project> AstralDocument::load(const std::string& filepath) {
+            std::ifstream file(filepath, std::ios::binary);
+            if (!file) {
+                AE_ERROR("Proje dosyası açılamadı: {}", filepath);
+                return nullptr;
+            }
+            
+            uint8_t headerData[HEADER_SIZE];
+            if (!file.read(reinterpret_cast<char*>(headerData), sizeof(headerData)) ||
+                std::memcmp(headerData, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+                AE_ERROR("Geçersiz Astral proje dosyası: {}", filepath);
+                return nullptr;
+            }
+            ByteReader header(headerData + sizeof(FILE_MAGIC), sizeof(headerData) - sizeof(FILE_MAGIC));
+            uint32_t version = header.read<uint32_t>();
+            header.read<uint32_t>();
+            uint64_t indexOffset = header.read<uint64_t>();
+            uint64_t indexSize = header.read<uint64_t>();
+            if (version > FILE_VERSION) {
+                AE_ERROR("Desteklenmeyen Astral proje sürümü {}: {}", version, filepath);
+                return nullptr;
+            }
+            
+            std::error_code error;
+            const uint64_t fileSize = std::filesystem::file_size(filepath, error);
+            if (error) {
+                AE_ERROR("Proje dosyası açılamadı: {} ({})", filepath, error.message());
+                return nullptr;
+            }
+            
+            std::vector<uint8_t> payload;
+            if (!readChunk(file, fileSize, indexOffset, TAG_DOCUMENT_INDEX, payload) || payload.size() != indexSize) {
+                AE_ERROR("Proje indeksi okunamadı: {}", filepath);
+                return nullptr;
+            }
+            
+            auto project = std::make_shared<Project>();
+            auto state = std::make_shared<AstralSaveState>();
+            project->filePath = filepath;
+            state->filePath = filepath;
+            state->endOffset = indexOffset + indexSize;
+            state->liveBytes = HEADER_SIZE + CHUNK_HEADER_SIZE + indexSize;
+            
+            ByteReader index(payload.data(), payload.size());
+            project->name = index.readString();
+            project->width = index.read<uint32_t>();
+            project->height = index.read<uint32_t>();
+            const uint8_t format = index.read<uint8_t>();
+            project->format = static_cast<D2::PixelFormat>(format);
+            uint32_t layerCount = index.read<uint32_t>();
+            if (!index.ok() || format > static_cast<uint8_t>(D2::PixelFormat::RGBA32F) ||
+                project->width == 0 || project->height == 0 ||
+                project->width > MAX_DIMENSION || project->height > MAX_DIMENSION ||
+                layerCount > payload.size() / MIN_LAYER_ENTRY_SIZE) {
+                AE_ERROR("Bozuk proje indeksi: {}", filepath);
+                return nullptr;
+            }
+            
+            struct TileEntry {
+                D2::TiledImage* image;
+                uint32_t tx, ty;
+                AstralSaveState::TileLocation location;
+                std::shared_ptr<D2::Tile> tile;
+            };
+            std::vector<TileEntry> entries;
+            std::vector<uint8_t> layerPayload;
+            
+            project->layers.reserve(layerCount);
+            for (uint32_t i = 0; i < layerCount && index.ok(); ++i) {
+                D2::Layer layer(index.readString());
+                layer.opacity = index.read<float>();
+                layer.visible = index.read<uint8_t>() != 0;
+                const uint8_t blendMode = index.read<uint8_t>();
+                layer.blendMode = static_cast<D2::BlendMode>(blendMode);
+                layer.position.x = index.read<float>();
+                layer.position.y = index.read<float>();
+                layer.scale.x = index.read<float>();
+                layer.scale.y = index.read<float>();
+                layer.rotation = index.read<float>();
+                uint32_t width = index.read<uint32_t>();
+                uint32_t height = index.read<uint32_t>();
+                uint64_t layerIndexOffset = index.read<uint64_t>();
+                uint64_t layerIndexSize = index.read<uint64_t>();
+                // Layers are either empty or cover the document
+                const bool empty = width == 0 && height == 0;
+                if (!index.ok() || blendMode > static_cast<uint8_t>(D2::BlendMode::Luminosity) ||
+                    (!empty && (width != project->width || height != project->height))) {
+                    AE_ERROR("Bozuk proje indeksi: {}", filepath);
+                    return nullptr;
+                }
+                
+                if (!empty) {
+                    layer.pixels = std::make_shared<D2::TiledImage>(width, height, project->format);
+                    if (!readChunk(file, fileSize, layerIndexOffset, TAG_LAYER_INDEX, layerPayload) || layerPayload.size() != layerIndexSize) {
+                        AE_ERROR("Layer indeksi okunamadı: {} ({})", layer.name, filepath);
+                        return nullptr;
+                    }
+                    
+                    ByteReader layerIndex(layerPayload.data(), layerPayload.size());
+                    uint32_t tileCount = layerIndex.read<uint32_t>();
+                    AstralSaveState::LayerIndexLocation& location = state->layerIndices[layer.pixels.get()];
+                    location.offset = layerIndexOffset;
+                    location.size = layerIndexSize;
+                    location.revisions.assign(layer.pixels->getTileCount(), 0);
+                    state->liveBytes += CHUNK_HEADER_SIZE + layerIndexSize;
+                    
+                    for (uint32_t t = 0; t < tileCount; ++t) {
+                        TileEntry entry;
+                        entry.image = layer.pixels.get();
+                        entry.tx = layerIndex.read<uint32_t>();
+                        entry.ty = layerIndex.read<uint32_t>();
+                        const uint8_t compression = layerIndex.read<uint8_t>();
+                        entry.location.compression = static_cast<D2::TileCompression>(compression);
+                        layerIndex.read<uint8_t>();
+                        layerIndex.read<uint16_t>();
+                        entry.location.size = layerIndex.read<uint32_t>();
+                        entry.location.offset = layerIndex.read<uint64_t>();
+                        if (!layerIndex.ok() || entry.tx >= entry.image->getTilesX() || entry.ty >= entry.image->getTilesY() ||
+                            compression > static_cast<uint8_t>(D2::TileCompression::PlanarRLE) ||
+                            entry.location.offset < HEADER_SIZE + CHUNK_HEADER_SIZE ||
+                            !withinFile(entry.location.offset, entry.location.size, fileSize)) {
+                            AE_ERROR("Bozuk layer indeksi: {} ({})", layer.name, filepath);
+                            return nullptr;
+                        }
+                        entries.push_back(std::move(entry));
+                    }
+                }
+                
+                project->layers.push_back(std::move(layer));
+            }
+            if (!index.ok()) {
+                AE_ERROR("Bozuk proje indeksi: {}", filepath);
+                return nullptr;
+            }
+            
+            // Read tiles in file order, decode each batch in parallel
+            std::sort(entries.begin(), entries.end(), [](const TileEntry& a, const TileEntry& b) {
+                return a.location.offset < b.location.offset;
+            });
+            
+            std::vector<std::vector<uint8_t>> blobs;
+            std::shared_ptr<D2::Tile> sharedTile;
+            uint64_t sharedOffset = 0;
+            for (size_t first = 0; first < entries.size(); first += TILE_BATCH_SIZE) {
+                size_t count = std::min(TILE_BATCH_SIZE, entries.size() - first);
+                blobs.resize(count);
+                for (size_t i = 0; i < count; ++i) {
+                    const auto& location = entries[first + i].location;
+                    blobs[i].resize(location.size);
+                    file.seekg(static_cast<std::streamoff>(location.offset));
+                    if (!file.read(reinterpret_cast<char*>(blobs[i].data()), location.size)) {
+                        AE_ERROR("Tile verisi okunamadı: {}", filepath);
+                        return nullptr;
+                    }
+                }
+                
+                std::atomic<bool> failed{false};
+                Jobs::JobSystem::getInstance().parallelFor(count, [&](size_t i) {
+                    TileEntry& entry = entries[first + i];
+                    entry.tile = std::make_shared<D2::Tile>(project->format);
+                    if (!D2::TileCodec::decode(entry.location.compression, blobs[i].data(), blobs[i].size(), *entry.tile)) {
+                        failed = true;
+                    } else if (entry.tile->detectUniform()) {
+                        entry.tile = D2::Tile::makeUniform(project->format, entry.tile->getUniformPixel());
+                    }
+                });
+                if (failed) {
+                    AE_ERROR("Tile verisi çözülemedi: {}", filepath);
+                    return nullptr;
+                }
+                
+                for (size_t i = 0; i < count; ++i) {
+                    TileEntry& entry = entries[first + i];
+                    // Tiles that were shared when saved are stored once; share them again
+                    if (sharedTile && entry.location.offset == sharedOffset) {
+                        entry.tile = sharedTile;
+                    } else {
+                        state->liveBytes += CHUNK_HEADER_SIZE + entry.location.size;
+                    }
+                    sharedTile = entry.tile;
+                    sharedOffset = entry.location.offset;
+                    
+                    uint64_t revision = entry.tile->getRevision();
+                    state->tiles.emplace(revision, entry.location);
+                    state->layerIndices[entry.image].revisions[entry.ty * entry.image->getTilesX() + entry.tx] = revision;
+                    entry.image->setTile(entry.tx, entry.ty, std::move(entry.tile));
+                }
+            }
+            
+            project->saveState = std::move(state);
+            AE_INFO("Astral projesi yüklendi: {} ({}x{}, {} layer, {} tile)",
+                    filepath, project->width, project->height, project->layers.size(), entries.size());
+            return project;
+        }
+        
+        bool AstralDocument::save(const std::string& filepath, const Project& project) {
+            const AstralSaveState* state = project.saveState.get();
+            bool canAppend = state && state->filePath == filepath && std::filesystem::exists(filepath);
+            
+            if (canAppend) {
+                uint64_t garbage = state->endOffset - std::min(state->endOffset, state->liveBytes);
+                if (garbage <= COMPACTION_THRESHOLD || garbage <= state->liveBytes) {
+                    return writeIncremental(project);
+                }
+                AE_DEBUG("Proje dosyası sıkıştırılıyor: {} ({} bayt kullanılmıyor)", filepath, garbage);
+            }
+            
+            return writeFull(filepath, project);
+        }
+        
+        bool AstralDocument::writeFull(const std::string& filepath, const Project& project) {
+            // Write next to the target and swap it in, so a failed save never truncates the old file
+            std::string tempPath = filepath + ".tmp";
+            auto next = std::make_shared<AstralSaveState>();
+            {
+                std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+                if (!file) {
+                    AE_ERROR("Proje dosyası yazılamadı: {}", tempPath);
+                    return false;
+                }
+                std::vector<uint8_t> header = buildHeader(0, 0);
+                file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+                if (!appendSnapshot(file, HEADER_SIZE, project, nullptr, *next)) {
+                    AE_ERROR("Proje dosyası yazılamadı: {}", tempPath);
+                    return false;
+                }
+            }
+            
+            std::error_code error;
+            std::filesystem::rename(tempPath, filepath, error);
+            if (error) {
+                AE_ERROR("Proje dosyası taşınamadı: {} ({})", filepath, error.message());
+                return false;
+            }
+            
+            next->filePath = filepath;
+            project.saveState = std::move(next);
+            AE_DEBUG("Astral projesi kaydedildi (tam): {} ({} bayt)", filepath, project.saveState->endOffset);
+            return true;
+        }
+        
+        bool AstralDocument::writeIncremental(const Project& project) {
+            const AstralSaveState& previous = *project.saveState;
+            std::fstream file(previous.filePath, std::ios::binary | std::ios::in | std::ios::out);
+            if (!file) {
+                AE_ERROR("Proje dosyası açılamadı: {}", previous.filePath);
+                return false;
+            }
+            
+            auto next = std::make_shared<AstralSaveState>();
+            next->filePath = previous.filePath;
+            file.seekp(static_cast<std::streamoff>(previous.endOffset));
+            if (!appendSnapshot(file, previous.endOffset, project, &previous, *next)) {
+                AE_ERROR("Proje dosyası güncellenemedi: {}", previous.filePath);
+                return false;
+            }
+            
+            AE_DEBUG("Astral projesi kaydedildi (artımlı): {} ({} -> {} bayt)",
+                     previous.filePath, previous.endOffset, next->endOffset);
+            project.saveState = std::move(next);
+            return true;
+        }
+    }
+}
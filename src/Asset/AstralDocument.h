@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Asset/ImageAssetManager.h"
+#include "2D/Image/TileCodec.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace AstralEngine {
+    namespace Asset {
+        /**
+         * @brief What the last save or load left on disk
+         *
+         * Kept on the Project so the next save can append only tiles whose revision was
+         * not written before and reuse every unchanged tile and layer index in place.
+         */
+        struct AstralSaveState {
+            struct TileLocation {
+                uint64_t offset = 0;
+                uint32_t size = 0;
+                D2::TileCompression compression = D2::TileCompression::Raw;
+            };
+            
+            struct LayerIndexLocation {
+                uint64_t offset = 0;
+                uint64_t size = 0;
+                std::vector<uint64_t> revisions; // Tile revisions the index was written for, 0 = empty
+            };
+            
+            std::string filePath;
+            uint64_t endOffset = 0;  // Where the next save appends
+            uint64_t liveBytes = 0;  // Bytes still referenced by the newest index
+            std::unordered_map<uint64_t, TileLocation> tiles;                          // By tile revision
+            std::unordered_map<const D2::TiledImage*, LayerIndexLocation> layerIndices; // By layer image
+        };
+        
+        /**
+         * @brief Native layered document format (.astral)
+         *
+         * The file is a header followed by an append-only sequence of chunks:
+         *  - TILE: one independently compressed tile
+         *  - LIDX: tile table of one layer (tile coordinates -> TILE chunk)
+         *  - DIDX: document index; document and layer metadata plus LIDX locations
+         *
+         * The header points at the newest DIDX, which always sits at the end of the file.
+         * Saving appends changed tiles, the indices of layers that changed and a new DIDX,
+         * then flips the header pointer, so an interrupted save leaves the previous state
+         * readable. Once dead chunks outweigh live data the file is rewritten compacted.
+         */
+        class AstralDocument {
+        public:
+            static std::shared_ptr<Project> load(const std::string& filepath);
+            static bool save(const std::string& filepath, const Project& project);
+            
+        private:
+            static bool writeFull(const std::string& filepath, const Project& project);
+            static bool writeIncremental(const Project& project);
+        };
+    }
+}
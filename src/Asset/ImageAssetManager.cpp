@@ -1,4 +1,6 @@
 #include "Asset/ImageAssetManager.h"
+#include "Asset/AstralDocument.h"
+#include "Asset/PsdDocument.h"
 #include "Core/Logger.h"
 #include "Renderer/Texture.h"
 #include "Renderer/RRenderer.h"
@@ -6,13 +8,12 @@
 #include <cctype>
 #include <filesystem>
 
-// Include STB image for image loading
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb/stb_image.h"
+// Include STB image for image loading (implementation lives in Renderer/Texture.cpp)
+#include <stb_image.h>
 
 // Include STB image write for image saving
 #define STB_IMAGE_WRITE_IMPLEMENTATION
-#include "stb/stb_image_write.h"
+#include <stb_image_write.h>
 
 namespace AstralEngine {
     namespace Asset {
@@ -59,7 +60,9 @@ namespace AstralEngine {
             ImageFormat format = detectFormat(filepath);
             
             // Load project based on format
-            if (format == ImageFormat::PSD) {
+            if (format == ImageFormat::Astral) {
+                return AstralDocument::load(filepath);
+            } else if (format == ImageFormat::PSD) {
                 return loadPSD(filepath);
             } else {
                 AE_WARN("Desteklenmeyen proje formatı: {}", filepath);
@@ -72,7 +75,9 @@ namespace AstralEngine {
             ImageFormat format = detectFormat(filepath);
             
             // Save project based on format
-            if (format == ImageFormat::PSD) {
+            if (format == ImageFormat::Astral) {
+                AstralDocument::save(filepath, project);
+            } else if (format == ImageFormat::PSD) {
                 savePSD(filepath, project);
             } else {
                 AE_WARN("Desteklenmeyen proje formatı: {}", filepath);
@@ -108,6 +113,8 @@ namespace AstralEngine {
                 return ImageFormat::TIFF;
             } else if (ext == "psd") {
                 return ImageFormat::PSD;
+            } else if (ext == "astral") {
+                return ImageFormat::Astral;
             } else {
                 return ImageFormat::Custom;
             }
@@ -208,21 +215,13 @@ namespace AstralEngine {
         }
         
         std::shared_ptr<Project> ImageAssetManager::loadPSD(const std::string& filepath) {
-            // For now, we'll just log the operation and return nullptr
-            // In a full implementation, we would parse the PSD file format
             AE_DEBUG("PSD dosyası yükleniyor: {}", filepath);
-            
-            // TODO: Implement actual PSD loading
-            
-            return nullptr;
+            return PsdDocument::load(filepath);
         }
         
         void ImageAssetManager::savePSD(const std::string& filepath, const Project& project) {
-            // For now, we'll just log the operation
-            // In a full implementation, we would serialize the project to PSD format
             AE_DEBUG("PSD dosyası kaydediliyor: {}", filepath);
-            
-            // TODO: Implement actual PSD saving
+            PsdDocument::save(filepath, project);
         }
         
         std::string ImageAssetManager::getExtension(const std::string& filepath) {
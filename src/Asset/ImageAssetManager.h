@@ -4,6 +4,7 @@
 #include "2D/Layers/Layer.h"
 #include <string>
 #include <vector>
+#include <memory>
 
 namespace AstralEngine {
     namespace Asset {
@@ -14,16 +15,23 @@ namespace AstralEngine {
             BMP,
             TIFF,
             PSD,
+            Astral,
             Custom
         };
         
+        struct AstralSaveState;
+        
         // Project structure
         struct Project {
             std::string name;
             std::string filePath;
-            uint32_t width;
-            uint32_t height;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            D2::PixelFormat format = D2::PixelFormat::RGBA8;
             std::vector<D2::Layer> layers;
+            
+            // On-disk state of the last .astral save/load, enables incremental saving
+            mutable std::shared_ptr<AstralSaveState> saveState;
             // Add more project properties as needed
         };
         
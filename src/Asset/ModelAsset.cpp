@@ -1,6 +1,8 @@
 #include "Asset/ModelAsset.h"
 #include "Asset/ModelLoader.h"
 #include "Core/Logger.h"
+#include "Core/AssetManager.h"
+#include "Renderer/UnifiedMaterial.h"
 #include "Renderer/VulkanR/VulkanDevice.h" // Required for device reference
 
 namespace AstralEngine {
@@ -28,12 +30,20 @@ namespace AstralEngine {
             return;
         }
 
-        // Step 2: Create the GPU-side Model resource
+        // Step 2: Bind material textures. Textures go through the asset cache so maps
+        // shared between materials (or models) are uploaded once.
+        for (auto& material : modelData->materials) {
+            for (const auto& [slot, texturePath] : material.texturePaths) {
+                if (auto texture = AssetManager::loadTexture(m_device, texturePath, slot)) {
+                    material.instance->setTexture(slot, texture);
+                }
+            }
+        }
+
+        // Step 3: Create the GPU-side Model resource
         // Use the injected device reference instead of global hack
         m_model = std::make_shared<Model>(m_device, std::move(modelData));
 
-        // TODO: Handle material loading asynchronously
-
         m_isLoaded = true;
         AE_INFO("Successfully loaded ModelAsset: {}", m_path);
     }
@@ -1,15 +1,110 @@
 #include "Asset/ModelLoader.h"
 #include "Core/Logger.h"
 #include "Core/AssetLocator.h"
+#include "Renderer/UnifiedMaterial.h"
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tiny_obj_loader.h>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <unordered_map>
 #include <filesystem>
 
 namespace AstralEngine {
 
+    namespace {
+        // Parameters that fully describe a converted MTL material. Two MTL entries that
+        // convert to the same key render identically and share one UnifiedMaterialInstance.
+        struct MaterialKey {
+            std::array<float, 10> params{}; // baseColor(4), emissive(3), metallic, roughness, ior
+            AlphaMode alphaMode = AlphaMode::Opaque;
+            std::vector<std::pair<TextureSlot, std::string>> textures;
+
+            bool operator==(const MaterialKey& other) const {
+                return params == other.params && alphaMode == other.alphaMode && textures == other.textures;
+            }
+        };
+
+        struct MaterialKeyHash {
+            size_t operator()(const MaterialKey& key) const {
+                size_t seed = std::hash<uint32_t>()(static_cast<uint32_t>(key.alphaMode));
+                auto combine = [&seed](size_t value) {
+                    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                };
+                for (float value : key.params) {
+                    combine(std::hash<float>()(value));
+                }
+                for (const auto& [slot, path] : key.textures) {
+                    combine(static_cast<size_t>(slot));
+                    combine(std::hash<std::string>()(path));
+                }
+                return seed;
+            }
+        };
+
+        std::string resolveTexturePath(const std::string& baseDirectory, const std::string& texname) {
+            if (texname.empty()) {
+                return {};
+            }
+            std::filesystem::path path(texname);
+            if (path.is_relative()) {
+                path = std::filesystem::path(baseDirectory) / path;
+            }
+            return path.lexically_normal().generic_string();
+        }
+
+        MaterialKey buildMaterialKey(const tinyobj::material_t& mtl, const std::string& baseDirectory) {
+            MaterialKey key;
+
+            // Prefer the PBR extension (Pr/Pm) when the file provides it, otherwise derive
+            // roughness from the Blinn-Phong exponent.
+            bool hasPbr = mtl.roughness > 0.0f || mtl.metallic > 0.0f ||
+                          !mtl.roughness_texname.empty() || !mtl.metallic_texname.empty();
+            float roughness = hasPbr ? mtl.roughness
+                                     : std::sqrt(2.0f / (std::max(mtl.shininess, 0.0f) + 2.0f));
+            float metallic = hasPbr ? mtl.metallic : 0.0f;
+
+            key.params = {
+                mtl.diffuse[0], mtl.diffuse[1], mtl.diffuse[2], mtl.dissolve,
+                mtl.emission[0], mtl.emission[1], mtl.emission[2],
+                metallic, glm::clamp(roughness, 0.0f, 1.0f), mtl.ior
+            };
+
+            if (mtl.dissolve < 1.0f) {
+                key.alphaMode = AlphaMode::Blend;
+            } else if (!mtl.alpha_texname.empty()) {
+                key.alphaMode = AlphaMode::Mask;
+            }
+
+            auto addTexture = [&](TextureSlot slot, const std::string& texname) {
+                std::string resolved = resolveTexturePath(baseDirectory, texname);
+                if (!resolved.empty()) {
+                    key.textures.emplace_back(slot, std::move(resolved));
+                }
+            };
+            addTexture(TextureSlot::BaseColor, mtl.diffuse_texname);
+            addTexture(TextureSlot::Normal, !mtl.normal_texname.empty() ? mtl.normal_texname : mtl.bump_texname);
+            addTexture(TextureSlot::MetallicRoughness, !mtl.roughness_texname.empty() ? mtl.roughness_texname : mtl.metallic_texname);
+            addTexture(TextureSlot::Occlusion, mtl.ambient_texname);
+            addTexture(TextureSlot::Emissive, mtl.emissive_texname);
+
+            return key;
+        }
+
+        std::shared_ptr<UnifiedMaterialInstance> createMaterialInstance(const MaterialKey& key) {
+            auto material = std::make_shared<UnifiedMaterialInstance>(UnifiedMaterialInstance::createDefault());
+            material->setBaseColor(glm::vec4(key.params[0], key.params[1], key.params[2], key.params[3]));
+            material->setEmissive(glm::vec3(key.params[4], key.params[5], key.params[6]));
+            material->setMetallic(key.params[7]);
+            material->setRoughness(key.params[8]);
+            material->setTransmission(0.0f, key.params[9] > 0.0f ? key.params[9] : 1.5f);
+            material->setAlphaMode(key.alphaMode);
+            return material;
+        }
+    }
+
     std::unique_ptr<ModelData> ModelLoader::loadModel(const std::string& filepath) {
         auto resolvedPath = AssetLocator::getInstance().resolveAssetPath(filepath);
         if (resolvedPath.empty()) {
@@ -37,10 +132,43 @@ namespace AstralEngine {
         auto modelData = std::make_unique<ModelData>();
         std::unordered_map<Vertex, uint32_t> uniqueVertices{};
 
+        // Map every MTL entry onto a deduplicated material slot. Slot 0 is reserved for
+        // faces without a material so they still get a valid instance.
+        std::unordered_map<MaterialKey, uint32_t, MaterialKeyHash> materialSlots;
+        std::vector<uint32_t> mtlToSlot(materials.size());
+
+        auto addMaterial = [&](const std::string& name, MaterialKey key) {
+            auto it = materialSlots.find(key);
+            if (it != materialSlots.end()) {
+                return it->second;
+            }
+            uint32_t slot = static_cast<uint32_t>(modelData->materials.size());
+            MaterialData material;
+            material.name = name;
+            material.instance = createMaterialInstance(key);
+            material.texturePaths = key.textures;
+            modelData->materials.push_back(std::move(material));
+            materialSlots.emplace(std::move(key), slot);
+            return slot;
+        };
+
+        tinyobj::material_t defaultMtl;
+        defaultMtl.diffuse[0] = defaultMtl.diffuse[1] = defaultMtl.diffuse[2] = 0.8f;
+        defaultMtl.roughness = 0.5f;
+        uint32_t defaultSlot = addMaterial("default", buildMaterialKey(defaultMtl, baseDirectory));
+        for (size_t i = 0; i < materials.size(); ++i) {
+            mtlToSlot[i] = addMaterial(materials[i].name, buildMaterialKey(materials[i], baseDirectory));
+        }
+
+        // Bucket triangle indices per material across all shapes so each material ends up
+        // as a single contiguous range, i.e. one draw and one descriptor set bind.
+        std::vector<std::vector<uint32_t>> buckets(modelData->materials.size());
+        std::vector<std::string> bucketNames(modelData->materials.size());
+
         for (const auto& shape : shapes) {
-            uint32_t indexOffset = static_cast<uint32_t>(modelData->indices.size());
-            
-            for (const auto& index : shape.mesh.indices) {
+            const auto& mesh = shape.mesh;
+            for (size_t i = 0; i < mesh.indices.size(); ++i) {
+                const auto& index = mesh.indices[i];
                 Vertex vertex{};
 
                 vertex.position = {
@@ -66,26 +194,45 @@ namespace AstralEngine {
 
                 vertex.color = {1.0f, 1.0f, 1.0f};
 
-                if (uniqueVertices.count(vertex) == 0) {
-                    uniqueVertices[vertex] = static_cast<uint32_t>(modelData->vertices.size());
+                auto [it, inserted] = uniqueVertices.try_emplace(vertex, static_cast<uint32_t>(modelData->vertices.size()));
+                if (inserted) {
                     modelData->vertices.push_back(vertex);
                 }
-                modelData->indices.push_back(uniqueVertices[vertex]);
-            }
 
-            uint32_t indexCount = static_cast<uint32_t>(modelData->indices.size()) - indexOffset;
-            if (indexCount > 0) {
-                std::string materialName = "default";
-                if (!shape.mesh.material_ids.empty() && shape.mesh.material_ids[0] >= 0) {
-                    materialName = materials[shape.mesh.material_ids[0]].name;
+                // Meshes are triangulated on load, so face i / 3 owns this index.
+                size_t face = i / 3;
+                int materialId = face < mesh.material_ids.size() ? mesh.material_ids[face] : -1;
+                uint32_t slot = (materialId >= 0 && static_cast<size_t>(materialId) < materials.size())
+                                    ? mtlToSlot[materialId] : defaultSlot;
+                if (bucketNames[slot].empty()) {
+                    bucketNames[slot] = shape.name;
                 }
-                modelData->subMeshes.emplace_back(shape.name, materialName, indexOffset, indexCount);
+                buckets[slot].push_back(it->second);
+            }
+        }
+
+        size_t totalIndices = 0;
+        for (const auto& bucket : buckets) {
+            totalIndices += bucket.size();
+        }
+        modelData->indices.reserve(totalIndices);
+
+        for (size_t slot = 0; slot < buckets.size(); ++slot) {
+            if (buckets[slot].empty()) {
+                continue;
             }
+            uint32_t indexOffset = static_cast<uint32_t>(modelData->indices.size());
+            uint32_t indexCount = static_cast<uint32_t>(buckets[slot].size());
+            modelData->indices.insert(modelData->indices.end(), buckets[slot].begin(), buckets[slot].end());
+
+            const auto& material = modelData->materials[slot];
+            SubMesh& subMesh = modelData->subMeshes.emplace_back(bucketNames[slot], material.name, indexOffset, indexCount);
+            subMesh.material = material.instance;
         }
-        
-        // TODO: Process materials and add them to ModelData
 
-        AE_INFO("Successfully loaded model data for '{}'. Vertices: {}, Indices: {}", filepath, modelData->vertices.size(), modelData->indices.size());
+        AE_INFO("Successfully loaded model data for '{}'. Vertices: {}, Indices: {}, Materials: {} ({} in MTL), SubMeshes: {}",
+                filepath, modelData->vertices.size(), modelData->indices.size(),
+                modelData->materials.size(), materials.size(), modelData->subMeshes.size());
         return modelData;
     }
-}
\ No newline at end of file
+}
@@ -1,18 +1,31 @@
 #pragma once
 
 #include "Renderer/Model.h" // For Vertex struct
+#include "Renderer/UnifiedMaterialConstants.h" // For TextureSlot
 #include <string>
 #include <vector>
 #include <memory>
+#include <utility>
 
 namespace AstralEngine {
 
+    // A material parsed from the model's MTL file.
+    // Texture paths are resolved against the model directory but not loaded yet,
+    // since the loader has no device; ModelAsset binds them through the asset cache.
+    struct MaterialData {
+        std::string name;
+        std::shared_ptr<UnifiedMaterialInstance> instance;
+        std::vector<std::pair<TextureSlot, std::string>> texturePaths;
+    };
+
     // A struct to hold the raw data loaded from a model file.
     struct ModelData {
         std::vector<Vertex> vertices;
         std::vector<uint32_t> indices;
+        // One submesh per unique material; indices are grouped so each range is contiguous.
         std::vector<SubMesh> subMeshes;
-        // We'll expand this with material information later.
+        // Deduplicated materials, referenced by SubMesh::material.
+        std::vector<MaterialData> materials;
     };
 
     class ModelLoader {
@@ -0,0 +1,958 @@
+#include "Asset/PsdDocument.h"
+#include "2D/Image/PackBits.h"
+#include "Core/JobSystem.h"
+#include "Core/Logger.h"
+#include "Core/MappedFile.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+
+namespace AstralEngine {
+    namespace Asset {
+        namespace {
+            constexpr uint32_t PSD_MAX_DIMENSION = 30000;
+            constexpr uint32_t PSB_MAX_DIMENSION = 300000;
+
+            constexpr uint32_t makeKey(char a, char b, char c, char d) {
+                return (static_cast<uint32_t>(static_cast<uint8_t>(a)) << 24) |
+                       (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 16) |
+                       (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 8) |
+                       static_cast<uint32_t>(static_cast<uint8_t>(d));
+            }
+
+            constexpr uint32_t KEY_SIGNATURE = makeKey('8', 'B', 'P', 'S');
+            constexpr uint32_t KEY_8BIM = makeKey('8', 'B', 'I', 'M');
+            constexpr uint32_t KEY_8B64 = makeKey('8', 'B', '6', '4');
+            constexpr uint32_t KEY_UNICODE_NAME = makeKey('l', 'u', 'n', 'i');
+            constexpr uint32_t KEY_SECTION_DIVIDER = makeKey('l', 's', 'c', 't');
+
+            // Additional layer information keys whose length field is 8 bytes in PSB files
+            constexpr std::array<uint32_t, 13> PSB_LONG_KEYS = {
+                makeKey('L', 'M', 's', 'k'), makeKey('L', 'r', '1', '6'), makeKey('L', 'r', '3', '2'),
+                makeKey('L', 'a', 'y', 'r'), makeKey('M', 't', '1', '6'), makeKey('M', 't', '3', '2'),
+                makeKey('M', 't', 'r', 'n'), makeKey('A', 'l', 'p', 'h'), makeKey('F', 'M', 's', 'k'),
+                makeKey('l', 'n', 'k', '2'), makeKey('F', 'E', 'i', 'd'), makeKey('F', 'X', 'i', 'd'),
+                makeKey('P', 'x', 'S', 'D')
+            };
+
+            struct BlendModeKey {
+                D2::BlendMode mode;
+                uint32_t key;
+            };
+
+            constexpr std::array<BlendModeKey, 16> BLEND_MODE_KEYS = {{
+                {D2::BlendMode::Normal,     makeKey('n', 'o', 'r', 'm')},
+                {D2::BlendMode::Multiply,   makeKey('m', 'u', 'l', ' ')},
+                {D2::BlendMode::Screen,     makeKey('s', 'c', 'r', 'n')},
+                {D2::BlendMode::Overlay,    makeKey('o', 'v', 'e', 'r')},
+                {D2::BlendMode::Darken,     makeKey('d', 'a', 'r', 'k')},
+                {D2::BlendMode::Lighten,    makeKey('l', 'i', 't', 'e')},
+                {D2::BlendMode::ColorDodge, makeKey('d', 'i', 'v', ' ')},
+                {D2::BlendMode::ColorBurn,  makeKey('i', 'd', 'i', 'v')},
+                {D2::BlendMode::HardLight,  makeKey('h', 'L', 'i', 't')},
+                {D2::BlendMode::SoftLight,  makeKey('s', 'L', 'i', 't')},
+                {D2::BlendMode::Difference, makeKey('d', 'i', 'f', 'f')},
+                {D2::BlendMode::Exclusion,  makeKey('s', 'm', 'u', 'd')},
+                {D2::BlendMode::Hue,        makeKey('h', 'u', 'e', ' ')},
+                {D2::BlendMode::Saturation, makeKey('s', 'a', 't', ' ')},
+                {D2::BlendMode::Color,      makeKey('c', 'o', 'l', 'r')},
+                {D2::BlendMode::Luminosity, makeKey('l', 'u', 'm', ' ')}
+            }};
+
+            D2::BlendMode blendModeFromKey(uint32_t key) {
+                for (const auto& entry : BLEND_MODE_KEYS) {
+                    if (entry.key == key) {
+                        return entry.mode;
+                    }
+                }
+                return D2::BlendMode::Normal; // Pass-through and modes we lack
+            }
+
+            uint32_t keyFromBlendMode(D2::BlendMode mode) {
+                for (const auto& entry : BLEND_MODE_KEYS) {
+                    if (entry.mode == mode) {
+                        return entry.key;
+                    }
+                }
+                return BLEND_MODE_KEYS[0].key;
+            }
+
+            // (x + 127) / 255 without a division, exact for x in [0, 255 * 255]
+            inline uint32_t div255(uint32_t x) {
+                x += 128;
+                return (x + (x >> 8)) >> 8;
+            }
+
+            // Big-endian cursor over a memory-mapped file; every read is bounds checked
+            class BigEndianReader {
+            public:
+                BigEndianReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+                uint64_t readUnsigned(size_t bytes) {
+                    if (!require(bytes)) {
+                        return 0;
+                    }
+                    uint64_t value = 0;
+                    for (size_t i = 0; i < bytes; ++i) {
+                        value = (value << 8) | m_data[m_pos + i];
+                    }
+                    m_pos += bytes;
+                    return value;
+                }
+
+                uint8_t readU8() { return static_cast<uint8_t>(readUnsigned(1)); }
+                uint16_t readU16() { return static_cast<uint16_t>(readUnsigned(2)); }
+                uint32_t readU32() { return static_cast<uint32_t>(readUnsigned(4)); }
+                int16_t readI16() { return static_cast<int16_t>(readU16()); }
+                int32_t readI32() { return static_cast<int32_t>(readU32()); }
+
+                const uint8_t* readBytes(size_t bytes) {
+                    if (!require(bytes)) {
+                        return nullptr;
+                    }
+                    const uint8_t* ptr = m_data + m_pos;
+                    m_pos += bytes;
+                    return ptr;
+                }
+
+                void skip(uint64_t bytes) { readBytes(static_cast<size_t>(bytes)); }
+                void seek(size_t pos) {
+                    if (pos > m_size) {
+                        m_ok = false;
+                        return;
+                    }
+                    m_pos = pos;
+                }
+
+                size_t position() const { return m_pos; }
+                bool ok() const { return m_ok; }
+
+            private:
+                bool require(size_t bytes) {
+                    if (!m_ok || bytes > m_size - m_pos) {
+                        m_ok = false;
+                        return false;
+                    }
+                    return true;
+                }
+
+                const uint8_t* m_data;
+                size_t m_size;
+                size_t m_pos = 0;
+                bool m_ok = true;
+            };
+
+            class BigEndianWriter {
+            public:
+                explicit BigEndianWriter(std::vector<uint8_t>& out) : m_out(out) {}
+
+                void writeUnsigned(uint64_t value, size_t bytes) {
+                    for (size_t i = bytes; i-- > 0;) {
+                        m_out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+                    }
+                }
+
+                void writeU8(uint8_t value) { m_out.push_back(value); }
+                void writeU16(uint16_t value) { writeUnsigned(value, 2); }
+                void writeU32(uint32_t value) { writeUnsigned(value, 4); }
+                void writeI16(int16_t value) { writeU16(static_cast<uint16_t>(value)); }
+                void writeI32(int32_t value) { writeU32(static_cast<uint32_t>(value)); }
+                void writeBytes(const void* data, size_t size) {
+                    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+                    m_out.insert(m_out.end(), bytes, bytes + size);
+                }
+                void pad(size_t alignment, size_t from) {
+                    while ((m_out.size() - from) % alignment != 0) {
+                        m_out.push_back(0);
+                    }
+                }
+
+            private:
+                std::vector<uint8_t>& m_out;
+            };
+
+            // One channel plane of a layer or of the merged image
+            struct ChannelPlane {
+                const uint8_t* data = nullptr;  // First byte of pixel data (after the row table)
+                std::vector<uint64_t> rowOffsets; // RLE only: row y spans [rowOffsets[y], rowOffsets[y + 1])
+                bool rle = false;
+                bool present = false;
+            };
+
+            // Pixel source in PSD coordinates; planes are ordered R, G, B, A
+            struct PlaneSet {
+                int32_t top = 0, left = 0, bottom = 0, right = 0;
+                std::array<ChannelPlane, 4> planes;
+
+                uint32_t width() const { return static_cast<uint32_t>(std::max(0, right - left)); }
+                uint32_t height() const { return static_cast<uint32_t>(std::max(0, bottom - top)); }
+            };
+
+            bool isValidLayerRect(const PlaneSet& rect, uint32_t canvasWidth, uint32_t canvasHeight, uint32_t maxDimension) {
+                const int64_t width = static_cast<int64_t>(rect.right) - rect.left;
+                const int64_t height = static_cast<int64_t>(rect.bottom) - rect.top;
+                if (width < 0 || height < 0 || width > maxDimension || height > maxDimension) {
+                    return false;
+                }
+                if (width == 0 || height == 0) {
+                    return true;
+                }
+                const int64_t limit = maxDimension;
+                return rect.left >= -limit && rect.top >= -limit &&
+                       rect.right <= static_cast<int64_t>(canvasWidth) + limit &&
+                       rect.bottom <= static_cast<int64_t>(canvasHeight) + limit;
+            }
+
+            int planeIndexForChannel(int16_t channelId) {
+                if (channelId >= 0 && channelId <= 2) {
+                    return channelId;
+                }
+                return channelId == -1 ? 3 : -1;
+            }
+
+            /**
+             * Sets up `plane` for `rows` rows of `width` bytes starting at the compression
+             * field of a channel (layers) or at its data with a shared row table (merged image).
+             */
+            bool setupPlane(ChannelPlane& plane, uint16_t compression, const uint8_t* rowTable,
+                            size_t rowCountBytes, const uint8_t* data, const uint8_t* end,
+                            uint32_t width, uint32_t rows, size_t& dataSize) {
+                plane.present = true;
+                if (compression == 0) {
+                    plane.rle = false;
+                    plane.data = data;
+                    dataSize = static_cast<size_t>(width) * rows;
+                    return dataSize <= static_cast<size_t>(end - data);
+                }
+                if (compression != 1) {
+                    return false;
+                }
+
+                plane.rle = true;
+                plane.data = data;
+                plane.rowOffsets.resize(static_cast<size_t>(rows) + 1);
+                uint64_t offset = 0;
+                BigEndianReader table(rowTable, rowCountBytes * rows);
+                for (uint32_t y = 0; y < rows; ++y) {
+                    plane.rowOffsets[y] = offset;
+                    offset += table.readUnsigned(rowCountBytes);
+                }
+                plane.rowOffsets[rows] = offset;
+                dataSize = static_cast<size_t>(offset);
+                return table.ok() && offset <= static_cast<uint64_t>(end - data);
+            }
+
+            bool decodeRow(const ChannelPlane& plane, uint32_t row, uint32_t width, uint8_t* dst) {
+                if (!plane.rle) {
+                    std::memcpy(dst, plane.data + static_cast<size_t>(row) * width, width);
+                    return true;
+                }
+                uint64_t begin = plane.rowOffsets[row];
+                uint64_t size = plane.rowOffsets[row + 1] - begin;
+                size_t consumed = 0;
+                return D2::PackBits::decode(plane.data + begin, static_cast<size_t>(size), dst, width, consumed);
+            }
+
+            /**
+             * Decodes one band of canvas tiles (tile row `ty`) from `source` into `image`,
+             * premultiplying on the way. Tiles the source leaves fully transparent stay unallocated.
+             */
+            bool decodeBand(const PlaneSet& source, D2::TiledImage& image, uint32_t ty) {
+                const int32_t bandTop = static_cast<int32_t>(ty * D2::TILE_SIZE);
+                const int32_t bandBottom = std::min<int32_t>(bandTop + D2::TILE_SIZE, image.getHeight());
+                const int32_t y0 = std::max(bandTop, source.top);
+                const int32_t y1 = std::min(bandBottom, source.bottom);
+                const int32_t x0 = std::max(0, source.left);
+                const int32_t x1 = std::min<int32_t>(image.getWidth(), source.right);
+                if (y0 >= y1 || x0 >= x1) {
+                    return true;
+                }
+
+                // Only the columns inside the canvas are kept, so the band never outgrows it
+                const uint32_t width = source.width();
+                const uint32_t span = static_cast<uint32_t>(x1 - x0);
+                const uint32_t skip = static_cast<uint32_t>(x0 - source.left);
+                const uint32_t rows = static_cast<uint32_t>(y1 - y0);
+                thread_local std::vector<uint8_t> band;
+                thread_local std::vector<uint8_t> row;
+                band.resize(static_cast<size_t>(4) * rows * span);
+
+                for (int plane = 0; plane < 4; ++plane) {
+                    const ChannelPlane& channel = source.planes[plane];
+                    uint8_t* planeRows = band.data() + static_cast<size_t>(plane) * rows * span;
+                    if (!channel.present) {
+                        std::memset(planeRows, plane == 3 ? 255 : 0, static_cast<size_t>(rows) * span);
+                        continue;
+                    }
+                    for (uint32_t r = 0; r < rows; ++r) {
+                        uint32_t sourceRow = static_cast<uint32_t>(y0 - source.top) + r;
+                        uint8_t* dst = planeRows + static_cast<size_t>(r) * span;
+                        if (!channel.rle) {
+                            std::memcpy(dst, channel.data + static_cast<size_t>(sourceRow) * width + skip, span);
+                            continue;
+                        }
+                        row.resize(width);
+                        if (!decodeRow(channel, sourceRow, width, row.data())) {
+                            return false;
+                        }
+                        std::memcpy(dst, row.data() + skip, span);
+                    }
+                }
+
+                const uint8_t* red = band.data();
+                const uint8_t* green = red + static_cast<size_t>(rows) * span;
+                const uint8_t* blue = green + static_cast<size_t>(rows) * span;
+                const uint8_t* alpha = blue + static_cast<size_t>(rows) * span;
+
+                for (uint32_t tx = static_cast<uint32_t>(x0) / D2::TILE_SIZE; tx * D2::TILE_SIZE < static_cast<uint32_t>(x1); ++tx) {
+                    const int32_t tileLeft = static_cast<int32_t>(tx * D2::TILE_SIZE);
+                    const int32_t cx0 = std::max(x0, tileLeft);
+                    const int32_t cx1 = std::min<int32_t>(x1, tileLeft + D2::TILE_SIZE);
+
+                    bool anyCoverage = false;
+                    for (uint32_t r = 0; r < rows && !anyCoverage; ++r) {
+                        const uint8_t* a = alpha + static_cast<size_t>(r) * span + (cx0 - x0);
+                        for (int32_t x = 0; x < cx1 - cx0; ++x) {
+                            if (a[x] != 0) {
+                                anyCoverage = true;
+                                break;
+                            }
+                        }
+                    }
+                    if (!anyCoverage) {
+                        continue;
+                    }
+
+                    uint8_t* pixels = image.getTileForWrite(tx, ty).getData();
+                    for (uint32_t r = 0; r < rows; ++r) {
+                        size_t sourceOffset = static_cast<size_t>(r) * span + (cx0 - x0);
+                        uint32_t tileRow = static_cast<uint32_t>(y0 - bandTop) + r;
+                        uint8_t* dst = pixels + (static_cast<size_t>(tileRow) * D2::TILE_SIZE + (cx0 - tileLeft)) * 4;
+                        for (int32_t x = 0; x < cx1 - cx0; ++x) {
+                            uint32_t a = alpha[sourceOffset + x];
+                            dst[x * 4 + 0] = static_cast<uint8_t>(div255(red[sourceOffset + x] * a));
+                            dst[x * 4 + 1] = static_cast<uint8_t>(div255(green[sourceOffset + x] * a));
+                            dst[x * 4 + 2] = static_cast<uint8_t>(div255(blue[sourceOffset + x] * a));
+                            dst[x * 4 + 3] = static_cast<uint8_t>(a);
+                        }
+                    }
+                    // Solid fills (backgrounds, flat colors) collapse to one shared tile
+                    image.compactTile(tx, ty);
+                }
+                return true;
+            }
+
+            bool decodePlaneSet(const PlaneSet& source, D2::TiledImage& image) {
+                std::atomic<bool> failed{false};
+                Jobs::JobSystem::getInstance().parallelFor(image.getTilesY(), [&](size_t ty) {
+                    if (!failed && !decodeBand(source, image, static_cast<uint32_t>(ty))) {
+                        failed = true;
+                    }
+                });
+                return !failed;
+            }
+
+            std::string utf16ToUtf8(const std::u16string& text) {
+                std::string out;
+                for (size_t i = 0; i < text.size(); ++i) {
+                    uint32_t cp = text[i];
+                    if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < text.size()) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (text[++i] - 0xDC00);
+                    }
+                    if (cp < 0x80) {
+                        out.push_back(static_cast<char>(cp));
+                    } else if (cp < 0x800) {
+                        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+                        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                    } else if (cp < 0x10000) {
+                        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+                        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                    } else {
+                        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+                        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+                        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                    }
+                }
+                return out;
+            }
+
+            std::u16string utf8ToUtf16(const std::string& text) {
+                std::u16string out;
+                for (size_t i = 0; i < text.size();) {
+                    uint8_t c = static_cast<uint8_t>(text[i]);
+                    uint32_t cp;
+                    size_t length;
+                    if (c < 0x80)              { cp = c;        length = 1; }
+                    else if ((c >> 5) == 0x6)  { cp = c & 0x1F; length = 2; }
+                    else if ((c >> 4) == 0xE)  { cp = c & 0x0F; length = 3; }
+                    else                       { cp = c & 0x07; length = 4; }
+                    if (i + length > text.size()) {
+                        break;
+                    }
+                    for (size_t k = 1; k < length; ++k) {
+                        cp = (cp << 6) | (static_cast<uint8_t>(text[i + k]) & 0x3F);
+                    }
+                    i += length;
+                    if (cp >= 0x10000) {
+                        cp -= 0x10000;
+                        out.push_back(static_cast<char16_t>(0xD800 + (cp >> 10)));
+                        out.push_back(static_cast<char16_t>(0xDC00 + (cp & 0x3FF)));
+                    } else {
+                        out.push_back(static_cast<char16_t>(cp));
+                    }
+                }
+                return out;
+            }
+
+            // Canvas rectangle covered by allocated tiles, the PSD layer bounds we write
+            struct Bounds {
+                int32_t top = 0, left = 0, bottom = 0, right = 0;
+                uint32_t width() const { return static_cast<uint32_t>(right - left); }
+                uint32_t height() const { return static_cast<uint32_t>(bottom - top); }
+            };
+
+            Bounds computeBounds(const D2::TiledImage& image) {
+                uint32_t minX = image.getTilesX(), minY = image.getTilesY(), maxX = 0, maxY = 0;
+                for (uint32_t ty = 0; ty < image.getTilesY(); ++ty) {
+                    for (uint32_t tx = 0; tx < image.getTilesX(); ++tx) {
+                        if (image.getTile(tx, ty)) {
+                            minX = std::min(minX, tx);
+                            minY = std::min(minY, ty);
+                            maxX = std::max(maxX, tx + 1);
+                            maxY = std::max(maxY, ty + 1);
+                        }
+                    }
+                }
+                Bounds bounds;
+                if (minX < maxX) {
+                    bounds.left = static_cast<int32_t>(minX * D2::TILE_SIZE);
+                    bounds.top = static_cast<int32_t>(minY * D2::TILE_SIZE);
+                    bounds.right = static_cast<int32_t>(std::min(maxX * D2::TILE_SIZE, image.getWidth()));
+                    bounds.bottom = static_cast<int32_t>(std::min(maxY * D2::TILE_SIZE, image.getHeight()));
+                }
+                return bounds;
+            }
+
+            // RLE output of one band of rows for the four channels (R, G, B, A)
+            struct EncodedBand {
+                std::array<std::vector<uint8_t>, 4> data;
+                std::array<std::vector<uint16_t>, 4> rowSizes;
+            };
+
+            // Converts a premultiplied band of rows to straight planes and RLE-encodes each row
+            void encodeRows(const std::vector<uint8_t>& rgba, uint32_t width, uint32_t rows, EncodedBand& out) {
+                thread_local std::vector<uint8_t> plane;
+                plane.resize(width);
+                for (int channel = 0; channel < 4; ++channel) {
+                    out.data[channel].clear();
+                    out.rowSizes[channel].clear();
+                    for (uint32_t r = 0; r < rows; ++r) {
+                        const uint8_t* src = rgba.data() + static_cast<size_t>(r) * width * 4;
+                        for (uint32_t x = 0; x < width; ++x) {
+                            uint32_t a = src[x * 4 + 3];
+                            if (channel == 3) {
+                                plane[x] = static_cast<uint8_t>(a);
+                            } else {
+                                plane[x] = a == 0 ? 0 : static_cast<uint8_t>(std::min<uint32_t>(255, (src[x * 4 + channel] * 255 + a / 2) / a));
+                            }
+                        }
+                        size_t size = D2::PackBits::encode(plane.data(), width, out.data[channel]);
+                        out.rowSizes[channel].push_back(static_cast<uint16_t>(size));
+                    }
+                }
+            }
+
+            // Copies rows [y0, y0 + rows) x [x0, x0 + width) of `image` as premultiplied RGBA8
+            void gatherRows(const D2::TiledImage& image, int32_t x0, int32_t y0, uint32_t width, uint32_t rows, std::vector<uint8_t>& rgba) {
+                rgba.assign(static_cast<size_t>(width) * rows * 4, 0);
+                for (uint32_t r = 0; r < rows; ++r) {
+                    uint32_t y = static_cast<uint32_t>(y0) + r;
+                    uint32_t ty = y / D2::TILE_SIZE;
+                    uint32_t tileRow = y % D2::TILE_SIZE;
+                    for (uint32_t x = static_cast<uint32_t>(x0); x < static_cast<uint32_t>(x0) + width;) {
+                        uint32_t tx = x / D2::TILE_SIZE;
+                        uint32_t tileCol = x % D2::TILE_SIZE;
+                        uint32_t span = std::min(D2::TILE_SIZE - tileCol, static_cast<uint32_t>(x0) + width - x);
+                        if (const D2::Tile* tile = image.getTile(tx, ty)) {
+                            std::memcpy(rgba.data() + (static_cast<size_t>(r) * width + (x - x0)) * 4,
+                                        tile->getData() + (static_cast<size_t>(tileRow) * D2::TILE_SIZE + tileCol) * 4,
+                                        static_cast<size_t>(span) * 4);
+                        }
+                        x += span;
+                    }
+                }
+            }
+
+            // Source-over flatten of the visible layers; PSD readers that ignore layers show this
+            void flattenRows(const Project& project, uint32_t y0, uint32_t rows, std::vector<uint8_t>& rgba) {
+                thread_local std::vector<uint8_t> layerRows;
+                rgba.assign(static_cast<size_t>(project.width) * rows * 4, 0);
+                for (const auto& layer : project.layers) {
+                    if (!layer.pixels || !layer.isVisible()) {
+                        continue;
+                    }
+                    gatherRows(*layer.pixels, 0, static_cast<int32_t>(y0), project.width, rows, layerRows);
+                    uint32_t opacity = static_cast<uint32_t>(std::clamp(layer.opacity, 0.0f, 1.0f) * 255.0f + 0.5f);
+                    for (size_t i = 0; i < rgba.size(); i += 4) {
+                        uint32_t sa = div255(layerRows[i + 3] * opacity);
+                        if (sa == 0) {
+                            continue;
+                        }
+                        for (int c = 0; c < 4; ++c) {
+                            uint32_t s = div255(layerRows[i + c] * opacity);
+                            rgba[i + c] = static_cast<uint8_t>(s + div255(rgba[i + c] * (255 - sa)));
+                        }
+                    }
+                }
+            }
+
+            // Gathers and encodes a `width` x `height` region band by band in parallel
+            std::vector<EncodedBand> encodeRegion(uint32_t width, uint32_t height, const std::function<void(uint32_t, uint32_t, std::vector<uint8_t>&)>& gather) {
+                uint32_t bandCount = (height + D2::TILE_SIZE - 1) / D2::TILE_SIZE;
+                std::vector<EncodedBand> bands(bandCount);
+                Jobs::JobSystem::getInstance().parallelFor(bandCount, [&](size_t band) {
+                    thread_local std::vector<uint8_t> rgba;
+                    uint32_t y = static_cast<uint32_t>(band) * D2::TILE_SIZE;
+                    uint32_t rows = std::min(D2::TILE_SIZE, height - y);
+                    gather(y, rows, rgba);
+                    encodeRows(rgba, width, rows, bands[band]);
+                });
+                return bands;
+            }
+
+            void writeBuffer(std::ofstream& file, const std::vector<uint8_t>& buffer) {
+                file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+            }
+
+            void patchU32(std::ofstream& file, std::streamoff position, uint32_t value) {
+                uint8_t bytes[4] = {
+                    static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16),
+                    static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)
+                };
+                std::streamoff current = file.tellp();
+                file.seekp(position);
+                file.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+                file.seekp(current);
+            }
+        }
+
+        std::shared_ptr<Project> PsdDocument::load(const std::string& filepath) {
+            MappedFile mapping(filepath);
+            if (!mapping.isOpen()) {
+                AE_ERROR("PSD dosyası açılamadı: {}", filepath);
+                return nullptr;
+            }
+
+            const uint8_t* fileData = mapping.getData();
+            const uint8_t* fileEnd = fileData + mapping.getSize();
+            BigEndianReader reader(fileData, mapping.getSize());
+
+            // --- File header ---
+            uint32_t signature = reader.readU32();
+            uint16_t version = reader.readU16();
+            reader.skip(6);
+            uint16_t channelCount = reader.readU16();
+            uint32_t height = reader.readU32();
+            uint32_t width = reader.readU32();
+            uint16_t depth = reader.readU16();
+            uint16_t colorMode = reader.readU16();
+
+            if (!reader.ok() || signature != KEY_SIGNATURE || (version != 1 && version != 2)) {
+                AE_ERROR("Geçersiz PSD dosyası: {}", filepath);
+                return nullptr;
+            }
+            if (depth != 8 || colorMode != 3) {
+                AE_ERROR("Desteklenmeyen PSD formatı (derinlik {}, renk modu {}): {}", depth, colorMode, filepath);
+                return nullptr;
+            }
+
+            const bool isLarge = version == 2;
+            const size_t lengthBytes = isLarge ? 8 : 4;
+            const size_t rowCountBytes = isLarge ? 4 : 2;
+            const uint32_t maxDimension = isLarge ? PSB_MAX_DIMENSION : PSD_MAX_DIMENSION;
+
+            if (width == 0 || height == 0 || width > maxDimension || height > maxDimension) {
+                AE_ERROR("PSD boyut sınırı aşıldı ({}x{}): {}", width, height, filepath);
+                return nullptr;
+            }
+
+            // --- Color mode data and image resources ---
+            reader.skip(reader.readU32());
+            reader.skip(reader.readU32());
+
+            auto project = std::make_shared<Project>();
+            project->filePath = filepath;
+            project->name = std::filesystem::path(filepath).stem().string();
+            project->width = width;
+            project->height = height;
+            project->format = D2::PixelFormat::RGBA8;
+
+            // --- Layer and mask information ---
+            uint64_t layerSectionLength = reader.readUnsigned(lengthBytes);
+            size_t layerSectionEnd = reader.position() + static_cast<size_t>(layerSectionLength);
+
+            struct LayerRecord {
+                D2::Layer layer;
+                PlaneSet source;
+                std::vector<std::pair<int16_t, uint64_t>> channels;
+                bool isGroupMarker = false;
+            };
+            std::vector<LayerRecord> records;
+
+            if (layerSectionLength > 0) {
+                uint64_t layerInfoLength = reader.readUnsigned(lengthBytes);
+                if (layerInfoLength > 0) {
+                    int16_t layerCount = static_cast<int16_t>(std::abs(reader.readI16()));
+                    records.resize(static_cast<size_t>(std::max<int16_t>(0, layerCount)));
+
+                    for (auto& record : records) {
+                        record.source.top = reader.readI32();
+                        record.source.left = reader.readI32();
+                        record.source.bottom = reader.readI32();
+                        record.source.right = reader.readI32();
+
+                        // Rects are checked before any channel data is sized from them; a layer may
+                        // hang off the canvas, but no further than the format allows a layer to be
+                        if (!isValidLayerRect(record.source, width, height, maxDimension)) {
+                            AE_ERROR("Geçersiz PSD layer sınırları ({}, {}, {}, {}): {}", record.source.top,
+                                     record.source.left, record.source.bottom, record.source.right, filepath);
+                            return nullptr;
+                        }
+
+                        uint16_t layerChannels = reader.readU16();
+                        for (uint16_t c = 0; c < layerChannels && reader.ok(); ++c) {
+                            int16_t id = reader.readI16();
+                            uint64_t length = reader.readUnsigned(lengthBytes);
+                            record.channels.emplace_back(id, length);
+                        }
+
+                        reader.readU32(); // '8BIM'
+                        record.layer.blendMode = blendModeFromKey(reader.readU32());
+                        record.layer.opacity = reader.readU8() / 255.0f;
+                        reader.readU8(); // Clipping
+                        uint8_t flags = reader.readU8();
+                        record.layer.visible = (flags & 0x02) == 0;
+                        reader.readU8(); // Filler
+
+                        uint32_t extraLength = reader.readU32();
+                        size_t extraEnd = reader.position() + extraLength;
+                        reader.skip(reader.readU32()); // Layer mask data
+                        reader.skip(reader.readU32()); // Blending ranges
+
+                        uint8_t nameLength = reader.readU8();
+                        const uint8_t* name = reader.readBytes(nameLength);
+                        if (name) {
+                            record.layer.name.assign(reinterpret_cast<const char*>(name), nameLength);
+                        }
+                        reader.skip((4 - (1 + nameLength) % 4) % 4);
+
+                        // Additional layer information; we only care about names and groups
+                        while (reader.ok() && reader.position() + 12 <= extraEnd) {
+                            uint32_t blockSignature = reader.readU32();
+                            uint32_t key = reader.readU32();
+                            if (blockSignature != KEY_8BIM && blockSignature != KEY_8B64) {
+                                break;
+                            }
+                            bool longLength = isLarge && std::find(PSB_LONG_KEYS.begin(), PSB_LONG_KEYS.end(), key) != PSB_LONG_KEYS.end();
+                            uint64_t blockLength = reader.readUnsigned(longLength ? 8 : 4);
+                            size_t blockEnd = reader.position() + static_cast<size_t>(blockLength);
+                            if (blockEnd > extraEnd) {
+                                break;
+                            }
+                            if (key == KEY_UNICODE_NAME) {
+                                uint32_t characters = reader.readU32();
+                                std::u16string unicodeName;
+                                for (uint32_t i = 0; i < characters && reader.ok() && reader.position() + 2 <= blockEnd; ++i) {
+                                    unicodeName.push_back(static_cast<char16_t>(reader.readU16()));
+                                }
+                                if (reader.ok()) {
+                                    record.layer.name = utf16ToUtf8(unicodeName);
+                                }
+                            } else if (key == KEY_SECTION_DIVIDER) {
+                                uint32_t type = reader.readU32();
+                                record.isGroupMarker = type >= 1 && type <= 3;
+                            }
+                            reader.seek(blockEnd);
+                        }
+                        reader.seek(extraEnd);
+                    }
+
+                    // Channel image data follows the records, layer by layer in record order
+                    for (auto& record : records) {
+                        const uint32_t layerWidth = record.source.width();
+                        const uint32_t layerHeight = record.source.height();
+                        for (const auto& [id, length] : record.channels) {
+                            size_t channelStart = reader.position();
+                            size_t channelEnd = channelStart + static_cast<size_t>(length);
+                            int plane = planeIndexForChannel(id);
+                            if (plane >= 0 && length >= 2 && !record.isGroupMarker) {
+                                uint16_t compression = reader.readU16();
+                                const uint8_t* rowTable = fileData + reader.position();
+                                size_t tableSize = compression == 1 ? rowCountBytes * layerHeight : 0;
+                                const uint8_t* data = rowTable + tableSize;
+                                const uint8_t* channelLimit = std::min(fileData + channelEnd, fileEnd);
+                                size_t dataSize = 0;
+                                if (data > channelLimit ||
+                                    !setupPlane(record.source.planes[plane], compression, rowTable, rowCountBytes,
+                                                data, channelLimit, layerWidth, layerHeight, dataSize)) {
+                                    AE_ERROR("Desteklenmeyen veya bozuk PSD kanal verisi ({}, sıkıştırma {}): {}",
+                                             record.layer.name, compression, filepath);
+                                    return nullptr;
+                                }
+                            }
+                            reader.seek(channelEnd);
+                        }
+                    }
+                }
+            }
+
+            if (!reader.ok()) {
+                AE_ERROR("Bozuk PSD layer bilgisi: {}", filepath);
+                return nullptr;
+            }
+
+            // Layers are stored bottom to top, matching our layer stack order
+            for (auto& record : records) {
+                if (record.isGroupMarker) {
+                    continue;
+                }
+                record.layer.pixels = std::make_shared<D2::TiledImage>(width, height, D2::PixelFormat::RGBA8);
+                if (!decodePlaneSet(record.source, *record.layer.pixels)) {
+                    AE_ERROR("PSD layer verisi çözülemedi: {} ({})", record.layer.name, filepath);
+                    return nullptr;
+                }
+                project->layers.push_back(std::move(record.layer));
+            }
+
+            // No layers: fall back to the merged image as a single background layer
+            if (project->layers.empty()) {
+                reader.seek(layerSectionEnd);
+                uint16_t compression = reader.readU16();
+                if (!reader.ok()) {
+                    AE_ERROR("PSD görüntü verisi okunamadı: {}", filepath);
+                    return nullptr;
+                }
+
+                uint32_t planeCount = std::min<uint32_t>(channelCount, 4);
+                const uint8_t* rowTable = fileData + reader.position();
+                size_t tableSize = compression == 1 ? rowCountBytes * static_cast<size_t>(height) * channelCount : 0;
+                const uint8_t* data = rowTable + tableSize;
+
+                PlaneSet merged;
+                merged.right = static_cast<int32_t>(width);
+                merged.bottom = static_cast<int32_t>(height);
+                for (uint32_t plane = 0; plane < planeCount; ++plane) {
+                    size_t dataSize = 0;
+                    if (data > fileEnd ||
+                        !setupPlane(merged.planes[plane], compression, rowTable + plane * rowCountBytes * height,
+                                    rowCountBytes, data, fileEnd, width, height, dataSize)) {
+                        AE_ERROR("Desteklenmeyen veya bozuk PSD görüntü verisi (sıkıştırma {}): {}", compression, filepath);
+                        return nullptr;
+                    }
+                    data += dataSize;
+                }
+
+                D2::Layer background("Background");
+                background.pixels = std::make_shared<D2::TiledImage>(width, height, D2::PixelFormat::RGBA8);
+                if (!decodePlaneSet(merged, *background.pixels)) {
+                    AE_ERROR("PSD görüntü verisi çözülemedi: {}", filepath);
+                    return nullptr;
+                }
+                project->layers.push_back(std::move(background));
+            }
+
+            AE_INFO("PSD dosyası yüklendi: {} ({}x{}, {} layer)", filepath, width, height, project->layers.size());
+            return project;
+        }
+
+        bool PsdDocument::save(const std::string& filepath, const Project& project) {
+            if (project.format != D2::PixelFormat::RGBA8) {
+                AE_ERROR("PSD dışa aktarımı yalnızca 8-bit projeleri destekler: {}", filepath);
+                return false;
+            }
+            if (project.width == 0 || project.height == 0 ||
+                project.width > PSD_MAX_DIMENSION || project.height > PSD_MAX_DIMENSION) {
+                AE_ERROR("PSD boyut sınırı aşıldı ({}x{}): {}", project.width, project.height, filepath);
+                return false;
+            }
+
+            std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+            if (!file) {
+                AE_ERROR("PSD dosyası yazılamadı: {}", filepath);
+                return false;
+            }
+
+            std::vector<uint8_t> buffer;
+            BigEndianWriter writer(buffer);
+
+            // --- File header, color mode data, image resources ---
+            writer.writeU32(KEY_SIGNATURE);
+            writer.writeU16(1);
+            writer.writeBytes("\0\0\0\0\0\0", 6);
+            writer.writeU16(4);
+            writer.writeU32(project.height);
+            writer.writeU32(project.width);
+            writer.writeU16(8);
+            writer.writeU16(3);
+            writer.writeU32(0);
+            writer.writeU32(0);
+
+            // --- Layer records; channel lengths are patched once the data is encoded ---
+            std::vector<const D2::Layer*> layers;
+            for (const auto& layer : project.layers) {
+                if (layer.pixels && layer.pixels->getWidth() == project.width && layer.pixels->getHeight() == project.height) {
+                    layers.push_back(&layer);
+                } else if (layer.pixels) {
+                    AE_WARN("Layer boyutu projeyle uyuşmuyor, atlanıyor: {}", layer.name);
+                }
+            }
+
+            const size_t layerSectionLengthPos = buffer.size();
+            writer.writeU32(0); // Layer and mask section length
+            const size_t layerInfoLengthPos = buffer.size();
+            writer.writeU32(0); // Layer info length
+            const size_t layerInfoStart = buffer.size();
+            writer.writeI16(static_cast<int16_t>(-static_cast<int32_t>(layers.size()))); // Negative: merged alpha present
+
+            static constexpr std::array<int16_t, 4> CHANNEL_IDS = {-1, 0, 1, 2};
+            static constexpr std::array<int, 4> CHANNEL_PLANES = {3, 0, 1, 2};
+            std::vector<Bounds> bounds;
+            std::vector<std::array<size_t, 4>> channelLengthPos;
+
+            for (const D2::Layer* layer : layers) {
+                Bounds layerBounds = computeBounds(*layer->pixels);
+                bounds.push_back(layerBounds);
+
+                writer.writeI32(layerBounds.top);
+                writer.writeI32(layerBounds.left);
+                writer.writeI32(layerBounds.bottom);
+                writer.writeI32(layerBounds.right);
+                writer.writeU16(4);
+                std::array<size_t, 4> positions;
+                for (size_t c = 0; c < 4; ++c) {
+                    writer.writeI16(CHANNEL_IDS[c]);
+                    positions[c] = buffer.size();
+                    writer.writeU32(0);
+                }
+                channelLengthPos.push_back(positions);
+
+                writer.writeU32(KEY_8BIM);
+                writer.writeU32(keyFromBlendMode(layer->blendMode));
+                writer.writeU8(static_cast<uint8_t>(std::clamp(layer->opacity, 0.0f, 1.0f) * 255.0f + 0.5f));
+                writer.writeU8(0);
+                writer.writeU8(layer->visible ? 0x00 : 0x02);
+                writer.writeU8(0);
+
+                std::vector<uint8_t> extra;
+                BigEndianWriter extraWriter(extra);
+                extraWriter.writeU32(0); // Layer mask data
+                extraWriter.writeU32(0); // Blending ranges
+                std::string pascalName = layer->name.substr(0, 255);
+                extraWriter.writeU8(static_cast<uint8_t>(pascalName.size()));
+                extraWriter.writeBytes(pascalName.data(), pascalName.size());
+                extraWriter.pad(4, 0);
+
+                std::u16string unicodeName = utf8ToUtf16(layer->name);
+                extraWriter.writeU32(KEY_8BIM);
+                extraWriter.writeU32(KEY_UNICODE_NAME);
+                uint32_t blockLength = static_cast<uint32_t>(4 + unicodeName.size() * 2);
+                blockLength += blockLength % 4 ? 4 - blockLength % 4 : 0;
+                extraWriter.writeU32(blockLength);
+                size_t blockStart = extra.size();
+                extraWriter.writeU32(static_cast<uint32_t>(unicodeName.size()));
+                for (char16_t ch : unicodeName) {
+                    extraWriter.writeU16(static_cast<uint16_t>(ch));
+                }
+                extraWriter.pad(4, blockStart);
+
+                writer.writeU32(static_cast<uint32_t>(extra.size()));
+                writer.writeBytes(extra.data(), extra.size());
+            }
+
+            writeBuffer(file, buffer);
+            std::streamoff position = static_cast<std::streamoff>(buffer.size());
+
+            // --- Channel image data, one layer at a time so only one layer is held encoded ---
+            for (size_t i = 0; i < layers.size(); ++i) {
+                const D2::Layer& layer = *layers[i];
+                const Bounds& layerBounds = bounds[i];
+                uint32_t layerWidth = layerBounds.width();
+                uint32_t layerHeight = layerBounds.height();
+
+                std::vector<EncodedBand> bands;
+                if (layerWidth > 0 && layerHeight > 0) {
+                    bands = encodeRegion(layerWidth, layerHeight, [&](uint32_t y, uint32_t rows, std::vector<uint8_t>& rgba) {
+                        gatherRows(*layer.pixels, layerBounds.left, layerBounds.top + static_cast<int32_t>(y), layerWidth, rows, rgba);
+                    });
+                }
+
+                for (size_t c = 0; c < 4; ++c) {
+                    int plane = CHANNEL_PLANES[c];
+                    buffer.clear();
+                    writer.writeU16(1);
+                    for (const auto& band : bands) {
+                        for (uint16_t rowSize : band.rowSizes[plane]) {
+                            writer.writeU16(rowSize);
+                        }
+                    }
+                    for (const auto& band : bands) {
+                        writer.writeBytes(band.data[plane].data(), band.data[plane].size());
+                    }
+                    writeBuffer(file, buffer);
+                    patchU32(file, static_cast<std::streamoff>(channelLengthPos[i][c]), static_cast<uint32_t>(buffer.size()));
+                    position += static_cast<std::streamoff>(buffer.size());
+                }
+            }
+
+            // Layer info length is rounded up to an even size
+            std::streamoff layerInfoLength = position - static_cast<std::streamoff>(layerInfoStart);
+            if (layerInfoLength % 2 != 0) {
+                file.put(0);
+                ++position;
+                ++layerInfoLength;
+            }
+            patchU32(file, static_cast<std::streamoff>(layerInfoLengthPos), static_cast<uint32_t>(layerInfoLength));
+
+            buffer.clear();
+            writer.writeU32(0); // Global layer mask info
+            writeBuffer(file, buffer);
+            position += static_cast<std::streamoff>(buffer.size());
+            patchU32(file, static_cast<std::streamoff>(layerSectionLengthPos),
+                     static_cast<uint32_t>(position - static_cast<std::streamoff>(layerInfoLengthPos)));
+
+            // --- Merged image data: row table for all channels, then planes R, G, B, A ---
+            std::vector<EncodedBand> merged = encodeRegion(project.width, project.height, [&](uint32_t y, uint32_t rows, std::vector<uint8_t>& rgba) {
+                flattenRows(project, y, rows, rgba);
+            });
+            buffer.clear();
+            writer.writeU16(1);
+            for (int plane = 0; plane < 4; ++plane) {
+                for (const auto& band : merged) {
+                    for (uint16_t rowSize : band.rowSizes[plane]) {
+                        writer.writeU16(rowSize);
+                    }
+                }
+            }
+            writeBuffer(file, buffer);
+            for (int plane = 0; plane < 4; ++plane) {
+                for (const auto& band : merged) {
+                    writeBuffer(file, band.data[plane]);
+                }
+            }
+
+            if (!file) {
+                AE_ERROR("PSD dosyası yazılamadı: {}", filepath);
+                return false;
+            }
+
+            AE_INFO("PSD dosyası kaydedildi: {} ({}x{}, {} layer)", filepath, project.width, project.height, layers.size());
+            return true;
+        }
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Asset/ImageAssetManager.h"
+#include <memory>
+#include <string>
+
+namespace AstralEngine {
+    namespace Asset {
+        /**
+         * @brief Photoshop document (.psd) interchange for layered 8-bit RGB(A) images
+         *
+         * Layers are read into canvas-sized tiled images (premultiplied) and written back
+         * with straight alpha, one RLE-compressed plane per channel. Both directions work on
+         * bands of TILE_SIZE scanlines that are decoded/encoded in parallel; reading goes
+         * through a memory mapping so the bands index straight into the file.
+         *
+         * Reading also accepts large-document (.psb, version 2) files. Group layers, masks,
+         * adjustment layers and ZIP-compressed channels are not supported.
+         */
+        class PsdDocument {
+        public:
+            static std::shared_ptr<Project> load(const std::string& filepath);
+            static bool save(const std::string& filepath, const Project& project);
+        };
+    }
+}
@@ -1,6 +1,7 @@
 #include "AssetManager.h"
 #include "Logger.h"
 #include "Asset/ModelAsset.h"
+#include "Renderer/Texture.h"
 #include <algorithm>
 
 namespace AstralEngine {
@@ -56,4 +57,27 @@ namespace AstralEngine {
         AE_ERROR("Failed to load ModelAsset: {}", assetPath);
         return nullptr;
     }
+
+    std::shared_ptr<Texture> AssetManager::loadTexture(Vulkan::VulkanDevice& device, const std::string& texturePath, TextureSlot slot) {
+        // Color and data textures use different formats, so the color space is part of the key
+        TextureFormat format = getPreferredFormat(slot);
+        std::string key = texturePath + (format == TextureFormat::SRGB ? "#srgb" : "#linear");
+
+        std::lock_guard<std::mutex> lock(s_mutex);
+
+        auto it = s_assets.find(key);
+        if (it != s_assets.end()) {
+            return std::static_pointer_cast<Texture>(it->second);
+        }
+
+        try {
+            auto texture = std::make_shared<Texture>(device, texturePath, format, slot);
+            s_assets[key] = texture;
+            AE_DEBUG("Texture cached: {}", key);
+            return texture;
+        } catch (const std::exception& e) {
+            AE_ERROR("Failed to load texture '{}': {}", texturePath, e.what());
+            return nullptr;
+        }
+    }
 }
@@ -5,11 +5,17 @@
 #include <unordered_map>
 #include <memory>
 #include <mutex>
+#include <cstdint>
 #include "Core/Logger.h" // For logging
 
 namespace AstralEngine {
     // Forward declare Asset types
     class ModelAsset;
+    class Texture;
+    enum class TextureSlot : uint32_t;
+    namespace Vulkan {
+        class VulkanDevice;
+    }
 
     class AssetManager {
     public:
@@ -25,6 +31,9 @@ namespace AstralEngine {
         template<typename T>
         static std::shared_ptr<T> getAsset(const std::string& assetPath);
         
+        // Loads a texture once per path and color space; later requests share the instance.
+        static std::shared_ptr<Texture> loadTexture(Vulkan::VulkanDevice& device, const std::string& texturePath, TextureSlot slot);
+        
         static bool isAssetLoaded(const std::string& assetPath);
         static void unloadAllAssets();
         
@@ -26,6 +26,10 @@ namespace AstralEngine {
         // Logging
         bool enableDetailedLogging = false;
         
+        // 2D tile paging; tiles past the budget go to a swap file in the temp directory
+        int tileMemoryBudgetMB = 4096; // 0 keeps every tile in memory
+        bool compressTileSwap = true;
+        
         // Get singleton instance
         static EngineConfig& getInstance() {
             static EngineConfig instance;
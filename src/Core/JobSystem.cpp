@@ -0,0 +1,179 @@
+#include "JobSystem.h"
+#include "Logger.h"
+#include <algorithm>
+#include <atomic>
+
+namespace AstralEngine {
+    namespace Jobs {
+        JobSystem::~JobSystem() {
+            shutdown();
+        }
+        
+        void JobSystem::initialize(uint32_t threadCount) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_running) {
+                AE_WARN("JobSystem already initialized");
+                return;
+            }
+            
+            if (threadCount == 0) {
+                uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+                threadCount = std::max(1u, hardwareThreads - 1);
+            }
+            
+            m_running = true;
+            m_workers.reserve(threadCount);
+            for (uint32_t i = 0; i < threadCount; ++i) {
+                m_workers.emplace_back(&JobSystem::workerLoop, this);
+            }
+            
+            AE_INFO("JobSystem initialized with {} worker threads", threadCount);
+        }
+        
+        void JobSystem::shutdown() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_running) {
+                    return;
+                }
+                m_running = false;
+            }
+            m_condition.notify_all();
+            
+            for (auto& worker : m_workers) {
+                if (worker.joinable()) {
+                    worker.join();
+                }
+            }
+            m_workers.clear();
+            m_queue.clear();
+        }
+        
+        uint32_t JobSystem::getWorkerCount() {
+            ensureStarted();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return static_cast<uint32_t>(m_workers.size());
+        }
+        
+        std::future<void> JobSystem::submit(std::function<void()> job) {
+            auto task = std::make_shared<std::packaged_task<void()>>(std::move(job));
+            std::future<void> future = task->get_future();
+            enqueue([task]() { (*task)(); });
+            return future;
+        }
+        
+        void JobSystem::parallelFor(size_t count, const std::function<void(size_t)>& fn, size_t grain) {
+            if (count == 0) {
+                return;
+            }
+            grain = std::max<size_t>(1, grain);
+            
+            size_t chunkCount = (count + grain - 1) / grain;
+            if (chunkCount == 1) {
+                for (size_t i = 0; i < count; ++i) {
+                    fn(i);
+                }
+                return;
+            }
+            
+            // Shared so helpers that get scheduled after the loop finished still
+            // see valid state; they simply find no chunks left.
+            struct LoopState {
+                std::atomic<size_t> nextChunk{0};
+                std::atomic<size_t> doneChunks{0};
+                std::mutex mutex;
+                std::condition_variable finished;
+            };
+            auto state = std::make_shared<LoopState>();
+            
+            auto runChunks = [state, &fn, count, grain, chunkCount]() {
+                size_t completed = 0;
+                for (size_t chunk = state->nextChunk.fetch_add(1); chunk < chunkCount;
+                     chunk = state->nextChunk.fetch_add(1)) {
+                    size_t end = std::min(count, (chunk + 1) * grain);
+                    for (size_t i = chunk * grain; i < end; ++i) {
+                        fn(i);
+                    }
+                    ++completed;
+                }
+                if (completed > 0 && state->doneChunks.fetch_add(completed) + completed == chunkCount) {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->finished.notify_all();
+                }
+            };
+            
+            size_t helpers = std::min<size_t>(getWorkerCount(), chunkCount - 1);
+            for (size_t i = 0; i < helpers; ++i) {
+                // Helpers only touch `fn` while holding a chunk, and the caller cannot
+                // return before every chunk is done, so the reference stays valid.
+                enqueue(runChunks);
+            }
+            
+            runChunks();
+            
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->finished.wait(lock, [&state, chunkCount]() {
+                return state->doneChunks.load() == chunkCount;
+            });
+        }
+        
+        bool JobSystem::runWhileIdle(const std::function<void()>& fn) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_queue.empty() || m_busy > 0) {
+                    return false;
+                }
+                m_paused = true;
+            }
+            fn();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_paused = false;
+            }
+            // Jobs queued meanwhile were held back
+            m_condition.notify_all();
+            return true;
+        }
+        
+        void JobSystem::ensureStarted() {
+            bool running;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                running = m_running;
+            }
+            if (!running) {
+                initialize();
+            }
+        }
+        
+        void JobSystem::enqueue(std::function<void()> job) {
+            ensureStarted();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_queue.push_back(std::move(job));
+            }
+            m_condition.notify_one();
+        }
+        
+        void JobSystem::workerLoop() {
+            while (true) {
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_condition.wait(lock, [this]() { return !m_running || (!m_queue.empty() && !m_paused); });
+                    if (!m_running && m_queue.empty()) {
+                        return;
+                    }
+                    job = std::move(m_queue.front());
+                    m_queue.pop_front();
+                    ++m_busy;
+                }
+                job();
+                // Destroyed before the job counts as done, so what it captured is released too
+                job = nullptr;
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_busy;
+            }
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef ASTRAL_ENGINE_JOB_SYSTEM_H
+#define ASTRAL_ENGINE_JOB_SYSTEM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <vector>
+
+namespace AstralEngine {
+    namespace Jobs {
+        /**
+         * @brief Fixed-size worker pool for data-parallel engine work
+         *
+         * Jobs are plain closures pulled from a single FIFO queue. parallelFor() lets the
+         * calling thread take part in the loop, so it is safe to call from inside a job.
+         * The pool starts lazily with (hardware threads - 1) workers on first use.
+         */
+        class JobSystem {
+        public:
+            static JobSystem& getInstance() {
+                static JobSystem instance;
+                return instance;
+            }
+            
+            // threadCount == 0 picks hardware_concurrency() - 1
+            void initialize(uint32_t threadCount = 0);
+            void shutdown();
+            
+            uint32_t getWorkerCount();
+            
+            // Queue a job for a worker thread; the future becomes ready when it has run
+            std::future<void> submit(std::function<void()> job);
+            
+            // Runs fn(i) for every i in [0, count) and blocks until all calls finished.
+            // Indices are handed out in chunks of `grain` to keep scheduling overhead low.
+            void parallelFor(size_t count, const std::function<void(size_t)>& fn, size_t grain = 1);
+            
+            // Runs fn on the calling thread while no job is queued or running, holding workers
+            // back until it returns, so it may change data jobs read without locking. Returns
+            // false without calling fn if jobs are pending. Must not be called from a job.
+            bool runWhileIdle(const std::function<void()>& fn);
+            
+        private:
+            JobSystem() = default;
+            ~JobSystem();
+            
+            void ensureStarted();
+            void workerLoop();
+            void enqueue(std::function<void()> job);
+            
+            std::vector<std::thread> m_workers;
+            std::deque<std::function<void()>> m_queue;
+            std::mutex m_mutex;
+            std::condition_variable m_condition;
+            bool m_running = false;
+            bool m_paused = false;  // runWhileIdle() in progress
+            uint32_t m_busy = 0;    // Jobs taken off the queue and still running
+        };
+    }
+}
+
+#endif // ASTRAL_ENGINE_JOB_SYSTEM_H
@@ -0,0 +1,117 @@
+#include "MappedFile.h"
+#include "Logger.h"
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace AstralEngine {
+    MappedFile::~MappedFile() {
+        close();
+    }
+    
+    MappedFile::MappedFile(MappedFile&& other) noexcept {
+        *this = std::move(other);
+    }
+    
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            std::swap(m_data, other.m_data);
+            std::swap(m_size, other.m_size);
+#ifdef _WIN32
+            std::swap(m_fileHandle, other.m_fileHandle);
+            std::swap(m_mappingHandle, other.m_mappingHandle);
+#endif
+        }
+        return *this;
+    }
+    
+    bool MappedFile::open(const std::string& filepath) {
+        close();
+        
+#ifdef _WIN32
+        HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            AE_ERROR("Failed to open file for mapping: {}", filepath);
+            return false;
+        }
+        
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            CloseHandle(file);
+            AE_ERROR("Failed to map empty or unreadable file: {}", filepath);
+            return false;
+        }
+        
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!view) {
+            if (mapping) {
+                CloseHandle(mapping);
+            }
+            CloseHandle(file);
+            AE_ERROR("Failed to map file: {}", filepath);
+            return false;
+        }
+        
+        m_fileHandle = file;
+        m_mappingHandle = mapping;
+        m_data = static_cast<const uint8_t*>(view);
+        m_size = static_cast<size_t>(size.QuadPart);
+#else
+        int fd = ::open(filepath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            AE_ERROR("Failed to open file for mapping: {}", filepath);
+            return false;
+        }
+        
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            AE_ERROR("Failed to map empty or unreadable file: {}", filepath);
+            return false;
+        }
+        
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // The mapping keeps its own reference to the file
+        if (view == MAP_FAILED) {
+            AE_ERROR("Failed to map file: {}", filepath);
+            return false;
+        }
+        madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+        
+        m_data = static_cast<const uint8_t*>(view);
+        m_size = static_cast<size_t>(info.st_size);
+#endif
+        return true;
+    }
+    
+    void MappedFile::close() {
+        if (!m_data) {
+            return;
+        }
+        
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+        CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+        CloseHandle(static_cast<HANDLE>(m_fileHandle));
+        m_mappingHandle = nullptr;
+        m_fileHandle = nullptr;
+#else
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
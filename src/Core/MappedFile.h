@@ -0,0 +1,43 @@
+#ifndef ASTRAL_ENGINE_MAPPED_FILE_H
+#define ASTRAL_ENGINE_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace AstralEngine {
+    /**
+     * @brief Read-only memory mapping of a whole file
+     *
+     * Lets parsers index into large files directly and decode regions from several
+     * threads at once, without staging reads through intermediate buffers.
+     */
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        explicit MappedFile(const std::string& filepath) { open(filepath); }
+        ~MappedFile();
+        
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        
+        bool open(const std::string& filepath);
+        void close();
+        
+        bool isOpen() const { return m_data != nullptr; }
+        const uint8_t* getData() const { return m_data; }
+        size_t getSize() const { return m_size; }
+        
+    private:
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        void* m_fileHandle = nullptr;
+        void* m_mappingHandle = nullptr;
+#endif
+    };
+}
+
+#endif // ASTRAL_ENGINE_MAPPED_FILE_H
@@ -69,6 +69,16 @@ namespace AstralEngine {
             return m_stackAllocator.get();
         }
         
+        void MemoryManager::setPagingStats(const PagingStats& stats) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pagingStats = stats;
+        }
+        
+        PagingStats MemoryManager::getPagingStats() const {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_pagingStats;
+        }
+        
         // FrameAllocator implementation
         MemoryManager::FrameAllocator::FrameAllocator(size_t size) 
             : m_totalSize(size), m_usedSize(0) {
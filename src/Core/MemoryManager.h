@@ -2,11 +2,22 @@
 #define ASTRAL_ENGINE_MEMORY_MANAGER_H
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 
 namespace AstralEngine {
     namespace Memory {
+        // Figures an out-of-core store reports each frame; Core itself pages nothing out
+        struct PagingStats {
+            size_t residentBytes = 0;
+            size_t budgetBytes = 0;
+            size_t swappedBytes = 0;
+            size_t swapFileBytes = 0;
+            uint64_t pageIns = 0;
+            uint64_t pageOuts = 0;
+        };
+        
         class MemoryManager {
         public:
             static MemoryManager& getInstance() {
@@ -56,6 +67,9 @@ namespace AstralEngine {
             FrameAllocator* getFrameAllocator();
             StackAllocator* getStackAllocator();
             
+            void setPagingStats(const PagingStats& stats);
+            PagingStats getPagingStats() const;
+            
         private:
             MemoryManager() = default;
             ~MemoryManager() = default;
@@ -63,7 +77,8 @@ namespace AstralEngine {
             std::unique_ptr<FrameAllocator> m_frameAllocator;
             std::unique_ptr<StackAllocator> m_stackAllocator;
             bool m_initialized;
-            std::mutex m_mutex;
+            PagingStats m_pagingStats;
+            mutable std::mutex m_mutex;
         };
     }
 }
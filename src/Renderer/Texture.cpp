@@ -33,9 +33,9 @@ namespace AstralEngine {
 		createSampler(m_mipLevels, m_slot);
 	}
 
-	Texture::Texture(Vulkan::VulkanDevice& device, uint32_t width, uint32_t height, VkFormat format, const void* data)
+	Texture::Texture(Vulkan::VulkanDevice& device, uint32_t width, uint32_t height, VkFormat format, const void* data, bool mipmapped)
 		: m_device(device), m_width(width), m_height(height), m_format(format), m_slot(TextureSlot::BaseColor) {
-		createFromData(width, height, format, data);
+		createFromData(width, height, format, data, mipmapped);
 		createSampler(m_mipLevels, m_slot);
 	}
 
@@ -230,10 +230,10 @@ namespace AstralEngine {
 		createImageView(format, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels);
 	}
 
-	void Texture::createFromData(uint32_t width, uint32_t height, VkFormat format, const void* data) {
+	void Texture::createFromData(uint32_t width, uint32_t height, VkFormat format, const void* data, bool mipmapped) {
 		m_width = width;
 		m_height = height;
-		m_mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+		m_mipLevels = mipmapped ? static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1 : 1;
 		
 		VkDeviceSize imageSize = width * height * 4; // Assuming 4 bytes per pixel
 		
@@ -262,6 +262,71 @@ namespace AstralEngine {
 		createImageView(format, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels);
 	}
 
+	void Texture::updateRegions(const std::vector<TextureRegion>& regions, const void* data) {
+		if (regions.empty()) {
+			return;
+		}
+		
+		std::vector<VkBufferImageCopy> copies;
+		copies.reserve(regions.size());
+		VkDeviceSize offset = 0;
+		for (const auto& region : regions) {
+			VkBufferImageCopy copy{};
+			copy.bufferOffset = offset;
+			copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			copy.imageSubresource.mipLevel = 0;
+			copy.imageSubresource.baseArrayLayer = 0;
+			copy.imageSubresource.layerCount = 1;
+			copy.imageOffset = { static_cast<int32_t>(region.x), static_cast<int32_t>(region.y), 0 };
+			copy.imageExtent = { region.width, region.height, 1 };
+			copies.push_back(copy);
+			offset += static_cast<VkDeviceSize>(region.width) * region.height * 4;
+		}
+		
+		Vulkan::VulkanBuffer stagingBuffer(m_device, offset, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
+		void* mapped;
+		vmaMapMemory(m_device.getAllocator(), stagingBuffer.getAllocation(), &mapped);
+		memcpy(mapped, data, static_cast<size_t>(offset));
+		vmaUnmapMemory(m_device.getAllocator(), stagingBuffer.getAllocation());
+		
+		VkCommandBuffer commandBuffer = m_device.beginSingleTimeCommands();
+		
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.image = m_image;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+			0, nullptr,
+			0, nullptr,
+			1, &barrier);
+		
+		vkCmdCopyBufferToImage(commandBuffer, stagingBuffer.getBuffer(), m_image,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(copies.size()), copies.data());
+		
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+			0, nullptr,
+			0, nullptr,
+			1, &barrier);
+		
+		m_device.endSingleTimeCommands(commandBuffer);
+	}
+
 	VkFormat Texture::getVulkanFormat(TextureFormat format) {
 		switch (format) {
 			case TextureFormat::SRGB:
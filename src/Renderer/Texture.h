@@ -11,17 +11,26 @@ namespace AstralEngine {
 
 #include "Renderer/VulkanR/Vulkan.h"
 #include <string>
+#include <vector>
 #include "Renderer/UnifiedMaterialConstants.h"
 
 namespace AstralEngine {
+	// Rectangle of texels, used for partial uploads
+	struct TextureRegion {
+		uint32_t x = 0;
+		uint32_t y = 0;
+		uint32_t width = 0;
+		uint32_t height = 0;
+	};
+
 	class Texture {
 	public:
 		// Constructor with automatic format detection
 		Texture(Vulkan::VulkanDevice& device, const std::string& filepath);
 		// Constructor with explicit format and slot specification
         Texture(Vulkan::VulkanDevice& device, const std::string& filepath, TextureFormat format, TextureSlot slot = TextureSlot::BaseColor);
-		// Constructor for manual texture creation
-		Texture(Vulkan::VulkanDevice& device, uint32_t width, uint32_t height, VkFormat format, const void* data = nullptr);
+		// Constructor for manual texture creation; textures updated in place should skip mipmaps
+		Texture(Vulkan::VulkanDevice& device, uint32_t width, uint32_t height, VkFormat format, const void* data = nullptr, bool mipmapped = true);
 		~Texture();
 
 		VkImageView getImageView() const { return m_imageView; }
@@ -32,6 +41,10 @@ namespace AstralEngine {
 		uint32_t getHeight() const { return m_height; }
 		uint32_t getMipLevels() const { return m_mipLevels; }
 		
+		// Uploads rectangles of mip level 0 in one transfer. `data` holds the regions' RGBA8
+		// pixels back to back, each tightly packed; other mip levels are left untouched.
+		void updateRegions(const std::vector<TextureRegion>& regions, const void* data);
+		
 		// Static utility methods
 		static VkFormat getVulkanFormat(TextureFormat format);
 		static TextureFormat detectFormatFromPath(const std::string& filepath);
@@ -43,7 +56,7 @@ namespace AstralEngine {
         void createSampler(uint32_t mipLevels, TextureSlot slot = TextureSlot::BaseColor);
 		void generateMipmaps(VkImage image, int32_t texWidth, int32_t texHeight, uint32_t mipLevels);
 		void loadFromFile(const std::string& filepath, VkFormat format);
-		void createFromData(uint32_t width, uint32_t height, VkFormat format, const void* data);
+		void createFromData(uint32_t width, uint32_t height, VkFormat format, const void* data, bool mipmapped);
 
 		Vulkan::VulkanDevice& m_device;
 		VkImage m_image;
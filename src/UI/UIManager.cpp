@@ -209,6 +209,9 @@ void UIManager::EndFrame() {
             if (ImGui::Button("Eraser")) {
                 m_toolManager->selectTool("Eraser");
             }
+            if (ImGui::Button("Magic Wand")) {
+                m_toolManager->selectTool("Magic Wand");
+            }
             // Add more tools here...
 
             ImGui::End();
@@ -239,6 +242,25 @@ void UIManager::EndFrame() {
                     }
                     ImGui::SliderFloat("Size", &brushProps.size, 1.0f, 100.0f);
                     ImGui::SliderFloat("Hardness", &brushProps.hardness, 0.0f, 1.0f);
+                    ImGui::SliderFloat("Roundness", &brushProps.roundness, 0.05f, 1.0f);
+                    ImGui::SliderFloat("Angle", &brushProps.angle, -180.0f, 180.0f, "%.0f deg");
+                }
+            } else if (auto* wand = dynamic_cast<D2::MagicWandTool*>(activeTool)) {
+                D2::FillOptions& options = wand->getOptions();
+                float tolerance = options.tolerance * 255.0f;
+                if (ImGui::SliderFloat("Tolerance", &tolerance, 0.0f, 255.0f, "%.0f")) {
+                    options.tolerance = tolerance / 255.0f;
+                }
+                ImGui::Checkbox("Contiguous", &options.contiguous);
+                ImGui::Checkbox("Anti-alias", &options.antiAlias);
+                bool sampleMerged = wand->isSampleMerged();
+                if (ImGui::Checkbox("Sample All Layers", &sampleMerged)) {
+                    wand->setSampleMerged(sampleMerged);
+                }
+                static const char* modeNames[] = {"New", "Add", "Subtract", "Intersect"};
+                int mode = static_cast<int>(wand->getMode());
+                if (ImGui::Combo("Mode", &mode, modeNames, IM_ARRAYSIZE(modeNames))) {
+                    wand->setMode(static_cast<D2::MaskCombine>(mode));
                 }
             }
 
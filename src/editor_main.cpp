@@ -11,16 +11,28 @@
 #include "ECS/ArchetypeECS.h"
 #include "UI/UIManager.h"
 #include "2D/Layers/Layer.h"
+#include "2D/Layers/LayerThumbnails.h"
+#include "2D/Layers/UndoHistory.h"
+#include "2D/Selection/Selection.h"
 #include "2D/Tools/Brush.h"
 #include "2D/Canvas/Canvas.h"
+#include "2D/Filters/Adjustments.h"
+#include "2D/Filters/FilterSession.h"
+#include "2D/Filters/GaussianBlur.h"
+#include "2D/Filters/Histogram.h"
 #include "2D/Tools/Tool.h"
+#include "2D/Image/TileStore.h"
 #include "Asset/ImageAssetManager.h"
 #include "Asset/ModelAsset.h"
 #include "Renderer/RRenderer.h"
 
 #include <imgui.h>
+#include <imgui_impl_vulkan.h>
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
 #include <chrono>
+#include <filesystem>
 #include <thread>
 
 
@@ -48,6 +60,16 @@ int main(int argc, char* argv[]) {
 
         AstralEngine::AssetManager::init();
 
+        // Budget and compression come from the config
+        auto& tileStore = AstralEngine::D2::TileStore::getInstance();
+        {
+            std::error_code error;
+            const std::filesystem::path swapDir = std::filesystem::temp_directory_path(error);
+            if (!error) {
+                tileStore.setSwapPath((swapDir / "astral_tiles.swap").string());
+            }
+        }
+
         try {
             AstralEngine::WindowConfig windowConfig = AstralEngine::WindowConfig::fromEngineConfig();
             windowConfig.title = "Astral Creative Suite v1.0";
@@ -64,17 +86,46 @@ int main(int argc, char* argv[]) {
             AstralEngine::D2::LayerSystem layerSystem(scene);
             AstralEngine::D2::BrushSystem brushSystem(scene);
             AstralEngine::D2::CanvasSystem canvasSystem(scene, renderer);
+            AstralEngine::D2::SelectionSystem selectionSystem;
             AstralEngine::D2::ToolManager toolManager(scene, canvasSystem, brushSystem);
             
             uiManager.Initialize(window, renderer, toolManager);
 
-            toolManager.registerTool(std::make_unique<AstralEngine::D2::SelectionTool>());
+            toolManager.registerTool(std::make_unique<AstralEngine::D2::SelectionTool>(selectionSystem));
+            toolManager.registerTool(std::make_unique<AstralEngine::D2::MagicWandTool>(selectionSystem, layerSystem, canvasSystem));
             toolManager.registerTool(std::make_unique<AstralEngine::D2::BrushTool2D>(brushSystem, layerSystem));
             toolManager.registerTool(std::make_unique<AstralEngine::D2::EraserTool>(brushSystem, layerSystem));
+            toolManager.registerTool(std::make_unique<AstralEngine::D2::FillTool>(brushSystem, layerSystem, canvasSystem));
             toolManager.selectTool("Brush");
 
+            layerSystem.setDocumentSize(1920, 1080);
+            selectionSystem.setDocumentSize(1920, 1080);
+            layerSystem.setSelection(&selectionSystem);
+            brushSystem.setSelection(&selectionSystem);
             auto baseLayer = layerSystem.addLayer("Background");
+            
+            // Created after the background so the initial document cannot be undone
+            AstralEngine::D2::UndoHistory undoHistory(scene, layerSystem);
+            layerSystem.setHistory(&undoHistory);
+            brushSystem.setHistory(&undoHistory);
             auto canvasEntity = canvasSystem.createCanvas(1920, 1080);
+            
+            // Thumbnails for the layers panel, in shared atlases with one ImGui texture each
+            AstralEngine::D2::LayerThumbnails layerThumbnails(scene, renderer);
+            std::vector<VkDescriptorSet> thumbnailTextures;
+            // Counts the active layer in the background while it is edited
+            AstralEngine::D2::HistogramMonitor histogramMonitor;
+            int histogramChannel = AstralEngine::D2::Histogram::Luminance;
+            // Open while a filter is previewed on the active layer; destroyed before the layer system
+            std::unique_ptr<AstralEngine::D2::FilterSession> filterSession;
+            int filterIndex = 0;
+            float filterRadius = 5.0f, filterAmount = 1.0f;
+            float levelsBlack = 0.0f, levelsWhite = 1.0f, levelsGamma = 1.0f;
+            float exposure = 0.0f, exposureOffset = 0.0f, exposureGamma = 1.0f;
+            float hue = 0.0f, saturation = 0.0f, lightness = 0.0f;
+            // Interactive transform of the active layer, relative to its pixels when the drag began
+            glm::vec2 transformOffset = {0.0f, 0.0f};
+            float transformAngle = 0.0f, transformScale = 1.0f;
 
             // Test 3D model loading with dependency injection (no global device hack)
             auto modelAsset = std::make_shared<AstralEngine::ModelAsset>("models/viking_room.obj", renderer.GetDevice());
@@ -92,16 +143,48 @@ int main(int argc, char* argv[]) {
             AE_INFO("Main loop starting...");
             while (!window.shouldClose()) {
                 AstralEngine::Memory::MemoryManager::getInstance().newFrame();
+                tileStore.update();
                 window.pollEvents();
                 
                 uiManager.BeginFrame();
                 uiManager.Render();
 
                 if (uiManager.GetAppState() == AstralEngine::UI::AppState::Editor2D) {
+                    ImGuiIO& keyIO = ImGui::GetIO();
+                    if (keyIO.KeyCtrl && !keyIO.WantTextInput) {
+                        if (ImGui::IsKeyPressed(ImGuiKey_Z, false)) {
+                            filterSession.reset();
+                            layerSystem.cancelTransform();
+                            if (keyIO.KeyShift) { undoHistory.redo(); } else { undoHistory.undo(); }
+                        } else if (ImGui::IsKeyPressed(ImGuiKey_Y, false)) {
+                            filterSession.reset();
+                            layerSystem.cancelTransform();
+                            undoHistory.redo();
+                        } else if (ImGui::IsKeyPressed(ImGuiKey_C, false)) {
+                            layerSystem.copyLayer(layerSystem.getActiveLayer());
+                        } else if (ImGui::IsKeyPressed(ImGuiKey_V, false) && layerSystem.hasClipboard()) {
+                            filterSession.reset();
+                            layerSystem.cancelTransform();
+                            layerSystem.pasteLayer();
+                        } else if (ImGui::IsKeyPressed(ImGuiKey_J, false)) {
+                            filterSession.reset();
+                            layerSystem.cancelTransform();
+                            layerSystem.duplicateLayer(layerSystem.getActiveLayer());
+                        } else if (ImGui::IsKeyPressed(ImGuiKey_A, false)) {
+                            selectionSystem.selectAll();
+                        } else if (ImGui::IsKeyPressed(ImGuiKey_D, false)) {
+                            selectionSystem.deselect();
+                        } else if (keyIO.KeyShift && ImGui::IsKeyPressed(ImGuiKey_I, false)) {
+                            selectionSystem.invert();
+                        }
+                    }
+                    
                     ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
                     ImGui::Begin("Canvas");
                     {
                         ImVec2 canvas_pos = ImGui::GetCursorScreenPos();
+                        const ImVec2 canvas_size = ImGui::GetContentRegionAvail();
+                        canvasSystem.setViewport(canvasEntity, {canvas_size.x, canvas_size.y});
                         if (ImGui::IsWindowHovered() && toolManager.getActiveTool()) {
                             ImGuiIO& io = ImGui::GetIO();
                             glm::vec2 mouse_pos = {io.MousePos.x - canvas_pos.x, io.MousePos.y - canvas_pos.y};
@@ -112,13 +195,228 @@ int main(int argc, char* argv[]) {
                                 toolManager.getActiveTool()->onMouseUp(mouse_pos, canvasEntity);
                             }
                         }
+                        
+                        // Marching ants: black dashes over a white line, shifting over time
+                        if (selectionSystem.hasSelection()) {
+                            ImDrawList* drawList = ImGui::GetWindowDrawList();
+                            const float dash = 4.0f;
+                            const float phase = std::fmod(static_cast<float>(ImGui::GetTime()) * 8.0f, dash * 2.0f);
+                            for (const auto& segment : selectionSystem.getOutline()) {
+                                const ImVec2 a(canvas_pos.x + segment.x0, canvas_pos.y + segment.y0);
+                                const ImVec2 b(canvas_pos.x + segment.x1, canvas_pos.y + segment.y1);
+                                drawList->AddLine(a, b, IM_COL32(255, 255, 255, 255));
+                                const bool horizontal = segment.y0 == segment.y1;
+                                const float start = horizontal ? a.x : a.y;
+                                const float end = horizontal ? b.x : b.y;
+                                // Dashes follow one grid along each axis so neighbouring segments line up
+                                for (float t = std::floor((start - phase) / (dash * 2.0f)) * dash * 2.0f + phase; t < end; t += dash * 2.0f) {
+                                    const float t0 = std::max(t, start), t1 = std::min(t + dash, end);
+                                    if (t0 < t1) {
+                                        drawList->AddLine(horizontal ? ImVec2(t0, a.y) : ImVec2(a.x, t0),
+                                                          horizontal ? ImVec2(t1, a.y) : ImVec2(a.x, t1), IM_COL32(0, 0, 0, 255));
+                                    }
+                                }
+                            }
+                        }
                     }
                     ImGui::End();
                     ImGui::PopStyleVar();
 
+                    // Sliders preview on the active layer; Apply commits one undo step
+                    ImGui::Begin("Filters");
+                    {
+                        static const char* filterNames[] = {"Gaussian Blur", "Unsharp Mask", "Levels", "Exposure", "Hue/Saturation"};
+                        bool changed = ImGui::Combo("Filter", &filterIndex, filterNames, IM_ARRAYSIZE(filterNames));
+                        switch (filterIndex) {
+                            case 0:
+                                changed |= ImGui::SliderFloat("Radius", &filterRadius, 0.1f, 100.0f, "%.1f px");
+                                break;
+                            case 1:
+                                changed |= ImGui::SliderFloat("Radius", &filterRadius, 0.1f, 100.0f, "%.1f px");
+                                changed |= ImGui::SliderFloat("Amount", &filterAmount, 0.0f, 5.0f);
+                                break;
+                            case 2:
+                                changed |= ImGui::SliderFloat("Input Black", &levelsBlack, 0.0f, 1.0f);
+                                changed |= ImGui::SliderFloat("Input White", &levelsWhite, 0.0f, 1.0f);
+                                changed |= ImGui::SliderFloat("Gamma", &levelsGamma, 0.1f, 10.0f);
+                                break;
+                            case 3:
+                                changed |= ImGui::SliderFloat("Exposure", &exposure, -5.0f, 5.0f, "%.2f EV");
+                                changed |= ImGui::SliderFloat("Offset", &exposureOffset, -0.5f, 0.5f, "%.3f");
+                                changed |= ImGui::SliderFloat("Gamma", &exposureGamma, 0.1f, 10.0f);
+                                break;
+                            default:
+                                changed |= ImGui::SliderFloat("Hue", &hue, -180.0f, 180.0f, "%.0f");
+                                changed |= ImGui::SliderFloat("Saturation", &saturation, -1.0f, 1.0f);
+                                changed |= ImGui::SliderFloat("Lightness", &lightness, -1.0f, 1.0f);
+                                break;
+                        }
+                        
+                        if (changed) {
+                            layerSystem.cancelTransform();
+                            if (!filterSession || !filterSession->isActive()) {
+                                filterSession = std::make_unique<AstralEngine::D2::FilterSession>(scene, layerSystem, layerSystem.getActiveLayer());
+                            }
+                            std::unique_ptr<AstralEngine::D2::Filter> filter;
+                            switch (filterIndex) {
+                                case 0: filter = std::make_unique<AstralEngine::D2::GaussianBlurFilter>(filterRadius); break;
+                                case 1: filter = std::make_unique<AstralEngine::D2::UnsharpMaskFilter>(filterRadius, filterAmount); break;
+                                case 2: filter = std::make_unique<AstralEngine::D2::LevelsFilter>(levelsBlack, levelsWhite, levelsGamma); break;
+                                case 3: filter = std::make_unique<AstralEngine::D2::ExposureFilter>(exposure, exposureOffset, exposureGamma); break;
+                                default: filter = std::make_unique<AstralEngine::D2::HueSaturationFilter>(hue, saturation, lightness); break;
+                            }
+                            filterSession->setFilter(std::move(filter));
+                        }
+                        
+                        if (filterSession && filterSession->isActive()) {
+                            if (ImGui::Button("Apply")) {
+                                filterSession->commit();
+                                filterSession.reset();
+                            }
+                            ImGui::SameLine();
+                            if (ImGui::Button("Cancel")) {
+                                filterSession.reset();
+                            }
+                            if (filterSession && filterSession->isRefining()) {
+                                ImGui::SameLine();
+                                ImGui::TextUnformatted("Refining...");
+                            }
+                        }
+                    }
+                    ImGui::End();
+                    if (filterSession) {
+                        filterSession->update();
+                    }
+
+                    // Live histogram of the active layer inside the selection
+                    ImGui::Begin("Histogram");
+                    {
+                        const auto activeLayer = layerSystem.getActiveLayer();
+                        const AstralEngine::D2::TiledImage* histogramSource = scene.hasComponent<AstralEngine::D2::Layer>(activeLayer)
+                            ? scene.getComponent<AstralEngine::D2::Layer>(activeLayer).pixels.get() : nullptr;
+                        histogramMonitor.update(histogramSource, selectionSystem.getClipMask());
+
+                        static const char* channelNames[] = {"Red", "Green", "Blue", "Luminosity"};
+                        ImGui::Combo("Channel", &histogramChannel, channelNames, IM_ARRAYSIZE(channelNames));
+                        const auto& histogram = histogramMonitor.getHistogram();
+                        const auto channel = static_cast<AstralEngine::D2::Histogram::Channel>(histogramChannel);
+                        float bins[AstralEngine::D2::Histogram::BIN_COUNT];
+                        for (uint32_t bin = 0; bin < AstralEngine::D2::Histogram::BIN_COUNT; ++bin) {
+                            bins[bin] = static_cast<float>(histogram.bins[channel][bin]);
+                        }
+                        ImGui::PlotHistogram("##bins", bins, IM_ARRAYSIZE(bins), 0, nullptr, 0.0f,
+                                             static_cast<float>(std::max(histogram.getPeak(channel), 1u)),
+                                             ImVec2(ImGui::GetContentRegionAvail().x, 100.0f));
+                        ImGui::Text("Pixels: %llu%s", static_cast<unsigned long long>(histogram.pixelCount),
+                                    histogramMonitor.isCounting() ? " (updating)" : "");
+                    }
+                    ImGui::End();
+
+                    // Layer stack, top first; thumbnails catch up in the background as layers are edited
+                    ImGui::Begin("Layers");
+                    {
+                        using AstralEngine::D2::LayerThumbnails;
+                        const auto& layerStack = layerSystem.getLayerStack();
+                        layerThumbnails.update(layerStack);
+                        while (thumbnailTextures.size() < layerThumbnails.getAtlasCount()) {
+                            const auto atlas = layerThumbnails.getAtlas(static_cast<uint32_t>(thumbnailTextures.size()));
+                            thumbnailTextures.push_back(ImGui_ImplVulkan_AddTexture(atlas->getSampler(), atlas->getImageView(),
+                                                                                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+                        }
+
+                        const auto& selectedLayers = layerSystem.getSelectedLayers();
+                        const float rowHeight = 40.0f;
+                        const float scale = rowHeight / LayerThumbnails::THUMBNAIL_SIZE;
+                        auto clickedLayer = AstralEngine::ECS::INVALID_ENTITY;
+                        for (auto it = layerStack.rbegin(); it != layerStack.rend(); ++it) {
+                            const auto layerId = *it;
+                            if (!scene.hasComponent<AstralEngine::D2::Layer>(layerId)) {
+                                continue;
+                            }
+                            const auto& layer = scene.getComponent<AstralEngine::D2::Layer>(layerId);
+                            ImGui::PushID(static_cast<int>(layerId));
+                            const ImVec2 rowStart = ImGui::GetCursorPos();
+                            const bool selected = std::find(selectedLayers.begin(), selectedLayers.end(), layerId) != selectedLayers.end();
+                            if (ImGui::Selectable("##layer", selected, 0, ImVec2(0.0f, rowHeight))) {
+                                clickedLayer = layerId;
+                            }
+
+                            ImGui::SetCursorPos(rowStart);
+                            if (const auto* thumbnail = layerThumbnails.getThumbnail(layerId); thumbnail && thumbnail->atlas < thumbnailTextures.size()) {
+                                ImGui::Image(reinterpret_cast<ImTextureID>(thumbnailTextures[thumbnail->atlas]),
+                                             ImVec2(thumbnail->width * scale, thumbnail->height * scale),
+                                             ImVec2(thumbnail->uv0.x, thumbnail->uv0.y), ImVec2(thumbnail->uv1.x, thumbnail->uv1.y));
+                            }
+                            ImGui::SetCursorPos(ImVec2(rowStart.x + rowHeight + ImGui::GetStyle().ItemSpacing.x,
+                                                       rowStart.y + (rowHeight - ImGui::GetTextLineHeight()) * 0.5f));
+                            ImGui::TextUnformatted(layer.name.c_str());
+                            ImGui::SetCursorPos(ImVec2(rowStart.x, rowStart.y + rowHeight + ImGui::GetStyle().ItemSpacing.y));
+                            ImGui::PopID();
+                        }
+                        if (clickedLayer != AstralEngine::ECS::INVALID_ENTITY) {
+                            layerSystem.clearSelection();
+                            layerSystem.selectLayer(clickedLayer);
+                        }
+                    }
+                    ImGui::End();
+
+                    // Tile memory; past the budget, cold tiles live in the swap file
+                    ImGui::Begin("Memory");
+                    {
+                        const auto paging = AstralEngine::Memory::MemoryManager::getInstance().getPagingStats();
+                        const auto mb = [](size_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); };
+                        ImGui::Text("Resident: %.0f / %.0f MB", mb(paging.residentBytes), mb(paging.budgetBytes));
+                        ImGui::Text("Swapped: %.0f MB (file %.0f MB)", mb(paging.swappedBytes), mb(paging.swapFileBytes));
+                        ImGui::Text("Page ins: %llu  Page outs: %llu", static_cast<unsigned long long>(paging.pageIns),
+                                    static_cast<unsigned long long>(paging.pageOuts));
+                        if (ImGui::InputInt("Budget (MB, 0 = none)", &config.tileMemoryBudgetMB, 256, 1024)) {
+                            config.tileMemoryBudgetMB = std::max(config.tileMemoryBudgetMB, 0);
+                            tileStore.setMemoryBudget(static_cast<size_t>(config.tileMemoryBudgetMB) << 20);
+                        }
+                        if (ImGui::Checkbox("Compress swap", &config.compressTileSwap)) {
+                            tileStore.setCompression(config.compressTileSwap);
+                        }
+                    }
+                    ImGui::End();
+
+                    // Dragging previews from a proxy; releasing commits the full-quality resample in the background
+                    ImGui::Begin("Transform");
+                    {
+                        bool moved = ImGui::DragFloat2("Offset", &transformOffset.x, 1.0f, 0.0f, 0.0f, "%.0f px");
+                        bool released = ImGui::IsItemDeactivatedAfterEdit();
+                        moved |= ImGui::SliderFloat("Angle", &transformAngle, -180.0f, 180.0f, "%.0f deg");
+                        released |= ImGui::IsItemDeactivatedAfterEdit();
+                        moved |= ImGui::SliderFloat("Scale", &transformScale, 0.05f, 4.0f);
+                        released |= ImGui::IsItemDeactivatedAfterEdit();
+                        
+                        if (moved && !layerSystem.isCommittingTransform()) {
+                            if (!layerSystem.isTransforming()) {
+                                filterSession.reset();
+                                layerSystem.beginTransform(layerSystem.getActiveLayer(), canvasSystem.getCanvasTextureLevel(canvasEntity));
+                            }
+                            // About the document center
+                            const glm::vec2 center(layerSystem.getDocumentWidth() * 0.5f, layerSystem.getDocumentHeight() * 0.5f);
+                            glm::mat3 transform = glm::translate(glm::mat3(1.0f), center + transformOffset);
+                            transform = glm::rotate(transform, glm::radians(transformAngle));
+                            transform = glm::scale(transform, glm::vec2(transformScale));
+                            layerSystem.previewTransform(glm::translate(transform, -center));
+                        }
+                        if (released && layerSystem.isTransforming()) {
+                            layerSystem.commitTransform();
+                            transformOffset = {0.0f, 0.0f};
+                            transformAngle = 0.0f;
+                            transformScale = 1.0f;
+                        }
+                        if (layerSystem.isCommittingTransform()) {
+                            ImGui::TextUnformatted("Applying...");
+                        }
+                    }
+                    ImGui::End();
+                    layerSystem.updateTransform();
+
                     // Note: canvasSystem.renderCanvas should be moved to CanvasPass
                     // For now, keep it here but it should be integrated into Vulkan pipeline
-                    canvasSystem.renderCanvas(canvasEntity, layerSystem.getLayerStack());
+                    canvasSystem.renderCanvas(canvasEntity, layerSystem.getLayerStack(), layerSystem.getActiveLayer());
                     toolManager.render();
                 }
                 
@@ -133,6 +431,7 @@ int main(int argc, char* argv[]) {
             return 1;
         }
 
+        tileStore.shutdown();
         AstralEngine::AssetManager::shutdown();
         AstralEngine::ShutdownEventSystem();
         AstralEngine::Memory::MemoryManager::getInstance().shutdown();